@@ -0,0 +1,53 @@
+# Generator zestawu treningowego dla kompilacji sterowanej profilem.
+# Wypisuje polecenia trybu wsadowego dla jednej z mieszanek:
+#   awk -v mix=golden|query|print -v seed=N -f make_replays.awk
+# Zestawy są deterministyczne dla danego ziarna, więc wersja bazowa
+# i zoptymalizowana czytają dokładnie to samo wejście.
+
+function pick(n) {
+    return int(rand() * n)
+}
+
+function command(kind) {
+    if (kind == "m")
+        printf "m %d %d %d\n", 1 + pick(players), pick(width), pick(height)
+    else if (kind == "g")
+        printf "g %d %d %d\n", 1 + pick(players), pick(width), pick(height)
+    else if (kind == "p")
+        print "p"
+    else
+        printf "%s %d\n", kind, 1 + pick(players)
+}
+
+BEGIN {
+    srand(seed == "" ? 1 : seed)
+    if (mix == "golden") {
+        width = 24; height = 24; players = 4; areas = 3; steps = 6000
+        split("m m m m g g q q f b", kinds, " ")
+    }
+    else if (mix == "query") {
+        width = 80; height = 60; players = 6; areas = 30; steps = 20000
+        split("m m m b b b f f f q", kinds, " ")
+    }
+    else if (mix == "print") {
+        width = 60; height = 40; players = 12; areas = 10; steps = 6000
+        split("m m m m m m b f p p", kinds, " ")
+    }
+    else {
+        print "unknown mix: " mix > "/dev/stderr"
+        exit 1
+    }
+    printf "B %d %d %d %d\n", width, height, players, areas
+    n = 0
+    for (k in kinds)
+        ++n
+    for (i = 0; i < steps; ++i) {
+        if (i % 500 == 0)
+            print "# krok " i
+        command(kinds[1 + pick(n)])
+    }
+    # Kilka niepoprawnych poleceń, żeby przećwiczyć ścieżki błędów.
+    print "m 1 2"
+    print "x"
+    print "f -1"
+}
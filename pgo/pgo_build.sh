@@ -0,0 +1,75 @@
+#!/bin/sh
+# Kompilacja sterowana profilem (PGO) z optymalizacją podczas konsolidacji
+# (LTO). Użycie: pgo_build.sh KATALOG_ŹRÓDEŁ KATALOG_ROBOCZY
+#
+# 1. Buduje wersję bazową (Release).
+# 2. Buduje wersję instrumentowaną i uruchamia ją na zestawie treningowym
+#    (mieszanki: złote ruchy, zapytania, wypisywanie planszy).
+# 3. Przebudowuje w tym samym katalogu z danymi profilu i LTO.
+# 4. Sprawdza, że wersja zoptymalizowana wypisuje to samo co bazowa,
+#    i porównuje czasy.
+set -e
+
+SOURCE_DIR=$(cd "${1:?source dir}" && pwd)
+WORK_DIR=${2:?work dir}
+MIXES="golden query print"
+
+mkdir -p "$WORK_DIR"
+WORK_DIR=$(cd "$WORK_DIR" && pwd)
+BASE_DIR=$WORK_DIR/base
+PGO_DIR=$WORK_DIR/pgo
+PROFILE_DIR=$WORK_DIR/profile
+REPLAY_DIR=$WORK_DIR/replays
+OUT_DIR=$WORK_DIR/out
+
+rm -rf "$PROFILE_DIR" "$OUT_DIR"
+mkdir -p "$PROFILE_DIR" "$REPLAY_DIR" "$OUT_DIR" "$BASE_DIR" "$PGO_DIR"
+
+for mix in $MIXES; do
+    awk -v mix="$mix" -v seed=2020 -f "$SOURCE_DIR/pgo/make_replays.awk" \
+        > "$REPLAY_DIR/$mix.in"
+done
+
+# Mierzy czas (w sekundach) przetworzenia wszystkich zestawów przez $1,
+# zapisując wyjście do plików z przyrostkiem $2.
+run_all() {
+    start=$(date +%s.%N)
+    for mix in $MIXES; do
+        "$1" < "$REPLAY_DIR/$mix.in" > "$OUT_DIR/$mix.$2" 2>&1 || true
+    done
+    end=$(date +%s.%N)
+    awk -v start="$start" -v end="$end" 'BEGIN { printf "%.3f", end - start }'
+}
+
+echo "== baseline build"
+(cd "$BASE_DIR" && cmake "$SOURCE_DIR" -DCMAKE_BUILD_TYPE=Release \
+    -DGAMMA_PGO=OFF -DGAMMA_LTO=OFF > /dev/null)
+cmake --build "$BASE_DIR" --target gamma > /dev/null
+
+echo "== instrumented build"
+(cd "$PGO_DIR" && cmake "$SOURCE_DIR" -DCMAKE_BUILD_TYPE=Release \
+    -DGAMMA_PGO=GENERATE -DGAMMA_PGO_DIR="$PROFILE_DIR" \
+    -DGAMMA_LTO=OFF > /dev/null)
+cmake --build "$PGO_DIR" --target gamma --clean-first > /dev/null
+
+echo "== training"
+run_all "$PGO_DIR/gamma" train > /dev/null
+
+echo "== optimised build"
+(cd "$PGO_DIR" && cmake "$SOURCE_DIR" -DCMAKE_BUILD_TYPE=Release \
+    -DGAMMA_PGO=USE -DGAMMA_PGO_DIR="$PROFILE_DIR" -DGAMMA_LTO=ON \
+    > /dev/null)
+cmake --build "$PGO_DIR" --target gamma --clean-first > /dev/null
+
+echo "== verification"
+base_time=$(run_all "$BASE_DIR/gamma" base)
+pgo_time=$(run_all "$PGO_DIR/gamma" pgo)
+for mix in $MIXES; do
+    if ! cmp -s "$OUT_DIR/$mix.base" "$OUT_DIR/$mix.pgo"; then
+        echo "output mismatch for $mix" >&2
+        exit 1
+    fi
+done
+
+echo "baseline: ${base_time}s, pgo+lto: ${pgo_time}s"
+echo "optimised binary: $PGO_DIR/gamma"
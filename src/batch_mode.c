@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include "batch_mode.h"
 #include "gamma.h"
+#include "record.h"
 
 #define BASE 10 ///< Podstawa systemu liczbowego wczytywanych liczb.
 #define BLANK 0 ///< Reprezentacja pustego paramtru.
@@ -71,6 +72,80 @@ static void print_command(gamma_t *g, const size_t *line) {
     free(board);
 }
 
+/**
+ * Funkcja pomocnicza realizująca polecenie wypisania statystyk silnika.
+ * Dla każdej operacji wypisuje wiersz z jej nazwą, liczbą wywołań i niepustymi
+ * przedziałami histogramu czasów w postaci numer:liczność, a następnie
+ * liczniki wykonanej pracy. Jeśli polecenie jest niepoprawne lub silnik
+ * skompilowano bez statystyk, wypisuje błąd na stderr.
+ * @param g     - Wskaźnik na planszę do gry w Gamma.
+ * @param line  - Wskaźnik na aktualny numer linii do wypisywania błędu.
+ */
+static void stats_command(gamma_t *g, const size_t *line) {
+    static const char *names[GAMMA_OP_COUNT] = {
+        "move", "golden_move", "busy_fields", "free_fields",
+        "golden_possible", "board", "print_board", "territory"
+    };
+    read_white_chars();
+
+    int c = getchar();
+    gamma_stats_t stats;
+    if (c != '\n' || !gamma_stats(g, &stats)) {
+        print_error(*line);
+        if (c != '\n')
+            skip_line();
+        return;
+    }
+
+    for (int op = 0; op < GAMMA_OP_COUNT; ++op) {
+        printf("%s %lu", names[op], stats.calls[op]);
+        for (int i = 0; i < GAMMA_STATS_BUCKETS; ++i)
+            if (stats.latency[op][i] > 0)
+                printf(" %d:%lu", i, stats.latency[op][i]);
+        printf("\n");
+    }
+    printf("cells_scanned %lu\n", stats.cells_scanned);
+    printf("find_root_hops %lu\n", stats.find_root_hops);
+    printf("golden_rebuilds %lu\n", stats.golden_rebuilds);
+    printf("golden_rebuilt_cells %lu\n", stats.golden_rebuilt_cells);
+}
+
+/**
+ * Funkcja pomocnicza realizująca polecenie wypisania potencjalnego
+ * terytorium graczy (@ref gamma_territory). Wypisuje w jednym wierszu
+ * liczby pól kolejnych graczy razem z pustymi polami, do których są
+ * najbliżej, a na końcu liczbę pozostałych pustych pól. Jeśli polecenie jest
+ * niepoprawne lub zabrakło pamięci, wypisuje błąd na stderr.
+ * @param g     - Wskaźnik na planszę do gry w Gamma.
+ * @param line  - Wskaźnik na aktualny numer linii do wypisywania błędu.
+ */
+static void territory_command(gamma_t *g, const size_t *line) {
+    read_white_chars();
+
+    int c = getchar();
+    if (c != '\n') {
+        print_error(*line);
+        skip_line();
+        return;
+    }
+
+    uint32_t players = gamma_get_players(g);
+    uint32_t *labels = malloc(sizeof(uint32_t) * gamma_get_width(g) *
+                              gamma_get_height(g));
+    uint64_t *counts = malloc(sizeof(uint64_t) * ((size_t) players + 1));
+    if (labels == NULL || counts == NULL ||
+        !gamma_territory(g, labels, counts)) {
+        print_error(*line);
+    }
+    else {
+        for (uint32_t player = 1; player <= players; ++player)
+            printf("%lu ", counts[player]);
+        printf("%lu\n", counts[0]);
+    }
+    free(labels);
+    free(counts);
+}
+
 /**
  * Sprawdza, czy dany znak @p c jest znakiem białym z przyjtą konwencją.
  * @param c     - znak do sprawdzenia.
@@ -225,8 +300,10 @@ static void busy_fields_command(gamma_t *g, bool *error, const size_t *line) {
  * @param error - Wskaźnik na zmienną trzymającą informację o poprawności
  * aktualnego polecenia.
  * @param line  - Wskaźnik na zmienną trzymającą aktualny numer wiersza.
+ * @param recorder - Wskaźnik na stan zapisu przebiegu gry albo NULL.
  */
-static void move_command(gamma_t *g, bool *error, const size_t *line) {
+static void move_command(gamma_t *g, bool *error, const size_t *line,
+                         gamma_recorder_t *recorder) {
     if (g == NULL) {
         *error = true;
         skip_line();
@@ -266,7 +343,9 @@ static void move_command(gamma_t *g, bool *error, const size_t *line) {
     }
 
     if (!(*error)) {
-        printf("%d\n", gamma_move(g, player, x, y));
+        printf("%d\n", recorder != NULL ?
+                        gamma_recorder_move(recorder, player, x, y) :
+                        gamma_move(g, player, x, y));
     }
     else {
         print_error(*line);
@@ -284,8 +363,10 @@ static void move_command(gamma_t *g, bool *error, const size_t *line) {
  * @param error - Wskaźnik na zmienną trzymającą informację o poprawności
  * aktualnego polecenia.
  * @param line  - Wskaźnik na zmienną trzymającą aktualny numer wiersza.
+ * @param recorder - Wskaźnik na stan zapisu przebiegu gry albo NULL.
  */
-static void golden_command(gamma_t *g, bool *error, const size_t *line) {
+static void golden_command(gamma_t *g, bool *error, const size_t *line,
+                           gamma_recorder_t *recorder) {
     int c = getchar();
     if (!is_white(c)) {
         *error = true;
@@ -315,7 +396,9 @@ static void golden_command(gamma_t *g, bool *error, const size_t *line) {
     }
 
     if (!(*error)) {
-        printf("%d\n", gamma_golden_move(g, player, x, y));
+        printf("%d\n", recorder != NULL ?
+                        gamma_recorder_golden_move(recorder, player, x, y) :
+                        gamma_golden_move(g, player, x, y));
     }
     else {
         print_error(*line);
@@ -371,16 +454,19 @@ static void golden_possible_command(gamma_t *g,
  * Jeśli @p c nie odpowiada żadnemu ustalonemu wcześniej poleceniu, zostaje
  * wypisany stosowny komunikat o błędzie na stderr zgodni ze specyfikacją
  * zadania.
+ * Ruchy i złote ruchy są zapisywane przez @p recorder, jeśli jest różny od
+ * NULL.
  */
-static void choose_command(gamma_t *g, int c, size_t *line) {
+static void choose_command(gamma_t *g, int c, size_t *line,
+                           gamma_recorder_t *recorder) {
     bool error = false;
 
     switch (c) {
         case 'm':
-            move_command(g, &error, line);
+            move_command(g, &error, line, recorder);
             break;
         case 'g':
-            golden_command(g, &error, line);
+            golden_command(g, &error, line, recorder);
             break;
         case 'b':
             busy_fields_command(g, &error, line);
@@ -394,6 +480,12 @@ static void choose_command(gamma_t *g, int c, size_t *line) {
         case 'p':
             print_command(g, line);
             break;
+        case 's':
+            stats_command(g, line);
+            break;
+        case 't':
+            territory_command(g, line);
+            break;
         default:
             print_error(*line);
             skip_line();
@@ -401,16 +493,18 @@ static void choose_command(gamma_t *g, int c, size_t *line) {
     }
 }
 
-void batch_mode(gamma_t *g, size_t *line) {
+void batch_mode(gamma_t *g, size_t *line, gamma_recorder_t *recorder) {
     int c;
 
     while (!feof(stdin) && (c = getchar()) != EOF) {
         if (c == '#')
             skip_line();
         else if (c != '\n')
-            choose_command(g, c, line);
+            choose_command(g, c, line, recorder);
 
         ++(*line);
     }
+    if (!gamma_recorder_finish(recorder))
+        perror("record");
     gamma_delete(g);
 }
\ No newline at end of file
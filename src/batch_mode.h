@@ -9,15 +9,20 @@
 
 #include <stddef.h>
 #include "gamma.h"
+#include "record.h"
 
 /**
  * Główna funkcja modułu. Realizuje rozgrywkę w trybie wsadowym zgodnie ze
  * specyfikacją zadania. Pod koniec działania zwalnia zaalokowaną pamięć
  * wskazywaną na przez @p g.
+ * Jeśli @p recorder jest różny od NULL, udane ruchy i złote ruchy są
+ * zapisywane w przebiegu gry, który na koniec zostaje zamknięty przez
+ * @ref gamma_recorder_finish.
  * @param g     - Wskaźnik na planszę do gry w Gamma. Różny od NULL.
  * @param line  - Wskaźnik na aktualny numer wiersza.
+ * @param recorder - Wskaźnik na stan zapisu przebiegu gry @p g albo NULL.
  */
-void batch_mode(gamma_t *g, size_t *line);
+void batch_mode(gamma_t *g, size_t *line, gamma_recorder_t *recorder);
 
 /**
  * Funkcja wypisująca błąd na stderr zgodni ze specyfikacją zadania.
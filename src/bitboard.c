@@ -0,0 +1,129 @@
+/**
+ * @file
+ * Implementacja operacji na planszach zapisanych jako maski bitowe wierszy.
+ */
+
+#include "bitboard.h"
+#include <stdbool.h>
+#include <string.h>
+
+uint64_t bitboard_row_mask(uint32_t width) {
+    if (width >= BITBOARD_MAX_SIDE)
+        return UINT64_MAX;
+    return ((uint64_t) 1 << width) - 1;
+}
+
+uint64_t bitboard_neighbours(const uint64_t *set, uint32_t height,
+                             uint64_t row_mask, uint32_t y) {
+    uint64_t row = set[y];
+    uint64_t around = (row << 1) | (row >> 1);
+    if (y > 0)
+        around |= set[y - 1];
+    if (y + 1 < height)
+        around |= set[y + 1];
+    return around & ~row & row_mask;
+}
+
+uint64_t bitboard_count_frontier(const uint64_t *player, const uint64_t *empty,
+                                 uint32_t height, uint64_t row_mask) {
+    uint64_t count = 0;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint64_t row = player[y];
+        uint64_t around = (row << 1) | (row >> 1);
+        if (y > 0)
+            around |= player[y - 1];
+        if (y + 1 < height)
+            around |= player[y + 1];
+        count += __builtin_popcountll(around & empty[y] & row_mask);
+    }
+    return count;
+}
+
+/**
+ * Funkcja pomocnicza rozszerzająca pola @p seed w poziomie, w obrębie
+ * ciągłych fragmentów wiersza @p mask.
+ * @param seed - Pola, od których zaczynamy.
+ * @param mask - Pola, po których wolno się rozszerzać.
+ * @return Wszystkie pola @p mask osiągalne z @p seed w obrębie wiersza.
+ */
+static uint64_t fill_row(uint64_t seed, uint64_t mask) {
+    uint64_t row = seed & mask;
+    uint64_t grown;
+    while ((grown = (row | (row << 1) | (row >> 1)) & mask) != row)
+        row = grown;
+    return row;
+}
+
+/**
+ * Funkcja pomocnicza wypełniająca obszar @p area w obrębie zbioru @p mask.
+ * Na przemian przegląda wiersze z góry na dół i z dołu do góry, dopóki
+ * obszar rośnie.
+ * @param mask - Wiersze zbioru pól, po których wolno się rozszerzać.
+ * @param height - Liczba wierszy.
+ * @param area - Wiersze obszaru, początkowo ziarno; na koniec cały obszar.
+ */
+static void flood(const uint64_t *mask, uint32_t height, uint64_t *area) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint32_t y = 0; y < height; ++y) {
+            uint64_t seed = area[y];
+            if (y > 0)
+                seed |= area[y - 1];
+            uint64_t row = fill_row(seed, mask[y]);
+            if (row != area[y]) {
+                area[y] = row;
+                changed = true;
+            }
+        }
+        for (uint32_t y = height; y-- > 0;) {
+            uint64_t seed = area[y];
+            if (y + 1 < height)
+                seed |= area[y + 1];
+            uint64_t row = fill_row(seed, mask[y]);
+            if (row != area[y]) {
+                area[y] = row;
+                changed = true;
+            }
+        }
+    }
+}
+
+uint32_t bitboard_split(const uint64_t *player, uint32_t height,
+                        uint64_t row_mask, uint32_t x, uint32_t y) {
+    uint64_t mask[BITBOARD_MAX_SIDE];
+    uint64_t area[BITBOARD_MAX_SIDE];
+    uint64_t bit = (uint64_t) 1 << x;
+
+    memcpy(mask, player, height * sizeof(uint64_t));
+    mask[y] &= ~bit;
+
+    // Sąsiedzi usuwanego pola należący do gracza, po jednym bicie na wiersz.
+    uint64_t same_row = ((bit << 1) | (bit >> 1)) & mask[y] & row_mask;
+    uint64_t above = y + 1 < height ? mask[y + 1] & bit : 0;
+    uint64_t below = y > 0 ? mask[y - 1] & bit : 0;
+    uint32_t neighbours = __builtin_popcountll(same_row) + (above != 0) +
+                          (below != 0);
+    if (neighbours <= 1)
+        return neighbours;
+
+    uint32_t areas = 0;
+    while (same_row != 0 || above != 0 || below != 0) {
+        memset(area, 0, height * sizeof(uint64_t));
+        if (same_row != 0)
+            area[y] = same_row & -same_row;
+        else if (above != 0)
+            area[y + 1] = above;
+        else
+            area[y - 1] = below;
+        flood(mask, height, area);
+        ++areas;
+
+        same_row &= ~area[y];
+        if (above != 0)
+            above &= ~area[y + 1];
+        if (below != 0)
+            below &= ~area[y - 1];
+    }
+    return areas;
+}
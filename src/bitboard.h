@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Interfejs operacji na planszach zapisanych jako maski bitowe wierszy.
+ * Plansza ma co najwyżej @ref BITBOARD_MAX_SIDE kolumn i wierszy; wiersz y
+ * zbioru pól to liczba uint64_t, w której bit x oznacza pole (x, y).
+ */
+
+#ifndef GAMMA_BITBOARD_H
+#define GAMMA_BITBOARD_H
+
+#include <stdint.h>
+
+/** Maksymalna szerokość i wysokość planszy zapisanej maskami wierszy. */
+#define BITBOARD_MAX_SIDE 64
+
+/**
+ * Funkcja podająca maskę poprawnych kolumn wiersza.
+ * @param width - Szerokość planszy, od 1 do @ref BITBOARD_MAX_SIDE.
+ * @return Maska z ustawionymi bitami od 0 do @p width - 1.
+ */
+uint64_t bitboard_row_mask(uint32_t width);
+
+/**
+ * Funkcja licząca pola zbioru @p empty, które sąsiadują z co najmniej jednym
+ * polem zbioru @p player, czyli liczbę jedynek w
+ * (rozszerzenie(@p player) & @p empty).
+ * @param player - Wiersze zbioru pól gracza.
+ * @param empty - Wiersze zbioru pustych pól.
+ * @param height - Liczba wierszy.
+ * @param row_mask - Maska poprawnych kolumn.
+ * @return Liczba pustych pól sąsiadujących z polami gracza.
+ */
+uint64_t bitboard_count_frontier(const uint64_t *player, const uint64_t *empty,
+                                 uint32_t height, uint64_t row_mask);
+
+/**
+ * Funkcja podająca pola sąsiadujące z polami zbioru @p set w wierszu @p y
+ * (bez samych pól zbioru).
+ * @param set - Wiersze zbioru pól.
+ * @param height - Liczba wierszy.
+ * @param row_mask - Maska poprawnych kolumn.
+ * @param y - Numer wiersza.
+ * @return Wiersz @p y zbioru sąsiadów.
+ */
+uint64_t bitboard_neighbours(const uint64_t *set, uint32_t height,
+                             uint64_t row_mask, uint32_t y);
+
+/**
+ * Funkcja licząca, na ile obszarów rozpadną się pola zbioru @p player
+ * sąsiadujące z polem (@p x, @p y), jeśli to pole zostanie usunięte ze
+ * zbioru. Obszary wyznacza wypełnianiem bitowym.
+ * @param player - Wiersze zbioru pól gracza, zawierającego pole (@p x, @p y).
+ * @param height - Liczba wierszy.
+ * @param row_mask - Maska poprawnych kolumn.
+ * @param x - Numer kolumny usuwanego pola.
+ * @param y - Numer wiersza usuwanego pola.
+ * @return Liczba różnych obszarów, do których należą sąsiedzi pola, od 0
+ * do 4.
+ */
+uint32_t bitboard_split(const uint64_t *player, uint32_t height,
+                        uint64_t row_mask, uint32_t x, uint32_t y);
+
+#endif //GAMMA_BITBOARD_H
@@ -2,12 +2,32 @@
 #include <stdlib.h>
 #include <errno.h>
 
-void initialize_field(field_t *field, uint32_t x, uint32_t y, uint32_t player) {
-    field->x = x;
-    field->y = y;
-    field->owner = player;
-    field->rep = field;
-    field->rank = 0;
+void reset_area(field_t *fields, area_t *areas, uint64_t field, uint32_t area,
+                uint32_t player, uint32_t x, uint32_t y) {
+    fields[field].link = ROOT_LINK | area;
+    area_t *it = &(areas[area]);
+    it->size = 1;
+    it->root = field;
+    it->player = player;
+    it->prev = NO_AREA;
+    it->next = NO_AREA;
+    it->min_x = it->max_x = x;
+    it->min_y = it->max_y = y;
+}
+
+void extend_area(field_t *fields, area_t *areas, uint64_t field,
+                 uint64_t root, uint32_t x, uint32_t y) {
+    fields[field].link = root;
+    area_t *it = &(areas[root_area(fields, root)]);
+    ++(it->size);
+    if (x < it->min_x)
+        it->min_x = x;
+    if (x > it->max_x)
+        it->max_x = x;
+    if (y < it->min_y)
+        it->min_y = y;
+    if (y > it->max_y)
+        it->max_y = y;
 }
 
 void* allocate_memory(size_t size, bool *error) {
@@ -23,30 +43,103 @@ void* allocate_memory(size_t size, bool *error) {
     return ptr;
 }
 
-field_t* find_root(field_t *field) {
-    if (field->rep == field)
-        return field;
-    return find_root(field->rep);
+uint64_t find_root(const field_t *fields, uint64_t field) {
+    while (!(fields[field].link & ROOT_LINK))
+        field = fields[field].link;
+    return field;
 }
 
-void unite(field_t first, field_t second) {
-    field_t *first_root = find_root(&first);
-    field_t *second_root = find_root(&second);
+uint32_t root_area(const field_t *fields, uint64_t root) {
+    return (uint32_t) (fields[root].link & ~ROOT_LINK);
+}
+
+uint32_t unite(field_t *fields, area_t *areas, uint64_t first,
+               uint64_t second) {
+    uint64_t first_root = find_root(fields, first);
+    uint64_t second_root = find_root(fields, second);
 
     if (first_root == second_root)
-        return;
-    if (first_root->rank > second_root->rank)
-        second_root->rep = first_root;
-    else if (first_root->rank < second_root->rank)
-        first_root->rep = second_root;
-    else {
-        second_root->rep = first_root;
-        ++(first_root->rank);
+        return NO_AREA;
+    uint32_t first_area = root_area(fields, first_root);
+    uint32_t second_area = root_area(fields, second_root);
+    area_t *kept = &(areas[first_area]);
+    area_t *absorbed = &(areas[second_area]);
+    if (kept->size < absorbed->size) {
+        area_t *swap = kept;
+        kept = absorbed;
+        absorbed = swap;
+        second_area = first_area;
     }
+    fields[absorbed->root].link = kept->root;
+
+    kept->size += absorbed->size;
+    if (absorbed->min_x < kept->min_x)
+        kept->min_x = absorbed->min_x;
+    if (absorbed->min_y < kept->min_y)
+        kept->min_y = absorbed->min_y;
+    if (absorbed->max_x > kept->max_x)
+        kept->max_x = absorbed->max_x;
+    if (absorbed->max_y > kept->max_y)
+        kept->max_y = absorbed->max_y;
+    return second_area;
 }
 
-void set_field(field_t *field, uint32_t x, uint32_t y, uint32_t player) {
-    field->x = x;
-    field->y = y;
-    field->owner = player;
+void move_area(field_t *fields, area_t *areas, root_list_t *lists,
+               uint32_t from, uint32_t to) {
+    area_t *area = &(areas[to]);
+    *area = areas[from];
+    fields[area->root].link = ROOT_LINK | to;
+    root_list_t *list = &(lists[area->player]);
+    if (area->prev != NO_AREA)
+        areas[area->prev].next = to;
+    else
+        list->first = to;
+    if (area->next != NO_AREA)
+        areas[area->next].prev = to;
+    else
+        list->last = to;
+}
+
+void root_list_init(root_list_t *list) {
+    list->first = NO_AREA;
+    list->last = NO_AREA;
+}
+
+void root_list_push(area_t *areas, root_list_t *list, uint32_t area) {
+    areas[area].prev = list->last;
+    areas[area].next = NO_AREA;
+    if (list->last != NO_AREA)
+        areas[list->last].next = area;
+    else
+        list->first = area;
+    list->last = area;
+}
+
+void root_list_remove(area_t *areas, root_list_t *list, uint32_t area) {
+    uint32_t prev = areas[area].prev;
+    uint32_t next = areas[area].next;
+    if (prev != NO_AREA)
+        areas[prev].next = next;
+    else
+        list->first = next;
+    if (next != NO_AREA)
+        areas[next].prev = prev;
+    else
+        list->last = prev;
+    areas[area].prev = NO_AREA;
+    areas[area].next = NO_AREA;
+}
+
+void root_list_append(area_t *areas, root_list_t *list, root_list_t *other) {
+    if (other->first == NO_AREA)
+        return;
+    if (list->last != NO_AREA) {
+        areas[list->last].next = other->first;
+        areas[other->first].prev = list->last;
+    }
+    else {
+        list->first = other->first;
+    }
+    list->last = other->last;
+    root_list_init(other);
 }
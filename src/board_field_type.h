@@ -2,6 +2,12 @@
  * @file
  * Interfejs struktury reprezentującej pole na planszy do gry w gamma wraz z
  * odpowiednimi funkcjami.
+ *
+ * Pola i obszary są trzymane w dwóch tablicach i wskazują się nawzajem
+ * indeksami. Pole pamięta tylko indeks swojego reprezentanta, a korzeń
+ * drzewa reprezentantów zamiast niego numer opisu obszaru, w którym jest
+ * rozmiar, prostokąt ograniczający i miejsce na liście obszarów gracza.
+ * Indeksy pól są 64-bitowe, więc liczby pól planszy nic nie ogranicza.
  */
 
 #ifndef GAMMA_BOARD_FIELD_TYPE_H
@@ -11,33 +17,78 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+/** Brak obszaru: koniec listy obszarów. */
+#define NO_AREA UINT32_MAX
+
+/** Brak pola: korzeń opisu obszaru, który nie jest używany. */
+#define NO_FIELD UINT64_MAX
+
+/** Bit odróżniający w polu numer opisu obszaru korzenia od indeksu
+ * reprezentanta. */
+#define ROOT_LINK ((uint64_t) 1 << 63)
+
 /**
  * Struktura reprezentująca pojedyńcze pole planszy do gry gamma.
  */
 typedef struct field {
-    uint32_t x; ///<Numer kolumny, w którym jest pole. Liczba nieujemna.
-    uint32_t y; ///< Numer wiersza, w którym jest pole. Liczba nieujemna.
-    uint32_t owner; /**< Właściciel danego pola(ma pionek na nim). Liczba
-    nieujemna. */
-    struct field *rep; /**<Reprezentant pola. Początkowo każde pole jest
-    swoim reprezentantem.*/
-    uint64_t rank; /**<Stopień pola, tj. liczba jego dzieci w drzewie
-    reprezentantów. */
+    uint64_t link; /**< Indeks reprezentanta pola w tablicy pól, a w korzeniu
+    drzewa reprezentantów ROOT_LINK z numerem opisu obszaru w tablicy
+    obszarów. */
 } field_t;
 
-//typedef struct field field_t;
+/**
+ * Struktura opisująca obszar, czyli drzewo reprezentantów pól gracza.
+ */
+typedef struct area {
+    uint64_t size; ///< Liczba pól obszaru.
+    uint64_t root; /**< Indeks korzenia drzewa w tablicy pól lub NO_FIELD dla
+    opisu, który przestał być używany. */
+    uint32_t player; ///< Numer gracza, do którego należy obszar.
+    uint32_t prev; ///< Poprzedni obszar na liście obszarów gracza lub NO_AREA.
+    uint32_t next; ///< Następny obszar na liście obszarów gracza lub NO_AREA.
+    uint32_t min_x; ///< Najmniejszy numer kolumny pola obszaru.
+    uint32_t min_y; ///< Najmniejszy numer wiersza pola obszaru.
+    uint32_t max_x; ///< Największy numer kolumny pola obszaru.
+    uint32_t max_y; ///< Największy numer wiersza pola obszaru.
+} area_t;
+
+/**
+ * Dwukierunkowa lista obszarów gracza, połączona numerami opisów obszarów.
+ */
+typedef struct root_list {
+    uint32_t first; ///< Pierwszy obszar na liście lub NO_AREA.
+    uint32_t last; ///< Ostatni obszar na liście lub NO_AREA.
+} root_list_t;
 
 /**
- * Funkcja inicjalizująca pole wskazywane przez @p field. Ustawia pole x, y,
- * player na wartości równe odpowiednim argumentom funkcji. Ustawia pole rank
- * struktury @ref field_t na 0 i wartość pola rep na wartość adresu w pamięci
- * danego pola [field].
- * @param field : Wskaźnik na pole na planszy.
+ * Funkcja robiąca z pola @p field jednopolowy obszar gracza @p player
+ * opisany przez @p area: pole staje się korzeniem drzewa, a obszar ma
+ * rozmiar 1, prostokąt ograniczający równy samemu polu i nie należy do
+ * żadnej listy obszarów.
+ * @param fields : Tablica pól.
+ * @param areas : Tablica opisów obszarów.
+ * @param field : Indeks pola.
+ * @param area : Numer wolnego opisu obszaru.
+ * @param player : Numer gracza, do którego należy pole.
  * @param x : Numer kolumny pola.
  * @param y : Numer wiersza pola.
- * @param player : Numer gracza, który będzie właścicielem pola.
  */
-void initialize_field(field_t *field, uint32_t x, uint32_t y, uint32_t player);
+void reset_area(field_t *fields, area_t *areas, uint64_t field, uint32_t area,
+                uint32_t player, uint32_t x, uint32_t y);
+
+/**
+ * Funkcja dołączająca pole @p field do obszaru o korzeniu @p root, do
+ * którego pole przylega: pole wskazuje wprost na korzeń, a opis obszaru
+ * powiększa rozmiar i prostokąt ograniczający.
+ * @param fields : Tablica pól.
+ * @param areas : Tablica opisów obszarów.
+ * @param field : Indeks pola spoza obszarów.
+ * @param root : Indeks korzenia drzewa reprezentantów.
+ * @param x : Numer kolumny pola.
+ * @param y : Numer wiersza pola.
+ */
+void extend_area(field_t *fields, area_t *areas, uint64_t field,
+                 uint64_t root, uint32_t x, uint32_t y);
 
 /**
  * Funkcja alokująca pamięć rozmiaru @p size. W razie niepowodzenia ustawia
@@ -51,32 +102,82 @@ void initialize_field(field_t *field, uint32_t x, uint32_t y, uint32_t player);
 void* allocate_memory(size_t size, bool *error);
 
 /**
- * Funkcja znajdująca korzeń drzewa reprezentantów pola wskazywanego na przez
- * @p field. Używana w celu rozróżnienia obszarów, do których pola planszy
- * należą.
- * @param field : Wskaźnik na pole planszy.
- * @return Wskaźnik na pole, które jest korzeniem drzewa reprezentantów, do
+ * Funkcja znajdująca korzeń drzewa reprezentantów pola @p field. Używana w
+ * celu rozróżnienia obszarów, do których pola planszy należą.
+ * @param fields : Tablica pól.
+ * @param field : Indeks pola.
+ * @return Indeks pola, które jest korzeniem drzewa reprezentantów, do
  * którego @p field należy.
  */
-field_t* find_root(field_t *field);
+uint64_t find_root(const field_t *fields, uint64_t field);
+
+/**
+ * Funkcja podająca numer opisu obszaru, którego korzeniem jest pole
+ * @p root.
+ * @param fields : Tablica pól.
+ * @param root : Indeks korzenia drzewa reprezentantów.
+ * @return Numer opisu obszaru.
+ */
+uint32_t root_area(const field_t *fields, uint64_t root);
 
 /**
  * Funkcja złączająca w jeden obszar pola @p first i @p second na zasadzie
  * algorytmu Union-Find, czyli połączeniu drzew reprezentatów tych pól.
- * @param first : Pierwsze pole planszy.
- * @param second : Drugie pole planszy.
+ * Korzeniem zostaje korzeń większego obszaru, a jego opis przejmuje
+ * rozmiar i prostokąt ograniczający obu obszarów.
+ * @param fields : Tablica pól.
+ * @param areas : Tablica opisów obszarów.
+ * @param first : Indeks pierwszego pola.
+ * @param second : Indeks drugiego pola.
+ * @return Numer opisu wchłoniętego obszaru albo NO_AREA, gdy pola już
+ * należały do jednego obszaru. Wywołujący usuwa go z listy obszarów i
+ * zwalnia.
  */
-void unite(field_t first, field_t second);
+uint32_t unite(field_t *fields, area_t *areas, uint64_t first,
+               uint64_t second);
 
 /**
- * Funkcja ustawiająca wartośći dla planszy wskazywanej na przez @p field.
- * Różni się od @ref initialize_field tym, że ustawia tylko pola x, y, player.
- * @param field : Wskaźnik na pole planszy, którego pola chcemy zmienić.
- * @param x : Numer kolumny pola.
- * @param y : Numer wiersza pola.
- * @param player : Numer gracza, którego ustawiamy na właśiciela pola.
+ * Funkcja przenosząca opis obszaru @p from pod numer @p to. Poprawia numer
+ * opisu w korzeniu obszaru i sąsiadów na liście obszarów gracza.
+ * @param fields : Tablica pól.
+ * @param areas : Tablica opisów obszarów.
+ * @param lists : Listy obszarów graczy, indeksowane numerem gracza.
+ * @param from : Numer używanego opisu obszaru.
+ * @param to : Numer wolnego opisu obszaru.
+ */
+void move_area(field_t *fields, area_t *areas, root_list_t *lists,
+               uint32_t from, uint32_t to);
+
+/**
+ * Funkcja tworząca pustą listę obszarów.
+ * @param list : Wskaźnik na listę.
+ */
+void root_list_init(root_list_t *list);
+
+/**
+ * Funkcja dopisująca obszar @p area na koniec listy @p list.
+ * @param areas : Tablica opisów obszarów.
+ * @param list : Wskaźnik na listę obszarów.
+ * @param area : Numer opisu obszaru spoza list.
+ */
+void root_list_push(area_t *areas, root_list_t *list, uint32_t area);
+
+/**
+ * Funkcja usuwająca obszar @p area z listy @p list.
+ * @param areas : Tablica opisów obszarów.
+ * @param list : Wskaźnik na listę obszarów, na której jest @p area.
+ * @param area : Numer opisu usuwanego obszaru.
+ */
+void root_list_remove(area_t *areas, root_list_t *list, uint32_t area);
+
+/**
+ * Funkcja przenosząca wszystkie obszary listy @p other na koniec listy
+ * @p list. Lista @p other zostaje pusta.
+ * @param areas : Tablica opisów obszarów.
+ * @param list : Wskaźnik na listę docelową.
+ * @param other : Wskaźnik na listę przenoszoną.
  */
-void set_field(field_t *field, uint32_t x, uint32_t y, uint32_t player);
+void root_list_append(area_t *areas, root_list_t *list, root_list_t *other);
 
 
 #endif //GAMMA_BOARD_FIELD_TYPE_H
@@ -0,0 +1,264 @@
+/**
+ * @file
+ * Implementacja strumienia zdarzeń planszy dla obserwatorów.
+ *
+ * Pisarz przed nadpisaniem bajtów pierścienia przesuwa znacznik reserved,
+ * a po zapisaniu całego zdarzenia znacznik published. Czytelnik kopiuje
+ * bajty do znacznika published, a potem sprawdza znacznik reserved: jeśli
+ * pisarz zaczął już nadpisywać któryś ze skopiowanych bajtów, kopia jest
+ * odrzucana, tak jak odczyt pod zamkiem sekwencyjnym.
+ */
+
+#include "feed.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define MARK_ALIGN 64 ///< Wyrównanie znaczników do linii pamięci podręcznej.
+#define VARINT_BITS 7 ///< Liczba bitów wartości w jednym bajcie liczby.
+#define VARINT_MORE 0x80 ///< Bit kontynuacji liczby.
+#define VARINT_MASK 0x7F ///< Maska bitów wartości w bajcie liczby.
+
+/**
+ * Struktura przechowująca pierścień zdarzeń.
+ */
+struct feed {
+    /** Koniec bajtów, które pisarz mógł już zacząć zapisywać. */
+    _Alignas(MARK_ALIGN) atomic_uint_fast64_t reserved;
+    /** Koniec opublikowanych zdarzeń. */
+    _Alignas(MARK_ALIGN) atomic_uint_fast64_t published;
+    /** Pozycja następnego zdarzenia, znana tylko pisarzowi. */
+    _Alignas(MARK_ALIGN) uint64_t head;
+    size_t mask; ///< Rozmiar pierścienia minus jeden.
+    atomic_uchar *ring; ///< Bajty pierścienia.
+};
+
+feed_t* feed_new(size_t capacity) {
+    if (capacity < GAMMA_EVENT_MAX_SIZE || capacity > (SIZE_MAX >> 1) + 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    feed_t *feed = aligned_alloc(MARK_ALIGN, sizeof(feed_t));
+    atomic_uchar *ring = malloc(size);
+    if (feed == NULL || ring == NULL) {
+        free(feed);
+        free(ring);
+        errno = ENOMEM;
+        return NULL;
+    }
+    atomic_init(&(feed->reserved), 0);
+    atomic_init(&(feed->published), 0);
+    feed->head = 0;
+    feed->mask = size - 1;
+    feed->ring = ring;
+    return feed;
+}
+
+void feed_delete(feed_t *feed) {
+    if (feed != NULL) {
+        free(feed->ring);
+        free(feed);
+    }
+}
+
+/**
+ * Funkcja pomocnicza zapisująca liczbę w kodzie zmiennej długości: po 7
+ * bitów na bajt, od najmłodszych, z najstarszym bitem ustawionym we
+ * wszystkich bajtach oprócz ostatniego.
+ * @param out - Miejsce na zakodowaną liczbę.
+ * @param value - Liczba.
+ * @return Liczba zapisanych bajtów.
+ */
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t length = 0;
+    while (value > VARINT_MASK) {
+        out[length++] = (uint8_t) (value | VARINT_MORE);
+        value >>= VARINT_BITS;
+    }
+    out[length++] = (uint8_t) value;
+    return length;
+}
+
+/**
+ * Funkcja pomocnicza kodująca zdarzenie.
+ * @param event - Wskaźnik na zdarzenie.
+ * @param out - Miejsce na co najmniej GAMMA_EVENT_MAX_SIZE bajtów.
+ * @return Liczba zapisanych bajtów.
+ */
+static size_t encode(const gamma_event_t *event, uint8_t *out) {
+    size_t length = 0;
+    out[length++] = (uint8_t) event->type;
+    switch (event->type) {
+        case GAMMA_EVENT_OWNER:
+            length += put_varint(out + length, event->x);
+            length += put_varint(out + length, event->y);
+            length += put_varint(out + length, event->player);
+            length += put_varint(out + length, event->previous);
+            break;
+        case GAMMA_EVENT_AREAS:
+            length += put_varint(out + length, event->player);
+            length += put_varint(out + length, event->previous);
+            length += put_varint(out + length, event->value);
+            break;
+        case GAMMA_EVENT_GOLDEN:
+            length += put_varint(out + length, event->player);
+            break;
+        case GAMMA_EVENT_BLOCKED:
+            length += put_varint(out + length, event->player);
+            length += put_varint(out + length, event->value);
+            break;
+        case GAMMA_EVENT_RESET:
+            length += put_varint(out + length, event->value);
+            break;
+    }
+    return length;
+}
+
+void feed_emit(feed_t *feed, const gamma_event_t *event) {
+    uint8_t bytes[GAMMA_EVENT_MAX_SIZE];
+    size_t length = encode(event, bytes);
+    uint64_t end = feed->head + length;
+    atomic_store_explicit(&(feed->reserved), end, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (size_t i = 0; i < length; ++i)
+        atomic_store_explicit(&(feed->ring[(feed->head + i) & feed->mask]),
+                              bytes[i], memory_order_relaxed);
+    atomic_store_explicit(&(feed->published), end, memory_order_release);
+    feed->head = end;
+}
+
+uint64_t feed_position(feed_t *feed) {
+    return atomic_load_explicit(&(feed->published), memory_order_acquire);
+}
+
+/**
+ * Funkcja pomocnicza odczytująca liczbę w kodzie zmiennej długości.
+ * @param data - Wskaźnik na wskaźnik na pierwszy bajt liczby, przesuwany za
+ * liczbę.
+ * @param end - Koniec danych.
+ * @param limit - Największa poprawna wartość.
+ * @param value - Wskaźnik, pod który zapisujemy liczbę.
+ * @return Wartość false, gdy liczba jest niedokończona lub niepoprawna.
+ */
+static bool get_varint(const uint8_t **data, const uint8_t *end,
+                       uint64_t limit, uint64_t *value) {
+    uint64_t result = 0;
+    for (uint32_t shift = 0; *data < end && shift < 64;
+         shift += VARINT_BITS) {
+        uint8_t byte = *((*data)++);
+        uint64_t bits = (uint64_t) (byte & VARINT_MASK);
+        if ((bits << shift) >> shift != bits)
+            return false;
+        result |= bits << shift;
+        if ((byte & VARINT_MORE) == 0) {
+            *value = result;
+            return result <= limit;
+        }
+    }
+    return false;
+}
+
+/**
+ * Funkcja pomocnicza odczytująca liczbę 32-bitową w kodzie zmiennej
+ * długości.
+ * @param data - Wskaźnik na wskaźnik na pierwszy bajt liczby, przesuwany za
+ * liczbę.
+ * @param end - Koniec danych.
+ * @param value - Wskaźnik, pod który zapisujemy liczbę.
+ * @return Wartość false, gdy liczba jest niedokończona lub niepoprawna.
+ */
+static bool get_uint32(const uint8_t **data, const uint8_t *end,
+                       uint32_t *value) {
+    uint64_t result;
+    if (!get_varint(data, end, UINT32_MAX, &result))
+        return false;
+    *value = (uint32_t) result;
+    return true;
+}
+
+size_t gamma_event_decode(const void *data, size_t size,
+                          gamma_event_t *event) {
+    const uint8_t *position = data;
+    const uint8_t *end = position + size;
+    if (size == 0)
+        return 0;
+    gamma_event_t result = {.type = *(position++)};
+    bool ok;
+    switch (result.type) {
+        case GAMMA_EVENT_OWNER:
+            ok = get_uint32(&position, end, &(result.x)) &&
+                 get_uint32(&position, end, &(result.y)) &&
+                 get_uint32(&position, end, &(result.player)) &&
+                 get_uint32(&position, end, &(result.previous));
+            break;
+        case GAMMA_EVENT_AREAS:
+            ok = get_uint32(&position, end, &(result.player)) &&
+                 get_uint32(&position, end, &(result.previous)) &&
+                 get_varint(&position, end, UINT32_MAX, &(result.value));
+            break;
+        case GAMMA_EVENT_GOLDEN:
+            ok = get_uint32(&position, end, &(result.player));
+            break;
+        case GAMMA_EVENT_BLOCKED:
+            ok = get_uint32(&position, end, &(result.player)) &&
+                 get_varint(&position, end, 1, &(result.value));
+            break;
+        case GAMMA_EVENT_RESET:
+            ok = get_varint(&position, end, UINT64_MAX, &(result.value));
+            break;
+        default:
+            ok = false;
+            break;
+    }
+    if (!ok)
+        return 0;
+    if (event != NULL)
+        *event = result;
+    return (size_t) (position - (const uint8_t*) data);
+}
+
+bool feed_read(feed_t *feed, uint64_t *position, void *buffer, size_t size,
+               size_t *length) {
+    uint64_t start = *position;
+    uint64_t end = atomic_load_explicit(&(feed->published),
+                                        memory_order_acquire);
+    if (start > end) {
+        errno = EINVAL;
+        return false;
+    }
+    uint64_t capacity = (uint64_t) feed->mask + 1;
+    uint64_t available = end - start;
+    bool lapped = available > capacity;
+    size_t count = available < size ? (size_t) available : size;
+    uint8_t *out = buffer;
+    if (!lapped) {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = atomic_load_explicit(
+                &(feed->ring[(start + i) & feed->mask]), memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t reserved = atomic_load_explicit(&(feed->reserved),
+                                                 memory_order_relaxed);
+        lapped = reserved - start > capacity;
+    }
+    if (lapped) {
+        *position = atomic_load_explicit(&(feed->published),
+                                         memory_order_acquire);
+        errno = ERANGE;
+        return false;
+    }
+
+    // Znacznik published stoi zawsze na granicy zdarzeń, więc obcięte może
+    // być tylko ostatnie zdarzenie, gdy zabrakło miejsca w buforze.
+    size_t whole = 0;
+    size_t event_length;
+    while (whole < count &&
+           (event_length = gamma_event_decode(out + whole, count - whole,
+                                              NULL)) > 0)
+        whole += event_length;
+    *position = start + whole;
+    *length = whole;
+    return true;
+}
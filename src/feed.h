@@ -0,0 +1,72 @@
+/**
+ * @file
+ * Interfejs strumienia zdarzeń planszy dla obserwatorów.
+ *
+ * Zdarzenia są kodowane zwięźle (bajt typu i liczby w kodzie zmiennej
+ * długości) i zapisywane do pierścienia bajtów, który zapisuje jeden wątek
+ * wykonujący ruchy. Każdy czytelnik pamięta tylko własną pozycję w
+ * strumieniu, więc dowolnie wielu czytelników czyta te same bajty bez
+ * zamków i bez zapisów do pamięci współdzielonej. Pisarz nie czeka na
+ * czytelników: czytelnik, którego pisarz zdążył wyprzedzić o cały
+ * pierścień, dowiaduje się o tym przy odczycie. Funkcje czytelnika są
+ * zadeklarowane w gamma.h.
+ */
+
+#ifndef GAMMA_FEED_H
+#define GAMMA_FEED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gamma.h"
+
+/**
+ * Struktura przechowująca pierścień zdarzeń.
+ */
+typedef struct feed feed_t;
+
+/**
+ * Funkcja tworząca pusty pierścień zdarzeń.
+ * @param capacity - Najmniejszy rozmiar pierścienia w bajtach, zaokrąglany
+ * w górę do potęgi dwójki, co najmniej GAMMA_EVENT_MAX_SIZE.
+ * @return Wskaźnik na pierścień lub NULL z ustawionym errno: EINVAL dla
+ * zbyt małego lub zbyt dużego rozmiaru i ENOMEM, gdy zabrakło pamięci.
+ */
+feed_t* feed_new(size_t capacity);
+
+/**
+ * Funkcja zwalniająca pierścień. Nikt nie może go wtedy czytać. Nic nie
+ * robi dla NULL.
+ * @param feed - Wskaźnik na pierścień.
+ */
+void feed_delete(feed_t *feed);
+
+/**
+ * Funkcja kodująca zdarzenie i publikująca je w pierścieniu.
+ * @param feed - Wskaźnik na pierścień.
+ * @param event - Wskaźnik na zdarzenie.
+ */
+void feed_emit(feed_t *feed, const gamma_event_t *event);
+
+/**
+ * Funkcja podająca pozycję końca opublikowanych zdarzeń.
+ * @param feed - Wskaźnik na pierścień.
+ * @return Liczba bajtów opublikowanych od utworzenia pierścienia.
+ */
+uint64_t feed_position(feed_t *feed);
+
+/**
+ * Funkcja kopiująca całe zdarzenia opublikowane od pozycji czytelnika.
+ * Robi to samo co @ref gamma_feed_read dla włączonego strumienia.
+ * @param feed - Wskaźnik na pierścień.
+ * @param position - Wskaźnik na pozycję czytelnika.
+ * @param buffer - Bufor na zdarzenia.
+ * @param size - Rozmiar bufora.
+ * @param length - Wskaźnik, pod który zapisujemy liczbę skopiowanych bajtów.
+ * @return Wartość false z ustawionym errno, gdy pozycja jest niepoprawna
+ * albo pisarz wyprzedził czytelnika o cały pierścień.
+ */
+bool feed_read(feed_t *feed, uint64_t *position, void *buffer, size_t size,
+               size_t *length);
+
+#endif //GAMMA_FEED_H
@@ -0,0 +1,259 @@
+/**
+ * @file
+ * Implementacja tablicy gier z pulą bloków pamięci plansz.
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do posix_memalign.
+
+#include <errno.h>
+#include <stdlib.h>
+#include "game_table.h"
+
+#define GRANULE 64 ///< Jednostka rozmiaru bloku i jego wyrównanie.
+#define LINEAR_CLASSES 8 /**< Liczba klas o rozmiarach będących kolejnymi
+wielokrotnościami GRANULE. */
+#define STEPS_SHIFT 2 /**< Logarytm liczby klas w każdym przedziale między
+kolejnymi potęgami dwójki powyżej klas liniowych. */
+#define CLASS_COUNT (LINEAR_CLASSES + 64 * (1 << STEPS_SHIFT)) /**< Liczba
+klas, z zapasem na wszystkie rozmiary typu size_t. */
+#define HANDLE_SHIFT 32 ///< Przesunięcie numeru pokolenia w uchwycie.
+#define NO_SLOT UINT32_MAX ///< Koniec listy wolnych miejsc.
+#define INITIAL_SLOTS 16 ///< Początkowa liczba miejsc na gry.
+
+/**
+ * Wolny blok w puli; jego pierwsze bajty wskazują następny wolny blok.
+ */
+typedef struct free_block free_block_t;
+
+/**
+ * Wolny blok w puli.
+ */
+struct free_block {
+    free_block_t *next; ///< Następny wolny blok tej samej klasy.
+};
+
+/**
+ * Miejsce na grę w tablicy.
+ */
+typedef struct game_slot {
+    gamma_t *g; ///< Gra lub NULL dla wolnego miejsca.
+    uint32_t generation; /**< Pokolenie miejsca, zwiększane przy usunięciu
+    gry, żeby stare uchwyty przestały działać. */
+    uint32_t next_free; ///< Następne wolne miejsce lub NO_SLOT.
+} game_slot_t;
+
+/**
+ * Struktura przechowująca tablicę gier.
+ */
+struct game_table {
+    gamma_allocator_t allocator; ///< Funkcje puli przekazywane do gier.
+    free_block_t *pool[CLASS_COUNT]; ///< Wolne bloki każdej klasy.
+    size_t pool_limit; ///< Największy łączny rozmiar wolnych bloków.
+    game_slot_t *slots; ///< Miejsca na gry.
+    uint32_t slot_count; ///< Liczba miejsc.
+    uint32_t free_slot; ///< Pierwsze wolne miejsce lub NO_SLOT.
+    game_table_stats_t stats; ///< Liczniki tablicy.
+};
+
+/**
+ * Funkcja pomocnicza podająca klasę bloku rozmiaru @p size.
+ * @param size - Rozmiar bloku, dodatni.
+ * @return Numer klasy.
+ */
+static uint32_t size_class(size_t size) {
+    size_t units = (size + GRANULE - 1) / GRANULE;
+    if (units <= LINEAR_CLASSES)
+        return (uint32_t) (units > 0 ? units - 1 : 0);
+    uint32_t exponent = 63 - (uint32_t) __builtin_clzll(units - 1);
+    uint32_t step = exponent - STEPS_SHIFT;
+    return LINEAR_CLASSES +
+           ((exponent - STEPS_SHIFT - 1) << STEPS_SHIFT) +
+           (uint32_t) ((units - 1) >> step) - (1u << STEPS_SHIFT);
+}
+
+/**
+ * Funkcja pomocnicza podająca rozmiar bloków klasy.
+ * @param class - Numer klasy.
+ * @return Rozmiar bloku w bajtach.
+ */
+static size_t class_size(uint32_t class) {
+    if (class < LINEAR_CLASSES)
+        return ((size_t) class + 1) * GRANULE;
+    uint32_t group = (class - LINEAR_CLASSES) >> STEPS_SHIFT;
+    uint32_t position = (class - LINEAR_CLASSES) & ((1u << STEPS_SHIFT) - 1);
+    uint32_t step = group + 1;
+    return (((size_t) (1u << STEPS_SHIFT) + position + 1) << step) * GRANULE;
+}
+
+/**
+ * Funkcja przydzielająca blok gry z puli, a gdy pula jest pusta, od
+ * systemu.
+ * @param size - Rozmiar bloku.
+ * @param alignment - Wymagane wyrównanie.
+ * @param ctx - Wskaźnik na tablicę.
+ * @return Wskaźnik na blok lub NULL, gdy zabrakło pamięci.
+ */
+static void* pool_alloc(size_t size, size_t alignment, void *ctx) {
+    game_table_t *table = ctx;
+    uint32_t class = size_class(size);
+    size_t rounded = class_size(class);
+    free_block_t *block = table->pool[class];
+    if (block != NULL && alignment <= GRANULE) {
+        table->pool[class] = block->next;
+        --(table->stats.pooled_blocks);
+        table->stats.pooled_bytes -= rounded;
+        ++(table->stats.reused);
+        return block;
+    }
+    void *ptr;
+    if (rounded < size ||
+        posix_memalign(&ptr, alignment > GRANULE ? alignment : GRANULE,
+                       rounded) != 0)
+        return NULL;
+    table->stats.allocated_bytes += rounded;
+    return ptr;
+}
+
+/**
+ * Funkcja oddająca blok gry do puli, a gdy pula jest pełna, do systemu.
+ * @param ptr - Wskaźnik na blok.
+ * @param size - Rozmiar bloku podany przy przydziale.
+ * @param ctx - Wskaźnik na tablicę.
+ */
+static void pool_free(void *ptr, size_t size, void *ctx) {
+    game_table_t *table = ctx;
+    uint32_t class = size_class(size);
+    size_t rounded = class_size(class);
+    if (table->stats.pooled_bytes + rounded > table->pool_limit) {
+        table->stats.allocated_bytes -= rounded;
+        free(ptr);
+        return;
+    }
+    free_block_t *block = ptr;
+    block->next = table->pool[class];
+    table->pool[class] = block;
+    ++(table->stats.pooled_blocks);
+    table->stats.pooled_bytes += rounded;
+}
+
+game_table_t* game_table_new(size_t pool_limit) {
+    game_table_t *table = calloc(1, sizeof(game_table_t));
+    if (table == NULL)
+        return NULL;
+    table->allocator.alloc = pool_alloc;
+    table->allocator.free = pool_free;
+    table->allocator.ctx = table;
+    table->pool_limit = pool_limit;
+    table->free_slot = NO_SLOT;
+    return table;
+}
+
+void game_table_delete(game_table_t *table) {
+    if (table == NULL)
+        return;
+    for (uint32_t i = 0; i < table->slot_count; ++i)
+        gamma_delete(table->slots[i].g);
+    for (uint32_t class = 0; class < CLASS_COUNT; ++class) {
+        while (table->pool[class] != NULL) {
+            free_block_t *block = table->pool[class];
+            table->pool[class] = block->next;
+            free(block);
+        }
+    }
+    free(table->slots);
+    free(table);
+}
+
+/**
+ * Funkcja pomocnicza podająca wolne miejsce na grę, w razie potrzeby
+ * powiększając tablicę miejsc.
+ * @param table - Wskaźnik na tablicę.
+ * @return Numer miejsca lub NO_SLOT, gdy zabrakło pamięci.
+ */
+static uint32_t take_slot(game_table_t *table) {
+    if (table->free_slot == NO_SLOT) {
+        uint32_t count = table->slot_count > 0 ? table->slot_count * 2 :
+                         INITIAL_SLOTS;
+        if (count <= table->slot_count || count == NO_SLOT)
+            return NO_SLOT;
+        game_slot_t *slots = realloc(table->slots,
+                                     sizeof(game_slot_t) * count);
+        if (slots == NULL)
+            return NO_SLOT;
+        for (uint32_t i = count; i-- > table->slot_count;) {
+            slots[i].g = NULL;
+            slots[i].generation = 1;
+            slots[i].next_free = table->free_slot;
+            table->free_slot = i;
+        }
+        table->slots = slots;
+        table->slot_count = count;
+    }
+    uint32_t slot = table->free_slot;
+    table->free_slot = table->slots[slot].next_free;
+    return slot;
+}
+
+game_handle_t game_table_create(game_table_t *table, uint32_t width,
+                                uint32_t height, uint32_t players,
+                                uint32_t areas) {
+    uint32_t slot = take_slot(table);
+    if (slot == NO_SLOT) {
+        errno = ENOMEM;
+        return GAME_HANDLE_NONE;
+    }
+    gamma_t *g = gamma_new_ex(width, height, players, areas,
+                              &(table->allocator));
+    if (g == NULL) {
+        table->slots[slot].next_free = table->free_slot;
+        table->free_slot = slot;
+        return GAME_HANDLE_NONE;
+    }
+    table->slots[slot].g = g;
+    ++(table->stats.live);
+    ++(table->stats.created);
+    return ((game_handle_t) table->slots[slot].generation << HANDLE_SHIFT) |
+           ((game_handle_t) slot + 1);
+}
+
+/**
+ * Funkcja pomocnicza podająca miejsce żyjącej gry o danym uchwycie.
+ * @param table - Wskaźnik na tablicę.
+ * @param handle - Uchwyt gry.
+ * @return Wskaźnik na miejsce lub NULL, gdy uchwyt nie wskazuje żyjącej
+ * gry.
+ */
+static game_slot_t* find_slot(const game_table_t *table,
+                              game_handle_t handle) {
+    uint64_t index = (handle & ((1ull << HANDLE_SHIFT) - 1));
+    if (index == 0 || index > table->slot_count)
+        return NULL;
+    game_slot_t *slot = &(table->slots[index - 1]);
+    if (slot->g == NULL || slot->generation != handle >> HANDLE_SHIFT)
+        return NULL;
+    return slot;
+}
+
+gamma_t* game_table_get(const game_table_t *table, game_handle_t handle) {
+    game_slot_t *slot = find_slot(table, handle);
+    return slot != NULL ? slot->g : NULL;
+}
+
+bool game_table_remove(game_table_t *table, game_handle_t handle) {
+    game_slot_t *slot = find_slot(table, handle);
+    if (slot == NULL)
+        return false;
+    gamma_delete(slot->g);
+    slot->g = NULL;
+    // Pokolenie 0 nie występuje w uchwytach, więc uchwyt nigdy nie jest 0.
+    if (++(slot->generation) == 0)
+        slot->generation = 1;
+    slot->next_free = table->free_slot;
+    table->free_slot = (uint32_t) (slot - table->slots);
+    --(table->stats.live);
+    return true;
+}
+
+void game_table_stats(const game_table_t *table, game_table_stats_t *out) {
+    *out = table->stats;
+}
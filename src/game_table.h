@@ -0,0 +1,95 @@
+/**
+ * @file
+ * Interfejs tablicy gier: rejestru wielu gier żyjących w jednym procesie,
+ * do których odwołujemy się uchwytami. Bloki pamięci plansz przydziela pula
+ * z klasami rozmiarów: rozmiar bloku jest zaokrąglany w górę do klasy (co
+ * najwyżej o jedną czwartą), a zwolnione bloki czekają w puli swojej klasy
+ * na następną grę o podobnych wymiarach. Tablica nie jest bezpieczna dla
+ * wątków; korzysta z niej jeden wątek naraz.
+ */
+#ifndef GAMMA_GAME_TABLE_H
+#define GAMMA_GAME_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gamma.h"
+
+/** Uchwyt gry w tablicy gier. */
+typedef uint64_t game_handle_t;
+
+/** Uchwyt, który nie wskazuje żadnej gry. */
+#define GAME_HANDLE_NONE 0
+
+/**
+ * Struktura przechowująca tablicę gier.
+ */
+typedef struct game_table game_table_t;
+
+/**
+ * Liczniki tablicy gier.
+ */
+typedef struct game_table_stats {
+    uint64_t live; ///< Liczba żyjących gier.
+    uint64_t created; ///< Liczba gier utworzonych od początku.
+    uint64_t reused; ///< Liczba gier, które dostały blok z puli.
+    uint64_t pooled_blocks; ///< Liczba bloków czekających w puli.
+    uint64_t pooled_bytes; ///< Rozmiar bloków czekających w puli.
+    uint64_t allocated_bytes; /**< Rozmiar wszystkich bloków przydzielonych
+    przez system, w grach i w puli. */
+} game_table_stats_t;
+
+/**
+ * Funkcja tworząca pustą tablicę gier.
+ * @param pool_limit - Największy łączny rozmiar bloków czekających w puli;
+ * blok, który by go przekroczył, wraca do systemu.
+ * @return Wskaźnik na tablicę lub NULL, gdy zabrakło pamięci.
+ */
+game_table_t* game_table_new(size_t pool_limit);
+
+/**
+ * Funkcja usuwająca tablicę razem z jej żyjącymi grami i pulą. Nic nie robi
+ * dla NULL.
+ * @param table - Wskaźnik na tablicę.
+ */
+void game_table_delete(game_table_t *table);
+
+/**
+ * Funkcja tworząca grę, jak @ref gamma_new, w pamięci z puli tablicy.
+ * @param table - Wskaźnik na tablicę.
+ * @param width - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @param players - Liczba graczy.
+ * @param areas - Maksymalna liczba obszarów gracza.
+ * @return Uchwyt gry lub GAME_HANDLE_NONE, gdy parametry są niepoprawne
+ * albo zabrakło pamięci.
+ */
+game_handle_t game_table_create(game_table_t *table, uint32_t width,
+                                uint32_t height, uint32_t players,
+                                uint32_t areas);
+
+/**
+ * Funkcja podająca grę o danym uchwycie.
+ * @param table - Wskaźnik na tablicę.
+ * @param handle - Uchwyt gry.
+ * @return Wskaźnik na grę lub NULL, gdy uchwyt nie wskazuje żyjącej gry, np.
+ * gdy gra została już usunięta.
+ */
+gamma_t* game_table_get(const game_table_t *table, game_handle_t handle);
+
+/**
+ * Funkcja usuwająca grę i oddająca jej blok do puli.
+ * @param table - Wskaźnik na tablicę.
+ * @param handle - Uchwyt gry.
+ * @return Wartość false, gdy uchwyt nie wskazuje żyjącej gry.
+ */
+bool game_table_remove(game_table_t *table, game_handle_t handle);
+
+/**
+ * Funkcja podająca liczniki tablicy.
+ * @param table - Wskaźnik na tablicę.
+ * @param out - Wskaźnik, pod który zapisujemy liczniki.
+ */
+void game_table_stats(const game_table_t *table, game_table_stats_t *out);
+
+#endif //GAMMA_GAME_TABLE_H
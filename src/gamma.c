@@ -3,11 +3,36 @@
  * Implementacja silnika do gry w gamma.
  */
 
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do clock_gettime.
+#define _DEFAULT_SOURCE ///< Potrzebne do madvise.
+#define _GNU_SOURCE ///< Potrzebne do zamków preferujących pisarza.
+
 #include "gamma.h"
 #include "board_field_type.h"
+#include "bitboard.h"
+#include "thread_pool.h"
+#include "move_index.h"
+#include "snapshot.h"
+#include "seqlock.h"
+#include "spectate.h"
+#include "feed.h"
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(GAMMA_NO_SIMD)
+/** Jądra AVX2 są kompilowane i wybierane w czasie działania programu. */
+#define GAMMA_AVX2
+#include <immintrin.h>
+#endif
 
 #define EMPTY 0 /**< Używam numeru 0 jako numeru pustego gracza. Powoduje
  * to, że numeracja gracza o numerze 2^32 - 1 może nie działać prawidłowo dla
@@ -15,6 +40,97 @@
  * istnienie takiego gracza jest niemożliwe ze względów technicznych, takich
  * jak brak pamięci. */
 #define LOG_BASE 10 ///< Baza logarytmu używana w kodzie.
+#define CACHE_LINE 64 ///< Wyrównanie tablic w bloku pamięci planszy.
+#define HUGE_PAGE_SIZE (2u << 20) ///< Rozmiar dużej strony pamięci.
+#define MAX_THREADS 256 ///< Największa liczba wątków puli planszy.
+#define BANDS_PER_THREAD 4 ///< Liczba pasów wierszy na jeden wątek puli.
+#define MAX_BANDS (MAX_THREADS * BANDS_PER_THREAD) ///< Limit pasów wierszy.
+#define REBUILD_BANDS 64 ///< Limit pasów wierszy przebudowy obszarów gracza.
+#define SYMMETRIES 8 ///< Największa liczba symetrii planszy.
+#define GOLDEN_SALT 0xA0761D6478BD642Full ///< Odróżnia klucze złotych ruchów.
+#define SNAPSHOT_CHUNK (1u << 16) ///< Rozmiar bufora zapisu i odczytu migawek.
+#define TERRITORY_CHUNK 1024 ///< Liczba pól kolejki na jedno zadanie przeglądu.
+#define TERRITORY_BUFFER (4 * TERRITORY_CHUNK) ///< Bufor pól dopisywanych do kolejki.
+#define NOT_WATCHED UINT32_MAX ///< Gracz spoza listy obserwowanych.
+#define SPLIT_SEARCH_QUEUE 16 ///< Początkowy rozmiar kolejki przeszukiwania.
+#define STREAM_BYTES (8u << 20) /**< Liczba bajtów planszy w pliku, po
+których przegląd całej planszy oddaje jądru przejrzane strony. */
+#ifndef GAMMA_PARALLEL_MIN_CELLS
+/** Najmniejsza liczba pól planszy, dla której przeglądy są dzielone między
+ * wątki puli. */
+#define GAMMA_PARALLEL_MIN_CELLS (1u << 16)
+#endif
+
+#ifdef GAMMA_STATS
+/** Dodaje @p n do licznika @p counter statystyk planszy @p g. Dodawanie
+ * jest atomowe, bo w trybie współbieżnym liczniki zwiększa naraz wielu
+ * czytelników. */
+#define STATS_ADD(g, counter, n) \
+    __atomic_fetch_add(&((g)->stats.counter), (n), __ATOMIC_RELAXED)
+/** Zapamiętuje w zmiennej @p start moment rozpoczęcia operacji. */
+#define STATS_START(start) uint64_t start = stats_now()
+/** Zapisuje wywołanie operacji @p op rozpoczętej w chwili @p start. */
+#define STATS_RECORD(g, op, start) stats_record((g), (op), (start))
+#else
+/** Bez statystyk nic nie robi. */
+#define STATS_ADD(g, counter, n) ((void) 0)
+/** Bez statystyk nic nie robi. */
+#define STATS_START(start) ((void) 0)
+/** Bez statystyk nic nie robi. */
+#define STATS_RECORD(g, op, start) ((void) 0)
+#endif
+
+/**
+ * Liczniki gracza publikowane w trybie współbieżnym pod zamkiem
+ * sekwencyjnym.
+ */
+typedef struct published_player {
+    atomic_uint_fast64_t fields; /**< Liczba pól gracza, a pod numerem EMPTY
+    liczba pustych pól. */
+    atomic_uint_fast64_t frontier; /**< Liczba wolnych pól gracza, jeśli ma
+    maksymalną liczbę obszarów; w przeciwnym razie 0. */
+    atomic_uint_fast32_t areas; ///< Liczba obszarów gracza.
+    atomic_bool golden_used; ///< Czy gracz wykorzystał złoty ruch.
+} published_player_t;
+
+/**
+ * Stan trybu współbieżnego planszy. Ruchy wykonuje się pod zamkiem
+ * pisarza, a po każdym udanym ruchu liczniki zmienionych graczy, wersja i
+ * skrót stanu gry są publikowane pod zamkiem sekwencyjnym, więc tanie
+ * odczyty nie czekają na nikogo. Odczyty przeglądające planszę biorą zamek
+ * czytelnika, a te, które przy okazji zmieniają stan pomocniczy planszy,
+ * zamek pisarza.
+ */
+typedef struct gamma_sync {
+    pthread_rwlock_t lock; ///< Zamek stanu planszy.
+    seqlock_t published; ///< Zamek sekwencyjny opublikowanych liczników.
+    atomic_uint_fast64_t version; ///< Opublikowana wersja stanu gry.
+    atomic_uint_fast64_t hash; ///< Opublikowany skrót stanu gry.
+    published_player_t *players; ///< Liczniki graczy, players + 1 elementów.
+    uint64_t empty; ///< Liczba pustych pól, zmieniana pod zamkiem pisarza.
+    uint64_t *frontier; /**< Liczby pustych pól sąsiednich polom graczy,
+    players + 1 elementów, zmieniane pod zamkiem pisarza. */
+} gamma_sync_t;
+
+/**
+ * Stan strumienia zdarzeń planszy. Oprócz pierścienia pamięta ostatnio
+ * zgłoszone liczby obszarów i możliwości ruchu graczy oraz listę graczy
+ * obserwowanych: tych, którzy nie wykorzystali złotego ruchu, a nie mają
+ * wolnych pól. Możliwość ruchu pozostałych graczy zależy tylko od ich
+ * wolnych pól, a te zmienia wyłącznie ruch na polu ich lub sąsiednim albo
+ * zapełnienie planszy, więc po ruchu wystarczy sprawdzić graczy z
+ * sąsiedztwa pola i obserwowanych.
+ */
+typedef struct observe {
+    feed_t *feed; ///< Pierścień zdarzeń.
+    uint32_t *areas; ///< Zgłoszone liczby obszarów, players + 1 elementów.
+    bool *blocked; ///< Czy gracz został zgłoszony jako bez ruchu.
+    uint32_t *watched; ///< Lista graczy obserwowanych.
+    uint32_t *watched_slot; /**< Położenie gracza na liście obserwowanych
+    lub NOT_WATCHED. */
+    uint32_t watched_count; ///< Długość listy obserwowanych.
+    bool filled; ///< Czy plansza była pełna przy ostatnim sprawdzeniu.
+} observe_t;
 
 /**
  * Struktura reprezentująca planszę do gry w gamma.
@@ -23,7 +139,27 @@ struct gamma {
     uint32_t height; ///< Ilość wierszy planszy.
     uint32_t width; ///< Ilość kolumn planszy.
 
-    field_t **fields; ///< Tablica dwuwymiarowa pól planszy.
+    field_t *fields; /**< Drzewa reprezentantów pól planszy w układzie
+    layout, bez ramki. Pole (x, y) to fields[field_index(g, x, y)]. Pola bez
+    pionka nie są czytane ani inicjowane. */
+    area_t *area_slots; /**< Opisy obszarów wskazywane przez korzenie drzew
+    reprezentantów. Używane są opisy o numerach mniejszych od area_count. */
+    uint32_t area_count; ///< Liczba używanych opisów obszarów.
+    uint32_t area_slot_count; ///< Rozmiar tablicy area_slots.
+    gamma_layout_t layout; ///< Układ tablicy fields.
+    uint32_t tile_shift; /**< Logarytm boku kwadratu pól dla układów innych
+    niż wiersz po wierszu. */
+    size_t tiles_per_row; ///< Liczba kwadratów pól w jednym pasie kwadratów.
+    void *owners; /**< Właściciele pól planszy, wiersz po wierszu, otoczeni
+    ramką szerokości jednego pola o największej wartości typu, która nie jest
+    numerem żadnego gracza. Elementy mają rozmiar owner_bytes. */
+    bool use_avx2; ///< Czy procesor pozwala na użycie jąder AVX2.
+    uint32_t owner_bytes; /**< Rozmiar numeru właściciela pola: 1, 2 lub 4
+    bajty, najmniejszy, w którym mieszczą się numery wszystkich graczy. */
+    uint64_t *bits; /**< Dla plansz o bokach do 64 pól i 8-bitowych numerów
+    graczy: maski wierszy pól każdego gracza, a pod numerem EMPTY maski pustych
+    pól, po height masek na gracza. Dla pozostałych plansz NULL. */
+    uint64_t row_mask; ///< Maska poprawnych kolumn wiersza, gdy bits != NULL.
 
     uint32_t areas; ///< Maksymalna ilość obszarów, którą może mieć gracz.
     uint32_t players; ///< Liczba graczy.
@@ -31,172 +167,686 @@ struct gamma {
     uint64_t *player_fields; ///< Tablica przechowująca ilość pól graczy.
     bool *golden_used; /**< Tablica przechowująca informację, czy dany gracz
     wykorzystał złoty ruch. */
+    root_list_t *player_roots; ///< Listy obszarów każdego gracza.
 
     bool no_memory; /**< Zmienna przechowująca informacje, czy skończyła się
     pamięć. */
+    gamma_allocator_t allocator; /**< Funkcje, którymi przydzielono blok
+    pamięci zaczynający się od tej struktury. */
+    size_t block_size; ///< Rozmiar tego bloku.
+    bool mapped; ///< Czy blok jest plikiem odwzorowanym w pamięć.
+    thread_pool_t *pool; /**< Pula wątków przeglądów całej planszy lub NULL,
+    gdy przeglądy są wykonywane w jednym wątku. */
+    move_index_t *moves; /**< Indeks ruchów budowany przy pierwszym wypisaniu
+    ruchów lub NULL. */
+    uint32_t *territory_queue; /**< Kolejka przeglądu @ref gamma_territory
+    przydzielana przy pierwszym wywołaniu lub NULL. */
+    atomic_bool territory_busy; /**< Czy kolejkę planszy zajmuje przegląd;
+    przeglądy równoczesne z nim przydzielają własną. */
+    uint64_t hash[SYMMETRIES]; /**< Skróty Zobrista stanu gry: pod indeksem 0
+    skrót planszy, a pod kolejnymi skróty jej obrazów w symetriach planszy. */
+    uint32_t hash_count; /**< Liczba aktualizowanych skrótów: 1, dopóki nikt
+    nie zapytał o skrót kanoniczny, a potem liczba symetrii planszy. */
+    uint64_t version; ///< Liczba udanych ruchów i złotych ruchów.
+    gamma_sync_t *sync; ///< Stan trybu współbieżnego lub NULL.
+    spectate_t *spectate; ///< Stan migawek dla obserwatorów lub NULL.
+    observe_t *observe; ///< Stan strumienia zdarzeń lub NULL.
+#ifdef GAMMA_STATS
+    gamma_stats_t stats; ///< Liczniki operacji i histogramy czasów.
+#endif
 };
 
+#ifdef GAMMA_STATS
+/**
+ * Funkcja pomocnicza podająca aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t stats_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
 /**
- * Funkcja pomocnicza dealokująca pamięć dla pola [fields] struktury [gamma_t].
- * Ustawia wartość wskaźnika [fields] na wartość NULL.
- * @param g - Wskaźnik na planszę, której jesteśmy w trakcie niszczenia.
+ * Funkcja pomocnicza zapisująca wywołanie operacji @p op. Zwiększa licznik
+ * wywołań i dopisuje czas wykonania do odpowiedniego przedziału histogramu.
+ * Przedział numer i zawiera czasy z zakresu [2^i, 2^(i+1)) nanosekund.
+ * @param g     - Wskaźnik na planszę, może być NULL.
+ * @param op    - Numer operacji.
+ * @param start - Moment rozpoczęcia operacji.
  */
-static void delete_fields(gamma_t *g) {
-    if (g->fields == NULL)
+static void stats_record(gamma_t *g, gamma_op_t op, uint64_t start) {
+    if (g == NULL)
         return;
-    for (uint32_t i = 0; i < g->height; ++i)
-        free(g->fields[i]);
-    free(g->fields);
-    g->fields = NULL;
+    uint64_t elapsed = stats_now() - start;
+    uint32_t bucket = 0;
+    while (elapsed > 1 && bucket < GAMMA_STATS_BUCKETS - 1) {
+        elapsed >>= 1;
+        ++bucket;
+    }
+    STATS_ADD(g, calls[op], 1);
+    STATS_ADD(g, latency[op][bucket], 1);
 }
+#endif
 
-void gamma_delete(gamma_t *g) {
-    if (g != NULL) {
-        delete_fields(g);
-        if (g->player_areas != NULL) {
-            free(g->player_areas);
-            g->player_areas = NULL;
-        }
-        free(g->golden_used);
-        free(g->player_fields);
-        free(g);
+/**
+ * Funkcja pomocnicza znajdująca korzeń drzewa reprezentantów pola @p field.
+ * Przy włączonych statystykach zlicza przebyte krawędzie drzewa.
+ * @param g     - Wskaźnik na planszę.
+ * @param field - Indeks pola planszy w tablicy fields.
+ * @return Indeks korzenia drzewa reprezentantów.
+ */
+static uint64_t root(gamma_t *g, uint64_t field) {
+#ifdef GAMMA_STATS
+    uint64_t hops = 0;
+    while (!(g->fields[field].link & ROOT_LINK)) {
+        field = g->fields[field].link;
+        ++hops;
     }
+    STATS_ADD(g, find_root_hops, hops);
+    return field;
+#else
+    return find_root(g->fields, field);
+#endif
 }
 
 /**
- * Funkcja pomocnicza alokująca pamięć dla pola @p fields struktury
- * @ref gamma_t. W przypadku braku pamięci w trakcie działania, dealokują całą
- * dotychczas zaalokowaną w tej funkcji pamięć.
- * @param g - Wskaźnik na planszę, której jesteśmy w trakcie tworzenia.
- * @return Wskaźnik na tablicę dwuwymiarową typu @ref field_t w przypadku
- * powodzenia lub NULL w przypadku błędu(brak pamięci).
+ * Funkcja pomocnicza robiąca z pola @p field jednopolowy obszar gracza
+ * @p player na końcu listy jego obszarów.
+ * @param g      - Wskaźnik na planszę.
+ * @param player - Numer gracza, do którego należy pole.
+ * @param field  - Indeks pola planszy w tablicy fields.
+ * @param x      - Numer kolumny pola.
+ * @param y      - Numer wiersza pola.
  */
-static field_t** initialize_fields(gamma_t *g) {
-    if (g == NULL || g->no_memory)
-        return NULL;
-    field_t **fields = NULL;
-    size_t size = sizeof(field_t*) * g->height;
-    fields = allocate_memory(size, &(g->no_memory));
-    if (!g->no_memory) {
-        uint32_t rows_alloced = 0;
-        size = sizeof(field_t) * g->width;
-        for (uint32_t i = 0; i < g->height; ++i) {
-            ++rows_alloced;
-            fields[i] = allocate_memory(size, &(g->no_memory));
-            if (!g->no_memory) {
-                for (uint32_t j = 0; j < g->width; ++j) {
-                    initialize_field(&(fields[i][j]), i, j, EMPTY);
-                }
-            }
-        }
-        if (g->no_memory) {
-            for (uint32_t i = 0; i < g->height; ++i) {
-                free(fields[i]);
-            }
-            free(fields);
-            fields = NULL;
-        }
+static void add_area(gamma_t *g, uint32_t player, uint64_t field,
+                     uint32_t x, uint32_t y) {
+    uint32_t area = g->area_count++;
+    reset_area(g->fields, g->area_slots, field, area, player, x, y);
+    root_list_push(g->area_slots, &(g->player_roots[player]), area);
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca opis obszaru @p area spoza list obszarów.
+ * Na jego miejsce przenosi ostatni używany opis, więc używane opisy zawsze
+ * zajmują początek tablicy area_slots.
+ * @param g    - Wskaźnik na planszę.
+ * @param area - Numer używanego opisu obszaru.
+ */
+static void free_area(gamma_t *g, uint32_t area) {
+    uint32_t last = --(g->area_count);
+    if (area != last)
+        move_area(g->fields, g->area_slots, g->player_roots, last, area);
+}
+
+/**
+ * Funkcja pomocnicza złączająca obszary pól @p first i @p second gracza
+ * @p player, usuwająca wchłonięty obszar z listy obszarów gracza i
+ * zwalniająca jego opis. Przy włączonych statystykach zlicza krawędzie
+ * przebyte przez @ref unite.
+ * @param g      - Wskaźnik na planszę.
+ * @param player - Numer gracza, do którego należą oba pola.
+ * @param first  - Indeks pierwszego pola planszy.
+ * @param second - Indeks drugiego pola planszy.
+ */
+static void join(gamma_t *g, uint32_t player, uint64_t first,
+                 uint64_t second) {
+#ifdef GAMMA_STATS
+    root(g, first);
+    root(g, second);
+#endif
+    uint32_t absorbed = unite(g->fields, g->area_slots, first, second);
+    if (absorbed != NO_AREA) {
+        root_list_remove(g->area_slots, &(g->player_roots[player]), absorbed);
+        free_area(g, absorbed);
     }
-    return fields;
 }
 
 /**
- * Pomocnicza funkcja alokująca pamięć dla pola player_areas struktury
- * @ref gamma_t. W razie powodzenia ustawia wartość każdego elementu tablicy
- * player_areas na wartość 0.
- * @param g - Wskaźnik na planszę, której jesteśmy aktualnie w trakcie
- * tworzenia.
- * @return Wskaźnik na pierwszy element zaalokowanej właśnie tablicy typu
- * uint32_t w razie powodzenia lub NULL w razie braku błędu(brak pamięci).
+ * Funkcja pomocnicza zaokrąglająca @p n w górę do wielokrotności
+ * @p alignment.
+ * @param n         - Zaokrąglana liczba.
+ * @param alignment - Potęga dwójki, do której wielokrotności zaokrąglamy.
+ * @return Zaokrąglona liczba lub 0, gdy wynik nie mieści się w size_t.
+ */
+static size_t align_up(size_t n, size_t alignment) {
+    if (n > SIZE_MAX - (alignment - 1))
+        return 0;
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * Funkcja pomocnicza rezerwująca w bloku pamięci miejsce na tablicę
+ * @p count elementów rozmiaru @p elem_size, wyrównaną do linii pamięci
+ * podręcznej.
+ * @param size      - Wskaźnik na dotychczasowy rozmiar bloku, który
+ *                    zwiększamy o rozmiar tablicy.
+ * @param count     - Liczba elementów tablicy.
+ * @param elem_size - Rozmiar jednego elementu.
+ * @param offset    - Wskaźnik na zmienną, w której zapisujemy przesunięcie
+ *                    tablicy względem początku bloku.
+ * @return Wartość true w razie powodzenia, false, gdy rozmiar bloku nie
+ * mieści się w size_t.
  */
-static uint32_t* initialize_player_areas(gamma_t *g) {
-    if (g == NULL || g->no_memory)
+static bool reserve(size_t *size, uint64_t count, size_t elem_size,
+                    size_t *offset) {
+    *offset = align_up(*size, CACHE_LINE);
+    if (*offset == 0 || count > (SIZE_MAX - *offset) / elem_size)
+        return false;
+    *size = *offset + count * elem_size;
+    return true;
+}
+
+/**
+ * Domyślna funkcja przydzielająca pamięć. Wyrównuje blok do @p alignment,
+ * a duże bloki, jeśli włączono opcję GAMMA_HUGE_PAGES, wyrównuje do
+ * wielkości dużej strony i prosi jądro o użycie dużych stron.
+ * @param size      - Rozmiar bloku.
+ * @param alignment - Wymagane wyrównanie.
+ * @param ctx       - Nieużywany kontekst.
+ * @return Wskaźnik na blok lub NULL w razie braku pamięci.
+ */
+static void* default_alloc(size_t size, size_t alignment, void *ctx) {
+    (void) ctx;
+    void *ptr = NULL;
+#if defined(GAMMA_HUGE_PAGES) && defined(MADV_HUGEPAGE)
+    if (size >= HUGE_PAGE_SIZE) {
+        if (posix_memalign(&ptr, HUGE_PAGE_SIZE, size) != 0)
+            return NULL;
+        madvise(ptr, align_up(size, HUGE_PAGE_SIZE), MADV_HUGEPAGE);
+        return ptr;
+    }
+#endif
+    if (posix_memalign(&ptr, alignment, size) != 0)
         return NULL;
+    return ptr;
+}
 
-    uint32_t *player_areas = NULL;
-    size_t size = sizeof(uint32_t) * (g->players + 1);
-    player_areas = allocate_memory(size, &(g->no_memory));
+/**
+ * Domyślna funkcja zwalniająca pamięć przydzieloną przez
+ * @ref default_alloc.
+ * @param ptr   - Wskaźnik na zwalniany blok.
+ * @param size  - Rozmiar bloku.
+ * @param ctx   - Nieużywany kontekst.
+ */
+static void default_free(void *ptr, size_t size, void *ctx) {
+    (void) size;
+    (void) ctx;
+    free(ptr);
+}
 
-    if (!g->no_memory)
-        memset(player_areas, 0, size);
+/** Domyślny sposób przydzielania pamięci dla stanu gry. */
+static const gamma_allocator_t default_allocator = {
+    default_alloc, default_free, NULL
+};
 
-    return player_areas;
+/**
+ * Funkcja pomocnicza tworząca nowy plik o unikalnej nazwie w katalogu
+ * @p directory i usuwająca go z katalogu. Najpierw próbuje utworzyć plik
+ * bez nazwy (O_TMPFILE), który nigdy nie pojawia się w katalogu; gdy
+ * system plików tego nie obsługuje, tworzy plik o losowej nazwie i od razu
+ * go usuwa.
+ * @param directory - Ścieżka katalogu.
+ * @return Deskryptor pliku lub -1 z ustawionym errno.
+ */
+static int open_unlinked(const char *directory) {
+#ifdef O_TMPFILE
+    int fd = open(directory, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd >= 0 || (errno != EOPNOTSUPP && errno != EISDIR &&
+                    errno != EINVAL))
+        return fd;
+#endif
+    static const char name[] = "/gamma-XXXXXX";
+    size_t length = strlen(directory);
+    char *template = malloc(length + sizeof(name));
+    if (template == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(template, directory, length);
+    memcpy(template + length, name, sizeof(name));
+    int fd_named = mkostemp(template, O_CLOEXEC);
+    if (fd_named >= 0)
+        unlink(template);
+    free(template);
+    return fd_named;
 }
 
 /**
- * Funkcja pomocnicza alokująca pamięć dla pola player_fields struktury
- * @ref gamma_t. W razie powodzenia ustawia wartość każdego elementu
- * player_fields na wartość 0.
- * @param g - Wskaźnik na planszę, której jesteśmy aktualnie w trakcie
- * tworzenia.
- * @return Wskaźnik na pierwszy element nowo zaalokowanej tablicy w razie
- * powodzenia lub NULL w razie błędu(brak pamięci).
+ * Funkcja przydzielająca blok w nowym rzadkim pliku odwzorowanym w pamięć.
+ * Plik nie ma nazwy w katalogu, więc znika razem z odwzorowaniem, także gdy
+ * proces zostanie przerwany, a równoczesne przydziały w tym samym katalogu
+ * sobie nie przeszkadzają. Za blokiem, w tym samym odwzorowaniu,
+ * zapisujemy ścieżkę katalogu, żeby kopia gry (@ref gamma_clone) mogła
+ * utworzyć w nim własny plik.
+ * @param size      - Rozmiar bloku.
+ * @param alignment - Wymagane wyrównanie, nie większe od strony pamięci.
+ * @param ctx       - Ścieżka katalogu na plik.
+ * @return Wskaźnik na blok lub NULL z ustawionym errno.
  */
-static uint64_t* initialize_player_fields(gamma_t *g) {
-    if (g == NULL || g->no_memory)
+static void* mapped_alloc(size_t size, size_t alignment, void *ctx) {
+    const char *directory = ctx;
+    size_t path_size = strlen(directory) + 1;
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0 || alignment > (size_t) page ||
+        size > SIZE_MAX - path_size ||
+        size + path_size > (uint64_t) INT64_MAX) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    size_t length = size + path_size;
+    int fd = open_unlinked(directory);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, (off_t) length) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return NULL;
+    }
+    void *ptr = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_NORESERVE, fd, 0);
+    int error = errno;
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        errno = error;
         return NULL;
+    }
+    // Ruchy sięgają do pól w dowolnej kolejności, więc czytanie z wyprzedzeniem
+    // tylko zaśmiecałoby pamięć podręczną stron.
+    madvise(ptr, length, MADV_RANDOM);
+    memcpy((char*) ptr + size, directory, path_size);
+    return ptr;
+}
+
+/**
+ * Funkcja zwalniająca blok przydzielony przez @ref mapped_alloc.
+ * @param ptr   - Wskaźnik na zwalniany blok.
+ * @param size  - Rozmiar bloku.
+ * @param ctx   - Ścieżka katalogu zapisana za blokiem.
+ */
+static void mapped_free(void *ptr, size_t size, void *ctx) {
+    munmap(ptr, size + strlen(ctx) + 1);
+}
 
-    uint64_t *player_fields = NULL;
-    size_t size = sizeof(uint64_t) * (g->players + 1);
-    player_fields = allocate_memory(size, &(g->no_memory));
+/**
+ * Funkcja pomocnicza wybierająca rozmiar numeru właściciela pola dla gry z
+ * @p players graczami. Największa wartość każdego typu jest zarezerwowana,
+ * podobnie jak numer UINT32_MAX dla liczby graczy.
+ * @param players - Liczba graczy, mniejsza od UINT32_MAX.
+ * @return Rozmiar numeru właściciela w bajtach.
+ */
+static uint32_t owner_size(uint32_t players) {
+    if (players < UINT8_MAX)
+        return sizeof(uint8_t);
+    if (players < UINT16_MAX)
+        return sizeof(uint16_t);
+    return sizeof(uint32_t);
+}
 
-    if (!g->no_memory)
-        memset(player_fields, 0, size);
+/**
+ * Funkcja pomocnicza podająca odległość między kolejnymi wierszami tablic
+ * pól i właścicieli planszy @p g, czyli szerokość planszy z ramką.
+ * @param g - Wskaźnik na planszę.
+ * @return Liczba elementów w jednym wierszu tablic.
+ */
+static inline size_t row_stride(const gamma_t *g) {
+    return (size_t) g->width + 2;
+}
 
-    return player_fields;
+/**
+ * Funkcja pomocnicza podająca położenie pola (@p x, @p y) w tablicy
+ * właścicieli planszy @p g. Pola ramki mają współrzędne -1, width i height.
+ * @param g - Wskaźnik na planszę.
+ * @param x - Numer kolumny, mniejszy od szerokości planszy.
+ * @param y - Numer wiersza, mniejszy od wysokości planszy.
+ * @return Indeks pola w tablicach.
+ */
+static inline size_t cell_index(const gamma_t *g, uint32_t x, uint32_t y) {
+    return ((size_t) y + 1) * row_stride(g) + x + 1;
 }
 
 /**
- * Funkcja pomocnicza alokująca pamięć dla pola golden_used struktury
- * @ref gamma_t. W razie powodzenia ustawia każdy element golden_used na
- * wartość false.
- * @param g - Wskaźnik na planszę, której jesteśmy aktualnie w trakcie
- * tworzenia.
- * @return Wskaźnik na pierwszy element nowo zaalokowanej tablicy typu
- * bool w razie powodzenia lub NULL w przypadku błędu(brak pamięci).
+ * Funkcja pomocnicza rozsuwająca bity liczby @p v mniejszej od 256 na
+ * parzyste pozycje, potrzebna do porządku Mortona.
+ * @param v - Liczba do rozsunięcia.
+ * @return Liczba z bitem i liczby @p v na pozycji 2i.
  */
-static bool* initialize_golden_used(gamma_t *g) {
-    if (g == NULL || g->no_memory)
-        return NULL;
+static inline uint32_t spread_bits(uint32_t v) {
+    v = (v | (v << 4)) & 0x0F0Fu;
+    v = (v | (v << 2)) & 0x3333u;
+    return (v | (v << 1)) & 0x5555u;
+}
 
-    bool *golden = NULL;
-    size_t size = sizeof(bool) * (g->players + 1);
-    golden = allocate_memory(size, &(g->no_memory));
+/**
+ * Funkcja pomocnicza podająca położenie drzewa reprezentantów pola
+ * (@p x, @p y) w tablicy fields planszy @p g, zgodnie z jej układem.
+ * @param g - Wskaźnik na planszę.
+ * @param x - Numer kolumny, mniejszy od szerokości planszy.
+ * @param y - Numer wiersza, mniejszy od wysokości planszy.
+ * @return Indeks pola w tablicy fields.
+ */
+static inline uint64_t field_index(const gamma_t *g, uint32_t x, uint32_t y) {
+    if (g->layout == GAMMA_LAYOUT_ROW_MAJOR)
+        return (uint64_t) y * g->width + x;
+
+    uint32_t shift = g->tile_shift;
+    uint32_t mask = (1u << shift) - 1;
+    uint64_t tile = (uint64_t) (y >> shift) * g->tiles_per_row + (x >> shift);
+    uint32_t inner;
+    if (g->layout == GAMMA_LAYOUT_TILED)
+        inner = ((y & mask) << shift) | (x & mask);
+    else
+        inner = spread_bits(x & mask) | (spread_bits(y & mask) << 1);
+    return (tile << (2 * shift)) | inner;
+}
 
-    if (!g->no_memory)
-        memset(golden, false, size);
+/**
+ * Funkcja pomocnicza podająca, co ile wierszy przegląd całej planszy w
+ * pliku oddaje jądru przejrzane strony.
+ * @param g - Wskaźnik na planszę.
+ * @return Liczba wierszy, dodatnia.
+ */
+static uint32_t stream_rows(const gamma_t *g) {
+    uint64_t row_bytes = (uint64_t) row_stride(g) * g->owner_bytes +
+                         (uint64_t) g->width * sizeof(field_t);
+    uint64_t rows = STREAM_BYTES / row_bytes;
+    return rows > 0 ? (uint32_t) (rows < UINT32_MAX ? rows : UINT32_MAX) : 1;
+}
 
-    return golden;
+/**
+ * Funkcja pomocnicza oddająca jądru strony pamięci przedziału, oprócz
+ * ostatniej, jeśli przedział kończy się w jej środku. Dane oddanej strony
+ * zostają w pliku, więc można oddać także stronę, którą przedział dzieli z
+ * poprzednim.
+ * @param start - Początek przedziału.
+ * @param end - Koniec przedziału.
+ */
+static void release_pages(const char *start, const char *end) {
+    uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t from = (uintptr_t) start & ~(page - 1);
+    uintptr_t to = (uintptr_t) end & ~(page - 1);
+    if (from < to)
+        madvise((void*) from, to - from, MADV_DONTNEED);
 }
 
-gamma_t* gamma_new(uint32_t width, uint32_t height,
-                   uint32_t players, uint32_t areas) {
+/**
+ * Funkcja pomocnicza wywoływana przez przegląd całej planszy po wierszach
+ * [@p from, @p to). Dla planszy w pliku oddaje jądru strony tych wierszy w
+ * tablicach właścicieli i pól: dane zostają w pliku i w pamięci podręcznej
+ * stron, ale przestają zajmować pamięć procesu, więc przegląd planszy
+ * większej niż pamięć nie wypycha z niej wszystkiego innego. Dla planszy w
+ * pamięci nic nie robi.
+ * @param g - Wskaźnik na planszę.
+ * @param from - Pierwszy przejrzany wiersz.
+ * @param to - Wiersz za ostatnim przejrzanym.
+ */
+static void stream_release(const gamma_t *g, uint32_t from, uint32_t to) {
+    if (!g->mapped || from >= to)
+        return;
+    const char *owners = g->owners;
+    release_pages(owners + cell_index(g, 0, from) * g->owner_bytes,
+                  owners + cell_index(g, 0, to) * g->owner_bytes);
+    if (g->layout == GAMMA_LAYOUT_ROW_MAJOR)
+        release_pages((const char*) (g->fields + field_index(g, 0, from)),
+                      (const char*) (g->fields + (size_t) to * g->width));
+}
+
+/**
+ * Funkcja pomocnicza wybierająca logarytm boku kwadratu pól dla układu
+ * @p layout: 3 dla kwadratów 8×8, 6 dla 64×64, ale nie więcej niż logarytm
+ * krótszego boku planszy.
+ * @param layout - Układ pól.
+ * @param width - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @return Logarytm boku kwadratu lub 0 dla układu wiersz po wierszu.
+ */
+static uint32_t layout_tile_shift(gamma_layout_t layout, uint32_t width,
+                                  uint32_t height) {
+    if (layout == GAMMA_LAYOUT_ROW_MAJOR)
+        return 0;
+    uint32_t shift = layout == GAMMA_LAYOUT_TILED ? 3 : 6;
+    uint32_t side = width < height ? width : height;
+    while (shift > 0 && (1u << shift) > side)
+        --shift;
+    return shift;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca, czy procesor obsługuje rozkazy AVX2.
+ * @return Wartość true, jeśli jądra AVX2 mogą zostać użyte.
+ */
+static bool cpu_has_avx2() {
+#ifdef GAMMA_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca stan trybu współbieżnego. Nic nie robi dla
+ * NULL.
+ * @param sync - Wskaźnik na stan trybu współbieżnego.
+ */
+static void sync_delete(gamma_sync_t *sync) {
+    if (sync != NULL) {
+        pthread_rwlock_destroy(&(sync->lock));
+        free(sync->players);
+        free(sync->frontier);
+        free(sync);
+    }
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca stan strumienia zdarzeń. Nic nie robi dla
+ * NULL.
+ * @param observe - Wskaźnik na stan strumienia zdarzeń.
+ */
+static void observe_delete(observe_t *observe) {
+    if (observe != NULL) {
+        feed_delete(observe->feed);
+        free(observe->areas);
+        free(observe->blocked);
+        free(observe->watched);
+        free(observe->watched_slot);
+        free(observe);
+    }
+}
+
+void gamma_delete(gamma_t *g) {
+    if (g != NULL) {
+        sync_delete(g->sync);
+        spectate_delete(g->spectate);
+        observe_delete(g->observe);
+        thread_pool_delete(g->pool);
+        move_index_delete(g->moves);
+        free(g->territory_queue);
+        g->allocator.free(g, g->block_size, g->allocator.ctx);
+    }
+}
+
+/**
+ * Funkcja pomocnicza podająca, ile opisów obszarów może być używanych
+ * naraz. Każdy gracz ma co najwyżej @p areas obszarów, oprócz gracza,
+ * któremu złoty ruch zabrał pole: przed cofnięciem ruchu może mieć o 3
+ * obszary więcej i jeszcze jeden na odzyskane pole. Przebudowa obszarów
+ * gracza w każdym z co najwyżej @ref REBUILD_BANDS pasów wierszy ma poza
+ * obszarami ostatecznymi co najwyżej width + 2 obszary stykające się z
+ * pierwszym wierszem pasa lub z polami jeszcze nieprzejrzanymi, a
+ * wczytywanie migawki, które działa jak jeden pas dla wszystkich graczy,
+ * mniej. Obszarów nigdy nie jest więcej niż pól.
+ * @param players - Liczba graczy.
+ * @param areas - Maksymalna liczba obszarów gracza.
+ * @param width - Szerokość planszy.
+ * @param field_count - Rozmiar tablicy fields.
+ * @return Liczba opisów obszarów.
+ */
+static uint64_t area_capacity(uint32_t players, uint32_t areas,
+                              uint32_t width, uint64_t field_count) {
+    uint64_t capacity = (uint64_t) players * areas + 4 +
+                        (uint64_t) REBUILD_BANDS * ((uint64_t) width + 2);
+    return capacity < field_count ? capacity : field_count;
+}
+
+gamma_t* gamma_new_ex(uint32_t width, uint32_t height,
+                      uint32_t players, uint32_t areas,
+                      const gamma_allocator_t *allocator) {
+    return gamma_new_layout(width, height, players, areas, allocator,
+                            GAMMA_LAYOUT_ROW_MAJOR);
+}
+
+gamma_t* gamma_new_layout(uint32_t width, uint32_t height,
+                          uint32_t players, uint32_t areas,
+                          const gamma_allocator_t *allocator,
+                          gamma_layout_t layout) {
     if (width == 0 || height == 0 || players == 0 || areas == 0)
         return NULL;
+    if (layout != GAMMA_LAYOUT_ROW_MAJOR && layout != GAMMA_LAYOUT_TILED &&
+        layout != GAMMA_LAYOUT_MORTON)
+        return NULL;
     if (players == UINT32_MAX)
         return NULL;
-    bool no_memory = false;
-    gamma_t *g = allocate_memory(sizeof(gamma_t), &no_memory);
+    if (allocator == NULL)
+        allocator = &default_allocator;
+
+    size_t size = sizeof(gamma_t);
+    size_t areas_offset, fields_offset, golden_offset, owners_offset;
+    size_t roots_offset, slots_offset;
+    size_t board_offset, bits_offset = 0;
+    uint64_t cells = ((uint64_t) width + 2) * ((uint64_t) height + 2);
+    uint32_t owner_bytes = owner_size(players);
+    uint32_t tile_shift = layout_tile_shift(layout, width, height);
+    uint64_t tile_side = (uint64_t) 1 << tile_shift;
+    uint64_t tiles_per_row = (width + tile_side - 1) / tile_side;
+    uint64_t tiles_per_column = (height + tile_side - 1) / tile_side;
+    uint64_t field_count = tiles_per_row * tiles_per_column * tile_side *
+                           tile_side;
+    uint64_t slot_count = area_capacity(players, areas, width, field_count);
+    bool use_bits = width <= BITBOARD_MAX_SIDE &&
+                    height <= BITBOARD_MAX_SIDE &&
+                    owner_bytes == sizeof(uint8_t);
+    if (slot_count >= NO_AREA) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    if (!reserve(&size, (uint64_t) players + 1, sizeof(uint32_t),
+                 &areas_offset) ||
+        !reserve(&size, (uint64_t) players + 1, sizeof(uint64_t),
+                 &fields_offset) ||
+        !reserve(&size, (uint64_t) players + 1, sizeof(bool),
+                 &golden_offset) ||
+        !reserve(&size, (uint64_t) players + 1, sizeof(root_list_t),
+                 &roots_offset) ||
+        !reserve(&size, cells, owner_bytes, &owners_offset) ||
+        !reserve(&size, field_count, sizeof(field_t), &board_offset) ||
+        !reserve(&size, slot_count, sizeof(area_t), &slots_offset) ||
+        (use_bits && !reserve(&size, ((uint64_t) players + 1) * height,
+                              sizeof(uint64_t), &bits_offset))) {
+        errno = ENOMEM;
+        return NULL;
+    }
 
-    if (!no_memory) {
-        g->height = height;
-        g->width = width;
-        g->players = players;
-        g->areas = areas;
-        g->no_memory = no_memory;
-        g->fields = initialize_fields(g);
-        g->player_areas = initialize_player_areas(g);
-        g->golden_used = initialize_golden_used(g);
-        g->player_fields = initialize_player_fields(g);
+    errno = 0;
+    char *block = allocator->alloc(size, CACHE_LINE, allocator->ctx);
+    if (block == NULL) {
+        if (errno == 0)
+            errno = ENOMEM;
+        return NULL;
     }
 
-    if (g != NULL && g->no_memory) {
-        gamma_delete(g);
-        g = NULL;
+    gamma_t *g = (gamma_t*) block;
+    g->height = height;
+    g->width = width;
+    g->players = players;
+    g->areas = areas;
+    g->no_memory = false;
+    g->allocator = *allocator;
+    g->block_size = size;
+    g->mapped = allocator->alloc == mapped_alloc;
+    // Ścieżka z kontekstu wywołującego może zniknąć przed końcem gry.
+    if (g->mapped)
+        g->allocator.ctx = block + size;
+    g->pool = NULL;
+    g->moves = NULL;
+    g->territory_queue = NULL;
+    atomic_init(&(g->territory_busy), false);
+    memset(g->hash, 0, sizeof(g->hash));
+    g->hash_count = 1;
+    g->version = 0;
+    g->sync = NULL;
+    g->spectate = NULL;
+    g->observe = NULL;
+#ifdef GAMMA_STATS
+    memset(&(g->stats), 0, sizeof(g->stats));
+#endif
+    g->player_areas = (uint32_t*) (block + areas_offset);
+    g->player_fields = (uint64_t*) (block + fields_offset);
+    g->golden_used = (bool*) (block + golden_offset);
+    memset(g->player_areas, 0, sizeof(uint32_t) * ((size_t) players + 1));
+    memset(g->player_fields, 0, sizeof(uint64_t) * ((size_t) players + 1));
+    memset(g->golden_used, false, sizeof(bool) * ((size_t) players + 1));
+    g->player_roots = (root_list_t*) (block + roots_offset);
+    for (uint32_t i = 0; i <= players; ++i)
+        root_list_init(&(g->player_roots[i]));
+
+    g->owner_bytes = owner_bytes;
+    g->owners = block + owners_offset;
+    g->use_avx2 = cpu_has_avx2();
+    g->fields = (field_t*) (block + board_offset);
+    g->area_slots = (area_t*) (block + slots_offset);
+    g->area_count = 0;
+    g->area_slot_count = (uint32_t) slot_count;
+    g->layout = layout;
+    g->tile_shift = tile_shift;
+    g->tiles_per_row = (size_t) tiles_per_row;
+
+    // Plansza jest wypełniana wiersz po wierszu, żeby plansza w pliku
+    // mogła oddawać jądru strony już wypełnionych wierszy.
+    size_t stride = row_stride(g) * owner_bytes;
+    char *owners = g->owners;
+    uint32_t band = stream_rows(g);
+    memset(owners, 0xFF, stride + owner_bytes);
+    for (uint32_t i = 0; i < height; ++i) {
+        char *row = owners + cell_index(g, 0, i) * owner_bytes;
+        memset(row, EMPTY, (size_t) width * owner_bytes);
+        memset(row + (size_t) width * owner_bytes, 0xFF, 2 * owner_bytes);
+        if ((i + 1) % band == 0)
+            stream_release(g, i + 1 - band, i + 1);
+    }
+    memset(owners + (size_t) (cells - row_stride(g) + 1) * owner_bytes, 0xFF,
+           stride - owner_bytes);
+    stream_release(g, height - height % band, height);
+
+    g->bits = NULL;
+    if (use_bits) {
+        g->bits = (uint64_t*) (block + bits_offset);
+        g->row_mask = bitboard_row_mask(width);
+        memset(g->bits, 0, sizeof(uint64_t) * ((size_t) players + 1) * height);
+        for (uint32_t i = 0; i < height; ++i)
+            g->bits[EMPTY * height + i] = g->row_mask;
     }
     return g;
 }
 
+gamma_t* gamma_new(uint32_t width, uint32_t height,
+                   uint32_t players, uint32_t areas) {
+    return gamma_new_ex(width, height, players, areas, NULL);
+}
+
+gamma_t* gamma_new_mapped(uint32_t width, uint32_t height,
+                          uint32_t players, uint32_t areas,
+                          const char *directory) {
+    if (directory == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    gamma_allocator_t allocator = {mapped_alloc, mapped_free,
+                                   (void*) directory};
+    return gamma_new_ex(width, height, players, areas, &allocator);
+}
+
 /**
  * Funkcja pomocnicza sprawdzająca czy dane współrzędne znajdują się na danej
  * planszy.
@@ -213,78 +863,45 @@ static bool good_coords(gamma_t *g, uint32_t x, uint32_t y) {
 }
 
 /**
- * Sprawdza, czy dany ruch z danymi specyfikacjami jest możliwy w danym
- * momencie.
+ * Funkcja pomocnicza biorąca zamek czytelnika planszy w trybie
+ * współbieżnym. Poza nim nic nie robi.
  * @param g - Wskaźnik na planszę.
- * @param player - Numer gracza, który chce wykonać ruch.
- * @param x - Numer kolumny.
- * @param y - Numer wiersza.
- * @return true w przypadku gdy jest możiwe wykonanie danego ruchu lub false,
- * gdy taki ruch jest niedozwolony lub któryś z parametrów jest błędny.
  */
-bool movie_possible(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    if (g == NULL || player == EMPTY || player > g->players || x >= g->width ||
-        y >= g->height || g->fields[y][x].owner != EMPTY) {
-        return false;
-    }
-
-
-    if (g->player_areas[player] == g->areas) {
-        int delta_x[] = {1, -1, 0, 0};
-        int delta_y[] = {0, 0, 1, -1};
-
-        for (int i = 0; i < 4; ++i) {
-            if (good_coords(g, x + delta_x[i], y + delta_y[i]) &&
-            g->fields[y + delta_y[i]][x + delta_x[i]].owner == player)
-                return true;
-        }
-        return false;
-
-    }
-    return true;
+static inline void sync_read_lock(gamma_t *g) {
+    if (g->sync != NULL)
+        pthread_rwlock_rdlock(&(g->sync->lock));
 }
 
+/**
+ * Funkcja pomocnicza biorąca zamek pisarza planszy w trybie współbieżnym.
+ * Poza nim nic nie robi.
+ * @param g - Wskaźnik na planszę.
+ */
+static inline void sync_write_lock(gamma_t *g) {
+    if (g->sync != NULL)
+        pthread_rwlock_wrlock(&(g->sync->lock));
+}
 
-bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    if (!movie_possible(g, player, x, y))
-        return false;
-    set_field(&(g->fields[y][x]), x, y, player);
-
-    int delta_x[] = {1, -1, 0, 0};
-    int delta_y[] = {0, 0, 1, -1};
-
-    bool connected = false;
-    int united_areas = 0;
-
-    for (int i = 0; i < 4; ++i) {
-        if (good_coords(g, x + delta_x[i], y + delta_y[i]) &&
-            g->fields[y + delta_y[i]][x + delta_x[i]].owner == player) {
-
-            connected = true;
-            if (find_root(&(g->fields[y][x]))->rep !=
-                find_root(&(g->fields[y + delta_y[i]][x + delta_x[i]]))->rep) {
-                united_areas++;
-            }
-            unite(g->fields[y][x],
-                    g->fields[y + delta_y[i]][x + delta_x[i]]);
-        }
-    }
-    if (!connected)
-        ++(g->player_areas[player]);
-
-
-    if (united_areas > 0)
-        g->player_areas[player] -= (united_areas - 1);
-
-    ++(g->player_fields[player]);
-
-    return true;
+/**
+ * Funkcja pomocnicza zwalniająca zamek wzięty przez @ref sync_read_lock lub
+ * @ref sync_write_lock.
+ * @param g - Wskaźnik na planszę.
+ */
+static inline void sync_unlock(gamma_t *g) {
+    if (g->sync != NULL)
+        pthread_rwlock_unlock(&(g->sync->lock));
 }
 
 uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
     if (g == NULL || player == EMPTY || player > g->players)
         return 0;
-    return g->player_fields[player];
+    STATS_START(start);
+    uint64_t busy = g->sync != NULL ?
+                    atomic_load_explicit(&(g->sync->players[player].fields),
+                                         memory_order_relaxed) :
+                    g->player_fields[player];
+    STATS_RECORD(g, GAMMA_OP_BUSY_FIELDS, start);
+    return busy;
 }
 
 /**
@@ -309,56 +926,6 @@ static bool old_golden_possible(gamma_t *g, uint32_t player) {
     return false;
 }
 
-/**
- * Pomocnicza funkcja sprawdzająca ilość miejsc, w której gracz @p player może
- * postawić pionka jeśli @p player ma maksymalną ilość obszarów. Sprawdzenie
- * przebiega w sposób brutalny sprawdzając każde pole na planszy, czy jest
- * możliwe do postawienia pionka na nim.
- * @param g - Wskaźnik na planszę.
- * @param player - Numer gracza, który ma maksymalną ilość obszarów.
- * @return Ilość obszarów, na które @p player może jeszcze postawić pionka,
- * która jest liczbą nieujemną.
- */
-static uint64_t free_fields_full_areas(gamma_t *g, uint32_t player) {
-
-    int delta_x[] = {1, -1, 0, 0};
-    int delta_y[] = {0, 0, 1, -1};
-
-    uint64_t free_count = 0;
-
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            if (g->fields[i][j].owner == EMPTY) {
-                for (int dir = 0; dir < 4; ++dir) {
-                    uint32_t x = j + delta_x[dir];
-                    uint32_t y = i + delta_y[dir];
-                    if (good_coords(g, x, y) &&
-                        g->fields[y][x].owner == player) {
-                        ++free_count;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    return free_count;
-}
-
-uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
-    if (g == NULL || player == EMPTY || player > g->players)
-        return 0;
-
-    if (g->player_areas[player] == g->areas)
-        return free_fields_full_areas(g, player);
-    uint64_t free_fields = g->height;
-    free_fields *= g->width;
-
-    for (uint32_t i = 1; i <= g->players; ++i) {
-        free_fields -= g->player_fields[i];
-    }
-    return free_fields;
-}
-
 /**
  * Funkcja pomocnicza obliczająca podłogę z logarytmu o podstawie @ref
  * LOG_BASE z liczby @p n.
@@ -374,328 +941,2400 @@ static uint32_t logarithm(uint32_t n) {
     return counter;
 }
 
+/** Przesunięcia kolumn czterech sąsiadów pola. */
+static const int delta_x[] = {1, -1, 0, 0};
+/** Przesunięcia wierszy czterech sąsiadów pola. */
+static const int delta_y[] = {0, 0, 1, -1};
+
 /**
- * Funkcja pomocnicza uzupełniająca string @p board w przypadku, gdy liczba
- * graczy > 9.
- * @param g - Wskaźnik na planszę do gry gamma.
- * @param board - Dynamicznie zaalokowany string.
- * @param size - Liczba cyfr liczby graczy.
- * @param position - Pozycja aktualnego znaku.
+ * Stan przeglądu planszy podzielonego na pasy kolejnych wierszy. Każdy pas
+ * zapisuje tylko własne elementy tablic, a wyniki są łączone po zakończeniu
+ * wszystkich pasów w kolejności pasów, więc nie potrzeba zamków, a wynik nie
+ * zależy od przydziału pasów do wątków.
  */
+typedef struct band_job {
+    gamma_t *g; ///< Przeglądana plansza.
+    uint32_t player; ///< Numer gracza, którego dotyczy przegląd.
+    uint32_t bands; ///< Liczba pasów.
+    char *board; ///< Bufor napisu planszy dla gamma_board.
+    uint32_t size; ///< Liczba cyfr numeru gracza dla gamma_board.
+    atomic_bool found; ///< Czy któryś pas znalazł już pole złotego ruchu.
+    uint64_t count[MAX_BANDS]; ///< Liczba pól znalezionych w pasie.
+    uint32_t areas[MAX_BANDS]; ///< Liczba obszarów zbudowanych w pasie.
+    root_list_t roots[MAX_BANDS]; ///< Obszary zbudowane w pasie.
+    uint32_t spare[MAX_BANDS]; /**< Listy opisów obszarów wchłoniętych w
+    pasie, połączone polem next opisu. */
+    atomic_uint_fast32_t area_count; /**< Liczba opisów obszarów, z nowymi
+    opisami zajętymi przez pasy. */
+    bool unsure[MAX_BANDS]; /**< Czy w pasie jest pole, dla którego nie
+    wiadomo bez przebudowy obszarów, czy można je zająć złotym ruchem. */
+} band_job_t;
 
-static void print_many_players(gamma_t *g, char *board,
-                               uint32_t size, uint64_t *position) {
-    char format_empty[] = {'%', size + 1 + '0', 'c', '\0'};
-    char format_empty9[] = "%10c";
-    char format_empty10[] = "%11c";
-    char format[] = {'%', size + 1 + '0', 'u', '\0'};
-    char format9[] = "%10u";
-    char format10[] = "%11u";
-
-
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            uint32_t player = g->fields[g->height - 1 - i][j].owner;
-            if (size < 9) {
-                if (player == EMPTY)
-                    sprintf(board + (*position), format_empty, '.');
-                else
-                    sprintf(board + (*position), format, player);
-            }
-            else if (size == 9) {
-                if (player == EMPTY)
-                    sprintf(board + (*position), format_empty9, '.');
-                else
-                    sprintf(board + (*position), format9, player);
-            }
-            else {
-                if (player == EMPTY)
-                    sprintf(board + (*position), format_empty10, '.');
-                else
-                    sprintf(board + (*position), format10, player);
-            }
-
-            (*position) += size + 1;
-        }
-        board[*position] = '\n';
-        ++(*position);
-    }
-    board[*position] = '\0';
+/**
+ * Funkcja pomocnicza podająca liczbę pasów, na które dzielimy przegląd
+ * planszy @p g. Plansze bez puli wątków i małe plansze przeglądamy w
+ * jednym pasie.
+ * @param g - Wskaźnik na planszę.
+ * @return Liczba pasów, od 1 do min(height, @ref MAX_BANDS).
+ */
+static uint32_t scan_bands(const gamma_t *g) {
+    if (g->pool == NULL ||
+        (uint64_t) g->width * g->height < GAMMA_PARALLEL_MIN_CELLS)
+        return 1;
+    uint32_t bands = thread_pool_threads(g->pool) * BANDS_PER_THREAD;
+    return bands < g->height ? bands : g->height;
 }
 
 /**
- * Funkcja pomocnicza uzupełniająca string @p board, gdy liczba gracz jest
- * mniejsza lub równa 9.
- * @param g - Wskaźnik na planszę do gry.
- * @param board - Dynamicznie zaalokowany string.
- * @param position - Pozycja aktualnego znaku.
+ * Funkcja pomocnicza przygotowująca przegląd planszy @p g.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, którego dotyczy przegląd.
  */
-static void print_little_players(gamma_t *g, char *board, uint64_t *position) {
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            char c;
-            if (g->fields[g->height - 1 - i][j].owner != EMPTY)
-                c = g->fields[g->height - 1 - i][j].owner + '0';
-            else
-                c = '.';
-            board[*position] = c;
-            ++(*position);
-        }
-        board[*position] = '\n';
-        ++(*position);
-    }
-    board[*position] = '\0';
+static void band_job_init(band_job_t *job, gamma_t *g, uint32_t player) {
+    job->g = g;
+    job->player = player;
+    job->bands = scan_bands(g);
+    job->board = NULL;
+    job->size = 0;
+    atomic_init(&(job->found), false);
+    memset(job->count, 0, sizeof(uint64_t) * job->bands);
+    memset(job->areas, 0, sizeof(uint32_t) * job->bands);
+    memset(job->unsure, false, sizeof(bool) * job->bands);
 }
 
-char* gamma_board(gamma_t *g) {
-    if (g == NULL || g->no_memory)
-        return NULL;
-    uint32_t size = 0;
-    size = logarithm(g->players);
-    size_t ptr_size = (g->width * g->height * (size + 1) * sizeof(char) + 1 +
-            g->height);
-    char *board = allocate_memory(ptr_size, &(g->no_memory));
-    if (g->no_memory)
-        return NULL;
-    uint64_t position = 0;
-    if (size > 1) {
-        print_many_players(g, board, size, &position);
-        char *new_board = realloc(board, position + 1);
-        board = new_board;
-    }
-    else {
-        print_little_players(g, board, &position);
-    }
+/**
+ * Funkcja pomocnicza podająca wiersze pasa @p band.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param band - Numer pasa.
+ * @param from - Wskaźnik, pod który zapisujemy pierwszy wiersz pasa.
+ * @param to - Wskaźnik, pod który zapisujemy wiersz za ostatnim wierszem pasa.
+ */
+static void band_rows(const band_job_t *job, uint32_t band,
+                      uint32_t *from, uint32_t *to) {
+    uint64_t height = job->g->height;
+    *from = (uint32_t) (height * band / job->bands);
+    *to = (uint32_t) (height * (band + 1) / job->bands);
+}
 
-    return board;
+/**
+ * Funkcja pomocnicza odkładająca opis obszaru @p area, wchłoniętego w
+ * trakcie przebudowy obszarów w pasie, na listę wolnych opisów pasa.
+ * @param slots - Tablica opisów obszarów.
+ * @param roots - Wskaźnik na listę obszarów pasa, na której jest @p area.
+ * @param area - Numer opisu wchłoniętego obszaru.
+ * @param spare - Wskaźnik na początek listy wolnych opisów pasa.
+ */
+static void spare_area(area_t *slots, root_list_t *roots, uint32_t area,
+                       uint32_t *spare) {
+    root_list_remove(slots, roots, area);
+    slots[area].root = NO_FIELD;
+    slots[area].next = *spare;
+    *spare = area;
 }
 
 /**
- * Funkcja pomocnicza resetująca reprezentantów i stopień kaźdego pola
- * planszy @p g, które należy do gracza @p player. Ustawia ilość obszarów i pól
- * gracza @p player na wartość 0.
+ * Funkcja pomocnicza zwalniająca opisy obszarów z listy wolnych opisów
+ * pasa, gdy obszary pasów są już na listach graczy. Opisy wolne z końca
+ * tablicy są po prostu odcinane, a na miejsce pozostałych przenoszone są
+ * ostatnie używane opisy.
  * @param g - Wskaźnik na planszę.
- * @param player - Numer gracza, którego chcemy 'zresetować'.
+ * @param spare - Początek listy wolnych opisów pasa.
  */
-static void golden_reset_field_reps(gamma_t *g, uint32_t player) {
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            if (g->fields[i][j].owner == player) {
-                g->fields[i][j].rep = &(g->fields[i][j]);
-                g->fields[i][j].rank = 0;
-            }
-        }
+static void free_spare_areas(gamma_t *g, uint32_t spare) {
+    while (spare != NO_AREA) {
+        uint32_t area = spare;
+        spare = g->area_slots[area].next;
+        while (g->area_count > 0 &&
+               g->area_slots[g->area_count - 1].root == NO_FIELD)
+            --(g->area_count);
+        if (area < g->area_count)
+            free_area(g, area);
     }
-    g->player_areas[player] = 0;
-    g->player_fields[player] = 0;
 }
 
 /**
- * Funkcja pomocnicza symulująca ruch gracza @p player na pole o współrzędnych
- * (@p x, @p y. Wiemy, że wcześniej ruch był poprawnie wykonany więc nie
- * sprawdzamy już parametrów pod
- * względem poprawności. Pozwalamy na to, żeby liczba obszarów gracza
- * @p player przekroczyła po takim symulowanym ruchu maksymalną liczbę obszarów.
- * @param g - Wskaźnik na planszę.
- * @param player - Numer gracza, któ©ego ruch symulujemy.
- * @param x - Numer kolumny pola, w które chcemy ustawić pionka.
- * @param y - Numer wiersza pola, w które chcemy ustawić pionka.
+ * Funkcja pomocnicza wykonująca zadanie @p task dla każdego pasa przeglądu,
+ * na wątkach puli planszy, gdy pasów jest więcej niż jeden.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param task - Zadanie przeglądające jeden pas.
  */
-static void restore_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    set_field(&(g->fields[y][x]), x, y, player);
+static void run_bands(band_job_t *job, thread_task_t task) {
+    if (job->bands == 1)
+        task(job, 0);
+    else
+        thread_pool_run(job->g->pool, job->bands, task, job);
+}
 
-    int delta_x[] = {1, -1, 0, 0};
-    int delta_y[] = {0, 0, 1, -1};
+/**
+ * Stan przeglądu wszerz dla @ref gamma_territory. Pola są numerowane wiersz
+ * po wierszu, bez ramki. Kolejka zawiera kolejne poziomy przeglądu: pola
+ * zajęte sąsiadujące z pustymi, potem puste pola w odległości 1, 2 itd.
+ * Pole dopisane do poziomu ma etykietę tymczasową (parity + 1) *
+ * (players + 1) + p, gdzie p to najbliższy gracz lub 0 dla remisu, a parity
+ * to parzystość poziomu; etykieta jest zamieniana na ostateczną, gdy pole
+ * jest rozwijane. Dzięki dwóm zakresom etykiet tymczasowych pola
+ * poprzedniego poziomu, jeszcze nierozwinięte, nie mylą się z polami
+ * dopisywanymi do następnego.
+ */
+typedef struct territory_job {
+    gamma_t *g; ///< Przeglądana plansza.
+    uint32_t *labels; ///< Etykiety pól.
+    uint64_t *counts; ///< Liczby pustych pól najbliższych każdemu graczowi.
+    uint32_t *queue; ///< Kolejka pól.
+    atomic_uint_fast64_t tail; ///< Koniec kolejki.
+    uint64_t head; ///< Początek rozwijanego poziomu.
+    uint64_t end; ///< Koniec rozwijanego poziomu.
+    uint32_t parity; ///< Parzystość poziomu, do którego dopisujemy pola.
+    uint32_t bands; ///< Liczba pasów przy wyszukiwaniu pól początkowych.
+    bool shared; ///< Czy zadania działają jednocześnie na wątkach puli.
+} territory_job_t;
 
-    int united_areas = 0;
+/**
+ * Bufor pól dopisywanych do kolejki przez jedno zadanie. Zadanie rezerwuje
+ * miejsce w kolejce jedną operacją atomową na cały bufor.
+ */
+typedef struct territory_buffer {
+    uint32_t cells[TERRITORY_BUFFER]; ///< Pola.
+    uint32_t count; ///< Liczba pól.
+} territory_buffer_t;
 
-    for (int i = 0; i < 4; ++i) {
-        if (good_coords(g, x + delta_x[i], y + delta_y[i]) &&
-            g->fields[y + delta_y[i]][x + delta_x[i]].owner == player) {
-            if (find_root(&(g->fields[y][x])) !=
-                find_root(&(g->fields[y + delta_y[i]][x + delta_x[i]]))) {
-                united_areas++;
+/**
+ * Funkcja pomocnicza czytająca etykietę pola.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param cell - Numer pola.
+ * @return Etykieta.
+ */
+static inline uint32_t label_load(const territory_job_t *job, uint32_t cell) {
+    if (job->shared)
+        return atomic_load_explicit((_Atomic uint32_t*) (job->labels + cell),
+                                    memory_order_relaxed);
+    return job->labels[cell];
+}
+
+/**
+ * Funkcja pomocnicza zapisująca etykietę pola.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param cell - Numer pola.
+ * @param label - Etykieta.
+ */
+static inline void label_store(territory_job_t *job, uint32_t cell,
+                               uint32_t label) {
+    if (job->shared)
+        atomic_store_explicit((_Atomic uint32_t*) (job->labels + cell), label,
+                              memory_order_relaxed);
+    else
+        job->labels[cell] = label;
+}
+
+/**
+ * Funkcja pomocnicza zamieniająca etykietę pola @p expected na @p label.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param cell - Numer pola.
+ * @param expected - Wskaźnik na oczekiwaną etykietę; gdy się nie zgadza,
+ * zapisujemy pod nim etykietę pola.
+ * @param label - Nowa etykieta.
+ * @return Wartość true, jeśli etykieta została zamieniona.
+ */
+static inline bool label_swap(territory_job_t *job, uint32_t cell,
+                              uint32_t *expected, uint32_t label) {
+    if (job->shared)
+        return atomic_compare_exchange_strong_explicit(
+            (_Atomic uint32_t*) (job->labels + cell), expected, label,
+            memory_order_relaxed, memory_order_relaxed);
+    if (job->labels[cell] != *expected) {
+        *expected = job->labels[cell];
+        return false;
+    }
+    job->labels[cell] = label;
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza przepisująca bufor zadania na koniec kolejki.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param buffer - Wskaźnik na bufor.
+ */
+static void territory_flush(territory_job_t *job, territory_buffer_t *buffer) {
+    uint64_t at = atomic_fetch_add_explicit(&(job->tail), buffer->count,
+                                            memory_order_relaxed);
+    memcpy(job->queue + at, buffer->cells, sizeof(uint32_t) * buffer->count);
+    buffer->count = 0;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca pole do bufora zadania.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param buffer - Wskaźnik na bufor.
+ * @param cell - Numer pola.
+ */
+static inline void territory_push(territory_job_t *job,
+                                  territory_buffer_t *buffer, uint32_t cell) {
+    if (buffer->count == TERRITORY_BUFFER)
+        territory_flush(job, buffer);
+    buffer->cells[buffer->count++] = cell;
+}
+
+/**
+ * Funkcja pomocnicza dodająca @p count pól do liczby pól gracza.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param player - Numer gracza lub 0.
+ * @param count - Liczba pól.
+ */
+static inline void territory_count(territory_job_t *job, uint32_t player,
+                                   uint64_t count) {
+    if (count == 0)
+        return;
+    if (job->shared)
+        atomic_fetch_add_explicit((_Atomic uint64_t*) (job->counts + player),
+                                  count, memory_order_relaxed);
+    else
+        job->counts[player] += count;
+}
+
+/**
+ * Funkcja pomocnicza odwiedzająca sąsiada @p cell rozwijanego pola. Puste,
+ * jeszcze nieodwiedzone pole dostaje etykietę @p mine i trafia do kolejki.
+ * Pole dopisane już do tego samego poziomu z inną etykietą staje się
+ * remisem.
+ * @param job - Wskaźnik na stan przeglądu.
+ * @param buffer - Wskaźnik na bufor zadania.
+ * @param cell - Numer pola.
+ * @param mine - Etykieta tymczasowa rozwijanego pola.
+ * @param tie - Etykieta tymczasowa remisu tego poziomu.
+ */
+static inline void territory_visit(territory_job_t *job,
+                                   territory_buffer_t *buffer, uint32_t cell,
+                                   uint32_t mine, uint32_t tie) {
+    uint32_t label = EMPTY;
+    if (label_swap(job, cell, &label, mine)) {
+        territory_push(job, buffer, cell);
+        return;
+    }
+    while (label > tie && label <= tie + job->g->players && label != mine &&
+           !label_swap(job, cell, &label, tie)) {}
+}
+
+/**
+ * Zadanie rozwijające fragment bieżącego poziomu przeglądu wszerz: zamienia
+ * etykiety pól fragmentu na ostateczne i odwiedza ich sąsiadów.
+ * @param arg - Wskaźnik na stan przeglądu (@ref territory_job_t).
+ * @param task - Numer fragmentu.
+ */
+static void territory_expand(void *arg, uint32_t task) {
+    territory_job_t *job = arg;
+    uint32_t width = job->g->width;
+    uint32_t height = job->g->height;
+    uint32_t players = job->g->players;
+    uint32_t tie = (job->parity + 1) * (players + 1);
+    uint32_t old_tie = (2 - job->parity) * (players + 1);
+    uint64_t from = job->head + (uint64_t) task * TERRITORY_CHUNK;
+    uint64_t to = from + TERRITORY_CHUNK < job->end ?
+                  from + TERRITORY_CHUNK : job->end;
+    territory_buffer_t buffer;
+    buffer.count = 0;
+    uint32_t run_player = EMPTY;
+    uint64_t run = 0;
+
+    for (uint64_t i = from; i < to; ++i) {
+        uint32_t cell = job->queue[i];
+        uint32_t player = label_load(job, cell);
+        if (player > players) {
+            player -= old_tie;
+            label_store(job, cell, player == EMPTY ? GAMMA_TERRITORY_TIE :
+                                                     player);
+            if (player != run_player) {
+                territory_count(job, run_player, run);
+                run_player = player;
+                run = 0;
+            }
+            ++run;
+        }
+        uint32_t mine = tie + player;
+        uint32_t x = cell % width;
+        uint32_t y = cell / width;
+        if (x > 0)
+            territory_visit(job, &buffer, cell - 1, mine, tie);
+        if (x + 1 < width)
+            territory_visit(job, &buffer, cell + 1, mine, tie);
+        if (y > 0)
+            territory_visit(job, &buffer, cell - width, mine, tie);
+        if (y + 1 < height)
+            territory_visit(job, &buffer, cell + width, mine, tie);
+    }
+    territory_count(job, run_player, run);
+    territory_flush(job, &buffer);
+}
+
+/**
+ * Funkcja pomocnicza podająca maski wierszy pól gracza @p player.
+ * @param g - Wskaźnik na planszę, dla której bits != NULL.
+ * @param player - Numer gracza lub EMPTY.
+ * @return Wskaźnik na maskę pierwszego wiersza.
+ */
+static inline uint64_t* bits_of(const gamma_t *g, uint32_t player) {
+    return g->bits + (size_t) player * g->height;
+}
+
+/**
+ * Funkcja pomocnicza mieszająca 64 bity (finalizator splitmix64).
+ * @param x - Wartość wejściowa.
+ * @return Wymieszana wartość.
+ */
+static inline uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Funkcja pomocnicza podająca klucz Zobrista pary (pole, właściciel).
+ * Klucze nie są przechowywane, tylko wyliczane z numeru pola i gracza, więc
+ * nie zajmują pamięci niezależnie od rozmiaru planszy i liczby graczy.
+ * Puste pole ma klucz 0.
+ * @param g - Wskaźnik na planszę.
+ * @param cell - Numer pola wiersz po wierszu, bez ramki.
+ * @param owner - Numer gracza lub EMPTY.
+ * @return Klucz.
+ */
+static inline uint64_t zobrist_cell(const gamma_t *g, uint64_t cell,
+                                    uint32_t owner) {
+    if (owner == EMPTY)
+        return 0;
+    return mix64(cell * ((uint64_t) g->players + 1) + owner + 1);
+}
+
+/**
+ * Funkcja pomocnicza podająca klucz Zobrista wykorzystanego złotego ruchu.
+ * @param player - Numer gracza.
+ * @return Klucz.
+ */
+static inline uint64_t zobrist_golden(uint32_t player) {
+    return mix64(player ^ GOLDEN_SALT);
+}
+
+/**
+ * Funkcja pomocnicza podająca numer obrazu pola (@p x, @p y) w symetrii
+ * planszy numer @p symmetry: 0 to tożsamość, 1-3 odbicia i obrót o 180
+ * stopni, a 4-7, tylko dla plansz kwadratowych, symetrie zamieniające
+ * wiersze z kolumnami.
+ * @param g - Wskaźnik na planszę.
+ * @param symmetry - Numer symetrii.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Numer pola obrazu wiersz po wierszu.
+ */
+static inline uint64_t symmetric_cell(const gamma_t *g, uint32_t symmetry,
+                                      uint32_t x, uint32_t y) {
+    uint32_t rx = g->width - 1 - x;
+    uint32_t ry = g->height - 1 - y;
+    uint32_t tx, ty;
+    switch (symmetry) {
+        case 1: tx = rx; ty = y; break;
+        case 2: tx = x; ty = ry; break;
+        case 3: tx = rx; ty = ry; break;
+        case 4: tx = y; ty = x; break;
+        case 5: tx = ry; ty = x; break;
+        case 6: tx = y; ty = rx; break;
+        case 7: tx = ry; ty = rx; break;
+        default: tx = x; ty = y; break;
+    }
+    return (uint64_t) ty * g->width + tx;
+}
+
+/**
+ * Funkcja pomocnicza zmieniająca informację o wykorzystaniu złotego ruchu
+ * razem ze skrótami stanu gry.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param used - Nowa wartość.
+ */
+static inline void set_golden_used(gamma_t *g, uint32_t player, bool used) {
+    if (g->golden_used[player] == used)
+        return;
+    g->golden_used[player] = used;
+    uint64_t key = zobrist_golden(player);
+    for (uint32_t i = 0; i < g->hash_count; ++i)
+        g->hash[i] ^= key;
+}
+
+/**
+ * Funkcja pomocnicza podająca właściciela pola o indeksie @p index,
+ * niezależnie od szerokości numerów graczy planszy.
+ * @param g - Wskaźnik na planszę.
+ * @param index - Indeks pola w tablicy właścicieli.
+ * @return Numer gracza lub EMPTY.
+ */
+static uint32_t owner_at(const gamma_t *g, size_t index) {
+    if (g->owner_bytes == sizeof(uint8_t))
+        return ((const uint8_t*) g->owners)[index];
+    if (g->owner_bytes == sizeof(uint16_t))
+        return ((const uint16_t*) g->owners)[index];
+    return ((const uint32_t*) g->owners)[index];
+}
+
+/**
+ * Funkcja pomocnicza zmieniająca o @p delta liczniki wolnych pól trybu
+ * współbieżnego wszystkich graczy, do których należą pola sąsiednie pustego
+ * pola o indeksie @p index, każdego gracza raz.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ * @param index - Indeks pustego pola w tablicy właścicieli.
+ * @param delta - Zmiana liczników, 1 lub -1.
+ */
+static void count_frontier(gamma_t *g, size_t index, int delta) {
+    size_t stride = row_stride(g);
+    const size_t near[] = {index - 1, index + 1, index - stride,
+                           index + stride};
+    uint32_t owners[4];
+    for (int i = 0; i < 4; ++i) {
+        owners[i] = owner_at(g, near[i]);
+        bool counted = owners[i] == EMPTY || owners[i] > g->players;
+        for (int j = 0; j < i && !counted; ++j)
+            counted = owners[j] == owners[i];
+        if (!counted)
+            g->sync->frontier[owners[i]] += (uint64_t) (int64_t) delta;
+    }
+}
+
+/**
+ * Funkcja pomocnicza licząca pola sąsiednie pola o indeksie @p index,
+ * które należą do gracza @p player.
+ * @param g - Wskaźnik na planszę.
+ * @param index - Indeks pola w tablicy właścicieli.
+ * @param player - Numer gracza.
+ * @return Liczba pól sąsiednich gracza, od 0 do 4.
+ */
+static int touching(const gamma_t *g, size_t index, uint32_t player) {
+    size_t stride = row_stride(g);
+    return (owner_at(g, index - 1) == player) +
+           (owner_at(g, index + 1) == player) +
+           (owner_at(g, index - stride) == player) +
+           (owner_at(g, index + stride) == player);
+}
+
+/**
+ * Funkcja pomocnicza poprawiająca liczniki trybu współbieżnego po
+ * przeniesieniu pola (@p x, @p y) od właściciela @p from do właściciela
+ * @p to, z których dokładnie jeden jest równy EMPTY. Tablica właścicieli
+ * jest już zmieniona. Pole zajęte przestaje być wolnym polem graczy z
+ * sąsiedztwa, a jego puste sąsiednie pola stają się wolnymi polami gracza
+ * @p to, jeśli nie były nimi wcześniej. Pole zwolnione działa odwrotnie.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @param from - Dotychczasowy właściciel pola lub EMPTY.
+ * @param to - Nowy właściciel pola lub EMPTY.
+ */
+static void sync_track(gamma_t *g, uint32_t x, uint32_t y,
+                       uint32_t from, uint32_t to) {
+    size_t index = cell_index(g, x, y);
+    size_t stride = row_stride(g);
+    if (from == EMPTY)
+        --(g->sync->empty);
+    else
+        ++(g->sync->empty);
+    count_frontier(g, index, from == EMPTY ? -1 : 1);
+
+    const size_t near[] = {index - 1, index + 1, index - stride,
+                           index + stride};
+    for (int i = 0; i < 4; ++i) {
+        if (owner_at(g, near[i]) != EMPTY)
+            continue;
+        if (to != EMPTY && touching(g, near[i], to) == 1)
+            ++(g->sync->frontier[to]);
+        if (from != EMPTY && touching(g, near[i], from) == 0)
+            --(g->sync->frontier[from]);
+    }
+}
+
+/**
+ * Funkcja pomocnicza licząca od zera liczniki trybu współbieżnego: liczbę
+ * pustych pól i liczby wolnych pól graczy. Koszt jest rzędu rozmiaru
+ * planszy.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ */
+static void sync_count(gamma_t *g) {
+    g->sync->empty = (uint64_t) g->width * g->height;
+    for (uint32_t player = 1; player <= g->players; ++player)
+        g->sync->empty -= g->player_fields[player];
+    memset(g->sync->frontier, 0, sizeof(uint64_t) * ((size_t) g->players + 1));
+    for (uint32_t y = 0; y < g->height; ++y) {
+        for (uint32_t x = 0; x < g->width; ++x) {
+            size_t index = cell_index(g, x, y);
+            if (owner_at(g, index) == EMPTY)
+                count_frontier(g, index, 1);
+        }
+    }
+}
+
+/**
+ * Funkcja pomocnicza przenosząca pole (@p x, @p y) od właściciela @p from do
+ * właściciela @p to w skrótach stanu gry oraz w maskach wierszy i indeksie
+ * ruchów, o ile plansza je ma, a w trybie współbieżnym także w jego
+ * licznikach. Gdy w indeksie zabraknie pamięci, indeks jest usuwany i
+ * zostanie zbudowany od nowa przy następnym wypisaniu ruchów; liczniki
+ * trybu współbieżnego z niego nie korzystają.
+ * @param g - Wskaźnik na planszę.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @param from - Dotychczasowy właściciel pola lub EMPTY.
+ * @param to - Nowy właściciel pola lub EMPTY.
+ */
+static inline void track_owner(gamma_t *g, uint32_t x, uint32_t y,
+                               uint32_t from, uint32_t to) {
+    uint64_t cell = (uint64_t) y * g->width + x;
+    g->hash[0] ^= zobrist_cell(g, cell, from) ^ zobrist_cell(g, cell, to);
+    for (uint32_t i = 1; i < g->hash_count; ++i) {
+        cell = symmetric_cell(g, i, x, y);
+        g->hash[i] ^= zobrist_cell(g, cell, from) ^ zobrist_cell(g, cell, to);
+    }
+    if (g->bits != NULL) {
+        uint64_t bit = (uint64_t) 1 << x;
+        bits_of(g, from)[y] &= ~bit;
+        bits_of(g, to)[y] |= bit;
+    }
+    if (g->sync != NULL)
+        sync_track(g, x, y, from, to);
+    if (g->moves != NULL && !move_index_set(g->moves, x, y, to)) {
+        move_index_delete(g->moves);
+        g->moves = NULL;
+    }
+}
+
+/**
+ * Funkcja pomocnicza przekazująca indeksowi ruchów, o ile plansza go ma,
+ * nową liczbę obszarów gracza @p player: ile obszarów gracz może zyskać,
+ * tracąc pole złotym ruchem innego gracza. Wywoływana po każdej zmianie
+ * liczby obszarów gracza.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ */
+static inline void track_areas(gamma_t *g, uint32_t player) {
+    if (g->moves != NULL)
+        move_index_set_budget(g->moves, player, (int64_t) g->areas + 1 -
+                                                g->player_areas[player]);
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca na maskach wierszy, czy złoty ruch gracza
+ * @p player na pole (@p x, @p y) gracza @p owner zostałby przyjęty, bez
+ * zmieniania stanu planszy. Liczba obszarów gracza @p owner po zabraniu
+ * pola to dotychczasowa liczba, pomniejszona o jeden i powiększona o liczbę
+ * obszarów, na które rozpadają się sąsiedzi pola.
+ * @param g - Wskaźnik na planszę, dla której bits != NULL.
+ * @param player - Numer gracza wykonującego złoty ruch.
+ * @param owner - Numer gracza, do którego należy pole.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Wartość true, jeśli żaden z graczy nie przekroczy liczby obszarów.
+ */
+static bool bits_golden_allowed(gamma_t *g, uint32_t player, uint32_t owner,
+                                uint32_t x, uint32_t y) {
+    uint32_t split = bitboard_split(bits_of(g, owner), g->height, g->row_mask,
+                                    x, y);
+    if ((uint64_t) g->player_areas[owner] - 1 + split > g->areas)
+        return false;
+    if (g->player_areas[player] < g->areas)
+        return true;
+    return (bitboard_neighbours(bits_of(g, player), g->height, g->row_mask,
+                                y) >> x) & 1;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca na maskach wierszy, czy gracz @p player,
+ * który ma maksymalną liczbę obszarów, może gdzieś wykonać złoty ruch.
+ * Kandydatami są pola innych graczy sąsiadujące z polami gracza @p player.
+ * @param g - Wskaźnik na planszę, dla której bits != NULL.
+ * @param player - Numer gracza spełniającego warunek konieczny złotego ruchu.
+ * @return Wartość true, jeśli istnieje pole, które można zająć złotym ruchem.
+ */
+static bool bits_golden_possible(gamma_t *g, uint32_t player) {
+    const uint8_t *owners = g->owners;
+    const uint64_t *empty = bits_of(g, EMPTY);
+    const uint64_t *mine = bits_of(g, player);
+    for (uint32_t y = 0; y < g->height; ++y) {
+        uint64_t candidates = bitboard_neighbours(mine, g->height, g->row_mask,
+                                                  y) & ~empty[y];
+        STATS_ADD(g, cells_scanned, g->width);
+        while (candidates != 0) {
+            uint32_t x = __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            uint32_t owner = owners[cell_index(g, x, y)];
+            uint32_t split = bitboard_split(bits_of(g, owner), g->height,
+                                            g->row_mask, x, y);
+            if ((uint64_t) g->player_areas[owner] - 1 + split <= g->areas)
+                return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Pamięć robocza przeszukiwania obszaru przy sprawdzaniu, na ile obszarów
+ * rozpadną się sąsiedzi opróżnionego pola. Należy do jednego wywołania
+ * funkcji publicznej, więc równoczesne zapytania pod zamkiem czytelnika nie
+ * dzielą żadnego stanu. Tablice są przydzielane dopiero przy pierwszym
+ * przeszukiwaniu, a odwiedzone pola są po nim czyszczone, więc kolejne
+ * przeszukiwania w tym samym wywołaniu nie zerują całej mapy.
+ */
+typedef struct split_search {
+    uint64_t *seen; ///< Mapa bitowa odwiedzonych pól w porządku wierszowym.
+    uint64_t *queue; ///< Kolejka pól w porządku wierszowym.
+    uint64_t size; ///< Rozmiar tablicy queue.
+} split_search_t;
+
+/** Początkowa wartość pamięci roboczej przeszukiwania. */
+#define SPLIT_SEARCH_INIT {NULL, NULL, 0}
+
+/**
+ * Funkcja pomocnicza przydzielająca tablice pamięci roboczej przeszukiwania
+ * przy pierwszym użyciu.
+ * @param search - Wskaźnik na pamięć roboczą.
+ * @param g - Wskaźnik na planszę.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool split_search_start(split_search_t *search, const gamma_t *g) {
+    if (search->seen != NULL)
+        return true;
+    uint64_t cells = (uint64_t) g->width * g->height;
+    search->seen = calloc((cells + 63) / 64, sizeof(uint64_t));
+    search->queue = malloc(sizeof(uint64_t) * SPLIT_SEARCH_QUEUE);
+    search->size = SPLIT_SEARCH_QUEUE;
+    if (search->seen == NULL || search->queue == NULL) {
+        free(search->seen);
+        free(search->queue);
+        search->seen = NULL;
+        search->queue = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca, czy pole zostało już odwiedzone.
+ * @param search - Wskaźnik na pamięć roboczą.
+ * @param cell - Numer pola w porządku wierszowym.
+ * @return Wartość true, jeśli pole jest odwiedzone.
+ */
+static inline bool split_search_seen(const split_search_t *search,
+                                     uint64_t cell) {
+    return (search->seen[cell / 64] >> (cell % 64)) & 1;
+}
+
+/**
+ * Funkcja pomocnicza oznaczająca pole jako odwiedzone i dopisująca je na
+ * koniec kolejki.
+ * @param search - Wskaźnik na pamięć roboczą.
+ * @param tail - Wskaźnik na długość kolejki.
+ * @param cell - Numer pola w porządku wierszowym.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool split_search_push(split_search_t *search, uint64_t *tail,
+                              uint64_t cell) {
+    if (*tail == search->size) {
+        uint64_t *queue = realloc(search->queue,
+                                  sizeof(uint64_t) * 2 * search->size);
+        if (queue == NULL)
+            return false;
+        search->queue = queue;
+        search->size *= 2;
+    }
+    search->seen[cell / 64] |= (uint64_t) 1 << (cell % 64);
+    search->queue[(*tail)++] = cell;
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza czyszcząca oznaczenia pól z kolejki po przeszukiwaniu.
+ * @param search - Wskaźnik na pamięć roboczą.
+ * @param tail - Długość kolejki.
+ */
+static void split_search_clear(split_search_t *search, uint64_t tail) {
+    for (uint64_t i = 0; i < tail; ++i)
+        search->seen[search->queue[i] / 64] = 0;
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca tablice pamięci roboczej przeszukiwania.
+ * @param search - Wskaźnik na pamięć roboczą.
+ */
+static void split_search_free(split_search_t *search) {
+    free(search->seen);
+    free(search->queue);
+}
+
+/** Jądra dla plansz z numerami graczy zapisanymi na 8 bitach. */
+#define OWNER_T uint8_t
+/** Porównanie wektorów 8-bitowych numerów graczy. */
+#define VEC_CMPEQ _mm256_cmpeq_epi8
+/** Wektor 8-bitowych kopii numeru gracza. */
+#define VEC_SET1 _mm256_set1_epi8
+/** Nazwa jądra dla 8-bitowych numerów graczy. */
+#define KERNEL(name) name##_8
+#include "gamma_kernels.h"
+#undef OWNER_T
+#undef KERNEL
+#undef VEC_CMPEQ
+#undef VEC_SET1
+
+/** Jądra dla plansz z numerami graczy zapisanymi na 16 bitach. */
+#define OWNER_T uint16_t
+/** Porównanie wektorów 16-bitowych numerów graczy. */
+#define VEC_CMPEQ _mm256_cmpeq_epi16
+/** Wektor 16-bitowych kopii numeru gracza. */
+#define VEC_SET1 _mm256_set1_epi16
+/** Nazwa jądra dla 16-bitowych numerów graczy. */
+#define KERNEL(name) name##_16
+#include "gamma_kernels.h"
+#undef OWNER_T
+#undef KERNEL
+#undef VEC_CMPEQ
+#undef VEC_SET1
+
+/** Jądra dla plansz z numerami graczy zapisanymi na 32 bitach. */
+#define OWNER_T uint32_t
+/** Porównanie wektorów 32-bitowych numerów graczy. */
+#define VEC_CMPEQ _mm256_cmpeq_epi32
+/** Wektor 32-bitowych kopii numeru gracza. */
+#define VEC_SET1 _mm256_set1_epi32
+/** Nazwa jądra dla 32-bitowych numerów graczy. */
+#define KERNEL(name) name##_32
+#include "gamma_kernels.h"
+#undef OWNER_T
+#undef KERNEL
+#undef VEC_CMPEQ
+#undef VEC_SET1
+
+/**
+ * Wywołuje wersję jądra @p name odpowiednią dla szerokości numerów graczy
+ * planszy @p g z argumentami podanymi po nazwie.
+ */
+#define DISPATCH(g, name, ...) \
+    ((g)->owner_bytes == sizeof(uint8_t) ? name##_8(__VA_ARGS__) : \
+     (g)->owner_bytes == sizeof(uint16_t) ? name##_16(__VA_ARGS__) : \
+     name##_32(__VA_ARGS__))
+
+/**
+ * Funkcja pomocnicza zapisująca liczniki gracza @p player do stanu trybu
+ * współbieżnego, a dla EMPTY liczbę pustych pól. Wywoływana między
+ * @ref seqlock_write_begin i @ref seqlock_write_end.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ * @param player - Numer gracza lub EMPTY.
+ */
+static void publish_player(gamma_t *g, uint32_t player) {
+    published_player_t *out = &(g->sync->players[player]);
+    if (player == EMPTY) {
+        atomic_store_explicit(&(out->fields), g->sync->empty,
+                              memory_order_relaxed);
+        return;
+    }
+    uint64_t frontier = g->player_areas[player] == g->areas ?
+                        g->sync->frontier[player] : 0;
+    atomic_store_explicit(&(out->fields), g->player_fields[player],
+                          memory_order_relaxed);
+    atomic_store_explicit(&(out->frontier), frontier, memory_order_relaxed);
+    atomic_store_explicit(&(out->areas), g->player_areas[player],
+                          memory_order_relaxed);
+    atomic_store_explicit(&(out->golden_used), g->golden_used[player],
+                          memory_order_relaxed);
+}
+
+/**
+ * Funkcja pomocnicza publikująca wersję i skrót stanu gry oraz liczbę
+ * pustych pól. Wywoływana między @ref seqlock_write_begin i
+ * @ref seqlock_write_end.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ */
+static void publish_state(gamma_t *g) {
+    atomic_store_explicit(&(g->sync->version), g->version,
+                          memory_order_relaxed);
+    atomic_store_explicit(&(g->sync->hash), g->hash[0], memory_order_relaxed);
+    publish_player(g, EMPTY);
+}
+
+/**
+ * Funkcja pomocnicza publikująca liczniki wszystkich graczy.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ */
+static void publish_all(gamma_t *g) {
+    seqlock_write_begin(&(g->sync->published));
+    for (uint32_t player = 1; player <= g->players; ++player)
+        publish_player(g, player);
+    publish_state(g);
+    seqlock_write_end(&(g->sync->published));
+}
+
+/**
+ * Funkcja pomocnicza zapisująca do migawek liczniki gracza.
+ * @param g - Wskaźnik na planszę z włączonymi migawkami.
+ * @param player - Numer gracza.
+ */
+static void spectate_player(gamma_t *g, uint32_t player) {
+    spectate_set_player(g->spectate, player, g->player_fields[player],
+                        g->player_areas[player], g->golden_used[player]);
+}
+
+/**
+ * Funkcja pomocnicza publikująca w migawkach cały stan gry.
+ * @param g - Wskaźnik na planszę z włączonymi migawkami.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool spectate_all(gamma_t *g) {
+    for (uint32_t y = 0; y < g->height; ++y)
+        for (uint32_t x = 0; x < g->width; ++x)
+            spectate_set_owner(g->spectate, x, y,
+                               owner_at(g, cell_index(g, x, y)));
+    for (uint32_t player = 1; player <= g->players; ++player)
+        spectate_player(g, player);
+    return spectate_publish(g->spectate, g->version, g->hash[0]);
+}
+
+/**
+ * Funkcja pomocnicza zapisująca do strumienia zdarzenia udanego ruchu.
+ * Zdefiniowana dalej, obok @ref can_move.
+ * @param g - Wskaźnik na planszę z włączonym strumieniem zdarzeń.
+ * @param player - Numer gracza, który wykonał ruch.
+ * @param previous - Poprzedni właściciel pola.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ */
+static void observe_move(gamma_t *g, uint32_t player, uint32_t previous,
+                         uint32_t x, uint32_t y);
+
+/**
+ * Funkcja pomocnicza odnotowująca udany ruch na polu (@p x, @p y):
+ * zwiększa wersję stanu gry, publikuje nową wersję migawek i zdarzenia
+ * strumienia, a w trybie współbieżnym publikuje liczniki tych graczy, które
+ * ruch mógł zmienić. Liczba wolnych pól gracza z maksymalną liczbą obszarów
+ * zmienia się tylko wtedy, gdy pole sąsiaduje z jego polem, więc wystarczą
+ * gracz, poprzedni właściciel pola i właściciele pól sąsiednich.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, który wykonał ruch.
+ * @param previous - Poprzedni właściciel pola.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ */
+static void publish_move(gamma_t *g, uint32_t player, uint32_t previous,
+                         uint32_t x, uint32_t y) {
+    ++(g->version);
+    if (g->spectate != NULL) {
+        spectate_set_owner(g->spectate, x, y, player);
+        spectate_player(g, player);
+        if (previous != EMPTY)
+            spectate_player(g, previous);
+        spectate_publish(g->spectate, g->version, g->hash[0]);
+    }
+    if (g->observe != NULL)
+        observe_move(g, player, previous, x, y);
+    if (g->sync == NULL)
+        return;
+    size_t index = cell_index(g, x, y);
+    size_t stride = row_stride(g);
+    const uint32_t touched[] = {player, previous,
+                                owner_at(g, index - 1), owner_at(g, index + 1),
+                                owner_at(g, index - stride),
+                                owner_at(g, index + stride)};
+    seqlock_write_begin(&(g->sync->published));
+    for (size_t i = 0; i < sizeof(touched) / sizeof(touched[0]); ++i)
+        if (touched[i] != EMPTY && touched[i] <= g->players)
+            publish_player(g, touched[i]);
+    publish_state(g);
+    seqlock_write_end(&(g->sync->published));
+}
+
+/**
+ * Funkcja pomocnicza odczytująca opublikowane liczniki gracza.
+ * @param g - Wskaźnik na planszę w trybie współbieżnym.
+ * @param player - Numer gracza.
+ * @param out - Wskaźnik, pod który zapisujemy liczniki.
+ */
+static void read_published(gamma_t *g, uint32_t player,
+                           gamma_player_info_t *out) {
+    gamma_sync_t *sync = g->sync;
+    const published_player_t *in = &(sync->players[player]);
+    uint_fast64_t sequence;
+    do {
+        sequence = seqlock_read_begin(&(sync->published));
+        uint32_t areas = (uint32_t) atomic_load_explicit(&(in->areas),
+                                                         memory_order_relaxed);
+        out->version = atomic_load_explicit(&(sync->version),
+                                            memory_order_relaxed);
+        out->busy_fields = atomic_load_explicit(&(in->fields),
+                                                memory_order_relaxed);
+        out->free_fields = areas < g->areas ?
+            atomic_load_explicit(&(sync->players[EMPTY].fields),
+                                 memory_order_relaxed) :
+            atomic_load_explicit(&(in->frontier), memory_order_relaxed);
+        out->areas = areas;
+        out->golden_used = atomic_load_explicit(&(in->golden_used),
+                                                memory_order_relaxed);
+    } while (seqlock_read_retry(&(sync->published), sequence));
+}
+
+/**
+ * Sprawdza, czy dany ruch z danymi specyfikacjami jest możliwy w danym
+ * momencie.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, który chce wykonać ruch.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return true w przypadku gdy jest możiwe wykonanie danego ruchu lub false,
+ * gdy taki ruch jest niedozwolony lub któryś z parametrów jest błędny.
+ */
+bool movie_possible(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if (g == NULL)
+        return false;
+    return DISPATCH(g, move_possible, g, player, x, y);
+}
+
+bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if (g == NULL)
+        return false;
+    STATS_START(start);
+    sync_write_lock(g);
+    bool moved = DISPATCH(g, move, g, player, x, y);
+    if (moved)
+        publish_move(g, player, EMPTY, x, y);
+    sync_unlock(g);
+    STATS_RECORD(g, GAMMA_OP_MOVE, start);
+    return moved;
+}
+
+/**
+ * Funkcja pomocnicza licząca wolne pola gracza. Robi to samo co
+ * @ref gamma_free_fields dla poprawnych parametrów.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @return Liczba pól, jakie jeszcze może zająć gracz.
+ */
+static uint64_t free_fields(gamma_t *g, uint32_t player) {
+    if (g->player_areas[player] == g->areas && g->sync != NULL)
+        return g->sync->frontier[player];
+    if (g->player_areas[player] == g->areas && g->moves != NULL)
+        return move_index_frontier(g->moves, player)->count;
+    if (g->player_areas[player] == g->areas && g->bits != NULL) {
+        STATS_ADD(g, cells_scanned, (uint64_t) g->width * g->height);
+        return bitboard_count_frontier(bits_of(g, player), bits_of(g, EMPTY),
+                                       g->height, g->row_mask);
+    }
+    if (g->player_areas[player] == g->areas)
+        return DISPATCH(g, free_fields_full_areas, g, player);
+    uint64_t free_fields = g->height;
+    free_fields *= g->width;
+
+    for (uint32_t i = 1; i <= g->players; ++i) {
+        free_fields -= g->player_fields[i];
+    }
+    return free_fields;
+}
+
+uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
+    if (g == NULL || player == EMPTY || player > g->players)
+        return 0;
+
+    STATS_START(start);
+    uint64_t result;
+    if (g->sync != NULL) {
+        gamma_player_info_t info;
+        read_published(g, player, &info);
+        result = info.free_fields;
+    }
+    else {
+        result = free_fields(g, player);
+    }
+    STATS_RECORD(g, GAMMA_OP_FREE_FIELDS, start);
+    return result;
+}
+
+char* gamma_board(gamma_t *g) {
+    if (g == NULL || (g->sync == NULL && g->no_memory))
+        return NULL;
+    STATS_START(start);
+    uint32_t size = 0;
+    size = logarithm(g->players);
+    uint64_t cells = (uint64_t) g->width * g->height;
+    if (cells > (SIZE_MAX - 1 - g->height) / (size + 1)) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    size_t ptr_size = (size_t) cells * (size + 1) + 1 + g->height;
+    bool no_memory = false;
+    char *board = allocate_memory(ptr_size, &no_memory);
+    if (no_memory) {
+        // W trybie współbieżnym plansza jest tu tylko czytana.
+        if (g->sync == NULL)
+            g->no_memory = true;
+        return NULL;
+    }
+    uint64_t position = 0;
+    sync_read_lock(g);
+    DISPATCH(g, print_players, g, board, size, &position);
+    sync_unlock(g);
+    if (size > 1) {
+        char *new_board = realloc(board, position + 1);
+        board = new_board;
+    }
+    STATS_ADD(g, cells_scanned, (uint64_t) g->width * g->height);
+    STATS_RECORD(g, GAMMA_OP_BOARD, start);
+
+    return board;
+}
+
+bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if (g == NULL)
+        return false;
+    STATS_START(start);
+    sync_write_lock(g);
+    uint32_t previous = good_coords(g, x, y) ?
+                        owner_at(g, cell_index(g, x, y)) : EMPTY;
+    bool moved = DISPATCH(g, golden_move, g, player, x, y);
+    if (moved)
+        publish_move(g, player, previous, x, y);
+    sync_unlock(g);
+    STATS_RECORD(g, GAMMA_OP_GOLDEN_MOVE, start);
+    return moved;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca, czy w przypadku gdy gracz @p player ma
+ * maksymalną liczbę obszarów, to może wykonać gdzieś złoty ruch.
+ * Sprawdzane jest to metodą brutalną.
+ * @param g         - wskaźnik na strukturę planszy do gry gamma
+ * @param player    - gracz pytający o możliwość złotego ruchu
+ * @return          - true, jeśli istnieje pole możliwe do zajęcia złotym ruchem
+ *                    bez przekraczania maksymalnej liczby obszarów.
+ */
+bool golden_wont_exceed_areas(gamma_t *g, uint32_t player) {
+    if (g->bits != NULL)
+        return bits_golden_possible(g, player);
+    return DISPATCH(g, golden_wont_exceed_areas, g, player);
+}
+
+/**
+ * Funkcja pomocnicza robiąca to samo co @ref gamma_golden_possible, ale bez
+ * zamków i statystyk.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @return Wartość true, jeśli gracz może wykonać złoty ruch.
+ */
+static bool golden_possible(gamma_t *g, uint32_t player) {
+    bool necessary_condition = old_golden_possible(g, player);
+    if (!necessary_condition)
+        return false;
+    else if (g->player_areas[player] < g->areas)
+        return true;
+    else
+        return golden_wont_exceed_areas(g, player);
+}
+
+bool gamma_golden_possible(gamma_t *g, uint32_t player) {
+    if (g == NULL)
+        return false;
+    STATS_START(start);
+    sync_read_lock(g);
+    bool possible = golden_possible(g, player);
+    sync_unlock(g);
+    STATS_RECORD(g, GAMMA_OP_GOLDEN_POSSIBLE, start);
+    return possible;
+}
+
+uint32_t gamma_print_board(gamma_t *g, uint32_t x, uint32_t y) {
+    if (g == NULL)
+        return 0;
+    STATS_START(start);
+    uint32_t size = 0;
+    size = logarithm(g->players);
+
+    sync_read_lock(g);
+    if (size > 1)
+        DISPATCH(g, print_big, g, size, x, y);
+    else
+        DISPATCH(g, print_little, g, x, y);
+    sync_unlock(g);
+    STATS_ADD(g, cells_scanned, (uint64_t) g->width * g->height);
+    STATS_RECORD(g, GAMMA_OP_PRINT_BOARD, start);
+
+    return size + (size > 1);
+}
+
+uint32_t gamma_get_players(gamma_t *g) {
+    return g->players;
+}
+
+uint32_t gamma_get_width(gamma_t *g) {
+    return g->width;
+}
+
+uint32_t gamma_get_height(gamma_t *g) {
+    return g->height;
+}
+
+uint32_t gamma_get_areas(gamma_t *g) {
+    return g->areas;
+}
+
+/**
+ * Funkcja pomocnicza opisująca obszar @p area.
+ * @param area - Wskaźnik na opis obszaru.
+ * @param out - Wskaźnik, pod który zapisujemy opis.
+ */
+static void describe_area(const area_t *area, gamma_area_t *out) {
+    out->player = area->player;
+    out->size = area->size;
+    out->min_x = area->min_x;
+    out->min_y = area->min_y;
+    out->max_x = area->max_x;
+    out->max_y = area->max_y;
+}
+
+bool gamma_area_info(gamma_t *g, uint32_t x, uint32_t y, gamma_area_t *out) {
+    if (g == NULL || out == NULL || !good_coords(g, x, y))
+        return false;
+    sync_read_lock(g);
+    uint32_t player = owner_at(g, cell_index(g, x, y));
+    if (player != EMPTY) {
+        uint64_t field = root(g, field_index(g, x, y));
+        describe_area(&(g->area_slots[root_area(g->fields, field)]), out);
+    }
+    sync_unlock(g);
+    return player != EMPTY;
+}
+
+bool gamma_for_each_area(gamma_t *g, uint32_t player,
+                         gamma_area_visitor_t visit, void *ctx) {
+    if (g == NULL || visit == NULL || player == EMPTY || player > g->players)
+        return false;
+    gamma_area_t area;
+    sync_read_lock(g);
+    for (uint32_t it = g->player_roots[player].first; it != NO_AREA;
+         it = g->area_slots[it].next) {
+        describe_area(&(g->area_slots[it]), &area);
+        if (!visit(&area, ctx))
+            break;
+    }
+    sync_unlock(g);
+    return true;
+}
+
+bool gamma_set_threads(gamma_t *g, uint32_t threads) {
+    if (g == NULL)
+        return false;
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+    thread_pool_t *pool = NULL;
+    if (threads > 1 && (pool = thread_pool_new(threads)) == NULL)
+        return false;
+    sync_write_lock(g);
+    thread_pool_t *old = g->pool;
+    g->pool = pool;
+    sync_unlock(g);
+    thread_pool_delete(old);
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza budująca indeks ruchów dla stanu planszy. Koszt jest
+ * rzędu rozmiaru planszy.
+ * @param g - Wskaźnik na planszę.
+ * @return Wskaźnik na nowy indeks lub NULL, gdy zabrakło pamięci.
+ */
+static move_index_t* build_move_index(const gamma_t *g) {
+    move_index_t *moves = move_index_new(g->width, g->height, g->players);
+    if (moves == NULL)
+        return NULL;
+    for (uint32_t player = 1; player <= g->players; ++player)
+        move_index_set_budget(moves, player, (int64_t) g->areas + 1 -
+                                             g->player_areas[player]);
+    for (uint32_t y = 0; y < g->height; ++y) {
+        for (uint32_t x = 0; x < g->width; ++x) {
+            uint32_t player = owner_at(g, cell_index(g, x, y));
+            if (player != EMPTY && !move_index_set(moves, x, y, player)) {
+                move_index_delete(moves);
+                return NULL;
             }
-            unite(g->fields[y][x],
-                  g->fields[y + delta_y[i]][x + delta_x[i]]);
         }
     }
-    if (united_areas == 0)
-        ++(g->player_areas[player]);
+    return moves;
+}
+
+/**
+ * Funkcja pomocnicza budująca indeks ruchów planszy, jeśli jeszcze go nie
+ * ma.
+ * @param g - Wskaźnik na planszę.
+ * @return Wartość false, gdy zabrakło pamięci; errno jest wtedy ustawione
+ * na ENOMEM.
+ */
+static bool ensure_move_index(gamma_t *g) {
+    if (g->moves == NULL && (g->moves = build_move_index(g)) == NULL) {
+        errno = ENOMEM;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza biorąca zamek czytelnika planszy z indeksem ruchów.
+ * Gdy indeksu nie ma (przed pierwszym zapytaniem, które go potrzebuje, albo
+ * po braku pamięci), jest budowany pod zamkiem pisarza, który zostaje wtedy
+ * wzięty zamiast zamka czytelnika. Oba zwalnia
+ * @ref sync_unlock.
+ * @param g - Wskaźnik na planszę.
+ * @return Wartość false, gdy zabrakło pamięci na indeks; errno jest wtedy
+ * ustawione na ENOMEM, a zamek i tak jest wzięty.
+ */
+static bool read_lock_move_index(gamma_t *g) {
+    sync_read_lock(g);
+    if (g->moves != NULL)
+        return true;
+    sync_unlock(g);
+    sync_write_lock(g);
+    return ensure_move_index(g);
+}
+
+bool gamma_set_concurrent(gamma_t *g, bool concurrent) {
+    if (g == NULL)
+        return false;
+    if (!concurrent) {
+        sync_delete(g->sync);
+        g->sync = NULL;
+        return true;
+    }
+    if (g->sync != NULL)
+        return true;
+
+    gamma_sync_t *sync = malloc(sizeof(gamma_sync_t));
+    published_player_t *players = malloc(sizeof(published_player_t) *
+                                         ((size_t) g->players + 1));
+    uint64_t *frontier = malloc(sizeof(uint64_t) * ((size_t) g->players + 1));
+    pthread_rwlockattr_t attr;
+    int error = sync == NULL || players == NULL || frontier == NULL ? ENOMEM :
+                pthread_rwlockattr_init(&attr);
+    if (error == 0) {
+#ifdef __GLIBC__
+        // Domyślny zamek glibc przepuszcza nowych czytelników przed
+        // czekającym pisarzem, a przy ciągłych odczytach ruch czekałby
+        // w nieskończoność.
+        pthread_rwlockattr_setkind_np(
+            &attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+        error = pthread_rwlock_init(&(sync->lock), &attr);
+        pthread_rwlockattr_destroy(&attr);
+    }
+    if (error != 0) {
+        free(frontier);
+        free(players);
+        free(sync);
+        errno = error;
+        return false;
+    }
+
+    sync->players = players;
+    sync->frontier = frontier;
+    seqlock_init(&(sync->published));
+    atomic_init(&(sync->version), 0);
+    atomic_init(&(sync->hash), 0);
+    for (uint32_t i = 0; i <= g->players; ++i) {
+        atomic_init(&(players[i].fields), 0);
+        atomic_init(&(players[i].frontier), 0);
+        atomic_init(&(players[i].areas), 0);
+        atomic_init(&(players[i].golden_used), false);
+    }
+    g->sync = sync;
+    sync_count(g);
+    publish_all(g);
+    return true;
+}
+
+bool gamma_set_snapshots(gamma_t *g, uint32_t readers) {
+    if (g == NULL) {
+        errno = EINVAL;
+        return false;
+    }
+    spectate_t *spectate = NULL;
+    if (readers > 0) {
+        spectate = spectate_new(g->width, g->height, g->players,
+                                g->owner_bytes, readers);
+        if (spectate == NULL)
+            return false;
+    }
+
+    sync_write_lock(g);
+    spectate_t *old = g->spectate;
+    g->spectate = spectate;
+    bool published = spectate == NULL || spectate_all(g);
+    if (!published)
+        g->spectate = old;
+    sync_unlock(g);
+    if (!published) {
+        spectate_delete(spectate);
+        errno = ENOMEM;
+        return false;
+    }
+    spectate_delete(old);
+    return true;
+}
+
+gamma_snapshot_t* gamma_snapshot_acquire(gamma_t *g) {
+    if (g == NULL || g->spectate == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return spectate_acquire(g->spectate);
+}
+
+uint64_t gamma_version(gamma_t *g) {
+    if (g == NULL)
+        return 0;
+    if (g->sync != NULL)
+        return atomic_load_explicit(&(g->sync->version), memory_order_relaxed);
+    return g->version;
+}
+
+bool gamma_player_info(gamma_t *g, uint32_t player, gamma_player_info_t *out) {
+    if (g == NULL || out == NULL || player == EMPTY || player > g->players)
+        return false;
+    if (g->sync != NULL) {
+        read_published(g, player, out);
+        return true;
+    }
+    out->version = g->version;
+    out->busy_fields = g->player_fields[player];
+    out->free_fields = free_fields(g, player);
+    out->areas = g->player_areas[player];
+    out->golden_used = g->golden_used[player];
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza przepisująca pola listy indeksu ruchów do tablicy.
+ * @param list - Wskaźnik na listę.
+ * @param buf - Tablica, do której zapisujemy pola.
+ * @param cap - Rozmiar tablicy @p buf.
+ * @return Liczba zapisanych pól.
+ */
+static uint64_t copy_cells(const move_list_t *list, gamma_cell_t *buf,
+                           uint64_t cap) {
+    uint64_t count = list->count < cap ? list->count : cap;
+    for (uint64_t i = 0; i < count; ++i) {
+        buf[i].x = (uint32_t) list->cells[i];
+        buf[i].y = (uint32_t) (list->cells[i] >> 32);
+    }
+    return count;
+}
+
+uint64_t gamma_legal_moves(gamma_t *g, uint32_t player, gamma_cell_t *buf,
+                           uint64_t cap) {
+    if (g == NULL || buf == NULL || player == EMPTY || player > g->players)
+        return 0;
+    uint64_t count = 0;
+    if (read_lock_move_index(g))
+        count = copy_cells(g->player_areas[player] < g->areas ?
+                           move_index_owned(g->moves, EMPTY) :
+                           move_index_frontier(g->moves, player), buf, cap);
+    sync_unlock(g);
+    return count;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca, czy gracz @p owner nie przekroczy
+ * maksymalnej liczby obszarów po utracie pola (@p x, @p y). Gdy nie
+ * wystarcza oszacowanie liczbą sąsiadów pola należących do gracza,
+ * przeszukiwany jest obszar pola.
+ * @param g - Wskaźnik na planszę z indeksem ruchów.
+ * @param search - Pamięć robocza przeszukiwania obszaru.
+ * @param owner - Numer gracza, do którego należy pole.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @param allowed - Wskaźnik, pod który zapisujemy wynik.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool golden_target_allowed(gamma_t *g, split_search_t *search,
+                                  uint32_t owner, uint32_t x, uint32_t y,
+                                  bool *allowed) {
+    uint64_t left = (uint64_t) g->player_areas[owner] - 1;
+    uint32_t split = move_index_split_bound(g->moves, x, y);
+    if (left + split > g->areas) {
+        if (g->bits != NULL)
+            split = bitboard_split(bits_of(g, owner), g->height, g->row_mask,
+                                   x, y);
+        else
+            split = DISPATCH(g, area_split, g, search, x, y);
+        if (split == UINT32_MAX)
+            return false;
+    }
+    *allowed = left + split <= g->areas;
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca do tablicy te pola listy, które można zająć
+ * złotym ruchem.
+ * @param g - Wskaźnik na planszę z indeksem ruchów.
+ * @param search - Pamięć robocza przeszukiwania obszaru.
+ * @param list - Wskaźnik na listę kandydatów, pól innych graczy.
+ * @param buf - Tablica, do której zapisujemy pola.
+ * @param cap - Rozmiar tablicy @p buf.
+ * @param count - Wskaźnik na liczbę pól zapisanych już w @p buf.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool collect_golden_targets(gamma_t *g, split_search_t *search,
+                                   const move_list_t *list,
+                                   gamma_cell_t *buf, uint64_t cap,
+                                   uint64_t *count) {
+    for (uint64_t i = 0; i < list->count && *count < cap; ++i) {
+        uint32_t x = (uint32_t) list->cells[i];
+        uint32_t y = (uint32_t) (list->cells[i] >> 32);
+        uint32_t owner = owner_at(g, cell_index(g, x, y));
+        bool allowed;
+        if (!golden_target_allowed(g, search, owner, x, y, &allowed)) {
+            errno = ENOMEM;
+            return false;
+        }
+        if (allowed) {
+            buf[*count].x = x;
+            buf[*count].y = y;
+            ++(*count);
+        }
+    }
+    return true;
+}
 
-    if (united_areas > 0)
-        g->player_areas[player] -= (united_areas - 1);
+/**
+ * Funkcja pomocnicza robiąca to samo co @ref gamma_golden_targets, ale bez
+ * zamków.
+ * @param g - Wskaźnik na planszę z indeksem ruchów.
+ * @param player - Numer gracza.
+ * @param buf - Tablica, do której zapisujemy pola.
+ * @param cap - Rozmiar tablicy @p buf.
+ * @return Liczba zapisanych pól.
+ */
+static uint64_t golden_targets(gamma_t *g, uint32_t player, gamma_cell_t *buf,
+                               uint64_t cap) {
+    if (!old_golden_possible(g, player))
+        return 0;
+    split_search_t search = SPLIT_SEARCH_INIT;
+    uint64_t count = 0;
+    if (g->player_areas[player] == g->areas) {
+        collect_golden_targets(g, &search,
+                               move_index_contact(g->moves, player), buf,
+                               cap, &count);
+    }
+    else {
+        for (uint32_t owner = 1; owner <= g->players; ++owner)
+            if (owner != player &&
+                !collect_golden_targets(g, &search,
+                                        move_index_owned(g->moves, owner),
+                                        buf, cap, &count))
+                break;
+    }
+    split_search_free(&search);
+    return count;
+}
 
-    ++(g->player_fields[player]);
+uint64_t gamma_golden_targets(gamma_t *g, uint32_t player, gamma_cell_t *buf,
+                              uint64_t cap) {
+    if (g == NULL || buf == NULL)
+        return 0;
+    uint64_t count = 0;
+    if (read_lock_move_index(g))
+        count = golden_targets(g, player, buf, cap);
+    sync_unlock(g);
+    return count;
+}
 
+/**
+ * Funkcja pomocnicza sprawdzająca, czy gracz z maksymalną liczbą obszarów
+ * może zająć złotym ruchem któreś z sąsiednich pól innych graczy. Indeks
+ * ruchów liczy dla każdego gracza pola styku, które można zająć według
+ * ograniczenia rozpadu obszaru, więc zwykle wystarcza jedno odczytanie.
+ * Pola, których ograniczenie przekracza zapas właściciela, mogą się jeszcze
+ * nadawać, gdy ich sąsiedzi łączą się poza polami narożnymi; tylko wtedy
+ * przeszukiwane są obszary pól styku.
+ * @param g - Wskaźnik na planszę z indeksem ruchów.
+ * @param player - Numer gracza.
+ * @return Wartość true, jeśli takie pole istnieje.
+ */
+static bool golden_target_exists(gamma_t *g, uint32_t player) {
+    if (move_index_golden(g->moves, player) > 0)
+        return true;
+    const move_list_t *contact = move_index_contact(g->moves, player);
+    if (contact->count == 0)
+        return false;
+    gamma_cell_t target;
+    uint64_t count = 0;
+    split_search_t search = SPLIT_SEARCH_INIT;
+    bool collected = collect_golden_targets(g, &search, contact, &target, 1,
+                                            &count);
+    split_search_free(&search);
+    if (!collected)
+        return golden_wont_exceed_areas(g, player);
+    return count > 0;
 }
 
 /**
- * Funkcja pomocnicza, która symuluje ciąg ruchów wykonanych przez gracza
- * @p player.
+ * Funkcja pomocnicza robiąca to samo co @ref gamma_can_move dla poprawnych
+ * parametrów, ale bez zamków. Plansza bez indeksu ruchów, któremu zabrakło
+ * pamięci, jest przeglądana.
  * @param g - Wskaźnik na planszę.
- * @param player - Numer gracza, któremu 'zabraliśmy' pola w celu wykonania
- * złotego ruchu.
+ * @param player - Numer gracza.
+ * @return Wartość true, jeśli gracz może wykonać ruch lub złoty ruch.
  */
-static void golden_set_other_field_reps(gamma_t *g, uint32_t player) {
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            if (g->fields[i][j].owner == player) {
-                restore_move(g, player, j, i);
-            }
-        }
+static bool can_move(gamma_t *g, uint32_t player) {
+    if (g->moves == NULL)
+        return free_fields(g, player) > 0 || golden_possible(g, player);
+
+    uint64_t empty = move_index_owned(g->moves, EMPTY)->count;
+    if (g->player_areas[player] < g->areas) {
+        uint64_t others = (uint64_t) g->width * g->height - empty -
+                          g->player_fields[player];
+        return empty > 0 || (!g->golden_used[player] && others > 0);
     }
+    if (move_index_frontier(g->moves, player)->count > 0)
+        return true;
+    return !g->golden_used[player] && golden_target_exists(g, player);
 }
 
-bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    if (!old_golden_possible(g, player) || !good_coords(g, x, y) ||
-        g->fields[y][x].owner == EMPTY || g->fields[y][x].owner == player ||
-        g->golden_used[player] == true)
+/**
+ * Funkcja pomocnicza rozstrzygająca z liczników trybu współbieżnego, bez
+ * indeksu ruchów, czy gracz może wykonać ruch. Nie rozstrzyga dla gracza
+ * bez wolnych pól, który nie wykorzystał złotego ruchu.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param possible - Wskaźnik, pod który zapisujemy wynik.
+ * @return Wartość true, jeśli wynik został zapisany.
+ */
+static bool counted_can_move(gamma_t *g, uint32_t player, bool *possible) {
+    if (g->sync == NULL || g->moves != NULL)
         return false;
+    *possible = free_fields(g, player) > 0;
+    return *possible || g->golden_used[player];
+}
 
-    uint32_t changed_player = g->fields[y][x].owner;
+bool gamma_can_move(gamma_t *g, uint32_t player) {
+    if (g == NULL || player == EMPTY || player > g->players)
+        return false;
+    bool possible;
+    sync_read_lock(g);
+    if (!counted_can_move(g, player, &possible)) {
+        sync_unlock(g);
+        read_lock_move_index(g);
+        possible = can_move(g, player);
+    }
+    sync_unlock(g);
+    return possible;
+}
 
-    golden_reset_field_reps(g, changed_player);
-    g->fields[y][x].owner = EMPTY;
-    golden_set_other_field_reps(g, changed_player);
+bool gamma_game_over(gamma_t *g) {
+    if (g == NULL)
+        return false;
+    bool possible = false, counted = true;
+    sync_read_lock(g);
+    for (uint32_t player = 1; player <= g->players && counted && !possible;
+         ++player)
+        counted = counted_can_move(g, player, &possible);
+    sync_unlock(g);
+    if (counted)
+        return !possible;
+
+    bool over = true;
+    read_lock_move_index(g);
+    for (uint32_t player = 1; player <= g->players && over; ++player)
+        over = !can_move(g, player);
+    sync_unlock(g);
+    return over;
+}
 
+/**
+ * Funkcja pomocnicza licząca puste pola planszy.
+ * @param g - Wskaźnik na planszę.
+ * @return Liczba pustych pól.
+ */
+static uint64_t empty_fields(gamma_t *g) {
+    if (g->sync != NULL)
+        return g->sync->empty;
+    if (g->moves != NULL)
+        return move_index_owned(g->moves, EMPTY)->count;
+    uint64_t empty = (uint64_t) g->width * g->height;
+    for (uint32_t i = 1; i <= g->players; ++i)
+        empty -= g->player_fields[i];
+    return empty;
+}
 
-    if (g->player_areas[changed_player] > g->areas) {
-        restore_move(g, changed_player, x, y);
-        return false;
+/**
+ * Funkcja pomocnicza sprawdzająca możliwość ruchu gracza, zgłaszająca jej
+ * zmianę i poprawiająca jego obecność na liście obserwowanych.
+ * @param g - Wskaźnik na planszę z włączonym strumieniem zdarzeń.
+ * @param player - Numer gracza.
+ * @param emit - Czy zgłosić zmianę do strumienia.
+ */
+static void observe_player(gamma_t *g, uint32_t player, bool emit) {
+    observe_t *o = g->observe;
+    bool blocked = !can_move(g, player);
+    if (blocked != o->blocked[player]) {
+        o->blocked[player] = blocked;
+        gamma_event_t event = {.type = GAMMA_EVENT_BLOCKED, .player = player,
+                               .value = blocked};
+        if (emit)
+            feed_emit(o->feed, &event);
     }
 
-    if (gamma_move(g, player, x, y)) {
-        g->golden_used[player] = true;
-        return true;
+    bool watched = !g->golden_used[player] && free_fields(g, player) == 0;
+    uint32_t slot = o->watched_slot[player];
+    if (watched && slot == NOT_WATCHED) {
+        o->watched_slot[player] = o->watched_count;
+        o->watched[o->watched_count++] = player;
     }
+    else if (!watched && slot != NOT_WATCHED) {
+        uint32_t last = o->watched[--(o->watched_count)];
+        o->watched[slot] = last;
+        o->watched_slot[last] = slot;
+        o->watched_slot[player] = NOT_WATCHED;
+    }
+}
 
-    restore_move(g, changed_player, x, y);
-    return false;
+/**
+ * Funkcja pomocnicza zgłaszająca zmianę liczby obszarów gracza.
+ * @param g - Wskaźnik na planszę z włączonym strumieniem zdarzeń.
+ * @param player - Numer gracza.
+ */
+static void observe_areas(gamma_t *g, uint32_t player) {
+    observe_t *o = g->observe;
+    if (g->player_areas[player] != o->areas[player]) {
+        gamma_event_t event = {.type = GAMMA_EVENT_AREAS, .player = player,
+                               .previous = o->areas[player],
+                               .value = g->player_areas[player]};
+        o->areas[player] = g->player_areas[player];
+        feed_emit(o->feed, &event);
+    }
 }
 
 /**
- * Funkcja pomocnicza sprawdzająca, czy w przypadku gdy gracz @p player ma
- * maksymalną liczbę obszarów, to może wykonać gdzieś złoty ruch.
- * Sprawdzane jest to metodą brutalną.
- * @param g         - wskaźnik na strukturę planszy do gry gamma
- * @param player    - gracz pytający o możliwość złotego ruchu
- * @return          - true, jeśli istnieje pole możliwe do zajęcia złotym ruchem
- *                    bez przekraczania maksymalnej liczby obszarów.
+ * Funkcja pomocnicza zapamiętująca bez zgłaszania bieżące liczby obszarów
+ * i możliwości ruchu wszystkich graczy.
+ * @param g - Wskaźnik na planszę z włączonym strumieniem zdarzeń.
  */
-bool golden_wont_exceed_areas(gamma_t *g, uint32_t player) {
-    uint32_t width = g->width;
-    uint32_t height = g->height;
+static void observe_all(gamma_t *g) {
+    observe_t *o = g->observe;
+    o->filled = empty_fields(g) == 0;
+    for (uint32_t player = 1; player <= g->players; ++player) {
+        o->areas[player] = g->player_areas[player];
+        observe_player(g, player, false);
+    }
+}
 
-    bool wont_exceed_max_areas = false;
-    for (uint32_t i = 0; i < height && !wont_exceed_max_areas; ++i) {
-        for (uint32_t j = 0; j < width && !wont_exceed_max_areas; ++j) {
-            if (g->fields[i][j].owner == player ||
-                g->fields[i][j].owner == EMPTY)
-                continue;
+static void observe_move(gamma_t *g, uint32_t player, uint32_t previous,
+                         uint32_t x, uint32_t y) {
+    observe_t *o = g->observe;
+    gamma_event_t event = {.type = GAMMA_EVENT_OWNER, .player = player,
+                           .x = x, .y = y, .previous = previous};
+    feed_emit(o->feed, &event);
+    if (previous != EMPTY) {
+        event = (gamma_event_t) {.type = GAMMA_EVENT_GOLDEN,
+                                 .player = player};
+        feed_emit(o->feed, &event);
+        observe_areas(g, previous);
+    }
+    observe_areas(g, player);
+
+    size_t index = cell_index(g, x, y);
+    size_t stride = row_stride(g);
+    const uint32_t touched[] = {player, previous,
+                                owner_at(g, index - 1), owner_at(g, index + 1),
+                                owner_at(g, index - stride),
+                                owner_at(g, index + stride)};
+    for (size_t i = 0; i < sizeof(touched) / sizeof(touched[0]); ++i)
+        if (touched[i] != EMPTY && touched[i] <= g->players)
+            observe_player(g, touched[i], true);
+    if (!o->filled && empty_fields(g) == 0) {
+        o->filled = true;
+        for (uint32_t i = 1; i <= g->players; ++i)
+            observe_player(g, i, true);
+    }
+    else {
+        // Sprawdzenie gracza może go usunąć z listy; na jego miejsce wchodzi
+        // wtedy ostatni gracz listy, już sprawdzony.
+        for (uint32_t i = o->watched_count; i-- > 0;)
+            if (i < o->watched_count)
+                observe_player(g, o->watched[i], true);
+    }
+}
 
-            uint32_t field_owner = g->fields[i][j].owner;
+bool gamma_set_feed(gamma_t *g, size_t capacity) {
+    if (g == NULL) {
+        errno = EINVAL;
+        return false;
+    }
+    observe_t *observe = NULL;
+    if (capacity > 0) {
+        size_t count = (size_t) g->players + 1;
+        observe = calloc(1, sizeof(observe_t));
+        if (observe == NULL) {
+            errno = ENOMEM;
+            return false;
+        }
+        observe->feed = feed_new(capacity);
+        observe->areas = malloc(sizeof(uint32_t) * count);
+        observe->blocked = calloc(count, sizeof(bool));
+        observe->watched = malloc(sizeof(uint32_t) * count);
+        observe->watched_slot = malloc(sizeof(uint32_t) * count);
+        if (observe->feed == NULL || observe->areas == NULL ||
+            observe->blocked == NULL || observe->watched == NULL ||
+            observe->watched_slot == NULL) {
+            if (observe->feed != NULL)
+                errno = ENOMEM;
+            observe_delete(observe);
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+            observe->watched_slot[i] = NOT_WATCHED;
+    }
 
-            if (gamma_golden_move(g, player, j, i)) {
-                wont_exceed_max_areas = true;
-                g->golden_used[player] = false;
+    sync_write_lock(g);
+    observe_t *old = g->observe;
+    g->observe = observe;
+    if (observe != NULL) {
+        // Indeks ruchów sprawia, że sprawdzenie gracza po ruchu nie
+        // przegląda całej planszy.
+        ensure_move_index(g);
+        observe_all(g);
+    }
+    sync_unlock(g);
+    observe_delete(old);
+    return true;
+}
 
-                bool field_owner_golden_used = g->golden_used[field_owner];
-                g->golden_used[field_owner] = false;
-                gamma_golden_move(g, field_owner, j, i);
-                g->golden_used[field_owner] = field_owner_golden_used;
-            }
-        }
+uint64_t gamma_feed_position(gamma_t *g) {
+    if (g == NULL || g->observe == NULL)
+        return 0;
+    return feed_position(g->observe->feed);
+}
+
+bool gamma_feed_read(gamma_t *g, uint64_t *position, void *buffer,
+                     size_t size, size_t *length) {
+    if (g == NULL || g->observe == NULL || position == NULL ||
+        buffer == NULL || size < GAMMA_EVENT_MAX_SIZE || length == NULL) {
+        errno = EINVAL;
+        return false;
     }
-    return wont_exceed_max_areas;
+    return feed_read(g->observe->feed, position, buffer, size, length);
 }
 
-bool gamma_golden_possible(gamma_t *g, uint32_t player) {
-    bool necessary_condition = old_golden_possible(g, player);
-    if (!necessary_condition)
+/**
+ * Funkcja pomocnicza robiąca to samo co @ref gamma_territory dla poprawnych
+ * parametrów, ale bez zamków.
+ * @param g - Wskaźnik na planszę.
+ * @param labels - Tablica etykiet pól.
+ * @param counts - Tablica liczb pól graczy.
+ * @return Wartość false z ustawionym errno w razie błędu.
+ */
+static bool territory(gamma_t *g, uint32_t *labels, uint64_t *counts) {
+    uint64_t cells = (uint64_t) g->width * g->height;
+    if (cells > UINT32_MAX || g->players > (UINT32_MAX - 3) / 3) {
+        errno = EOVERFLOW;
         return false;
-    else if (g->player_areas[player] < g->areas)
-        return true;
+    }
+    // Kolejkę planszy bierze jeden przegląd naraz, a przeglądy równoczesne
+    // z nim w trybie współbieżnym dostają kolejkę na czas wywołania.
+    bool owned = !atomic_exchange_explicit(&(g->territory_busy), true,
+                                           memory_order_acquire);
+    uint32_t *queue = owned ? g->territory_queue : NULL;
+    if (queue == NULL) {
+        queue = malloc(sizeof(uint32_t) * cells);
+        if (queue == NULL) {
+            if (owned)
+                atomic_store_explicit(&(g->territory_busy), false,
+                                      memory_order_release);
+            errno = ENOMEM;
+            return false;
+        }
+        if (owned)
+            g->territory_queue = queue;
+    }
+    STATS_START(start);
+    territory_job_t job;
+    job.g = g;
+    job.labels = labels;
+    job.counts = counts;
+    job.queue = queue;
+    atomic_init(&(job.tail), 0);
+    job.bands = scan_bands(g);
+    job.shared = job.bands > 1;
+    memset(counts, 0, sizeof(uint64_t) * ((size_t) g->players + 1));
+    DISPATCH(g, territory_sources, &job);
+    STATS_ADD(g, cells_scanned, cells);
+
+    job.head = 0;
+    job.end = atomic_load(&(job.tail));
+    job.parity = 1;
+    while (job.head < job.end) {
+        uint64_t tasks = (job.end - job.head + TERRITORY_CHUNK - 1) /
+                         TERRITORY_CHUNK;
+        job.shared = g->pool != NULL && tasks > 1 &&
+                     cells >= GAMMA_PARALLEL_MIN_CELLS;
+        if (job.shared)
+            thread_pool_run(g->pool, (uint32_t) tasks, territory_expand, &job);
+        else
+            for (uint32_t task = 0; task < tasks; ++task)
+                territory_expand(&job, task);
+        job.head = job.end;
+        job.end = atomic_load(&(job.tail));
+        job.parity ^= 1;
+    }
+
+    uint64_t assigned = 0;
+    for (uint32_t i = 1; i <= g->players; ++i) {
+        counts[i] += g->player_fields[i];
+        assigned += counts[i];
+    }
+    counts[EMPTY] = cells - assigned;
+    if (owned)
+        atomic_store_explicit(&(g->territory_busy), false,
+                              memory_order_release);
     else
-        return golden_wont_exceed_areas(g, player);
+        free(queue);
+    STATS_RECORD(g, GAMMA_OP_TERRITORY, start);
+    return true;
+}
+
+bool gamma_territory(gamma_t *g, uint32_t *labels, uint64_t *counts) {
+    if (g == NULL || labels == NULL || counts == NULL) {
+        errno = EINVAL;
+        return false;
+    }
+    sync_read_lock(g);
+    bool done = territory(g, labels, counts);
+    sync_unlock(g);
+    return done;
 }
 
 /**
- * Funkcja pomocnicza wypisująca planszę na stdout dla <= 9 graczy. Nie
- * obsługuje planszy @p g = NULL.
- * Podswietla pole wyznaczone przez współrzędne (x,y).
- * @param g     - wskaźnik na strukturę przechowującą grę.
- * @param x     - współrzędna pola do wyróżnienia.
- * @param y     - współrzdna pola do wyróżnienia.
- */
-static void print_little(gamma_t *g, uint32_t x, uint32_t y) {
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            char c;
-            if (i == y && j == x)
-                printf("\033[44m");
-            if (g->fields[g->height - 1 - i][j].owner != EMPTY)
-                c = g->fields[g->height - 1 - i][j].owner + '0';
-            else
-                c = '.';
-            printf("%c", c);
-            if (i == y && j == x)
-                printf("\033[0m");
+ * Funkcja pomocnicza robiąca to samo co @ref gamma_copy dla zgodnych,
+ * różnych plansz, ale bez zamków. Plansza docelowa dostaje indeks ruchów
+ * tylko wtedy, gdy ma go plansza źródłowa, a w trybie współbieżnym liczy
+ * swoje liczniki od nowa. Kopiowany jest blok pamięci za strukturą planszy
+ * i pola struktury opisujące stan gry. Pozostałe pola struktury zależą
+ * tylko od parametrów planszy albo należą do @p dst, a czytelnicy w trybie
+ * współbieżnym mogą je czytać w trakcie kopiowania.
+ * @param dst - Wskaźnik na planszę docelową.
+ * @param src - Wskaźnik na planszę źródłową.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool copy_state(gamma_t *dst, const gamma_t *src) {
+    if (src->moves == NULL) {
+        move_index_delete(dst->moves);
+        dst->moves = NULL;
+    }
+    else {
+        if (dst->moves == NULL)
+            dst->moves = move_index_new(src->width, src->height, src->players);
+        if (dst->moves == NULL || !move_index_copy(dst->moves, src->moves)) {
+            move_index_delete(dst->moves);
+            dst->moves = NULL;
+            errno = ENOMEM;
+            return false;
         }
-        printf("\n");
     }
+
+    memcpy((char*) dst + sizeof(gamma_t),
+           (const char*) src + sizeof(gamma_t),
+           src->block_size - sizeof(gamma_t));
+    dst->no_memory = src->no_memory;
+    memcpy(dst->hash, src->hash, sizeof(dst->hash));
+    dst->hash_count = src->hash_count;
+    dst->version = src->version;
+    dst->area_count = src->area_count;
+    if (dst->sync != NULL)
+        sync_count(dst);
+    return true;
+}
+
+bool gamma_copy(gamma_t *dst, gamma_t *src) {
+    if (dst == NULL || src == NULL || dst->width != src->width ||
+        dst->height != src->height || dst->players != src->players ||
+        dst->areas != src->areas || dst->layout != src->layout ||
+        dst->block_size != src->block_size)
+        return false;
+    if (dst == src)
+        return true;
+
+    // Zamki obu plansz bierzemy w kolejności adresów, żeby równoczesne
+    // gamma_copy(a, b) i gamma_copy(b, a) nie czekały na siebie nawzajem.
+    if ((uintptr_t) dst < (uintptr_t) src) {
+        sync_write_lock(dst);
+        sync_read_lock(src);
+    }
+    else {
+        sync_read_lock(src);
+        sync_write_lock(dst);
+    }
+    bool copied = copy_state(dst, src);
+    if (copied && dst->sync != NULL)
+        publish_all(dst);
+    if (copied && dst->spectate != NULL)
+        spectate_all(dst);
+    if (copied && dst->observe != NULL) {
+        gamma_event_t event = {.type = GAMMA_EVENT_RESET,
+                               .value = dst->version};
+        feed_emit(dst->observe->feed, &event);
+        observe_all(dst);
+    }
+    sync_unlock(src);
+    sync_unlock(dst);
+    return copied;
+}
+
+gamma_t* gamma_clone(gamma_t *g) {
+    if (g == NULL)
+        return NULL;
+    gamma_t *copy = gamma_new_layout(g->width, g->height, g->players, g->areas,
+                                     &(g->allocator), g->layout);
+    if (copy != NULL && !gamma_copy(copy, g)) {
+        gamma_delete(copy);
+        return NULL;
+    }
+    return copy;
 }
 
 /**
- * Funkcja pomocnicza wypisująca planszę na stdout dla > 9 graczy. Nie obsługuje
- * planszy @p g = NULL.
- * Podswietla pole wyznaczone przez współrzędne (x,y).
- * @param size  - szerokość tekstowej reprezentacji gracza.
- * @param g     - wskaźnik na strukturę przechowującą grę.
- * @param x     - współrzędna pola do wyróżnienia.
- * @param y     - współrzdna pola do wyróżnienia.
+ * Funkcja pomocnicza robiąca to samo co @ref gamma_random_move dla
+ * poprawnych parametrów, ale bez zamków.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param seed - Stan generatora liczb pseudolosowych.
+ * @return Wartość true, jeśli ruch został wykonany.
  */
-static void print_big(gamma_t *g, uint32_t size, uint32_t x, uint32_t y) {
+static bool random_move(gamma_t *g, uint32_t player, uint64_t *seed) {
+    if (!ensure_move_index(g))
+        return false;
+    const move_list_t *list = g->player_areas[player] < g->areas ?
+                              move_index_owned(g->moves, EMPTY) :
+                              move_index_frontier(g->moves, player);
+    if (list->count == 0)
+        return false;
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+    uint64_t cell = list->cells[(*seed * 2685821657736338717ull) % list->count];
+    uint32_t x = (uint32_t) cell, y = (uint32_t) (cell >> 32);
+    if (!DISPATCH(g, move, g, player, x, y))
+        return false;
+    publish_move(g, player, EMPTY, x, y);
+    return true;
+}
+
+bool gamma_random_move(gamma_t *g, uint32_t player, uint64_t *seed) {
+    if (g == NULL || seed == NULL || player == EMPTY || player > g->players)
+        return false;
+    sync_write_lock(g);
+    bool moved = random_move(g, player, seed);
+    sync_unlock(g);
+    return moved;
+}
 
-    for (uint32_t i = 0; i < g->height; ++i) {
-        for (uint32_t j = 0; j < g->width; ++j) {
-            uint32_t player = g->fields[g->height - 1 - i][j].owner;
-            if (i == y && j == x)
-                printf("\033[45m");
-            if (player == EMPTY)
-                printf("%*c", size + 1, '.');
-            else
-                printf("%*d", size + 1, player);
-            if (i == y && j == x)
-                printf("\033[0m");
+uint64_t gamma_hash(gamma_t *g) {
+    if (g == NULL)
+        return 0;
+    if (g->sync != NULL)
+        return atomic_load_explicit(&(g->sync->hash), memory_order_relaxed);
+    return g->hash[0];
+}
 
+/**
+ * Funkcja pomocnicza włączająca aktualizację skrótów obrazów planszy we
+ * wszystkich jej symetriach. Liczy je raz od zera, w czasie rzędu rozmiaru
+ * planszy.
+ * @param g - Wskaźnik na planszę.
+ */
+static void track_symmetries(gamma_t *g) {
+    uint32_t count = g->width == g->height ? SYMMETRIES : SYMMETRIES / 2;
+    uint64_t golden = 0;
+    for (uint32_t player = 1; player <= g->players; ++player)
+        if (g->golden_used[player])
+            golden ^= zobrist_golden(player);
+    for (uint32_t i = 1; i < count; ++i)
+        g->hash[i] = golden;
+    for (uint32_t y = 0; y < g->height; ++y) {
+        for (uint32_t x = 0; x < g->width; ++x) {
+            uint32_t owner = owner_at(g, cell_index(g, x, y));
+            if (owner == EMPTY)
+                continue;
+            for (uint32_t i = 1; i < count; ++i)
+                g->hash[i] ^= zobrist_cell(g, symmetric_cell(g, i, x, y),
+                                           owner);
         }
-        printf("\n");
     }
+    g->hash_count = count;
 }
 
-uint32_t gamma_print_board(gamma_t *g, uint32_t x, uint32_t y) {
+uint64_t gamma_canonical_hash(gamma_t *g) {
     if (g == NULL)
         return 0;
-    uint32_t size = 0;
-    size = logarithm(g->players);
+    sync_read_lock(g);
+    if (g->hash_count == 1) {
+        // Skróty symetrii liczymy raz, pod zamkiem pisarza; potem każdy ruch
+        // aktualizuje je sam.
+        sync_unlock(g);
+        sync_write_lock(g);
+        if (g->hash_count == 1)
+            track_symmetries(g);
+    }
+    uint64_t hash = g->hash[0];
+    for (uint32_t i = 1; i < g->hash_count; ++i)
+        if (g->hash[i] < hash)
+            hash = g->hash[i];
+    sync_unlock(g);
+    return hash;
+}
 
-    if (size > 1)
-        print_big(g, size, x, y);
-    else
-        print_little(g, x, y);
+/**
+ * Bufor zapisu lub odczytu migawki, liczący po drodze sumę kontrolną.
+ */
+typedef struct snapshot_io {
+    int fd; ///< Deskryptor pliku lub -1, gdy tylko liczymy sumę.
+    snapshot_sum_t sum; ///< Suma kontrolna przetworzonych bajtów.
+    uint64_t position; ///< Położenie w pliku.
+    uint64_t remaining; ///< Liczba bajtów pliku, których jeszcze nie czytano.
+    size_t used; ///< Liczba bajtów w buforze.
+    size_t next; ///< Położenie w buforze następnego bajtu do odczytu.
+    uint8_t buffer[SNAPSHOT_CHUNK]; ///< Bufor.
+} snapshot_io_t;
 
-    return size + (size > 1);
+/**
+ * Funkcja pomocnicza zapisująca bufor do pliku.
+ * @param io - Wskaźnik na bufor zapisu.
+ * @return Wartość false, gdy zapis się nie udał; errno jest wtedy ustawione.
+ */
+static bool io_flush(snapshot_io_t *io) {
+    snapshot_sum_update(&(io->sum), io->buffer, io->used);
+    for (size_t done = 0; io->fd >= 0 && done < io->used;) {
+        ssize_t written = write(io->fd, io->buffer + done, io->used - done);
+        if (written < 0 && errno != EINTR)
+            return false;
+        if (written > 0)
+            done += (size_t) written;
+    }
+    io->used = 0;
+    return true;
 }
 
-uint32_t gamma_get_players(gamma_t *g) {
-    return g->players;
+/**
+ * Funkcja pomocnicza dopisująca bajty do migawki.
+ * @param io - Wskaźnik na bufor zapisu.
+ * @param data - Wskaźnik na dane lub NULL dla zer.
+ * @param size - Liczba bajtów.
+ * @return Wartość false, gdy zapis się nie udał.
+ */
+static bool io_put(snapshot_io_t *io, const void *data, uint64_t size) {
+    const uint8_t *bytes = data;
+    while (size > 0) {
+        size_t part = SNAPSHOT_CHUNK - io->used;
+        if (part > size)
+            part = (size_t) size;
+        if (bytes != NULL) {
+            memcpy(io->buffer + io->used, bytes, part);
+            bytes += part;
+        }
+        else {
+            memset(io->buffer + io->used, 0, part);
+        }
+        io->used += part;
+        io->position += part;
+        size -= part;
+        if (io->used == SNAPSHOT_CHUNK && !io_flush(io))
+            return false;
+    }
+    return true;
 }
 
-uint32_t gamma_get_width(gamma_t *g) {
-    return g->width;
+/**
+ * Funkcja pomocnicza zapisująca stan gry w formacie migawki.
+ * @param g - Wskaźnik na planszę.
+ * @param header - Wskaźnik na nagłówek.
+ * @param io - Wskaźnik na bufor zapisu.
+ * @return Wartość false, gdy zapis się nie udał.
+ */
+static bool emit_snapshot(gamma_t *g, const snapshot_header_t *header,
+                          snapshot_io_t *io) {
+    size_t entries = (size_t) g->players + 1;
+    if (!io_put(io, header, sizeof(*header)) ||
+        !io_put(io, NULL, header->areas_offset - io->position) ||
+        !io_put(io, g->player_areas, sizeof(uint32_t) * entries) ||
+        !io_put(io, NULL, header->fields_offset - io->position) ||
+        !io_put(io, g->player_fields, sizeof(uint64_t) * entries) ||
+        !io_put(io, NULL, header->golden_offset - io->position))
+        return false;
+    for (size_t i = 0; i < entries; ++i) {
+        uint8_t used = g->golden_used[i];
+        if (!io_put(io, &used, sizeof(used)))
+            return false;
+    }
+    if (!io_put(io, NULL, header->owners_offset - io->position))
+        return false;
+    uint32_t band = stream_rows(g);
+    for (uint32_t y = 0; y < g->height; ++y) {
+        if (!io_put(io, (char*) g->owners +
+                        cell_index(g, 0, y) * g->owner_bytes,
+                    (uint64_t) g->width * g->owner_bytes))
+            return false;
+        if ((y + 1) % band == 0)
+            stream_release(g, y + 1 - band, y + 1);
+    }
+    stream_release(g, g->height - g->height % band, g->height);
+    return io_put(io, NULL, header->file_size - io->position) &&
+           io_flush(io);
 }
 
-uint32_t gamma_get_height(gamma_t *g) {
-    return g->height;
-}
\ No newline at end of file
+bool gamma_save(gamma_t *g, int fd) {
+    snapshot_header_t header;
+    if (g == NULL || fd < 0) {
+        errno = EINVAL;
+        return false;
+    }
+    if (!snapshot_init(&header, g->width, g->height, g->players, g->areas,
+                       g->owner_bytes)) {
+        errno = EOVERFLOW;
+        return false;
+    }
+    snapshot_io_t *io = malloc(sizeof(snapshot_io_t));
+    if (io == NULL)
+        return false;
+    sync_read_lock(g);
+    header.hash = g->hash[0];
+
+    // Suma kontrolna jest w nagłówku na początku pliku, więc liczymy ją
+    // pierwszym przebiegiem bez zapisu. Oba przebiegi czytają tylko pamięć.
+    memset(io, 0, offsetof(snapshot_io_t, buffer));
+    io->fd = -1;
+    snapshot_sum_init(&(io->sum));
+    bool saved = emit_snapshot(g, &header, io);
+    header.checksum = snapshot_sum_final(&(io->sum));
+    if (saved) {
+        memset(io, 0, offsetof(snapshot_io_t, buffer));
+        io->fd = fd;
+        snapshot_sum_init(&(io->sum));
+        saved = emit_snapshot(g, &header, io);
+    }
+    sync_unlock(g);
+    free(io);
+    return saved;
+}
+
+/**
+ * Funkcja pomocnicza czytająca dokładnie @p size bajtów z pliku.
+ * @param fd - Deskryptor pliku.
+ * @param data - Wskaźnik, pod który zapisujemy dane.
+ * @param size - Liczba bajtów.
+ * @return Wartość false, gdy odczyt się nie udał lub plik się skończył; errno
+ * jest wtedy ustawione, dla końca pliku na EBADMSG.
+ */
+static bool read_exact(int fd, void *data, size_t size) {
+    for (size_t done = 0; done < size;) {
+        ssize_t got = read(fd, (uint8_t*) data + done, size - done);
+        if (got == 0) {
+            errno = EBADMSG;
+            return false;
+        }
+        if (got < 0 && errno != EINTR)
+            return false;
+        if (got > 0)
+            done += (size_t) got;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza czytająca bajty migawki.
+ * @param io - Wskaźnik na bufor odczytu.
+ * @param data - Wskaźnik, pod który zapisujemy dane, lub NULL, żeby je
+ * pominąć.
+ * @param size - Liczba bajtów.
+ * @return Wartość false, gdy odczyt się nie udał.
+ */
+static bool io_get(snapshot_io_t *io, void *data, uint64_t size) {
+    uint8_t *bytes = data;
+    while (size > 0) {
+        if (io->next == io->used) {
+            size_t part = io->remaining < SNAPSHOT_CHUNK ?
+                          (size_t) io->remaining : SNAPSHOT_CHUNK;
+            if (part == 0) {
+                errno = EBADMSG;
+                return false;
+            }
+            if (!read_exact(io->fd, io->buffer, part))
+                return false;
+            snapshot_sum_update(&(io->sum), io->buffer, part);
+            io->remaining -= part;
+            io->used = part;
+            io->next = 0;
+        }
+        size_t part = io->used - io->next;
+        if (part > size)
+            part = (size_t) size;
+        if (bytes != NULL) {
+            memcpy(bytes, io->buffer + io->next, part);
+            bytes += part;
+        }
+        io->next += part;
+        io->position += part;
+        size -= part;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza wczytująca właścicieli pól i stawiająca pionki w
+ * kolejności wierszy. Każdy pionek łączy się tylko z już postawionymi
+ * sąsiadami z lewej i z góry, więc drzewa reprezentantów, liczby obszarów i
+ * pól graczy powstają w jednym przebiegu planszy.
+ * @param g - Wskaźnik na pustą planszę.
+ * @param io - Wskaźnik na bufor odczytu ustawiony na początku sekcji.
+ * @return Wartość false, gdy odczyt się nie udał lub numer gracza jest
+ * niepoprawny.
+ */
+static bool load_owners(gamma_t *g, snapshot_io_t *io) {
+    uint8_t cells[SNAPSHOT_CHUNK];
+    uint32_t per_read = SNAPSHOT_CHUNK / g->owner_bytes;
+    for (uint32_t y = 0; y < g->height; ++y) {
+        for (uint32_t x = 0; x < g->width;) {
+            uint32_t count = g->width - x < per_read ? g->width - x : per_read;
+            if (!io_get(io, cells, (uint64_t) count * g->owner_bytes))
+                return false;
+            for (uint32_t i = 0; i < count; ++i, ++x) {
+                uint32_t owner;
+                if (g->owner_bytes == sizeof(uint8_t)) {
+                    owner = cells[i];
+                }
+                else if (g->owner_bytes == sizeof(uint16_t)) {
+                    uint16_t value;
+                    memcpy(&value, cells + i * sizeof(value), sizeof(value));
+                    owner = value;
+                }
+                else {
+                    memcpy(&owner, cells + i * sizeof(owner), sizeof(owner));
+                }
+                if (owner > g->players) {
+                    errno = EBADMSG;
+                    return false;
+                }
+                // Poprawna migawka nie wyczerpuje opisów obszarów.
+                if (owner != EMPTY && g->area_count == g->area_slot_count) {
+                    errno = EBADMSG;
+                    return false;
+                }
+                if (owner != EMPTY)
+                    DISPATCH(g, place, g, owner, x, y);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza wczytująca sekcje migawki do pustej planszy i
+ * sprawdzająca ich zgodność z odbudowanym stanem oraz sumę kontrolną.
+ * @param g - Wskaźnik na pustą planszę o parametrach z nagłówka.
+ * @param header - Wskaźnik na nagłówek.
+ * @param io - Wskaźnik na bufor odczytu ustawiony za nagłówkiem.
+ * @return Wartość false z ustawionym errno, gdy odczyt się nie udał lub
+ * plik jest niepoprawny.
+ */
+static bool load_snapshot(gamma_t *g, const snapshot_header_t *header,
+                          snapshot_io_t *io) {
+    size_t entries = (size_t) g->players + 1;
+    uint32_t *areas = malloc(sizeof(uint32_t) * entries);
+    uint64_t *fields = malloc(sizeof(uint64_t) * entries);
+    uint8_t *golden = malloc(entries);
+    bool loaded = areas != NULL && fields != NULL && golden != NULL &&
+        io_get(io, NULL, header->areas_offset - io->position) &&
+        io_get(io, areas, sizeof(uint32_t) * entries) &&
+        io_get(io, NULL, header->fields_offset - io->position) &&
+        io_get(io, fields, sizeof(uint64_t) * entries) &&
+        io_get(io, NULL, header->golden_offset - io->position) &&
+        io_get(io, golden, entries) &&
+        io_get(io, NULL, header->owners_offset - io->position) &&
+        load_owners(g, io) &&
+        io_get(io, NULL, header->file_size - io->position);
+
+    if (loaded) {
+        bool valid = snapshot_sum_final(&(io->sum)) == header->checksum;
+        for (uint32_t i = 1; valid && i <= g->players; ++i) {
+            valid = areas[i] == g->player_areas[i] && areas[i] <= g->areas &&
+                    fields[i] == g->player_fields[i] && golden[i] <= 1;
+            set_golden_used(g, i, golden[i] == 1);
+        }
+        if (!valid || g->hash[0] != header->hash) {
+            errno = EBADMSG;
+            loaded = false;
+        }
+    }
+    free(areas);
+    free(fields);
+    free(golden);
+    return loaded;
+}
+
+gamma_t* gamma_load(int fd) {
+    snapshot_header_t header;
+    if (fd < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!read_exact(fd, &header, sizeof(header)))
+        return NULL;
+    if (!snapshot_header_valid(&header)) {
+        errno = EBADMSG;
+        return NULL;
+    }
+    gamma_t *g = gamma_new(header.width, header.height, header.players,
+                           header.areas);
+    if (g == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (g->owner_bytes != header.owner_bytes) {
+        gamma_delete(g);
+        errno = EBADMSG;
+        return NULL;
+    }
+    snapshot_io_t *io = malloc(sizeof(snapshot_io_t));
+    if (io == NULL) {
+        gamma_delete(g);
+        return NULL;
+    }
+    memset(io, 0, offsetof(snapshot_io_t, buffer));
+    io->fd = fd;
+    io->position = sizeof(header);
+    io->remaining = header.file_size - sizeof(header);
+    snapshot_header_t copy = header;
+    copy.checksum = 0;
+    snapshot_sum_init(&(io->sum));
+    snapshot_sum_update(&(io->sum), &copy, sizeof(copy));
+
+    bool loaded = load_snapshot(g, &header, io);
+    free(io);
+    if (!loaded) {
+        int error = errno;
+        gamma_delete(g);
+        errno = error;
+        return NULL;
+    }
+    return g;
+}
+
+bool gamma_stats(gamma_t *g, gamma_stats_t *out) {
+#ifdef GAMMA_STATS
+    if (g == NULL || out == NULL)
+        return false;
+    // Liczniki mogą być w tej chwili zwiększane przez innych czytelników,
+    // więc każdy czytamy atomowo. Struktura składa się z samych liczników.
+    const uint64_t *from = (const uint64_t*) &(g->stats);
+    uint64_t *to = (uint64_t*) out;
+    for (size_t i = 0; i < sizeof(gamma_stats_t) / sizeof(uint64_t); ++i)
+        to[i] = __atomic_load_n(from + i, __ATOMIC_RELAXED);
+    return true;
+#else
+    (void) g;
+    (void) out;
+    return false;
+#endif
+}
@@ -11,6 +11,7 @@
 #define GAMMA_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "board_field_type.h"
 
@@ -19,20 +20,164 @@
  */
 typedef struct gamma gamma_t;
 
+/**
+ * Funkcje przydzielające i zwalniające pamięć dla stanu gry. Cały stan gry
+ * zajmuje jeden blok pamięci.
+ */
+typedef struct gamma_allocator {
+    /** Przydziela blok rozmiaru @p size wyrównany do @p alignment bajtów,
+     * zwraca NULL w razie braku pamięci. */
+    void* (*alloc)(size_t size, size_t alignment, void *ctx);
+    /** Zwalnia blok @p ptr rozmiaru @p size przydzielony przez alloc. */
+    void (*free)(void *ptr, size_t size, void *ctx);
+    void *ctx; ///< Kontekst przekazywany do obu funkcji.
+} gamma_allocator_t;
+
+/** Liczba przedziałów w histogramach czasów wykonania operacji. */
+#define GAMMA_STATS_BUCKETS 32
+
+/**
+ * Publiczne operacje silnika, dla których zbierane są statystyki.
+ */
+typedef enum gamma_op {
+    GAMMA_OP_MOVE,            ///< @ref gamma_move
+    GAMMA_OP_GOLDEN_MOVE,     ///< @ref gamma_golden_move
+    GAMMA_OP_BUSY_FIELDS,     ///< @ref gamma_busy_fields
+    GAMMA_OP_FREE_FIELDS,     ///< @ref gamma_free_fields
+    GAMMA_OP_GOLDEN_POSSIBLE, ///< @ref gamma_golden_possible
+    GAMMA_OP_BOARD,           ///< @ref gamma_board
+    GAMMA_OP_PRINT_BOARD,     ///< @ref gamma_print_board
+    GAMMA_OP_TERRITORY,       ///< @ref gamma_territory
+    GAMMA_OP_COUNT            ///< Liczba operacji.
+} gamma_op_t;
+
+/**
+ * Statystyki pracy silnika dla jednej rozgrywki. Zbierane tylko wtedy, gdy
+ * silnik został skompilowany z opcją GAMMA_STATS.
+ */
+typedef struct gamma_stats {
+    uint64_t calls[GAMMA_OP_COUNT]; ///< Liczba wywołań każdej z operacji.
+    /** Histogramy czasów wykonania. Przedział numer i zawiera wywołania
+     * trwające od 2^i do 2^(i+1) nanosekund. */
+    uint64_t latency[GAMMA_OP_COUNT][GAMMA_STATS_BUCKETS];
+    uint64_t cells_scanned; ///< Pola odwiedzone w pętlach po całej planszy.
+    uint64_t find_root_hops; ///< Krawędzie przebyte w drzewach reprezentantów.
+    uint64_t golden_rebuilds; ///< Liczba przebudowań obszarów gracza.
+    uint64_t golden_rebuilt_cells; ///< Pola odtworzone podczas przebudowań.
+} gamma_stats_t;
+
 /** @brief Tworzy strukturę przechowującą stan gry.
  * Alokuje pamięć na nową strukturę przechowującą stan gry.
  * Inicjuje tę strukturę tak, aby reprezentowała początkowy stan gry.
+ * Liczby pól planszy nie ogranicza nic poza pamięcią, ale opisów obszarów,
+ * min(players · areas + 64 · (width + 2) + 4, width · height), musi być
+ * mniej niż 2^32 - 1.
  * @param[in] width   – szerokość planszy, liczba dodatnia,
  * @param[in] height  – wysokość planszy, liczba dodatnia,
  * @param[in] players – liczba graczy, liczba dodatnia,
  * @param[in] areas   – maksymalna liczba obszarów,
  *                      jakie może zająć jeden gracz, liczba dodatnia.
  * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
- * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny; errno jest
+ * ustawione na EOVERFLOW, gdy opisów obszarów byłoby za dużo.
  */
 gamma_t* gamma_new(uint32_t width, uint32_t height,
                    uint32_t players, uint32_t areas);
 
+/**
+ * Układ drzew reprezentantów pól planszy w pamięci. Układy inne niż
+ * wiersz po wierszu trzymają blisko siebie pola sąsiadujące w pionie, co
+ * pomaga przy bardzo szerokich planszach.
+ */
+typedef enum gamma_layout {
+    GAMMA_LAYOUT_ROW_MAJOR, ///< Wiersz po wierszu (domyślny).
+    GAMMA_LAYOUT_TILED, /**< Kwadraty 8×8 pól ułożone wiersz po wierszu,
+    pola wewnątrz kwadratu wiersz po wierszu. */
+    GAMMA_LAYOUT_MORTON, /**< Kwadraty 64×64 pól ułożone wiersz po wierszu,
+    pola wewnątrz kwadratu w porządku Mortona (krzywa Z). */
+} gamma_layout_t;
+
+/** @brief Tworzy strukturę przechowującą stan gry we wskazanej pamięci.
+ * Działa jak @ref gamma_new, ale cały stan gry umieszcza w jednym bloku
+ * pamięci przydzielonym przez @p allocator. Tablice w bloku są wyrównane do
+ * linii pamięci podręcznej. Ograniczenia rozmiaru są te same co w
+ * @ref gamma_new.
+ * @param[in] width     – szerokość planszy, liczba dodatnia,
+ * @param[in] height    – wysokość planszy, liczba dodatnia,
+ * @param[in] players   – liczba graczy, liczba dodatnia,
+ * @param[in] areas     – maksymalna liczba obszarów,
+ *                        jakie może zająć jeden gracz, liczba dodatnia,
+ * @param[in] allocator – funkcje przydzielające pamięć lub NULL, wtedy
+ *                        używany jest domyślny przydział pamięci.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny; errno jest
+ * ustawione na EOVERFLOW, gdy opisów obszarów byłoby za dużo.
+ */
+gamma_t* gamma_new_ex(uint32_t width, uint32_t height,
+                      uint32_t players, uint32_t areas,
+                      const gamma_allocator_t *allocator);
+
+/** @brief Tworzy strukturę przechowującą stan gry w pliku na dysku.
+ * Działa jak @ref gamma_new, ale cały blok stanu gry, z tablicami
+ * właścicieli i drzew reprezentantów pól oraz opisów obszarów, leży w nowym
+ * rzadkim pliku odwzorowanym w pamięć. Stronami zarządza jądro, więc
+ * plansza może być większa niż pamięć operacyjna: ruchy wczytują tylko
+ * potrzebne strony, a tworzenie planszy i @ref gamma_save przeglądają ją
+ * pasami wierszy i oddają jądru przejrzane strony. Plik nie ma nazwy w
+ * katalogu (albo jest z niego usuwany od razu po utworzeniu) i znika razem
+ * z grą; @ref gamma_clone tworzy w tym samym katalogu własny plik. Poza
+ * plikiem, w zwykłej pamięci procesu, zostają struktury pomocnicze tworzone
+ * dopiero na żądanie, więc gra, która ich używa, nie ma już ograniczonego
+ * zużycia pamięci:
+ * - indeks ruchów, rzędu W·H, budowany przez @ref gamma_legal_moves,
+ *   @ref gamma_golden_targets, @ref gamma_can_move, @ref gamma_game_over,
+ *   @ref gamma_random_move i @ref gamma_set_feed,
+ * - kolejka przeglądu, rzędu W·H, przydzielana przy pierwszym wywołaniu
+ *   @ref gamma_territory i przechowywana w planszy, oraz mapa odwiedzonych
+ *   pól, rzędu W·H bitów, przydzielana na czas sprawdzania złotych ruchów,
+ * - strony migawek dla obserwatorów, rzędu W·H na migawkę, tworzone przez
+ *   @ref gamma_set_snapshots,
+ * - tablice stanu graczy strumienia zdarzeń, rzędu liczby graczy, i jego
+ *   pierścień, tworzone przez @ref gamma_set_feed.
+ *
+ * Gdy na dysku zabraknie miejsca na zapisywane strony, proces dostaje
+ * sygnał SIGBUS. Liczba pól planszy może przekraczać 2^32; opisów obszarów
+ * musi być mniej niż 2^32 - 1, jak w @ref gamma_new.
+ * @param[in] width     – szerokość planszy, liczba dodatnia,
+ * @param[in] height    – wysokość planszy, liczba dodatnia,
+ * @param[in] players   – liczba graczy, liczba dodatnia,
+ * @param[in] areas     – maksymalna liczba obszarów,
+ *                        jakie może zająć jeden gracz, liczba dodatnia,
+ * @param[in] directory – katalog, w którym powstaje plik.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy któryś z
+ * parametrów jest niepoprawny albo nie udało się utworzyć lub odwzorować
+ * pliku; errno jest wtedy ustawione, np. na ENOENT, gdy katalog nie
+ * istnieje, lub na EOVERFLOW, gdy opisów obszarów byłoby za dużo.
+ */
+gamma_t* gamma_new_mapped(uint32_t width, uint32_t height,
+                          uint32_t players, uint32_t areas,
+                          const char *directory);
+
+/** @brief Tworzy strukturę przechowującą stan gry o wybranym układzie pól.
+ * Działa jak @ref gamma_new_ex, ale drzewa reprezentantów pól układa w
+ * pamięci zgodnie z @p layout. Układ nie wpływa na wyniki funkcji. Krawędzie
+ * planszy są uzupełniane do wielokrotności boku kwadratu, chyba że krótszy
+ * bok planszy jest mniejszy; wtedy kwadraty są mniejsze.
+ * @param[in] width     – szerokość planszy, liczba dodatnia,
+ * @param[in] height    – wysokość planszy, liczba dodatnia,
+ * @param[in] players   – liczba graczy, liczba dodatnia,
+ * @param[in] areas     – maksymalna liczba obszarów,
+ *                        jakie może zająć jeden gracz, liczba dodatnia,
+ * @param[in] allocator – funkcje przydzielające pamięć lub NULL,
+ * @param[in] layout    – układ pól w pamięci.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+gamma_t* gamma_new_layout(uint32_t width, uint32_t height,
+                          uint32_t players, uint32_t areas,
+                          const gamma_allocator_t *allocator,
+                          gamma_layout_t layout);
+
 /** @brief Usuwa strukturę przechowującą stan gry.
  * Usuwa z pamięci strukturę wskazywaną przez @p g.
  * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
@@ -101,7 +246,8 @@ uint64_t gamma_free_fields(gamma_t *g, uint32_t player);
  *                      @p players z funkcji @ref gamma_new.
  * @return Wartość @p true, jeśli gracz jeszcze nie wykonał w tej rozgrywce
  * złotego ruchu i jest przynajmniej jedno pole zajęte przez innego gracza,
- * a @p false w przeciwnym przypadku.
+ * a @p false w przeciwnym przypadku lub gdy zabrakło pamięci na
+ * przeszukanie obszarów.
  */
 bool gamma_golden_possible(gamma_t *g, uint32_t player);
 
@@ -111,7 +257,8 @@ bool gamma_golden_possible(gamma_t *g, uint32_t player);
  * Funkcja wywołująca musi zwolnić ten bufor.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
  * @return Wskaźnik na zaalokowany bufor zawierający napis opisujący stan
- * planszy lub NULL, jeśli nie udało się zaalokować pamięci.
+ * planszy lub NULL, jeśli nie udało się zaalokować pamięci albo napis nie
+ * mieści się w size_t (errno jest wtedy ustawione na EOVERFLOW).
  */
 char* gamma_board(gamma_t *g);
 
@@ -147,4 +294,543 @@ uint32_t gamma_get_width(gamma_t *g);
  * @return Ilość wirszy na planszy.
  */
 uint32_t gamma_get_height(gamma_t *g);
+
+/**
+ * Getter do parametru areas w strukturze gamma_t.
+ * @param g         - wskaźnik na strukturę przechowującą planszę.
+ * @return Maksymalna liczba obszarów jednego gracza.
+ */
+uint32_t gamma_get_areas(gamma_t *g);
+
+/**
+ * Opis jednego obszaru gracza.
+ */
+typedef struct gamma_area {
+    uint32_t player; ///< Numer gracza, do którego należy obszar.
+    uint64_t size; ///< Liczba pól obszaru.
+    uint32_t min_x; ///< Najmniejszy numer kolumny pola obszaru.
+    uint32_t min_y; ///< Najmniejszy numer wiersza pola obszaru.
+    uint32_t max_x; ///< Największy numer kolumny pola obszaru.
+    uint32_t max_y; ///< Największy numer wiersza pola obszaru.
+} gamma_area_t;
+
+/**
+ * Funkcja wywoływana dla kolejnych obszarów przez gamma_for_each_area.
+ * @param area      – opis obszaru, ważny tylko w czasie wywołania,
+ * @param ctx       – wskaźnik przekazany do gamma_for_each_area.
+ * @return Wartość @p true, żeby przejść do następnego obszaru, a @p false,
+ * żeby zakończyć przeglądanie.
+ */
+typedef bool (*gamma_area_visitor_t)(const gamma_area_t *area, void *ctx);
+
+/** @brief Podaje opis obszaru zawierającego pole.
+ * Koszt jest rzędu wysokości drzewa reprezentantów pola, czyli O(log n).
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza,
+ * @param[out] out    – wskaźnik, pod który zapisujemy opis obszaru.
+ * @return Wartość @p true, jeśli pole (@p x, @p y) jest zajęte, a @p false,
+ * gdy pole jest puste, któryś z parametrów jest niepoprawny lub któryś ze
+ * wskaźników jest NULL.
+ */
+bool gamma_area_info(gamma_t *g, uint32_t x, uint32_t y, gamma_area_t *out);
+
+/** @brief Przegląda obszary gracza.
+ * Wywołuje @p visit dla każdego obszaru gracza @p player, w kolejności
+ * nieokreślonej. Koszt jest proporcjonalny do liczby obszarów gracza.
+ * W trakcie przeglądania nie wolno zmieniać stanu gry.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] visit   – funkcja wywoływana dla każdego obszaru,
+ * @param[in] ctx     – wskaźnik przekazywany do @p visit.
+ * @return Wartość @p false, jeśli któryś z parametrów jest niepoprawny,
+ * a @p true w przeciwnym przypadku.
+ */
+bool gamma_for_each_area(gamma_t *g, uint32_t player,
+                         gamma_area_visitor_t visit, void *ctx);
+
+/**
+ * Ustawia liczbę wątków, na które dzielone są przeglądy całej planszy
+ * (gamma_free_fields i gamma_golden_possible dla gracza z maksymalną liczbą
+ * obszarów, przebudowa obszarów w gamma_golden_move oraz gamma_board).
+ * Domyślnie plansza używa jednego wątku. Wyniki nie zależą od liczby wątków.
+ * Z planszy nie wolno korzystać jednocześnie z kilku wątków programu, chyba
+ * że włączono tryb współbieżny (@ref gamma_set_concurrent).
+ * @param g         - wskaźnik na strukturę przechowującą planszę,
+ * @param threads   - liczba wątków razem z wątkiem wywołującym; 0 lub 1
+ *                    wyłącza pulę, wartości powyżej 256 są obcinane do 256.
+ * @return Wartość @p true, jeśli liczba wątków została ustawiona, a @p false,
+ * gdy plansza jest NULL lub nie udało się uruchomić wątków; wtedy plansza
+ * zachowuje dotychczasową pulę.
+ */
+bool gamma_set_threads(gamma_t *g, uint32_t threads);
+
+/**
+ * Spójny stan liczników jednego gracza.
+ */
+typedef struct gamma_player_info {
+    uint64_t version; ///< Wersja stanu gry, jak w @ref gamma_version.
+    uint64_t busy_fields; ///< Liczba pól gracza.
+    uint64_t free_fields; ///< Liczba pól, które gracz może zająć ruchem.
+    uint32_t areas; ///< Liczba obszarów gracza.
+    bool golden_used; ///< Czy gracz wykorzystał złoty ruch.
+} gamma_player_info_t;
+
+/** @brief Włącza lub wyłącza tryb współbieżny planszy.
+ * W trybie współbieżnym z planszy mogą naraz korzystać wątki programu:
+ * jeden lub więcej wątków wykonujących ruchy i dowolnie wielu czytelników.
+ * Ruchy, złote ruchy, @ref gamma_random_move i @ref gamma_copy do planszy
+ * wykonują się na wyłączność i po każdej zmianie publikują liczniki
+ * zmienionych graczy, wersję i skrót stanu gry pod zamkiem sekwencyjnym.
+ * @ref gamma_busy_fields, @ref gamma_free_fields, @ref gamma_player_info,
+ * @ref gamma_version i @ref gamma_hash czytają opublikowane wartości w
+ * czasie stałym, bez zamków i bez czekania na wątek wykonujący ruch.
+ * @ref gamma_board, @ref gamma_print_board, @ref gamma_legal_moves,
+ * @ref gamma_golden_possible, @ref gamma_golden_targets,
+ * @ref gamma_can_move, @ref gamma_game_over, @ref gamma_territory,
+ * @ref gamma_canonical_hash, @ref gamma_area_info,
+ * @ref gamma_for_each_area, @ref gamma_save i kopie z planszy wykonują się
+ * współbieżnie ze sobą, a czekają tylko na ruchy; pamięć roboczą
+ * przeszukiwań przydzielają na czas wywołania, z wyjątkiem kolejki
+ * przechowywanej w planszy, której używa jeden przegląd
+ * @ref gamma_territory naraz. Tylko pierwsze wywołanie
+ * @ref gamma_canonical_hash raz liczy skróty symetrii na wyłączność.
+ * Włączenie liczy raz puste pola i wolne pola graczy, w czasie rzędu
+ * rozmiaru planszy, i nie buduje indeksu ruchów (zob.
+ * @ref gamma_legal_moves); @ref gamma_can_move i @ref gamma_game_over
+ * rozstrzygają z tych liczników, a budują indeks dopiero dla gracza bez
+ * wolnych pól, który nie wykorzystał złotego ruchu. Samej funkcji, tak
+ * jak @ref gamma_delete, nie wolno wywołać, gdy z planszy korzystają inne
+ * wątki.
+ * @param[in,out] g     – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] concurrent – czy tryb ma być włączony.
+ * @return Wartość @p true, jeśli tryb został ustawiony, a @p false, gdy
+ * @p g jest NULL lub zabrakło pamięci; errno jest wtedy ustawione.
+ */
+bool gamma_set_concurrent(gamma_t *g, bool concurrent);
+
+/** @brief Podaje wersję stanu gry.
+ * Liczba udanych ruchów i złotych ruchów wykonanych na planszy, także
+ * przez @ref gamma_random_move. @ref gamma_copy przenosi wersję planszy
+ * źródłowej. Czytelnik może po niej poznać, czy stan gry się zmienił.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wersja lub 0, gdy @p g jest NULL.
+ */
+uint64_t gamma_version(gamma_t *g);
+
+/** @brief Podaje spójny stan liczników gracza.
+ * Wszystkie liczniki pochodzą z tej samej wersji stanu gry, także gdy w
+ * trybie współbieżnym inny wątek w tym czasie wykonuje ruchy. W trybie
+ * współbieżnym koszt jest stały; poza nim jak dla @ref gamma_free_fields.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[out] out    – wskaźnik, pod który zapisujemy liczniki.
+ * @return Wartość @p true, jeśli liczniki zostały zapisane, a @p false, gdy
+ * któryś z parametrów jest niepoprawny.
+ */
+bool gamma_player_info(gamma_t *g, uint32_t player, gamma_player_info_t *out);
+
+/**
+ * Niezmienna migawka planszy i liczników graczy z jednej wersji stanu gry.
+ */
+typedef struct gamma_snapshot gamma_snapshot_t;
+
+/** @brief Włącza lub wyłącza migawki dla obserwatorów.
+ * Po włączeniu każdy ruch, złoty ruch, @ref gamma_random_move i
+ * @ref gamma_copy do planszy publikuje nową wersję stanu gry, którą
+ * obserwatorzy z innych wątków biorą funkcją @ref gamma_snapshot_acquire.
+ * Plansza i liczniki leżą w stronach po 256 bajtów: ruch kopiuje tylko
+ * zmienione strony i ścieżkę do nich, a publikacja to jeden zapis
+ * wskaźnika, więc ruch nigdy nie czeka na obserwatorów. Zastąpione strony
+ * wracają do puli, gdy nie trzyma ich już żadna migawka; migawka trzymana
+ * długo wstrzymuje zwalnianie stron zmienionych od jej wzięcia. Migawki
+ * działają niezależnie od trybu współbieżnego (@ref gamma_set_concurrent);
+ * bez niego ruchy nadal wykonuje jeden wątek naraz. Samej funkcji, tak jak
+ * @ref gamma_delete, nie wolno wywołać, gdy któraś migawka jest trzymana.
+ * @param[in,out] g     – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] readers   – liczba migawek, które można trzymać naraz;
+ *                        0 wyłącza migawki.
+ * @return Wartość @p true, jeśli migawki zostały ustawione, a @p false, gdy
+ * @p g jest NULL lub zabrakło pamięci; errno jest wtedy ustawione, a
+ * plansza zachowuje dotychczasowe migawki.
+ */
+bool gamma_set_snapshots(gamma_t *g, uint32_t readers);
+
+/** @brief Bierze migawkę ostatniej opublikowanej wersji stanu gry.
+ * Może być wywołana z dowolnego wątku, także w trakcie ruchu; nie czeka na
+ * ruch i nie zakłada zamków. Koszt jest stały.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na migawkę, którą trzeba oddać funkcją
+ * @ref gamma_snapshot_release, lub NULL z ustawionym errno: EINVAL, gdy
+ * @p g jest NULL lub migawki są wyłączone, EAGAIN, gdy trzymanych jest już
+ * tyle migawek, ile podano w @ref gamma_set_snapshots, a ENOMEM, gdy
+ * zabrakło pamięci na kopię strony i migawki przestały nadążać za grą.
+ */
+gamma_snapshot_t* gamma_snapshot_acquire(gamma_t *g);
+
+/** @brief Oddaje migawkę.
+ * Po oddaniu z migawki nie wolno korzystać. Nic nie robi dla NULL.
+ * @param[in] s       – wskaźnik na migawkę.
+ */
+void gamma_snapshot_release(gamma_snapshot_t *s);
+
+/** @brief Podaje wersję stanu gry migawki.
+ * @param[in] s       – wskaźnik na migawkę.
+ * @return Wersja, jak w @ref gamma_version.
+ */
+uint64_t gamma_snapshot_version(const gamma_snapshot_t *s);
+
+/** @brief Podaje skrót stanu gry migawki.
+ * @param[in] s       – wskaźnik na migawkę.
+ * @return Skrót, jak w @ref gamma_hash.
+ */
+uint64_t gamma_snapshot_hash(const gamma_snapshot_t *s);
+
+/** @brief Podaje właściciela pola w migawce.
+ * @param[in] s       – wskaźnik na migawkę,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Numer gracza albo 0 dla pola pustego lub spoza planszy.
+ */
+uint32_t gamma_snapshot_owner(const gamma_snapshot_t *s, uint32_t x,
+                              uint32_t y);
+
+/** @brief Podaje liczbę pól gracza w migawce.
+ * @param[in] s       – wskaźnik na migawkę,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól lub 0 dla niepoprawnego numeru gracza.
+ */
+uint64_t gamma_snapshot_busy_fields(const gamma_snapshot_t *s,
+                                    uint32_t player);
+
+/** @brief Podaje liczbę obszarów gracza w migawce.
+ * @param[in] s       – wskaźnik na migawkę,
+ * @param[in] player  – numer gracza.
+ * @return Liczba obszarów lub 0 dla niepoprawnego numeru gracza.
+ */
+uint32_t gamma_snapshot_player_areas(const gamma_snapshot_t *s,
+                                     uint32_t player);
+
+/** @brief Sprawdza, czy gracz wykorzystał złoty ruch w migawce.
+ * @param[in] s       – wskaźnik na migawkę,
+ * @param[in] player  – numer gracza.
+ * @return Wartość @p true, jeśli gracz wykorzystał złoty ruch, a @p false
+ * w przeciwnym przypadku lub dla niepoprawnego numeru gracza.
+ */
+bool gamma_snapshot_golden_used(const gamma_snapshot_t *s, uint32_t player);
+
+/** @brief Daje napis opisujący planszę migawki.
+ * Format jest taki sam jak w @ref gamma_board.
+ * @param[in] s       – wskaźnik na migawkę.
+ * @return Wskaźnik na zaalokowany bufor zawierający napis, który trzeba
+ * zwolnić funkcją free, lub NULL, gdy zabrakło pamięci.
+ */
+char* gamma_snapshot_board(const gamma_snapshot_t *s);
+
+/** Największa długość zakodowanego zdarzenia w bajtach. */
+#define GAMMA_EVENT_MAX_SIZE 21
+
+/**
+ * Rodzaje zdarzeń strumienia zdarzeń planszy.
+ */
+typedef enum gamma_event_type {
+    GAMMA_EVENT_OWNER = 1, ///< Pole zmieniło właściciela.
+    GAMMA_EVENT_AREAS,     ///< Zmieniła się liczba obszarów gracza.
+    GAMMA_EVENT_GOLDEN,    ///< Gracz wykorzystał złoty ruch.
+    GAMMA_EVENT_BLOCKED,   ///< Gracz stracił lub odzyskał możliwość ruchu.
+    GAMMA_EVENT_RESET      ///< Cały stan gry został zastąpiony.
+} gamma_event_type_t;
+
+/**
+ * Zdarzenie strumienia zdarzeń planszy. Zdarzenie niesie tylko pola
+ * potrzebne jego rodzajowi, pozostałe są zerami.
+ */
+typedef struct gamma_event {
+    gamma_event_type_t type; ///< Rodzaj zdarzenia.
+    /** Gracz: nowy właściciel pola, gracz, którego liczba obszarów się
+     * zmieniła, który wykorzystał złoty ruch lub którego możliwość ruchu się
+     * zmieniła. */
+    uint32_t player;
+    uint32_t x; ///< Numer kolumny pola dla GAMMA_EVENT_OWNER.
+    uint32_t y; ///< Numer wiersza pola dla GAMMA_EVENT_OWNER.
+    /** Poprzedni właściciel pola dla GAMMA_EVENT_OWNER albo poprzednia
+     * liczba obszarów dla GAMMA_EVENT_AREAS. */
+    uint32_t previous;
+    /** Nowa liczba obszarów dla GAMMA_EVENT_AREAS, 1 dla gracza, który
+     * stracił możliwość ruchu, i 0 dla tego, który ją odzyskał, dla
+     * GAMMA_EVENT_BLOCKED, albo wersja stanu gry dla GAMMA_EVENT_RESET. */
+    uint64_t value;
+} gamma_event_t;
+
+/** @brief Włącza lub wyłącza strumień zdarzeń planszy.
+ * Po włączeniu każdy ruch, złoty ruch i @ref gamma_random_move zapisuje do
+ * pierścienia bajtów zdarzenia opisujące zmianę: zmianę właściciela pola,
+ * wykorzystanie złotego ruchu, zmiany liczby obszarów gracza, który
+ * wykonał ruch, i poprzedniego właściciela pola (połączenie lub podział
+ * obszarów) oraz utratę lub odzyskanie możliwości ruchu przez graczy, jak
+ * w @ref gamma_can_move. @ref gamma_copy do planszy zapisuje tylko
+ * zdarzenie GAMMA_EVENT_RESET. Koszt zależy od liczby ruchów, a nie od
+ * rozmiaru planszy ani liczby obserwatorów: każde zdarzenie jest kodowane
+ * i zapisywane raz, a obserwatorzy z dowolnych wątków czytają te same
+ * bajty funkcją @ref gamma_feed_read, każdy od własnej pozycji. Ruch nigdy
+ * nie czeka na obserwatorów. Samej funkcji nie wolno wywołać, gdy ktoś
+ * czyta strumień.
+ * @param[in,out] g     – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] capacity  – rozmiar pierścienia w bajtach, zaokrąglany w górę
+ *                        do potęgi dwójki, co najmniej
+ *                        GAMMA_EVENT_MAX_SIZE; 0 wyłącza strumień.
+ * @return Wartość @p true, jeśli strumień został ustawiony, a @p false z
+ * ustawionym errno, gdy @p g jest NULL, rozmiar jest niepoprawny lub
+ * zabrakło pamięci; plansza zachowuje wtedy dotychczasowy strumień.
+ */
+bool gamma_set_feed(gamma_t *g, size_t capacity);
+
+/** @brief Podaje pozycję końca strumienia zdarzeń.
+ * Nowy obserwator bierze pozycję przed odczytaniem stanu gry, np.
+ * @ref gamma_board: zdarzenia podają nowe wartości, a nie różnice, więc
+ * zdarzenia już uwzględnione w odczytanym stanie ustawiają te same
+ * wartości jeszcze raz.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Liczba bajtów zapisanych do strumienia od jego włączenia lub 0,
+ * gdy @p g jest NULL lub strumień jest wyłączony.
+ */
+uint64_t gamma_feed_position(gamma_t *g);
+
+/** @brief Kopiuje zdarzenia zapisane od pozycji obserwatora.
+ * Kopiuje tylko całe zdarzenia, tyle, ile mieści bufor, i przesuwa pozycję
+ * za nie. Może być wywołana z dowolnego wątku, także w trakcie ruchu; nie
+ * czeka na ruch i nie zakłada zamków.
+ * @param[in] g           – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] position – wskaźnik na pozycję obserwatora,
+ * @param[out] buffer     – bufor na zakodowane zdarzenia,
+ * @param[in] size        – rozmiar bufora, co najmniej GAMMA_EVENT_MAX_SIZE,
+ * @param[out] length     – wskaźnik, pod który zapisujemy liczbę
+ *                          skopiowanych bajtów, 0 gdy nie ma nowych zdarzeń.
+ * @return Wartość @p true, jeśli odczyt się udał, a @p false z ustawionym
+ * errno: EINVAL, gdy któryś z parametrów jest niepoprawny lub strumień jest
+ * wyłączony, a ERANGE, gdy od pozycji obserwatora zapisano więcej bajtów,
+ * niż mieści pierścień, i część zdarzeń przepadła. Pozycja jest wtedy
+ * przesuwana na koniec strumienia, a obserwator musi od nowa odczytać
+ * stan gry.
+ */
+bool gamma_feed_read(gamma_t *g, uint64_t *position, void *buffer,
+                     size_t size, size_t *length);
+
+/** @brief Odczytuje jedno zakodowane zdarzenie.
+ * @param[in] data    – wskaźnik na początek zakodowanego zdarzenia,
+ * @param[in] size    – liczba dostępnych bajtów,
+ * @param[out] event  – wskaźnik, pod który zapisujemy zdarzenie, lub NULL.
+ * @return Długość zdarzenia w bajtach lub 0, gdy dane są niedokończone lub
+ * niepoprawne.
+ */
+size_t gamma_event_decode(const void *data, size_t size,
+                          gamma_event_t *event);
+
+/**
+ * Współrzędne jednego pola planszy.
+ */
+typedef struct gamma_cell {
+    uint32_t x; ///< Numer kolumny.
+    uint32_t y; ///< Numer wiersza.
+} gamma_cell_t;
+
+/** @brief Wypisuje pola, na które gracz może wykonać zwykły ruch.
+ * Gracz, który nie ma maksymalnej liczby obszarów, może zająć każde puste
+ * pole, a gracz z maksymalną liczbą obszarów tylko puste pola sąsiadujące
+ * z jego polami. Pierwsze wywołanie tej funkcji lub
+ * @ref gamma_golden_targets buduje w czasie rzędu rozmiaru planszy indeks
+ * ruchów, który potem jest aktualizowany przez każdy ruch; od tej chwili
+ * koszt wywołania jest proporcjonalny do liczby wypisanych pól.
+ * Liczba wszystkich pól to wynik @ref gamma_free_fields. Kolejność pól
+ * jest nieokreślona.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[out] buf    – tablica, do której zapisujemy pola,
+ * @param[in] cap     – rozmiar tablicy @p buf.
+ * @return Liczba pól zapisanych w @p buf, najwyżej @p cap. Wartość 0, gdy
+ * gracz nie ma ruchu, któryś z parametrów jest niepoprawny lub zabrakło
+ * pamięci na indeks ruchów; wtedy errno jest ustawione na ENOMEM.
+ */
+uint64_t gamma_legal_moves(gamma_t *g, uint32_t player, gamma_cell_t *buf,
+                           uint64_t cap);
+
+/** @brief Wypisuje pola, na które gracz może wykonać złoty ruch.
+ * Kandydatami są pola innych graczy, a gdy gracz ma maksymalną liczbę
+ * obszarów, tylko te z nich, które sąsiadują z jego polami. Kandydat jest
+ * wypisywany, jeśli jego właściciel po utracie pola nie przekroczy
+ * maksymalnej liczby obszarów. Zwykle wystarcza do tego policzenie sąsiadów
+ * pola; gdy właścicielowi brakuje do limitu mniej niż trzech obszarów,
+ * przeszukiwany jest obszar pola. Koszt jest proporcjonalny do liczby
+ * przejrzanych kandydatów, nie do rozmiaru planszy. Indeks ruchów jest
+ * budowany jak w @ref gamma_legal_moves.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[out] buf    – tablica, do której zapisujemy pola,
+ * @param[in] cap     – rozmiar tablicy @p buf.
+ * @return Liczba pól zapisanych w @p buf, najwyżej @p cap. Wartość 0, gdy
+ * gracz nie może wykonać złotego ruchu, któryś z parametrów jest
+ * niepoprawny lub zabrakło pamięci; wtedy errno jest ustawione na ENOMEM.
+ */
+uint64_t gamma_golden_targets(gamma_t *g, uint32_t player, gamma_cell_t *buf,
+                              uint64_t cap);
+
+/** @brief Sprawdza, czy gracz może wykonać jakikolwiek ruch.
+ * Daje ten sam wynik co sprawdzenie, czy @ref gamma_golden_possible zwraca
+ * true lub @ref gamma_free_fields wartość dodatnią, ale odpowiada z indeksu
+ * ruchów, aktualizowanego przy każdej zmianie właściciela pola: z liczby
+ * pustych pól, liczby pustych pól sąsiadujących z graczem i listy pól innych
+ * graczy sąsiadujących z graczem. Koszt nie zależy od rozmiaru planszy;
+ * tylko gdy gracz ma maksymalną liczbę obszarów, nie ma wolnego pola obok
+ * siebie i nie wykorzystał złotego ruchu, przeglądane są sąsiednie pola
+ * innych graczy do pierwszego, które można zająć złotym ruchem; zwykle
+ * rozstrzyga o tym sama liczba sąsiadów pola. Indeks ruchów jest budowany
+ * jak w @ref gamma_legal_moves.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli gracz może wykonać zwykły lub złoty ruch,
+ * a @p false w przeciwnym przypadku lub gdy któryś z parametrów jest
+ * niepoprawny.
+ */
+bool gamma_can_move(gamma_t *g, uint32_t player);
+
+/** @brief Sprawdza, czy gra się skończyła.
+ * Gra kończy się, gdy żaden gracz nie może wykonać ruchu. Funkcja wywołuje
+ * @ref gamma_can_move dla kolejnych graczy, do pierwszego, który może.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli żaden gracz nie może wykonać ruchu, a
+ * @p false w przeciwnym przypadku lub gdy @p g jest NULL.
+ */
+bool gamma_game_over(gamma_t *g);
+
+/** Etykieta pustego pola, do którego najbliżej jest kilku graczom. */
+#define GAMMA_TERRITORY_TIE UINT32_MAX
+
+/** @brief Wyznacza potencjalne terytorium graczy.
+ * Każde puste pole dostaje numer gracza, który jest do niego najbliżej,
+ * licząc kroki przez puste pola od pól gracza. Tak liczone terytorium
+ * gracz może zająć, powiększając swoje obszary, więc nie przekracza
+ * maksymalnej liczby obszarów. Pole, do którego jest najbliżej kilku
+ * graczom, dostaje etykietę @ref GAMMA_TERRITORY_TIE, a pole, do którego
+ * nie dochodzi żaden gracz, etykietę 0. Pole zajęte dostaje numer swojego
+ * właściciela. Wynik wylicza jeden przegląd wszerz rozpoczęty jednocześnie
+ * od wszystkich pól zajętych, w czasie rzędu rozmiaru planszy. Kolejka
+ * przeglądu jest przydzielana przy pierwszym wywołaniu i przechowywana w
+ * planszy, więc kolejne wywołania nie przydzielają pamięci. W trybie
+ * współbieżnym (@ref gamma_set_concurrent) kolejkę planszy zajmuje jeden
+ * przegląd naraz; przeglądy wykonywane równocześnie z nim przydzielają
+ * własną kolejkę na czas wywołania. Gdy plansza ma
+ * pulę wątków (@ref gamma_set_threads) i jest duża, kolejne poziomy
+ * przeglądu są dzielone między wątki; wynik od tego nie zależy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] labels – tablica width * height etykiet pól, wiersz po
+ *                      wierszu: pole (x, y) to labels[y * width + x],
+ * @param[out] counts – tablica players + 1 liczb: pod numerem gracza liczba
+ *                      jego pól i pustych pól z jego numerem, a pod
+ *                      indeksem 0 liczba pozostałych pustych pól.
+ * @return Wartość @p true, jeśli się udało, a @p false z ustawionym errno:
+ * EINVAL, gdy któryś wskaźnik jest NULL, EOVERFLOW, gdy plansza ma więcej
+ * niż 2^32 - 1 pól, i ENOMEM, gdy zabrakło pamięci na kolejkę.
+ */
+bool gamma_territory(gamma_t *g, uint32_t *labels, uint64_t *counts);
+
+/** @brief Tworzy kopię stanu gry.
+ * Kopia ma te same parametry, układ pól i funkcje przydzielające pamięć co
+ * @p g, ale własną, domyślnie wyłączoną pulę wątków i wyłączony tryb
+ * współbieżny.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na kopię lub NULL, gdy @p g jest NULL lub nie udało się
+ * zaalokować pamięci.
+ */
+gamma_t* gamma_clone(gamma_t *g);
+
+/** @brief Nadpisuje stan gry @p dst stanem gry @p src.
+ * Obie plansze muszą mieć te same parametry i układ pól, np. gdy @p dst
+ * powstała przez @ref gamma_clone planszy @p src. Funkcja nie przydziela
+ * pamięci, chyba że listy indeksu ruchów @p dst są krótsze niż w @p src,
+ * więc powtarzane kopiowanie do tej samej planszy jest tanie. Koszt jest
+ * rzędu rozmiaru planszy. Pula wątków i tryb współbieżny @p dst zostają bez
+ * zmian.
+ * @param[in,out] dst – wskaźnik na planszę docelową,
+ * @param[in] src     – wskaźnik na planszę źródłową.
+ * @return Wartość @p true, jeśli stan został skopiowany, a @p false, gdy
+ * plansze są niezgodne, któryś ze wskaźników jest NULL lub zabrakło pamięci.
+ */
+bool gamma_copy(gamma_t *dst, gamma_t *src);
+
+/** @brief Wykonuje losowy zwykły ruch gracza.
+ * Wybiera jednostajnie jedno z pól, które wypisałaby
+ * @ref gamma_legal_moves, i zajmuje je. Służy do szybkiego rozgrywania
+ * losowych partii: po zbudowaniu indeksu ruchów koszt nie zależy od
+ * rozmiaru planszy i funkcja nie przydziela pamięci.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in,out] seed – stan generatora liczb pseudolosowych, niezerowy.
+ * @return Wartość @p true, jeśli ruch został wykonany, a @p false, gdy
+ * gracz nie ma zwykłego ruchu lub któryś z parametrów jest niepoprawny.
+ */
+bool gamma_random_move(gamma_t *g, uint32_t player, uint64_t *seed);
+
+/** @brief Podaje skrót stanu gry.
+ * 64-bitowy skrót Zobrista par (pole, właściciel) zajętych pól i złotych
+ * ruchów wykorzystanych przez graczy. Ruchy i złote ruchy aktualizują go w
+ * czasie stałym, więc odczyt nie kosztuje nic. Ten sam stan daje ten sam
+ * skrót niezależnie od kolejności ruchów, także na różnych planszach o tych
+ * samych parametrach. Pusta plansza ma skrót 0.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Skrót lub 0, gdy @p g jest NULL.
+ */
+uint64_t gamma_hash(gamma_t *g);
+
+/** @brief Podaje skrót stanu gry niezależny od symetrii planszy.
+ * Najmniejszy ze skrótów w sensie @ref gamma_hash obrazów planszy we
+ * wszystkich jej symetriach: odbiciach i obrocie o 180 stopni, a dla plansz
+ * kwadratowych także obrotach o 90 stopni i odbiciach względem przekątnych.
+ * Pierwsze wywołanie dla planszy kosztuje czas rzędu jej rozmiaru i włącza
+ * aktualizację skrótów obrazów przy każdym ruchu; kolejne są tanie.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Skrót lub 0, gdy @p g jest NULL.
+ */
+uint64_t gamma_canonical_hash(gamma_t *g);
+
+/** @brief Zapisuje stan gry do pliku.
+ * Zapisuje migawkę w wersjonowanym formacie binarnym z sumą kontrolną
+ * (opisanym w snapshot.h): parametry planszy, właścicieli pól, liczby
+ * obszarów i pól graczy oraz wykorzystane złote ruchy. Drzewa
+ * reprezentantów nie są zapisywane, bo @ref gamma_load odbudowuje je w
+ * jednym przebiegu planszy. Plik można też otworzyć bez kopiowania przez
+ * gamma_view_open.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli migawka została zapisana, a @p false z
+ * ustawionym errno w przeciwnym przypadku.
+ */
+bool gamma_save(gamma_t *g, int fd);
+
+/** @brief Wczytuje stan gry z pliku.
+ * Czyta migawkę zapisaną przez @ref gamma_save od bieżącego położenia
+ * w pliku, więc działa także dla potoków. Odbudowuje obszary graczy w
+ * jednym przebiegu planszy i sprawdza, czy zgadzają się z zapisanymi
+ * liczbami obszarów i pól, sumą kontrolną i skrótem stanu gry.
+ * @param[in] fd      – deskryptor pliku otwartego do odczytu.
+ * @return Wskaźnik na nową planszę lub NULL z ustawionym errno: EBADMSG dla
+ * niepoprawnego lub uszkodzonego pliku, ENOMEM, gdy zabrakło pamięci, a w
+ * pozostałych przypadkach kod błędu odczytu.
+ */
+gamma_t* gamma_load(int fd);
+
+/**
+ * Kopiuje statystyki pracy silnika dla planszy @p g do @p out.
+ * @param g         - wskaźnik na strukturę przechowującą planszę.
+ * @param out       - wskaźnik na strukturę, do której kopiujemy statystyki.
+ * @return Wartość @p true, jeśli statystyki zostały skopiowane, a @p false,
+ * gdy któryś ze wskaźników jest NULL lub silnik skompilowano bez statystyk.
+ */
+bool gamma_stats(gamma_t *g, gamma_stats_t *out);
+
 #endif /* GAMMA_H */
@@ -0,0 +1,278 @@
+/** @file
+ * Pomiar wpływu układu pól planszy na szybkość silnika gry gamma.
+ * Dla każdego układu mierzy średni czas ruchu w losowe pola dużej planszy
+ * oraz przepustowość przebudowy obszarów gracza po złotym ruchu, czyli
+ * liczbę pól przeglądanych i łączonych w ciągu sekundy. Na koniec mierzy
+ * liczbę losowych partii na sekundę gracza komputerowego MCTS na planszy
+ * 20×20 z czterema graczami: w całej partii na jednym wątku oraz w ustalonej
+ * pozycji dla 1, 2, 4, ... wątków przy obu sposobach zrównoleglenia.
+ *
+ * Użycie: gamma_bench [-w szerokość] [-h wysokość] [-m ruchy] [-s ziarno]
+ *                     [-t milisekundy_mcts] [-j największa_liczba_wątków]
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do getopt i clock_gettime.
+
+#include "gamma.h"
+#include "mcts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_WIDTH 100000 ///< Domyślna szerokość planszy.
+#define DEFAULT_HEIGHT 64 ///< Domyślna wysokość planszy.
+#define DEFAULT_MOVES 2000000 ///< Domyślna liczba mierzonych ruchów.
+#define GOLDEN_PLAYERS 8 ///< Liczba graczy wykonujących złote ruchy.
+#define MCTS_SIDE 20 ///< Bok planszy pomiaru MCTS.
+#define MCTS_PLAYERS 4 ///< Liczba graczy pomiaru MCTS.
+#define MCTS_AREAS 5 ///< Maksymalna liczba obszarów pomiaru MCTS.
+#define MCTS_OPENING 40 ///< Liczba losowych ruchów przed pomiarem skalowania.
+#define MCTS_SEARCHES 5 ///< Liczba przeszukiwań na punkt krzywej skalowania.
+
+/** Nazwy układów pól używane w raporcie. */
+static const char *layout_names[] = {"row-major", "tiled", "morton"};
+
+/** Stan generatora liczb pseudolosowych. */
+static uint64_t rng_state;
+
+/**
+ * Generator xorshift64*.
+ * @return Kolejna liczba pseudolosowa.
+ */
+static uint64_t rng_next() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+/**
+ * Podaje aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Mierzy jeden układ pól: ruchy graczy 1 i 2 w losowe pola, a potem złote
+ * ruchy graczy 3 i kolejnych na pola gracza 1, z których każdy przebudowuje
+ * wszystkie obszary gracza 1.
+ * @param width  - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @param moves  - Liczba ruchów.
+ * @param seed   - Ziarno generatora.
+ * @param layout - Układ pól.
+ * @return 0, gdy pomiar się udał, 1 w przeciwnym wypadku.
+ */
+static int bench_layout(uint32_t width, uint32_t height, uint64_t moves,
+                        uint64_t seed, gamma_layout_t layout) {
+    gamma_t *g = gamma_new_layout(width, height, 2 + GOLDEN_PLAYERS,
+                                  UINT32_MAX - 1, NULL, layout);
+    if (g == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    rng_state = seed * 0x9E3779B97F4A7C15ull + 1;
+    uint64_t start = now();
+    for (uint64_t i = 0; i < moves; ++i) {
+        uint64_t r = rng_next();
+        gamma_move(g, 1 + (i & 1), (uint32_t) (r % width),
+                   (uint32_t) ((r >> 32) % height));
+    }
+    uint64_t move_time = now() - start;
+
+    uint64_t rebuilt = 0;
+    uint64_t golden_time = 0;
+    for (uint32_t player = 3; player < 3 + GOLDEN_PLAYERS; ++player) {
+        uint32_t x, y;
+        gamma_area_t area;
+        do {
+            uint64_t r = rng_next();
+            x = (uint32_t) (r % width);
+            y = (uint32_t) ((r >> 32) % height);
+        } while (!gamma_area_info(g, x, y, &area) || area.player != 1);
+        uint64_t cells = gamma_busy_fields(g, 1);
+        start = now();
+        bool moved = gamma_golden_move(g, player, x, y);
+        golden_time += now() - start;
+        if (moved)
+            rebuilt += cells;
+    }
+
+    printf("%-10s %14.1f %18.1f\n", layout_names[layout],
+           (double) move_time / moves,
+           golden_time > 0 ? rebuilt * 1e3 / golden_time : 0.0);
+    gamma_delete(g);
+    return 0;
+}
+
+/**
+ * Mierzy gracza komputerowego MCTS: rozgrywa jedną partię, w której każdy
+ * ruch wybiera przeszukiwanie z limitem czasu @p budget_ms, i wypisuje
+ * średnią liczbę losowych partii na sekundę.
+ * @param budget_ms - Czas na ruch w milisekundach.
+ * @param seed      - Ziarno generatora.
+ * @return 0, gdy pomiar się udał, 1 w przeciwnym wypadku.
+ */
+static int bench_mcts(uint32_t budget_ms, uint64_t seed) {
+    gamma_t *g = gamma_new(MCTS_SIDE, MCTS_SIDE, MCTS_PLAYERS, MCTS_AREAS);
+    mcts_config_t config;
+    mcts_default_config(&config);
+    config.budget_ms = budget_ms;
+    config.seed = seed;
+    mcts_t *mcts = g != NULL ? mcts_new(g, &config) : NULL;
+    if (mcts == NULL) {
+        gamma_delete(g);
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    uint64_t playouts = 0, elapsed = 0, moves = 0;
+    uint32_t player = 1, passes = 0;
+    mcts_result_t result;
+    while (passes < MCTS_PLAYERS) {
+        bool moved = mcts_search(mcts, g, player, &result) && result.found &&
+                     (result.golden ?
+                      gamma_golden_move(g, player, result.x, result.y) :
+                      gamma_move(g, player, result.x, result.y));
+        playouts += result.playouts;
+        elapsed += result.elapsed_ns;
+        moves += moved;
+        passes = moved ? 0 : passes + 1;
+        player = player % MCTS_PLAYERS + 1;
+    }
+
+    printf("mcts %ux%u, %u players, %u ms/move: %lu moves, %.0f playouts/s\n",
+           MCTS_SIDE, MCTS_SIDE, MCTS_PLAYERS, budget_ms, moves,
+           elapsed > 0 ? playouts * 1e9 / elapsed : 0.0);
+    mcts_delete(mcts);
+    gamma_delete(g);
+    return 0;
+}
+
+/**
+ * Mierzy liczbę losowych partii na sekundę przy danej liczbie wątków i
+ * sposobie zrównoleglenia: wykonuje kilka przeszukiwań z pozycji @p g.
+ * @param g         - Wskaźnik na planszę.
+ * @param config    - Wskaźnik na ustawienia przeszukiwania.
+ * @param rate      - Wskaźnik, pod który zapisujemy wynik.
+ * @return 0, gdy pomiar się udał, 1 w przeciwnym wypadku.
+ */
+static int bench_mcts_rate(gamma_t *g, const mcts_config_t *config,
+                           double *rate) {
+    mcts_t *mcts = mcts_new(g, config);
+    if (mcts == NULL) {
+        fprintf(stderr, "Cannot start %u threads\n", config->threads);
+        return 1;
+    }
+    uint64_t playouts = 0, elapsed = 0;
+    mcts_result_t result;
+    for (int i = 0; i < MCTS_SEARCHES; ++i) {
+        if (!mcts_search(mcts, g, 1, &result)) {
+            mcts_delete(mcts);
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        playouts += result.playouts;
+        elapsed += result.elapsed_ns;
+    }
+    *rate = elapsed > 0 ? playouts * 1e9 / elapsed : 0.0;
+    mcts_delete(mcts);
+    return 0;
+}
+
+/**
+ * Wypisuje krzywą skalowania przeszukiwania MCTS: liczbę losowych partii
+ * na sekundę dla 1, 2, 4, ... @p max_threads wątków przy wspólnym drzewie
+ * i przy osobnych drzewach wątków, w pozycji po @ref MCTS_OPENING losowych
+ * ruchach.
+ * @param budget_ms   - Czas na ruch w milisekundach.
+ * @param seed        - Ziarno generatora.
+ * @param max_threads - Największa liczba wątków.
+ * @return 0, gdy pomiar się udał, 1 w przeciwnym wypadku.
+ */
+static int bench_mcts_scaling(uint32_t budget_ms, uint64_t seed,
+                              uint32_t max_threads) {
+    gamma_t *g = gamma_new(MCTS_SIDE, MCTS_SIDE, MCTS_PLAYERS, MCTS_AREAS);
+    if (g == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    uint64_t rng = seed;
+    for (uint32_t i = 0; i < MCTS_OPENING; ++i)
+        gamma_random_move(g, i % MCTS_PLAYERS + 1, &rng);
+
+    mcts_config_t config;
+    mcts_default_config(&config);
+    config.budget_ms = budget_ms;
+    config.seed = seed;
+    printf("%-8s %16s %16s\n", "threads", "tree playouts/s", "root playouts/s");
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        double tree, root;
+        config.threads = threads;
+        config.parallel = MCTS_TREE_PARALLEL;
+        if (bench_mcts_rate(g, &config, &tree) != 0)
+            break;
+        config.parallel = MCTS_ROOT_PARALLEL;
+        if (bench_mcts_rate(g, &config, &root) != 0)
+            break;
+        printf("%-8u %16.0f %16.0f\n", threads, tree, root);
+        if (threads > UINT32_MAX / 2)
+            break;
+    }
+    gamma_delete(g);
+    return 0;
+}
+
+/**
+ * Główna funkcja pomiaru.
+ * @param argc  - Liczba argumentów.
+ * @param argv  - Argumenty wywołania.
+ * @return 0, gdy pomiar się udał, 1 w przeciwnym wypadku.
+ */
+int main(int argc, char *argv[]) {
+    uint32_t width = DEFAULT_WIDTH;
+    uint32_t height = DEFAULT_HEIGHT;
+    uint64_t moves = DEFAULT_MOVES;
+    uint64_t seed = 1;
+    uint32_t budget_ms = 10;
+    uint32_t max_threads = 64;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:m:s:t:j:")) != -1) {
+        unsigned long value = strtoul(optarg, NULL, 10);
+        switch (opt) {
+            case 'w': width = value; break;
+            case 'h': height = value; break;
+            case 'm': moves = value; break;
+            case 's': seed = value; break;
+            case 't': budget_ms = value; break;
+            case 'j': max_threads = value; break;
+            default:
+                fprintf(stderr, "Usage: %s [-w width] [-h height] "
+                                "[-m moves] [-s seed] [-t mcts_ms] "
+                                "[-j max_threads]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (width == 0 || height == 0 || moves == 0 || budget_ms == 0 ||
+        max_threads == 0) {
+        fprintf(stderr, "Parameters must be positive\n");
+        return 1;
+    }
+
+    printf("board %ux%u, %lu moves\n", width, height, moves);
+    printf("%-10s %14s %18s\n", "layout", "move ns/op", "rebuild Mcells/s");
+    for (int layout = GAMMA_LAYOUT_ROW_MAJOR; layout <= GAMMA_LAYOUT_MORTON;
+         ++layout)
+        if (bench_layout(width, height, moves, seed, layout) != 0)
+            return 1;
+    if (bench_mcts(budget_ms, seed) != 0)
+        return 1;
+    return bench_mcts_scaling(budget_ms, seed, max_threads);
+}
@@ -0,0 +1,812 @@
+/** @file
+ * Porównawczy test silnika gry gamma z silnikiem wzorcowym.
+ * Rozgrywa losowe ciągi poleceń jednocześnie na obu silnikach, porównuje
+ * każdy wynik i stan planszy, sprawdza indeks obszarów silnika i wypisywane
+ * przez niego ruchy, a na koniec wypisuje, ile razy silnik jest szybszy od
+ * wzorca dla każdej operacji. Wypisywanie ruchów buduje na planszy indeks
+ * ruchów, z którego potem korzystają też inne operacje, więc ruchy są
+ * wypisywane z drugiej planszy silnika, na której powtarzamy te same
+ * polecenia. Mierzona plansza nigdy nie ma indeksu i jej wyniki pochodzą
+ * z przeglądania planszy.
+ *
+ * Czasy nie są mierzone w trakcie porównywania. Po sprawdzeniu rozgrywki
+ * jej zapisane polecenia są powtarzane na nowych planszach obu silników,
+ * raz jednego, raz drugiego jako pierwszego, a pierwszy, sprawdzany
+ * przebieg służy obu silnikom za rozgrzewkę. Mierzone są paczki poleceń:
+ * kolejne ruchy tego samego rodzaju razem, a zapytania, które nie zmieniają
+ * planszy, powtórzone kilka razy. Od czasu paczki odejmowany jest koszt
+ * odczytu zegara, a oba silniki są wywoływane przez taką samą funkcję.
+ *
+ * Użycie: gamma_diff [-g gry] [-s ziarno] [-n bok] [-p gracze] [-a obszary]
+ *                    [-b co_ile_plansza] [-t wątki] [-l układ]
+ * Układ to 0 (wiersz po wierszu), 1 (kwadraty) lub 2 (porządek Mortona).
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do getopt i clock_gettime.
+
+#include "gamma.h"
+#include "gamma_ref.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_GAMES 1000 ///< Domyślna liczba rozgrywek.
+#define DEFAULT_SEED 1 ///< Domyślne ziarno generatora.
+#define DEFAULT_SIDE 12 ///< Domyślny maksymalny bok planszy.
+#define DEFAULT_PLAYERS 4 ///< Domyślna maksymalna liczba graczy.
+#define DEFAULT_AREAS 4 ///< Domyślna maksymalna liczba obszarów.
+#define STEPS_PER_FIELD 4 ///< Liczba poleceń na jedno pole planszy.
+#define QUERY_REPEAT 4 ///< Liczba mierzonych powtórzeń jednego zapytania.
+#define CLOCK_SAMPLES 1000 ///< Liczba prób przy mierzeniu kosztu zegara.
+
+/**
+ * Operacje porównywane przez test.
+ */
+enum diff_op {
+    OP_MOVE, OP_GOLDEN_MOVE, OP_BUSY, OP_FREE, OP_GOLDEN_POSSIBLE,
+    OP_GOLDEN_TARGET, OP_BOARD, OP_COUNT
+};
+
+/** Nazwy operacji używane w raporcie. */
+static const char *op_names[OP_COUNT] = {
+    "move", "golden_move", "busy_fields", "free_fields",
+    "golden_possible", "golden_target", "board"
+};
+
+/**
+ * Czasy wykonania operacji na obu silnikach.
+ */
+typedef struct diff_times {
+    uint64_t calls[OP_COUNT]; ///< Liczba wywołań operacji.
+    uint64_t engine[OP_COUNT]; ///< Łączny czas silnika w nanosekundach.
+    uint64_t reference[OP_COUNT]; ///< Łączny czas wzorca w nanosekundach.
+} diff_times_t;
+
+/**
+ * Polecenie rozgrywki zapisane do powtórzenia z pomiarem czasu.
+ */
+typedef struct diff_command {
+    int op; ///< Operacja.
+    uint32_t player; ///< Numer gracza.
+    uint32_t x; ///< Numer kolumny.
+    uint32_t y; ///< Numer wiersza.
+    bool board; ///< Czy po poleceniu wypisywana jest plansza.
+} diff_command_t;
+
+/**
+ * Silnik mierzony w powtórzeniu rozgrywki: plansza i funkcje wywołujące
+ * na niej operacje.
+ */
+typedef struct diff_side {
+    void *board; ///< Plansza silnika.
+    /** Wykonuje operację i podaje jej wynik. */
+    uint64_t (*op)(void *board, int op, uint32_t player, uint32_t x,
+                   uint32_t y);
+    /** Wypisuje planszę do nowego napisu. */
+    char* (*print)(void *board);
+} diff_side_t;
+
+/** Stan generatora liczb pseudolosowych. */
+static uint64_t rng_state;
+
+/** Koszt pary odczytów zegara w nanosekundach. */
+static uint64_t clock_cost;
+
+/** Suma wyników mierzonych operacji, żeby nie zostały pominięte. */
+static volatile uint64_t sink;
+
+/**
+ * Generator xorshift64*.
+ * @return Kolejna liczba pseudolosowa.
+ */
+static uint64_t rng_next() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+/**
+ * Losuje liczbę z przedziału [0, @p n).
+ * @param n     - Górne ograniczenie, liczba dodatnia.
+ * @return Wylosowana liczba.
+ */
+static uint32_t rng_below(uint32_t n) {
+    return (uint32_t) (rng_next() % n);
+}
+
+/**
+ * Podaje aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Mierzy koszt pary odczytów zegara: najmniejszy z @ref CLOCK_SAMPLES
+ * pomiarów.
+ */
+static void measure_clock_cost() {
+    clock_cost = UINT64_MAX;
+    for (int i = 0; i < CLOCK_SAMPLES; ++i) {
+        uint64_t start = now();
+        uint64_t elapsed = now() - start;
+        if (elapsed < clock_cost)
+            clock_cost = elapsed;
+    }
+}
+
+/**
+ * Podaje czas paczki bez kosztu odczytu zegara.
+ * @param start - Czas rozpoczęcia paczki.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t batch_time(uint64_t start) {
+    uint64_t elapsed = now() - start;
+    return elapsed > clock_cost ? elapsed - clock_cost : 0;
+}
+
+/**
+ * Wypisuje informację o rozbieżności i kończy program z kodem 1.
+ * @param game      - Numer rozgrywki.
+ * @param step      - Numer polecenia w rozgrywce.
+ * @param op        - Operacja, przy której wystąpiła rozbieżność.
+ * @param player    - Numer gracza.
+ * @param x         - Numer kolumny.
+ * @param y         - Numer wiersza.
+ * @param engine    - Wynik silnika.
+ * @param reference - Wynik wzorca.
+ */
+static void report_mismatch(uint64_t game, uint64_t step, int op,
+                            uint32_t player, uint32_t x, uint32_t y,
+                            uint64_t engine, uint64_t reference) {
+    fprintf(stderr, "MISMATCH game %lu step %lu: %s %u %u %u "
+                    "engine %lu reference %lu\n", game, step, op_names[op],
+            player, x, y, engine, reference);
+    exit(1);
+}
+
+/**
+ * Porównuje plansze obu silników.
+ * @param g     - Plansza silnika.
+ * @param r     - Plansza wzorca.
+ * @return Wartość true, jeśli napisy opisujące plansze są równe.
+ */
+static bool same_boards(gamma_t *g, gamma_ref_t *r) {
+    char *engine = gamma_board(g);
+    char *reference = gamma_ref_board(r);
+    bool same = engine != NULL && reference != NULL &&
+                strcmp(engine, reference) == 0;
+    if (!same && engine != NULL && reference != NULL)
+        fprintf(stderr, "engine:\n%sreference:\n%s", engine, reference);
+    free(engine);
+    free(reference);
+    return same;
+}
+
+/**
+ * Funkcja zliczająca obszary odwiedzone przez gamma_for_each_area.
+ * @param area  - Opis obszaru.
+ * @param ctx   - Wskaźnik na dwie liczby: liczbę obszarów i sumę ich pól.
+ * @return Zawsze true.
+ */
+static bool count_area(const gamma_area_t *area, void *ctx) {
+    uint64_t *totals = ctx;
+    ++totals[0];
+    totals[1] += area->size;
+    return true;
+}
+
+/**
+ * Sprawdza indeks obszarów silnika: wyznacza obszary przeszukiwaniem wszerz
+ * i porównuje ich rozmiary i prostokąty ograniczające z gamma_area_info dla
+ * każdego pola, a liczby obszarów i pól graczy z gamma_for_each_area.
+ * @param g       - Plansza silnika.
+ * @param players - Liczba graczy.
+ * @return Wartość true, jeśli indeks obszarów jest zgodny z planszą.
+ */
+static bool same_areas(gamma_t *g, uint32_t players) {
+    uint32_t width = gamma_get_width(g);
+    uint32_t height = gamma_get_height(g);
+    size_t cells = (size_t) width * height;
+    uint32_t *owner = calloc(cells, sizeof(uint32_t));
+    bool *seen = calloc(cells, sizeof(bool));
+    size_t *queue = malloc(cells * sizeof(size_t));
+    uint64_t *areas = calloc((size_t) players + 1, sizeof(uint64_t));
+    if (owner == NULL || seen == NULL || queue == NULL || areas == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    gamma_area_t info;
+    for (size_t cell = 0; cell < cells; ++cell)
+        if (gamma_area_info(g, cell % width, cell / width, &info))
+            owner[cell] = info.player;
+
+    bool same = true;
+    for (size_t start = 0; start < cells && same; ++start) {
+        if (owner[start] == 0 || seen[start])
+            continue;
+        gamma_area_t expected = {owner[start], 0, width, height, 0, 0};
+        size_t head = 0, tail = 0;
+        queue[tail++] = start;
+        seen[start] = true;
+        while (head < tail) {
+            size_t cell = queue[head++];
+            uint32_t x = cell % width, y = cell / width;
+            ++expected.size;
+            expected.min_x = x < expected.min_x ? x : expected.min_x;
+            expected.min_y = y < expected.min_y ? y : expected.min_y;
+            expected.max_x = x > expected.max_x ? x : expected.max_x;
+            expected.max_y = y > expected.max_y ? y : expected.max_y;
+            size_t next[] = {x > 0 ? cell - 1 : cell,
+                             x + 1 < width ? cell + 1 : cell,
+                             y > 0 ? cell - width : cell,
+                             y + 1 < height ? cell + width : cell};
+            for (int dir = 0; dir < 4; ++dir) {
+                if (!seen[next[dir]] && owner[next[dir]] == owner[start]) {
+                    seen[next[dir]] = true;
+                    queue[tail++] = next[dir];
+                }
+            }
+        }
+        ++areas[owner[start]];
+        for (size_t i = 0; i < tail && same; ++i) {
+            gamma_area_info(g, queue[i] % width, queue[i] / width, &info);
+            same = info.player == expected.player &&
+                   info.size == expected.size &&
+                   info.min_x == expected.min_x &&
+                   info.min_y == expected.min_y &&
+                   info.max_x == expected.max_x &&
+                   info.max_y == expected.max_y;
+        }
+    }
+
+    for (uint32_t player = 1; player <= players && same; ++player) {
+        uint64_t totals[2] = {0, 0};
+        gamma_for_each_area(g, player, count_area, totals);
+        same = totals[0] == areas[player] &&
+               totals[1] == gamma_busy_fields(g, player);
+    }
+    if (!same)
+        fprintf(stderr, "area index does not match the board\n");
+
+    free(owner);
+    free(seen);
+    free(queue);
+    free(areas);
+    return same;
+}
+
+/**
+ * Podaje właściciela pola na podstawie gamma_area_info.
+ * @param g - Plansza silnika.
+ * @param x - Numer kolumny, być może spoza planszy.
+ * @param y - Numer wiersza, być może spoza planszy.
+ * @return Numer gracza lub 0 dla pustego pola i pola spoza planszy.
+ */
+static uint32_t owner_of(gamma_t *g, int64_t x, int64_t y) {
+    gamma_area_t info;
+    if (x < 0 || y < 0 ||
+        !gamma_area_info(g, (uint32_t) x, (uint32_t) y, &info))
+        return 0;
+    return info.player;
+}
+
+/**
+ * Liczy metodą brutalną, na ile obszarów rozpadną się sąsiedzi zajętego
+ * pola należący do jego właściciela, gdy pole zostanie opróżnione.
+ * @param g - Plansza silnika.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Liczba obszarów.
+ */
+static uint32_t split_areas(gamma_t *g, uint32_t x, uint32_t y) {
+    static const int dx[] = {-1, 1, 0, 0}, dy[] = {0, 0, -1, 1};
+    uint32_t width = gamma_get_width(g);
+    size_t cells = (size_t) width * gamma_get_height(g);
+    uint32_t owner = owner_of(g, x, y);
+    bool *seen = calloc(cells, sizeof(bool));
+    size_t *queue = malloc(cells * sizeof(size_t));
+    if (seen == NULL || queue == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    seen[(size_t) y * width + x] = true;
+    uint32_t areas = 0;
+    for (int dir = 0; dir < 4; ++dir) {
+        int64_t sx = (int64_t) x + dx[dir], sy = (int64_t) y + dy[dir];
+        if (owner_of(g, sx, sy) != owner || seen[sy * width + sx])
+            continue;
+        ++areas;
+        size_t head = 0, tail = 0;
+        queue[tail++] = sy * width + sx;
+        seen[sy * width + sx] = true;
+        while (head < tail) {
+            size_t cell = queue[head++];
+            int64_t cx = cell % width, cy = cell / width;
+            for (int next = 0; next < 4; ++next) {
+                int64_t nx = cx + dx[next], ny = cy + dy[next];
+                if (owner_of(g, nx, ny) == owner && !seen[ny * width + nx]) {
+                    seen[ny * width + nx] = true;
+                    queue[tail++] = ny * width + nx;
+                }
+            }
+        }
+    }
+    free(seen);
+    free(queue);
+    return areas;
+}
+
+/**
+ * Sprawdza, czy pole sąsiaduje z polem gracza.
+ * @param g      - Plansza silnika.
+ * @param player - Numer gracza.
+ * @param x      - Numer kolumny.
+ * @param y      - Numer wiersza.
+ * @return Wartość true, jeśli któryś z sąsiadów pola należy do gracza.
+ */
+static bool touches(gamma_t *g, uint32_t player, int64_t x, int64_t y) {
+    return owner_of(g, x - 1, y) == player || owner_of(g, x + 1, y) == player ||
+           owner_of(g, x, y - 1) == player || owner_of(g, x, y + 1) == player;
+}
+
+/**
+ * Funkcja zliczająca obszary odwiedzone przez gamma_for_each_area.
+ * @param area  - Opis obszaru.
+ * @param ctx   - Wskaźnik na liczbę obszarów.
+ * @return Zawsze true.
+ */
+static bool count_areas(const gamma_area_t *area, void *ctx) {
+    (void) area;
+    ++*(uint32_t*) ctx;
+    return true;
+}
+
+/**
+ * Sprawdza ruchy wypisywane przez silnik dla gracza @p player: pola
+ * z gamma_legal_moves muszą być różnymi polami, w które gracz może się
+ * ruszyć, a ich liczba równa wynikowi gamma_ref_free_fields. Pola
+ * z gamma_golden_targets muszą być dokładnie polami, które wyznacza metoda
+ * brutalna, a gamma_can_move musi się zgadzać z wolnymi polami i złotym
+ * ruchem wzorca.
+ * @param g       - Plansza silnika.
+ * @param r       - Plansza wzorca.
+ * @param player  - Numer gracza; niepoprawny numer nie jest sprawdzany.
+ * @param players - Liczba graczy.
+ * @param limit   - Maksymalna liczba obszarów.
+ * @param buf     - Tablica na wszystkie pola planszy.
+ * @return Wartość true, jeśli wypisane ruchy są poprawne.
+ */
+static bool same_moves(gamma_t *g, gamma_ref_t *r, uint32_t player,
+                       uint32_t players, uint32_t limit, gamma_cell_t *buf) {
+    if (player == 0 || player > players)
+        return true;
+    uint32_t width = gamma_get_width(g);
+    uint64_t cells = (uint64_t) width * gamma_get_height(g);
+    bool *listed = calloc(cells, sizeof(bool));
+    uint32_t *areas = calloc((size_t) players + 1, sizeof(uint32_t));
+    if (listed == NULL || areas == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (uint32_t i = 1; i <= players; ++i)
+        gamma_for_each_area(g, i, count_areas, &(areas[i]));
+
+    uint64_t count = gamma_legal_moves(g, player, buf, cells);
+    bool same = count == gamma_ref_free_fields(r, player);
+    for (uint64_t i = 0; i < count && same; ++i) {
+        uint64_t cell = (uint64_t) buf[i].y * width + buf[i].x;
+        same = buf[i].x < width && cell < cells && !listed[cell] &&
+               owner_of(g, buf[i].x, buf[i].y) == 0 &&
+               (areas[player] < limit || touches(g, player, cell % width,
+                                                 cell / width));
+        if (same)
+            listed[cell] = true;
+    }
+
+    if (same) {
+        count = gamma_golden_targets(g, player, buf, cells);
+        memset(listed, 0, cells * sizeof(bool));
+    }
+    for (uint64_t i = 0; i < count && same; ++i) {
+        uint64_t cell = (uint64_t) buf[i].y * width + buf[i].x;
+        same = buf[i].x < width && cell < cells && !listed[cell];
+        if (same)
+            listed[cell] = true;
+    }
+    bool golden = gamma_ref_golden_possible(r, player);
+    for (uint64_t cell = 0; cell < cells && same; ++cell) {
+        uint32_t x = cell % width, y = cell / width;
+        uint32_t owner = owner_of(g, x, y);
+        bool expected = golden && owner != 0 && owner != player &&
+                        (areas[player] < limit || touches(g, player, x, y)) &&
+                        areas[owner] - 1 + split_areas(g, x, y) <= limit;
+        same = listed[cell] == expected;
+    }
+    if (same)
+        same = gamma_can_move(g, player) ==
+               (gamma_ref_free_fields(r, player) > 0 ||
+                gamma_ref_golden_possible(r, player));
+    if (!same)
+        fprintf(stderr, "listed moves do not match the board\n");
+
+    free(listed);
+    free(areas);
+    return same;
+}
+
+/**
+ * Wybiera losowe pole spośród pól, które gracz może zająć złotym ruchem.
+ * Jeśli takich pól nie ma, współrzędne pozostają bez zmian.
+ * @param g       - Plansza silnika.
+ * @param player  - Numer gracza, być może niepoprawny.
+ * @param buf     - Tablica na wszystkie pola planszy.
+ * @param x       - Wskaźnik na numer kolumny.
+ * @param y       - Wskaźnik na numer wiersza.
+ */
+static void pick_golden_target(gamma_t *g, uint32_t player, gamma_cell_t *buf,
+                               uint32_t *x, uint32_t *y) {
+    uint64_t cells = (uint64_t) gamma_get_width(g) * gamma_get_height(g);
+    uint64_t count = gamma_golden_targets(g, player, buf, cells);
+    if (count > 0) {
+        uint64_t i = rng_next() % count;
+        *x = buf[i].x;
+        *y = buf[i].y;
+    }
+}
+
+/**
+ * Wykonuje operację na planszy silnika.
+ * @param board   - Plansza silnika (gamma_t).
+ * @param op      - Operacja.
+ * @param player  - Numer gracza.
+ * @param x       - Numer kolumny.
+ * @param y       - Numer wiersza.
+ * @return Wynik operacji.
+ */
+static uint64_t engine_op(void *board, int op, uint32_t player, uint32_t x,
+                          uint32_t y) {
+    gamma_t *g = board;
+    switch (op) {
+        case OP_MOVE:
+            return gamma_move(g, player, x, y);
+        case OP_GOLDEN_MOVE:
+        case OP_GOLDEN_TARGET:
+            return gamma_golden_move(g, player, x, y);
+        case OP_BUSY:
+            return gamma_busy_fields(g, player);
+        case OP_FREE:
+            return gamma_free_fields(g, player);
+        default:
+            return gamma_golden_possible(g, player);
+    }
+}
+
+/**
+ * Wykonuje operację na planszy wzorca.
+ * @param board   - Plansza wzorca (gamma_ref_t).
+ * @param op      - Operacja.
+ * @param player  - Numer gracza.
+ * @param x       - Numer kolumny.
+ * @param y       - Numer wiersza.
+ * @return Wynik operacji.
+ */
+static uint64_t reference_op(void *board, int op, uint32_t player,
+                             uint32_t x, uint32_t y) {
+    gamma_ref_t *r = board;
+    switch (op) {
+        case OP_MOVE:
+            return gamma_ref_move(r, player, x, y);
+        case OP_GOLDEN_MOVE:
+        case OP_GOLDEN_TARGET:
+            return gamma_ref_golden_move(r, player, x, y);
+        case OP_BUSY:
+            return gamma_ref_busy_fields(r, player);
+        case OP_FREE:
+            return gamma_ref_free_fields(r, player);
+        default:
+            return gamma_ref_golden_possible(r, player);
+    }
+}
+
+/**
+ * Wypisuje planszę silnika.
+ * @param board   - Plansza silnika (gamma_t).
+ * @return Napis opisujący planszę lub NULL.
+ */
+static char* engine_print(void *board) {
+    return gamma_board(board);
+}
+
+/**
+ * Wypisuje planszę wzorca.
+ * @param board   - Plansza wzorca (gamma_ref_t).
+ * @return Napis opisujący planszę lub NULL.
+ */
+static char* reference_print(void *board) {
+    return gamma_ref_board(board);
+}
+
+/**
+ * Sprawdza, czy operacja zmienia planszę.
+ * @param op      - Operacja.
+ * @return Wartość true dla ruchów i złotych ruchów.
+ */
+static bool mutating(int op) {
+    return op == OP_MOVE || op == OP_GOLDEN_MOVE || op == OP_GOLDEN_TARGET;
+}
+
+/**
+ * Mierzy zapytanie, które nie zmienia planszy: wykonuje je raz bez
+ * pomiaru, a potem @ref QUERY_REPEAT razy w jednej paczce.
+ * @param side    - Mierzony silnik.
+ * @param command - Polecenie lub NULL dla wypisania planszy.
+ * @param total   - Wskaźnik na łączny czas operacji.
+ */
+static void time_query(const diff_side_t *side, const diff_command_t *command,
+                       uint64_t *total) {
+    uint64_t sum = 0;
+    if (command == NULL) {
+        free(side->print(side->board));
+        uint64_t start = now();
+        for (int i = 0; i < QUERY_REPEAT; ++i)
+            free(side->print(side->board));
+        *total += batch_time(start);
+        return;
+    }
+    sum += side->op(side->board, command->op, command->player, command->x,
+                    command->y);
+    uint64_t start = now();
+    for (int i = 0; i < QUERY_REPEAT; ++i)
+        sum += side->op(side->board, command->op, command->player,
+                        command->x, command->y);
+    *total += batch_time(start);
+    sink += sum;
+}
+
+/**
+ * Powtarza zapisane polecenia rozgrywki na nowej planszy silnika i dodaje
+ * czasy operacji do @p totals. Kolejne ruchy tego samego rodzaju są
+ * mierzone razem, a zapytania przez @ref time_query.
+ * @param side     - Mierzony silnik.
+ * @param commands - Polecenia rozgrywki.
+ * @param count    - Liczba poleceń.
+ * @param totals   - Łączne czasy operacji silnika.
+ */
+static void replay(const diff_side_t *side, const diff_command_t *commands,
+                   uint64_t count, uint64_t *totals) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < count;) {
+        const diff_command_t *first = &(commands[i]);
+        if (mutating(first->op)) {
+            uint64_t end = i;
+            do {
+                ++end;
+            } while (end < count && commands[end].op == first->op &&
+                     !commands[end - 1].board);
+            uint64_t start = now();
+            for (uint64_t j = i; j < end; ++j)
+                sum += side->op(side->board, commands[j].op,
+                                commands[j].player, commands[j].x,
+                                commands[j].y);
+            totals[first->op] += batch_time(start);
+            i = end;
+        }
+        else {
+            time_query(side, first, &(totals[first->op]));
+            ++i;
+        }
+        if (commands[i - 1].board)
+            time_query(side, NULL, &(totals[OP_BOARD]));
+    }
+    sink += sum;
+}
+
+/**
+ * Mierzy czasy operacji obu silników na zapisanych poleceniach rozgrywki,
+ * na nowych planszach o parametrach rozgrywki. Dla parzystych rozgrywek
+ * pierwszy jest silnik, a dla nieparzystych wzorzec.
+ * @param game     - Numer rozgrywki.
+ * @param g        - Sprawdzona plansza silnika, wzór parametrów.
+ * @param threads  - Liczba wątków planszy silnika.
+ * @param layout   - Układ pól planszy silnika.
+ * @param commands - Polecenia rozgrywki.
+ * @param count    - Liczba poleceń.
+ * @param times    - Czasy wykonania operacji.
+ */
+static void time_game(uint64_t game, gamma_t *g, uint32_t threads,
+                      gamma_layout_t layout, const diff_command_t *commands,
+                      uint64_t count, diff_times_t *times) {
+    uint32_t width = gamma_get_width(g);
+    uint32_t height = gamma_get_height(g);
+    uint32_t players = gamma_get_players(g);
+    uint32_t areas = gamma_get_areas(g);
+    gamma_t *engine = gamma_new_layout(width, height, players, areas, NULL,
+                                       layout);
+    gamma_ref_t *reference = gamma_ref_new(width, height, players, areas);
+    if (engine == NULL || reference == NULL ||
+        !gamma_set_threads(engine, threads)) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    diff_side_t engine_side = {engine, engine_op, engine_print};
+    diff_side_t reference_side = {reference, reference_op, reference_print};
+
+    if (game % 2 == 0) {
+        replay(&engine_side, commands, count, times->engine);
+        replay(&reference_side, commands, count, times->reference);
+    }
+    else {
+        replay(&reference_side, commands, count, times->reference);
+        replay(&engine_side, commands, count, times->engine);
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        times->calls[commands[i].op] +=
+            mutating(commands[i].op) ? 1 : QUERY_REPEAT;
+        if (commands[i].board)
+            times->calls[OP_BOARD] += QUERY_REPEAT;
+    }
+
+    gamma_delete(engine);
+    gamma_ref_delete(reference);
+}
+
+/**
+ * Rozgrywa jedną losową rozgrywkę na obu silnikach, porównując wyniki, a
+ * potem mierzy czasy jej poleceń przez @ref time_game. Plansza @p indexed
+ * silnika dostaje te same polecenia co sprawdzana plansza i to z niej są
+ * wypisywane ruchy.
+ * @param game        - Numer rozgrywki.
+ * @param max_side    - Maksymalny bok planszy.
+ * @param max_players - Maksymalna liczba graczy.
+ * @param max_areas   - Maksymalna liczba obszarów.
+ * @param board_every - Co ile poleceń porównywać plansze.
+ * @param threads     - Liczba wątków planszy silnika.
+ * @param layout      - Układ pól planszy silnika.
+ * @param times       - Czasy wykonania operacji.
+ */
+static void play_game(uint64_t game, uint32_t max_side, uint32_t max_players,
+                      uint32_t max_areas, uint32_t board_every,
+                      uint32_t threads, gamma_layout_t layout,
+                      diff_times_t *times) {
+    uint32_t width = 1 + rng_below(max_side);
+    uint32_t height = 1 + rng_below(max_side);
+    uint32_t players = 1 + rng_below(max_players);
+    uint32_t areas = 1 + rng_below(max_areas);
+    uint64_t steps = (uint64_t) STEPS_PER_FIELD * width * height;
+
+    gamma_t *g = gamma_new_layout(width, height, players, areas, NULL, layout);
+    gamma_t *indexed = gamma_clone(g);
+    gamma_ref_t *r = gamma_ref_new(width, height, players, areas);
+    gamma_cell_t *targets = malloc(sizeof(gamma_cell_t) * width * height);
+    diff_command_t *commands = malloc(sizeof(diff_command_t) * steps);
+    if (g == NULL || indexed == NULL || r == NULL || targets == NULL ||
+        commands == NULL || !gamma_set_threads(g, threads)) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    for (uint64_t step = 0; step < steps; ++step) {
+        uint32_t roll = rng_below(100);
+        int op = roll < 55 ? OP_MOVE : roll < 63 ? OP_GOLDEN_MOVE :
+                 roll < 73 ? OP_BUSY : roll < 85 ? OP_FREE :
+                 roll < 95 ? OP_GOLDEN_POSSIBLE : OP_GOLDEN_TARGET;
+        // Czasem podajemy niepoprawnego gracza lub współrzędne.
+        uint32_t player = rng_below(players + 2);
+        uint32_t x = rng_below(width + 1);
+        uint32_t y = rng_below(height + 1);
+        if (op == OP_GOLDEN_TARGET)
+            pick_golden_target(indexed, player, targets, &x, &y);
+        bool board = step % board_every == 0;
+        commands[step] = (diff_command_t) {op, player, x, y, board};
+
+        uint64_t engine = engine_op(g, op, player, x, y);
+        uint64_t reference = reference_op(r, op, player, x, y);
+        if (engine != reference)
+            report_mismatch(game, step, op, player, x, y, engine, reference);
+        engine = engine_op(indexed, op, player, x, y);
+        if (engine != reference) {
+            fprintf(stderr, "board with the move index:\n");
+            report_mismatch(game, step, op, player, x, y, engine, reference);
+        }
+        if (board &&
+            (!same_boards(g, r) || !same_areas(g, players) ||
+             !same_boards(indexed, r) ||
+             !same_moves(indexed, r, player, players, areas, targets)))
+            report_mismatch(game, step, OP_BOARD, player, x, y, 0, 0);
+    }
+    if (!same_boards(g, r) || !same_areas(g, players) ||
+        !same_boards(indexed, r) ||
+        !same_moves(indexed, r, 1 + rng_below(players), players, areas,
+                    targets))
+        report_mismatch(game, steps, OP_BOARD, 0, 0, 0, 0, 0);
+
+    time_game(game, g, threads, layout, commands, steps, times);
+
+    free(targets);
+    free(commands);
+    gamma_delete(g);
+    gamma_delete(indexed);
+    gamma_ref_delete(r);
+}
+
+/**
+ * Wypisuje raport z czasami wykonania operacji na obu silnikach.
+ * @param times - Czasy wykonania operacji.
+ */
+static void print_report(const diff_times_t *times) {
+    printf("%-16s %12s %14s %14s %9s\n", "operation", "calls",
+           "engine ns/op", "ref ns/op", "speedup");
+    for (int op = 0; op < OP_COUNT; ++op) {
+        if (times->calls[op] == 0)
+            continue;
+        double engine = (double) times->engine[op] / times->calls[op];
+        double reference = (double) times->reference[op] / times->calls[op];
+        printf("%-16s %12lu %14.1f %14.1f %8.2fx\n", op_names[op],
+               times->calls[op], engine, reference,
+               engine > 0 ? reference / engine : 0.0);
+    }
+}
+
+/**
+ * Główna funkcja testu porównawczego.
+ * @param argc  - Liczba argumentów.
+ * @param argv  - Argumenty wywołania.
+ * @return 0, gdy silniki dały te same wyniki, 1 w przeciwnym wypadku.
+ */
+int main(int argc, char *argv[]) {
+    uint64_t games = DEFAULT_GAMES;
+    uint64_t seed = DEFAULT_SEED;
+    uint32_t max_side = DEFAULT_SIDE;
+    uint32_t max_players = DEFAULT_PLAYERS;
+    uint32_t max_areas = DEFAULT_AREAS;
+    uint32_t board_every = 1;
+    uint32_t threads = 1;
+    gamma_layout_t layout = GAMMA_LAYOUT_ROW_MAJOR;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:s:n:p:a:b:t:l:")) != -1) {
+        unsigned long value = strtoul(optarg, NULL, 10);
+        switch (opt) {
+            case 'g': games = value; break;
+            case 's': seed = value; break;
+            case 'n': max_side = value; break;
+            case 'p': max_players = value; break;
+            case 'a': max_areas = value; break;
+            case 'b': board_every = value; break;
+            case 't': threads = value; break;
+            case 'l': layout = (gamma_layout_t) value; break;
+            default:
+                fprintf(stderr, "Usage: %s [-g games] [-s seed] [-n side] "
+                                "[-p players] [-a areas] [-b board_every] "
+                                "[-t threads] [-l layout]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (max_side == 0 || max_players == 0 || max_areas == 0 ||
+        board_every == 0) {
+        fprintf(stderr, "Parameters must be positive\n");
+        return 1;
+    }
+
+    rng_state = seed * 0x9E3779B97F4A7C15ull + 1;
+    measure_clock_cost();
+    diff_times_t times;
+    memset(&times, 0, sizeof(times));
+
+    for (uint64_t game = 0; game < games; ++game)
+        play_game(game, max_side, max_players, max_areas, board_every,
+                  threads, layout, &times);
+
+    printf("OK %lu games\n", games);
+    print_report(&times);
+    return 0;
+}
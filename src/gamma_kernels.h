@@ -0,0 +1,816 @@
+/**
+ * @file
+ * Jądra silnika zależne od szerokości numeru właściciela pola. Plik jest
+ * dołączany do gamma.c kilka razy, za każdym razem z innymi definicjami:
+ * - OWNER_T      - typ całkowity bez znaku przechowujący właściciela pola,
+ * - KERNEL(name) - nazwa funkcji z przyrostkiem szerokości typu,
+ * - VEC_CMPEQ, VEC_SET1 - porównanie i wypełnienie wektorów AVX2 elementami
+ *   typu OWNER_T (używane tylko, gdy zdefiniowano GAMMA_AVX2).
+ *
+ * Każda pętla po planszy jest więc skompilowana osobno dla każdej szerokości,
+ * a wersję wybiera się raz na wywołanie funkcji publicznej, a nie raz na
+ * pole. Plik celowo nie ma strażnika dołączania.
+ */
+
+/**
+ * Sprawdza, czy dany ruch jest możliwy w danym momencie. Odpowiednik
+ * @ref movie_possible dla planszy różnej od NULL.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, który chce wykonać ruch.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return true w przypadku gdy jest możiwe wykonanie danego ruchu lub false,
+ * gdy taki ruch jest niedozwolony lub któryś z parametrów jest błędny.
+ */
+static bool KERNEL(move_possible)(gamma_t *g, uint32_t player,
+                                  uint32_t x, uint32_t y) {
+    const OWNER_T *owners = g->owners;
+    if (player == EMPTY || player > g->players || x >= g->width ||
+        y >= g->height || owners[cell_index(g, x, y)] != EMPTY) {
+        return false;
+    }
+
+    if (g->player_areas[player] == g->areas) {
+        for (int i = 0; i < 4; ++i) {
+            uint32_t nx = x + delta_x[i];
+            uint32_t ny = y + delta_y[i];
+            if (good_coords(g, nx, ny) &&
+                owners[cell_index(g, nx, ny)] == player)
+                return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza stawiająca pionek gracza @p player na polu
+ * (@p x, @p y) bez sprawdzania poprawności ruchu. Dołącza nowe pole do
+ * obszaru pierwszego sąsiedniego pola gracza, łączy z nim obszary pozostałych
+ * sąsiednich pól i aktualizuje liczbę jego obszarów i pól. Nowy opis obszaru
+ * jest potrzebny tylko dla pola bez sąsiednich pól gracza.
+ * Pozwalamy na to, żeby liczba obszarów gracza @p player przekroczyła po
+ * takim ruchu maksymalną liczbę obszarów.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param x - Numer kolumny pola, w które chcemy ustawić pionka.
+ * @param y - Numer wiersza pola, w które chcemy ustawić pionka.
+ */
+static void KERNEL(place)(gamma_t *g, uint32_t player,
+                          uint32_t x, uint32_t y) {
+    OWNER_T *owners = g->owners;
+    size_t index = cell_index(g, x, y);
+    uint64_t field = field_index(g, x, y);
+    owners[index] = (OWNER_T) player;
+    track_owner(g, x, y, EMPTY, player);
+
+    bool attached = false;
+    uint32_t united_areas = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        uint32_t nx = x + delta_x[i];
+        uint32_t ny = y + delta_y[i];
+        if (!good_coords(g, nx, ny))
+            continue;
+        size_t neighbour = cell_index(g, nx, ny);
+        if (owners[neighbour] != player)
+            continue;
+        uint64_t other = field_index(g, nx, ny);
+        if (!attached) {
+            extend_area(g->fields, g->area_slots, field, root(g, other),
+                        x, y);
+            attached = true;
+            continue;
+        }
+        if (root(g, field) != root(g, other))
+            united_areas++;
+        join(g, player, field, other);
+    }
+    if (!attached) {
+        add_area(g, player, field, x, y);
+        ++(g->player_areas[player]);
+    }
+    else {
+        g->player_areas[player] -= united_areas;
+    }
+    track_areas(g, player);
+
+    ++(g->player_fields[player]);
+}
+
+/**
+ * Funkcja pomocnicza wykonująca ruch. Odpowiednik @ref gamma_move dla
+ * planszy różnej od NULL.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Wartość true, jeśli ruch został wykonany, false w p.p.
+ */
+static bool KERNEL(move)(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if (!KERNEL(move_possible)(g, player, x, y))
+        return false;
+    KERNEL(place)(g, player, x, y);
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza licząca puste pola wiersza od kolumny @p from do
+ * kolumny @p to (bez niej), które sąsiadują z polem gracza @p player.
+ * Dzięki ramce planszy sąsiedzi każdego pola istnieją, więc pętla nie
+ * sprawdza współrzędnych i nie ma rozgałęzień zależnych od danych.
+ * @param row - Wskaźnik na pierwsze pole wiersza.
+ * @param stride - Odległość między kolejnymi wierszami.
+ * @param from - Pierwsza sprawdzana kolumna.
+ * @param to - Kolumna za ostatnią sprawdzaną.
+ * @param player - Numer gracza.
+ * @return Liczba pustych pól sąsiadujących z polami gracza.
+ */
+static uint64_t KERNEL(frontier_cells)(const OWNER_T *row, size_t stride,
+                                       uint32_t from, uint32_t to,
+                                       OWNER_T player) {
+    const OWNER_T *up = row - stride;
+    const OWNER_T *down = row + stride;
+    const OWNER_T *left = row - 1;
+    const OWNER_T *right = row + 1;
+    uint64_t count = 0;
+    for (uint32_t j = from; j < to; ++j)
+        count += (row[j] == EMPTY) &
+                 ((up[j] == player) | (down[j] == player) |
+                  (left[j] == player) | (right[j] == player));
+    return count;
+}
+
+/**
+ * Funkcja pomocnicza licząca puste pola w wierszach od @p from do @p to (bez
+ * niego), które sąsiadują z polem gracza @p player.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param from - Pierwszy wiersz.
+ * @param to - Wiersz za ostatnim.
+ * @return Liczba pustych pól sąsiadujących z polami gracza.
+ */
+static uint64_t KERNEL(frontier_rows)(gamma_t *g, uint32_t player,
+                                      uint32_t from, uint32_t to) {
+    const OWNER_T *owners = g->owners;
+    uint64_t free_count = 0;
+
+    for (uint32_t i = from; i < to; ++i)
+        free_count += KERNEL(frontier_cells)(owners + cell_index(g, 0, i),
+                                             row_stride(g), 0, g->width,
+                                             (OWNER_T) player);
+    return free_count;
+}
+
+#ifdef GAMMA_AVX2
+/**
+ * Wersja funkcji frontier_rows dla procesorów z rozkazami AVX2. Porównuje
+ * naraz 32 bajty wiersza z numerem gracza i z EMPTY, łączy wyniki dla wiersza
+ * wyżej, wiersza niżej i wiersza przesuniętego o jedno pole w obie strony,
+ * a pasujące pola liczy rozkazem popcnt. Końcówkę wiersza krótszą od wektora
+ * liczy wersja skalarna.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param from - Pierwszy wiersz.
+ * @param to - Wiersz za ostatnim.
+ * @return Liczba pustych pól sąsiadujących z polami gracza.
+ */
+__attribute__((target("avx2,popcnt")))
+static uint64_t KERNEL(frontier_rows_avx2)(gamma_t *g, uint32_t player,
+                                           uint32_t from, uint32_t to) {
+    const OWNER_T *owners = g->owners;
+    const uint32_t lanes = sizeof(__m256i) / sizeof(OWNER_T);
+    const size_t stride = row_stride(g);
+    const __m256i mine = VEC_SET1((OWNER_T) player);
+    const __m256i empty = _mm256_setzero_si256();
+    uint64_t matched_bytes = 0;
+    uint64_t free_count = 0;
+
+    for (uint32_t i = from; i < to; ++i) {
+        const OWNER_T *row = owners + cell_index(g, 0, i);
+        const OWNER_T *up = row - stride;
+        const OWNER_T *down = row + stride;
+        const OWNER_T *left = row - 1;
+        const OWNER_T *right = row + 1;
+        uint32_t j = 0;
+        for (; j + lanes <= g->width; j += lanes) {
+            __m256i cell = _mm256_loadu_si256((const __m256i*) (row + j));
+            __m256i vertical = _mm256_or_si256(
+                VEC_CMPEQ(_mm256_loadu_si256((const __m256i*) (up + j)), mine),
+                VEC_CMPEQ(_mm256_loadu_si256((const __m256i*) (down + j)),
+                          mine));
+            __m256i horizontal = _mm256_or_si256(
+                VEC_CMPEQ(_mm256_loadu_si256((const __m256i*) (left + j)),
+                          mine),
+                VEC_CMPEQ(_mm256_loadu_si256((const __m256i*) (right + j)),
+                          mine));
+            __m256i hit = _mm256_and_si256(
+                VEC_CMPEQ(cell, empty),
+                _mm256_or_si256(vertical, horizontal));
+            matched_bytes += __builtin_popcount(
+                (uint32_t) _mm256_movemask_epi8(hit));
+        }
+        free_count += KERNEL(frontier_cells)(row, stride, j, g->width,
+                                             (OWNER_T) player);
+    }
+    return free_count + matched_bytes / sizeof(OWNER_T);
+}
+#endif
+
+/**
+ * Zadanie liczące pola brzegowe gracza w jednym pasie wierszy.
+ * @param arg - Wskaźnik na stan przeglądu (@ref band_job_t).
+ * @param band - Numer pasa.
+ */
+static void KERNEL(frontier_band)(void *arg, uint32_t band) {
+    band_job_t *job = arg;
+    uint32_t from, to;
+    band_rows(job, band, &from, &to);
+#ifdef GAMMA_AVX2
+    if (job->g->use_avx2) {
+        job->count[band] = KERNEL(frontier_rows_avx2)(job->g, job->player,
+                                                      from, to);
+        return;
+    }
+#endif
+    job->count[band] = KERNEL(frontier_rows)(job->g, job->player, from, to);
+}
+
+/**
+ * Pomocnicza funkcja sprawdzająca ilość miejsc, w której gracz @p player może
+ * postawić pionka jeśli @p player ma maksymalną ilość obszarów. Sprawdzenie
+ * przebiega w sposób brutalny sprawdzając każde pole na planszy, czy jest
+ * możliwe do postawienia pionka na nim.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, który ma maksymalną ilość obszarów.
+ * @return Ilość obszarów, na które @p player może jeszcze postawić pionka,
+ * która jest liczbą nieujemną.
+ */
+static uint64_t KERNEL(free_fields_full_areas)(gamma_t *g, uint32_t player) {
+    band_job_t job;
+    band_job_init(&job, g, player);
+    run_bands(&job, KERNEL(frontier_band));
+
+    uint64_t free_count = 0;
+    for (uint32_t band = 0; band < job.bands; ++band)
+        free_count += job.count[band];
+    STATS_ADD(g, cells_scanned, (uint64_t) g->width * g->height);
+    return free_count;
+}
+
+/**
+ * Funkcja pomocnicza usuwająca wszystkie obszary gracza @p player i
+ * ustawiająca ilość jego obszarów i pól na wartość 0. Drzewa reprezentantów
+ * pól gracza buduje od nowa KERNEL(golden_set_other_field_reps).
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, którego chcemy 'zresetować'.
+ */
+static void KERNEL(golden_reset_field_reps)(gamma_t *g, uint32_t player) {
+    root_list_t *roots = &(g->player_roots[player]);
+    while (roots->first != NO_AREA) {
+        uint32_t area = roots->first;
+        root_list_remove(g->area_slots, roots, area);
+        free_area(g, area);
+    }
+    g->player_areas[player] = 0;
+    g->player_fields[player] = 0;
+}
+
+/**
+ * Zadanie budujące obszary gracza w jednym pasie wierszy. Łączy każde pole
+ * gracza z lewym i górnym sąsiadem z tego samego pasa; obszary przecinające
+ * granice pasów łączy potem KERNEL(golden_set_other_field_reps). Obszary
+ * pasa zbiera na osobnej liście pasa. Nowe opisy obszarów bierze z końca
+ * tablicy area_slots, a opisy wchłoniętych obszarów odkłada na listę
+ * wolnych opisów pasa i używa ich ponownie. Nie używa liczników
+ * statystyk, bo działa równolegle z innymi pasami.
+ * @param arg - Wskaźnik na stan przeglądu (@ref band_job_t).
+ * @param band - Numer pasa.
+ */
+static void KERNEL(rebuild_band)(void *arg, uint32_t band) {
+    band_job_t *job = arg;
+    gamma_t *g = job->g;
+    const OWNER_T *owners = g->owners;
+    const size_t stride = row_stride(g);
+    const OWNER_T player = (OWNER_T) job->player;
+    field_t *fields = g->fields;
+    area_t *slots = g->area_slots;
+    uint32_t from, to;
+    band_rows(job, band, &from, &to);
+
+    uint64_t fields_count = 0;
+    uint32_t areas = 0;
+    uint32_t spare = NO_AREA;
+    root_list_t *roots = &(job->roots[band]);
+    root_list_init(roots);
+    for (uint32_t i = from; i < to; ++i) {
+        for (uint32_t j = 0; j < g->width; ++j) {
+            size_t index = cell_index(g, j, i);
+            if (owners[index] != player)
+                continue;
+            uint64_t field = field_index(g, j, i);
+            uint32_t area = spare;
+            if (area != NO_AREA)
+                spare = slots[area].next;
+            else
+                area = (uint32_t) atomic_fetch_add_explicit(
+                    &(job->area_count), 1, memory_order_relaxed);
+            ++fields_count;
+            ++areas;
+            reset_area(fields, slots, field, area, player, j, i);
+            root_list_push(slots, roots, area);
+            uint32_t absorbed = NO_AREA;
+            if (owners[index - 1] == player &&
+                (absorbed = unite(fields, slots, field,
+                                  field_index(g, j - 1, i))) != NO_AREA) {
+                --areas;
+                spare_area(slots, roots, absorbed, &spare);
+            }
+            if (i > from && owners[index - stride] == player &&
+                (absorbed = unite(fields, slots, field,
+                                  field_index(g, j, i - 1))) != NO_AREA) {
+                --areas;
+                spare_area(slots, roots, absorbed, &spare);
+            }
+        }
+    }
+    job->count[band] = fields_count;
+    job->areas[band] = areas;
+    job->spare[band] = spare;
+}
+
+/**
+ * Funkcja pomocnicza, która symuluje ciąg ruchów wykonanych przez gracza
+ * @p player. Obszary są budowane niezależnie w pasach wierszy (w jednym,
+ * gdy plansza nie ma puli wątków), a następnie łączone wzdłuż granic pasów.
+ * Opisy obszarów wchłoniętych w pasach są zwalniane przed łączeniem pasów.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, któremu 'zabraliśmy' pola w celu wykonania
+ * złotego ruchu.
+ */
+static void KERNEL(golden_set_other_field_reps)(gamma_t *g, uint32_t player) {
+    const OWNER_T *owners = g->owners;
+    STATS_ADD(g, golden_rebuilds, 1);
+    band_job_t job;
+    band_job_init(&job, g, player);
+    if (job.bands > REBUILD_BANDS)
+        job.bands = REBUILD_BANDS;
+    atomic_init(&(job.area_count), g->area_count);
+    run_bands(&job, KERNEL(rebuild_band));
+    g->area_count = (uint32_t) atomic_load_explicit(&(job.area_count),
+                                                    memory_order_relaxed);
+    uint64_t fields = 0;
+    uint64_t areas = 0;
+    for (uint32_t band = 0; band < job.bands; ++band) {
+        fields += job.count[band];
+        areas += job.areas[band];
+        root_list_append(g->area_slots, &(g->player_roots[player]),
+                         &(job.roots[band]));
+    }
+    for (uint32_t band = 0; band < job.bands; ++band)
+        free_spare_areas(g, job.spare[band]);
+    for (uint32_t band = 1; band < job.bands; ++band) {
+        uint32_t from, to;
+        band_rows(&job, band, &from, &to);
+        for (uint32_t j = 0; j < g->width; ++j) {
+            size_t index = cell_index(g, j, from);
+            size_t up = cell_index(g, j, from - 1);
+            if (owners[index] == player && owners[up] == player) {
+                uint64_t field = field_index(g, j, from);
+                uint64_t above = field_index(g, j, from - 1);
+                if (root(g, field) != root(g, above))
+                    --areas;
+                join(g, player, field, above);
+            }
+        }
+    }
+    g->player_areas[player] += (uint32_t) areas;
+    track_areas(g, player);
+    g->player_fields[player] += fields;
+    STATS_ADD(g, cells_scanned, (uint64_t) g->width * g->height);
+    STATS_ADD(g, golden_rebuilt_cells, fields);
+}
+
+/**
+ * Funkcja pomocnicza wykonująca złoty ruch. Odpowiednik
+ * @ref gamma_golden_move.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Wartość true, jeśli złoty ruch został wykonany, false w p.p.
+ */
+static bool KERNEL(golden_move)(gamma_t *g, uint32_t player,
+                                uint32_t x, uint32_t y) {
+    OWNER_T *owners = g->owners;
+    if (!old_golden_possible(g, player) || !good_coords(g, x, y))
+        return false;
+    size_t index = cell_index(g, x, y);
+    if (owners[index] == EMPTY || owners[index] == player ||
+        g->golden_used[player] == true)
+        return false;
+
+    uint32_t changed_player = owners[index];
+
+    if (g->bits != NULL &&
+        !bits_golden_allowed(g, player, changed_player, x, y))
+        return false;
+
+    KERNEL(golden_reset_field_reps)(g, changed_player);
+    owners[index] = EMPTY;
+    track_owner(g, x, y, changed_player, EMPTY);
+    KERNEL(golden_set_other_field_reps)(g, changed_player);
+
+    if (g->player_areas[changed_player] > g->areas) {
+        KERNEL(place)(g, changed_player, x, y);
+        return false;
+    }
+
+    if (KERNEL(move)(g, player, x, y)) {
+        set_golden_used(g, player, true);
+        return true;
+    }
+
+    KERNEL(place)(g, changed_player, x, y);
+    return false;
+}
+
+/**
+ * Zadanie szukające w jednym pasie wierszy pola, które gracz z maksymalną
+ * liczbą obszarów może zająć złotym ruchem, bez zmieniania planszy. Pole
+ * gracza Q sąsiadujące z graczem nadaje się na pewno, jeśli Q po jego
+ * utracie nie przekroczy limitu nawet wtedy, gdy każdy z k sąsiadów pola
+ * należących do Q znajdzie się w osobnym obszarze, czyli gdy
+ * obszary(Q) - 1 + k <= limit. Pozostałe pola są tylko oznaczane jako
+ * niepewne. Pas kończy pracę, gdy któryś z pasów znalazł już pole.
+ * @param arg - Wskaźnik na stan przeglądu (@ref band_job_t).
+ * @param band - Numer pasa.
+ */
+static void KERNEL(golden_candidates_band)(void *arg, uint32_t band) {
+    band_job_t *job = arg;
+    gamma_t *g = job->g;
+    const OWNER_T *owners = g->owners;
+    const size_t stride = row_stride(g);
+    const OWNER_T player = (OWNER_T) job->player;
+    uint32_t from, to;
+    band_rows(job, band, &from, &to);
+
+    for (uint32_t i = from; i < to; ++i) {
+        if (atomic_load_explicit(&(job->found), memory_order_relaxed))
+            return;
+        for (uint32_t j = 0; j < g->width; ++j) {
+            size_t index = cell_index(g, j, i);
+            OWNER_T owner = owners[index];
+            if (owner == EMPTY || owner == player)
+                continue;
+            const OWNER_T around[] = {owners[index - 1], owners[index + 1],
+                                      owners[index - stride],
+                                      owners[index + stride]};
+            uint32_t mine = 0, same = 0;
+            for (int dir = 0; dir < 4; ++dir) {
+                mine += around[dir] == player;
+                same += around[dir] == owner;
+            }
+            if (mine == 0)
+                continue;
+            if ((uint64_t) g->player_areas[owner] - 1 + same <= g->areas) {
+                atomic_store_explicit(&(job->found), true,
+                                      memory_order_relaxed);
+                return;
+            }
+            job->unsure[band] = true;
+        }
+    }
+}
+
+/**
+ * Funkcja pomocnicza licząca, na ile obszarów rozpadną się sąsiedzi pola
+ * (@p x, @p y) należący do jego właściciela, jeśli pole zostanie
+ * opróżnione. Przeszukuje wszerz obszar pola bez samego pola, nie zmieniając
+ * planszy, więc koszt jest rzędu rozmiaru obszaru.
+ * @param g - Wskaźnik na planszę.
+ * @param search - Pamięć robocza przeszukiwania.
+ * @param x - Numer kolumny zajętego pola.
+ * @param y - Numer wiersza zajętego pola.
+ * @return Liczba od 0 do 4 lub UINT32_MAX, gdy zabrakło pamięci.
+ */
+static uint32_t KERNEL(area_split)(gamma_t *g, split_search_t *search,
+                                   uint32_t x, uint32_t y) {
+    const OWNER_T *owners = g->owners;
+    const OWNER_T owner = owners[cell_index(g, x, y)];
+    uint64_t same[4];
+    uint32_t count = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint32_t nx = x + delta_x[i];
+        uint32_t ny = y + delta_y[i];
+        if (good_coords(g, nx, ny) && owners[cell_index(g, nx, ny)] == owner)
+            same[count++] = (uint64_t) ny * g->width + nx;
+    }
+    if (count <= 1)
+        return count;
+    if (!split_search_start(search, g))
+        return UINT32_MAX;
+
+    uint64_t tail = 0;
+    bool enough_memory = split_search_push(search, &tail,
+                                           (uint64_t) y * g->width + x);
+    uint32_t areas = 0;
+    for (uint32_t i = 0; i < count && enough_memory; ++i) {
+        if (split_search_seen(search, same[i]))
+            continue;
+        ++areas;
+        if (i == count - 1)
+            break;
+        uint64_t head = tail;
+        enough_memory = split_search_push(search, &tail, same[i]);
+        while (head < tail && enough_memory) {
+            uint64_t cell = search->queue[head++];
+            uint32_t cx = (uint32_t) (cell % g->width);
+            uint32_t cy = (uint32_t) (cell / g->width);
+            for (int dir = 0; dir < 4 && enough_memory; ++dir) {
+                uint32_t nx = cx + delta_x[dir];
+                uint32_t ny = cy + delta_y[dir];
+                uint64_t next = (uint64_t) ny * g->width + nx;
+                if (good_coords(g, nx, ny) &&
+                    owners[cell_index(g, nx, ny)] == owner &&
+                    !split_search_seen(search, next))
+                    enough_memory = split_search_push(search, &tail, next);
+            }
+        }
+    }
+    split_search_clear(search, tail);
+    return enough_memory ? areas : UINT32_MAX;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca, czy w przypadku gdy gracz @p player ma
+ * maksymalną liczbę obszarów, to może wykonać gdzieś złoty ruch. Kandydatami
+ * są pola innych graczy sąsiadujące z polami gracza; gdy oszacowanie liczbą
+ * sąsiadów nie wystarcza, przeszukiwany jest obszar pola. Plansza nie jest
+ * zmieniana, więc funkcja może działać pod zamkiem czytelnika.
+ * @param g         - wskaźnik na strukturę planszy do gry gamma
+ * @param player    - gracz pytający o możliwość złotego ruchu
+ * @return          - true, jeśli istnieje pole możliwe do zajęcia złotym ruchem
+ *                    bez przekraczania maksymalnej liczby obszarów; false
+ *                    także wtedy, gdy zabrakło pamięci, z errno ustawionym na
+ *                    ENOMEM.
+ */
+static bool KERNEL(golden_wont_exceed_areas)(gamma_t *g, uint32_t player) {
+    const OWNER_T *owners = g->owners;
+    uint32_t width = g->width;
+    uint32_t height = g->height;
+
+    band_job_t job;
+    band_job_init(&job, g, player);
+    if (job.bands > 1) {
+        run_bands(&job, KERNEL(golden_candidates_band));
+        STATS_ADD(g, cells_scanned, (uint64_t) width * height);
+        if (atomic_load(&(job.found)))
+            return true;
+        bool unsure = false;
+        for (uint32_t band = 0; band < job.bands; ++band)
+            unsure |= job.unsure[band];
+        if (!unsure)
+            return false;
+    }
+
+    split_search_t search = SPLIT_SEARCH_INIT;
+    bool wont_exceed_max_areas = false;
+    bool enough_memory = true;
+    for (uint32_t i = 0; i < height && !wont_exceed_max_areas &&
+                         enough_memory; ++i) {
+        for (uint32_t j = 0; j < width && !wont_exceed_max_areas &&
+                             enough_memory; ++j) {
+            STATS_ADD(g, cells_scanned, 1);
+            uint32_t field_owner = owners[cell_index(g, j, i)];
+            if (field_owner == player || field_owner == EMPTY)
+                continue;
+
+            uint32_t mine = 0, same = 0;
+            for (int dir = 0; dir < 4; ++dir) {
+                uint32_t nx = j + delta_x[dir];
+                uint32_t ny = i + delta_y[dir];
+                if (!good_coords(g, nx, ny))
+                    continue;
+                uint32_t owner = owners[cell_index(g, nx, ny)];
+                mine += owner == player;
+                same += owner == field_owner;
+            }
+            if (mine == 0)
+                continue;
+            uint64_t left = (uint64_t) g->player_areas[field_owner] - 1;
+            if (left + same > g->areas)
+                same = KERNEL(area_split)(g, &search, j, i);
+            enough_memory = same != UINT32_MAX;
+            wont_exceed_max_areas = enough_memory && left + same <= g->areas;
+        }
+    }
+    split_search_free(&search);
+    if (!enough_memory)
+        errno = ENOMEM;
+    return wont_exceed_max_areas;
+}
+
+/**
+ * Funkcja pomocnicza uzupełniająca wiersze napisu @p board od @p from do
+ * @p to (bez niego) w przypadku, gdy liczba graczy > 9. Wiersze napisu są
+ * numerowane od góry, a każdy ma tę samą długość, więc pozycja wiersza nie
+ * zależy od pozostałych wierszy.
+ * @param g - Wskaźnik na planszę do gry gamma.
+ * @param board - Dynamicznie zaalokowany string.
+ * @param size - Liczba cyfr liczby graczy.
+ * @param from - Pierwszy wiersz napisu.
+ * @param to - Wiersz napisu za ostatnim.
+ */
+static void KERNEL(print_many_rows)(gamma_t *g, char *board, uint32_t size,
+                                    uint32_t from, uint32_t to) {
+    const OWNER_T *owners = g->owners;
+    char format_empty[] = {'%', size + 1 + '0', 'c', '\0'};
+    char format_empty9[] = "%10c";
+    char format_empty10[] = "%11c";
+    char format[] = {'%', size + 1 + '0', 'u', '\0'};
+    char format9[] = "%10u";
+    char format10[] = "%11u";
+    uint64_t position = (uint64_t) from * ((uint64_t) g->width * (size + 1) + 1);
+
+    for (uint32_t i = from; i < to; ++i) {
+        for (uint32_t j = 0; j < g->width; ++j) {
+            uint32_t player = owners[cell_index(g, j, g->height - 1 - i)];
+            if (size < 9) {
+                if (player == EMPTY)
+                    sprintf(board + position, format_empty, '.');
+                else
+                    sprintf(board + position, format, player);
+            }
+            else if (size == 9) {
+                if (player == EMPTY)
+                    sprintf(board + position, format_empty9, '.');
+                else
+                    sprintf(board + position, format9, player);
+            }
+            else {
+                if (player == EMPTY)
+                    sprintf(board + position, format_empty10, '.');
+                else
+                    sprintf(board + position, format10, player);
+            }
+
+            position += size + 1;
+        }
+        board[position] = '\n';
+        ++position;
+    }
+}
+
+/**
+ * Funkcja pomocnicza uzupełniająca wiersze napisu @p board od @p from do
+ * @p to (bez niego), gdy liczba graczy jest mniejsza lub równa 9.
+ * @param g - Wskaźnik na planszę do gry.
+ * @param board - Dynamicznie zaalokowany string.
+ * @param from - Pierwszy wiersz napisu.
+ * @param to - Wiersz napisu za ostatnim.
+ */
+static void KERNEL(print_little_rows)(gamma_t *g, char *board,
+                                      uint32_t from, uint32_t to) {
+    uint32_t width = g->width;
+    char *line = board + (uint64_t) from * ((uint64_t) width + 1);
+    for (uint32_t i = from; i < to; ++i) {
+        const OWNER_T *row = g->owners + cell_index(g, 0, g->height - 1 - i);
+        for (uint32_t j = 0; j < width; ++j)
+            line[j] = row[j] != EMPTY ? (char) (row[j] + '0') : '.';
+        line[width] = '\n';
+        line += (uint64_t) width + 1;
+    }
+}
+
+/**
+ * Zadanie uzupełniające napis planszy dla jednego pasa wierszy.
+ * @param arg - Wskaźnik na stan przeglądu (@ref band_job_t).
+ * @param band - Numer pasa.
+ */
+static void KERNEL(print_band)(void *arg, uint32_t band) {
+    band_job_t *job = arg;
+    uint32_t from, to;
+    band_rows(job, band, &from, &to);
+    if (job->size > 1)
+        KERNEL(print_many_rows)(job->g, job->board, job->size, from, to);
+    else
+        KERNEL(print_little_rows)(job->g, job->board, from, to);
+}
+
+/**
+ * Funkcja pomocnicza uzupełniająca string @p board opisem planszy.
+ * @param g - Wskaźnik na planszę do gry gamma.
+ * @param board - Dynamicznie zaalokowany string.
+ * @param size - Liczba cyfr liczby graczy.
+ * @param position - Pozycja aktualnego znaku.
+ */
+static void KERNEL(print_players)(gamma_t *g, char *board, uint32_t size,
+                                  uint64_t *position) {
+    band_job_t job;
+    band_job_init(&job, g, EMPTY);
+    job.board = board;
+    job.size = size;
+    run_bands(&job, KERNEL(print_band));
+
+    uint64_t cell = size > 1 ? size + 1 : 1;
+    *position += (uint64_t) g->height * ((uint64_t) g->width * cell + 1);
+    board[*position] = '\0';
+}
+
+/**
+ * Funkcja pomocnicza wypisująca planszę na stdout dla <= 9 graczy. Nie
+ * obsługuje planszy @p g = NULL.
+ * Podswietla pole wyznaczone przez współrzędne (x,y).
+ * @param g     - wskaźnik na strukturę przechowującą grę.
+ * @param x     - współrzędna pola do wyróżnienia.
+ * @param y     - współrzdna pola do wyróżnienia.
+ */
+static void KERNEL(print_little)(gamma_t *g, uint32_t x, uint32_t y) {
+    const OWNER_T *owners = g->owners;
+    for (uint32_t i = 0; i < g->height; ++i) {
+        for (uint32_t j = 0; j < g->width; ++j) {
+            OWNER_T owner = owners[cell_index(g, j, g->height - 1 - i)];
+            if (i == y && j == x)
+                printf("\033[44m");
+            printf("%c", owner != EMPTY ? (char) (owner + '0') : '.');
+            if (i == y && j == x)
+                printf("\033[0m");
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Funkcja pomocnicza wypisująca planszę na stdout dla > 9 graczy. Nie obsługuje
+ * planszy @p g = NULL.
+ * Podswietla pole wyznaczone przez współrzędne (x,y).
+ * @param size  - szerokość tekstowej reprezentacji gracza.
+ * @param g     - wskaźnik na strukturę przechowującą grę.
+ * @param x     - współrzędna pola do wyróżnienia.
+ * @param y     - współrzdna pola do wyróżnienia.
+ */
+static void KERNEL(print_big)(gamma_t *g, uint32_t size,
+                              uint32_t x, uint32_t y) {
+    const OWNER_T *owners = g->owners;
+    for (uint32_t i = 0; i < g->height; ++i) {
+        for (uint32_t j = 0; j < g->width; ++j) {
+            uint32_t player = owners[cell_index(g, j, g->height - 1 - i)];
+            if (i == y && j == x)
+                printf("\033[45m");
+            if (player == EMPTY)
+                printf("%*c", size + 1, '.');
+            else
+                printf("%*d", size + 1, player);
+            if (i == y && j == x)
+                printf("\033[0m");
+
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Zadanie przepisujące właścicieli pól pasa wierszy do etykiet przeglądu
+ * wszerz i dopisujące do kolejki pola zajęte, które sąsiadują z pustymi.
+ * @param arg - Wskaźnik na stan przeglądu (@ref territory_job_t).
+ * @param band - Numer pasa.
+ */
+static void KERNEL(territory_band)(void *arg, uint32_t band) {
+    territory_job_t *job = arg;
+    gamma_t *g = job->g;
+    const OWNER_T *owners = g->owners;
+    size_t stride = row_stride(g);
+    uint32_t from = (uint32_t) ((uint64_t) g->height * band / job->bands);
+    uint32_t to = (uint32_t) ((uint64_t) g->height * (band + 1) / job->bands);
+    territory_buffer_t buffer;
+    buffer.count = 0;
+
+    for (uint32_t y = from; y < to; ++y) {
+        const OWNER_T *row = owners + cell_index(g, 0, y);
+        uint32_t *labels = job->labels + (size_t) y * g->width;
+        for (uint32_t x = 0; x < g->width; ++x) {
+            const OWNER_T *cell = row + x;
+            labels[x] = *cell;
+            if (*cell != EMPTY &&
+                (cell[-1] == EMPTY || cell[1] == EMPTY ||
+                 *(cell - stride) == EMPTY || cell[stride] == EMPTY))
+                territory_push(job, &buffer,
+                               (uint32_t) ((size_t) y * g->width + x));
+        }
+    }
+    territory_flush(job, &buffer);
+}
+
+/**
+ * Funkcja przygotowująca przegląd wszerz dla @ref gamma_territory: etykiety
+ * wszystkich pól i pierwszy poziom kolejki, na wątkach puli planszy, gdy
+ * pasów jest więcej niż jeden.
+ * @param job - Wskaźnik na stan przeglądu.
+ */
+static void KERNEL(territory_sources)(territory_job_t *job) {
+    if (job->bands == 1)
+        KERNEL(territory_band)(job, 0);
+    else
+        thread_pool_run(job->g->pool, job->bands, KERNEL(territory_band), job);
+}
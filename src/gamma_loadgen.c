@@ -0,0 +1,340 @@
+/** @file
+ * Generator obciążenia serwera gier (gamma -s gniazdo). Otwiera wiele
+ * połączeń naraz, w każdym zakłada grę nagłówkiem trybu wsadowego, a potem
+ * wysyła losowe ruchy, złote ruchy i zapytania o liczniki graczy. Każde
+ * połączenie ma w danej chwili jedno polecenie bez odpowiedzi, a wszystkie
+ * połączenia obsługuje jedna pętla epoll. Na koniec wypisuje liczbę
+ * poleceń na sekundę i percentyle czasu od wysłania polecenia do odebrania
+ * odpowiedzi.
+ *
+ * Użycie: gamma_loadgen -s gniazdo [-c połączenia] [-n polecenia]
+ *                       [-w szerokość] [-h wysokość] [-p gracze]
+ *                       [-a obszary] [-S ziarno]
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do getopt i clock_gettime.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_CONNECTIONS 1000 ///< Domyślna liczba połączeń.
+#define DEFAULT_REQUESTS 1000 ///< Domyślna liczba poleceń na połączenie.
+#define DEFAULT_SIDE 32 ///< Domyślny bok planszy.
+#define DEFAULT_PLAYERS 4 ///< Domyślna liczba graczy.
+#define DEFAULT_AREAS 8 ///< Domyślna maksymalna liczba obszarów.
+#define MAX_EVENTS 256 ///< Liczba zdarzeń odbieranych naraz.
+#define REQUEST_SIZE 96 ///< Miejsce na jeden wiersz polecenia.
+#define RECEIVE_SIZE 4096 ///< Rozmiar bufora odbieranych odpowiedzi.
+#define PERCENT 100 ///< Zakres losowania rodzaju polecenia.
+#define MOVE_SHARE 60 ///< Procent ruchów wśród poleceń.
+#define GOLDEN_SHARE 70 ///< Procent ruchów i złotych ruchów.
+#define BUSY_SHARE 80 ///< Jak wyżej, razem z poleceniami b.
+#define FREE_SHARE 90 ///< Jak wyżej, razem z poleceniami f.
+
+/**
+ * Stan jednego połączenia.
+ */
+typedef struct client {
+    int fd; ///< Gniazdo połączenia.
+    uint64_t sent_at; ///< Czas wysłania polecenia czekającego na odpowiedź.
+    uint64_t remaining; ///< Liczba poleceń do wysłania.
+    bool header; ///< Czy czekamy na odpowiedź na nagłówek.
+    bool line_start; ///< Czy następny odebrany znak zaczyna wiersz.
+} client_t;
+
+/** Stan generatora liczb pseudolosowych. */
+static uint64_t rng_state;
+
+/**
+ * Generator xorshift64*.
+ * @return Kolejna liczba pseudolosowa.
+ */
+static uint64_t rng_next() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+/**
+ * Podaje aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Porównuje dwa czasy dla qsort.
+ * @param a - Wskaźnik na pierwszy czas.
+ * @param b - Wskaźnik na drugi czas.
+ * @return Wynik porównania.
+ */
+static int compare_times(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Wysyła cały wiersz do gniazda.
+ * @param fd - Gniazdo.
+ * @param text - Wiersz.
+ * @param length - Długość wiersza.
+ * @return Wartość false, gdy wysyłanie się nie udało.
+ */
+static bool send_all(int fd, const char *text, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, text, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno != EINTR)
+            return false;
+        if (sent > 0) {
+            text += sent;
+            length -= (size_t) sent;
+        }
+    }
+    return true;
+}
+
+/**
+ * Wysyła losowe polecenie trybu wsadowego.
+ * @param c - Wskaźnik na połączenie.
+ * @param width - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @param players - Liczba graczy.
+ * @return Wartość false, gdy wysyłanie się nie udało.
+ */
+static bool send_request(client_t *c, uint32_t width, uint32_t height,
+                         uint32_t players) {
+    char request[REQUEST_SIZE];
+    uint64_t kind = rng_next() % PERCENT;
+    uint32_t player = 1 + (uint32_t) (rng_next() % players);
+    uint32_t x = (uint32_t) (rng_next() % width);
+    uint32_t y = (uint32_t) (rng_next() % height);
+    int length;
+    if (kind < GOLDEN_SHARE)
+        length = snprintf(request, sizeof(request), "%c %u %u %u\n",
+                          kind < MOVE_SHARE ? 'm' : 'g', player, x, y);
+    else
+        length = snprintf(request, sizeof(request), "%c %u\n",
+                          kind < BUSY_SHARE ? 'b' :
+                          kind < FREE_SHARE ? 'f' : 'q', player);
+    c->sent_at = now();
+    --(c->remaining);
+    return send_all(c->fd, request, (size_t) length);
+}
+
+/**
+ * Podnosi miękki limit otwartych plików do limitu twardego.
+ */
+static void raise_file_limit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+        limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/**
+ * Łączy się z serwerem i ustawia gniazdo jako nieblokujące.
+ * @param address - Adres serwera.
+ * @return Gniazdo lub -1 w razie błędu.
+ */
+static int connect_to(const struct sockaddr_un *address) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (const struct sockaddr*) address, sizeof(*address)) < 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Główna funkcja generatora.
+ * @param argc  - Liczba argumentów.
+ * @param argv  - Argumenty wywołania.
+ * @return 0, gdy wszystkie polecenia dostały odpowiedź, 1 w przeciwnym
+ * wypadku.
+ */
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    uint64_t connections = DEFAULT_CONNECTIONS;
+    uint64_t requests = DEFAULT_REQUESTS;
+    uint64_t width = DEFAULT_SIDE, height = DEFAULT_SIDE;
+    uint64_t players = DEFAULT_PLAYERS, areas = DEFAULT_AREAS;
+    uint64_t seed = 1;
+
+    bool usage = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:n:w:h:p:a:S:")) != -1) {
+        char *end = "";
+        unsigned long long value = 0;
+        if (opt != 's' && opt != '?')
+            value = strtoull(optarg, &end, 10);
+        if (*end != '\0' || (opt != 's' && value == 0) ||
+            (opt != 'n' && opt != 'S' && value > UINT32_MAX))
+            opt = '?';
+        switch (opt) {
+            case 's':
+                path = optarg;
+                break;
+            case 'c':
+                connections = value;
+                break;
+            case 'n':
+                requests = value;
+                break;
+            case 'w':
+                width = value;
+                break;
+            case 'h':
+                height = value;
+                break;
+            case 'p':
+                players = value;
+                break;
+            case 'a':
+                areas = value;
+                break;
+            case 'S':
+                seed = value;
+                break;
+            default:
+                usage = true;
+                break;
+        }
+    }
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (usage || path == NULL || optind != argc ||
+        strlen(path) >= sizeof(address.sun_path) ||
+        requests > UINT64_MAX / connections) {
+        fprintf(stderr, "Usage: %s -s socket [-c connections] [-n requests] "
+                        "[-w width] [-h height] [-p players] [-a areas] "
+                        "[-S seed]\n", argv[0]);
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+    rng_state = seed * 0x9E3779B97F4A7C15ull + 1;
+    raise_file_limit();
+
+    client_t *clients = calloc(connections, sizeof(client_t));
+    uint64_t *latencies = malloc(sizeof(uint64_t) * connections * requests);
+    struct epoll_event *events = malloc(sizeof(struct epoll_event) *
+                                        MAX_EVENTS);
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (clients == NULL || latencies == NULL || events == NULL || epoll < 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    char header[REQUEST_SIZE];
+    int header_length = snprintf(header, sizeof(header), "B %lu %lu %lu %lu\n",
+                                 (unsigned long) width, (unsigned long) height,
+                                 (unsigned long) players,
+                                 (unsigned long) areas);
+    uint64_t start = now();
+    uint64_t open = 0;
+    for (uint64_t i = 0; i < connections; ++i) {
+        client_t *c = &(clients[i]);
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = c};
+        c->fd = connect_to(&address);
+        if (c->fd < 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, c->fd, &event) < 0 ||
+            !send_all(c->fd, header, (size_t) header_length)) {
+            perror(path);
+            return 1;
+        }
+        c->remaining = requests;
+        c->header = true;
+        c->line_start = true;
+        ++open;
+    }
+
+    uint64_t answered = 0, errors = 0;
+    char received[RECEIVE_SIZE];
+    bool failed = false;
+    while (open > 0 && !failed) {
+        int count = epoll_wait(epoll, events, MAX_EVENTS, -1);
+        if (count < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            failed = true;
+        }
+        for (int i = 0; i < count; ++i) {
+            client_t *c = events[i].data.ptr;
+            ssize_t size = recv(c->fd, received, sizeof(received), 0);
+            if (size < 0 && (errno == EAGAIN || errno == EINTR))
+                continue;
+            if (size <= 0) {
+                if (c->remaining > 0 || c->sent_at != 0) {
+                    fprintf(stderr, "Connection closed early\n");
+                    failed = true;
+                }
+                close(c->fd);
+                c->fd = -1;
+                --open;
+                continue;
+            }
+            for (ssize_t j = 0; j < size; ++j) {
+                if (c->line_start && received[j] == 'E')
+                    ++errors;
+                c->line_start = received[j] == '\n';
+                if (!c->line_start)
+                    continue;
+                if (c->header)
+                    c->header = false;
+                else
+                    latencies[answered++] = now() - c->sent_at;
+                c->sent_at = 0;
+                if (c->remaining > 0) {
+                    if (!send_request(c, (uint32_t) width, (uint32_t) height,
+                                      (uint32_t) players))
+                        failed = true;
+                }
+                else {
+                    shutdown(c->fd, SHUT_WR);
+                }
+            }
+        }
+    }
+    double seconds = (double) (now() - start) / 1e9;
+
+    qsort(latencies, answered, sizeof(uint64_t), compare_times);
+    printf("connections %lu requests %lu errors %lu seconds %.3f\n",
+           (unsigned long) connections, (unsigned long) answered,
+           (unsigned long) errors, seconds);
+    printf("requests/s %.0f\n", (double) answered / seconds);
+    if (answered > 0) {
+        static const double percentiles[] = {50, 90, 99, 99.9};
+        printf("latency_us");
+        for (size_t i = 0; i < sizeof(percentiles) / sizeof(double); ++i)
+            printf(" p%g %.1f", percentiles[i],
+                   (double) latencies[(uint64_t) ((double) (answered - 1) *
+                                                  percentiles[i] / 100)] /
+                   1e3);
+        printf(" max %.1f\n", (double) latencies[answered - 1] / 1e3);
+    }
+
+    for (uint64_t i = 0; i < connections; ++i)
+        if (clients[i].fd >= 0)
+            close(clients[i].fd);
+    close(epoll);
+    free(clients);
+    free(latencies);
+    free(events);
+    return failed || answered != connections * requests ? 1 : 0;
+}
@@ -1,14 +1,88 @@
 /**
  * @file
  * Główny plik programu.
+ *
+ * Użycie: gamma [-c gracz]... [-m milisekundy] [-j wątki] [-r]
+ *              [-w plik] [-k ruchy] [-s gniazdo]
+ * Opcja -c oddaje gracza w trybie interaktywnym komputerowi, -m ustawia
+ * czas komputera na jeden ruch, -j liczbę wątków przeszukiwania, a -r
+ * przełącza wątki ze wspólnego drzewa na osobne drzewa łączone w korzeniu.
+ * Opcja -w zapisuje przebieg gry w trybie wsadowym do pliku, a -k ustawia
+ * odstęp między jego punktami kontrolnymi. Opcja -s zamiast czytać grę ze
+ * standardowego wejścia uruchamia serwer gier w trybie wsadowym na podanym
+ * gnieździe domeny uniksowej.
  */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do getopt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include "no_mode.h"
+#include "server.h"
 
 /**
  * Główna funkcja programu.
- * @return 0 w przypadku braku błędów.
+ * @param argc  - Liczba argumentów.
+ * @param argv  - Argumenty wywołania.
+ * @return 0 w przypadku braku błędów, 1 dla niepoprawnych argumentów lub
+ * gdy nie udało się uruchomić serwera.
  */
-int main() {
-    begin_game();
-    return 0;
-}
\ No newline at end of file
+int main(int argc, char *argv[]) {
+    uint32_t *computers = malloc(sizeof(uint32_t) * (argc > 0 ? argc : 1));
+    if (computers == NULL)
+        return 1;
+    interactive_options_t options = {computers, 0, {0}};
+    mcts_default_config(&(options.search));
+    record_options_t record = {NULL, RECORD_DEFAULT_INTERVAL};
+    const char *socket_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:m:j:rw:k:s:")) != -1) {
+        char *end = "";
+        unsigned long value = 0;
+        if (opt == 'c' || opt == 'm' || opt == 'j' || opt == 'k')
+            value = strtoul(optarg, &end, 10);
+        else if (opt == 'r' || opt == 'w' || opt == 's')
+            value = 1;
+        if (*end != '\0' || value == 0 || value > UINT32_MAX)
+            opt = '?';
+        if (opt == 'c') {
+            computers[options.computer_count++] = (uint32_t) value;
+        }
+        else if (opt == 'm') {
+            options.search.budget_ms = (uint32_t) value;
+        }
+        else if (opt == 'j') {
+            options.search.threads = (uint32_t) value;
+        }
+        else if (opt == 'r') {
+            options.search.parallel = MCTS_ROOT_PARALLEL;
+        }
+        else if (opt == 'w') {
+            record.path = optarg;
+        }
+        else if (opt == 'k') {
+            record.interval = (uint32_t) value;
+        }
+        else if (opt == 's') {
+            socket_path = optarg;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-c player]... [-m milliseconds] "
+                            "[-j threads] [-r] [-w record] [-k moves] "
+                            "[-s socket]\n",
+                    argv[0]);
+            free(computers);
+            return 1;
+        }
+    }
+
+    int status = 0;
+    if (socket_path != NULL)
+        status = server_run(socket_path) ? 0 : 1;
+    else
+        begin_game(&options, &record);
+    free(computers);
+    return status;
+}
@@ -0,0 +1,90 @@
+/** @file
+ * Interfejs wzorcowego silnika gry gamma. Jest to zamrożona, brutalna
+ * implementacja, z którą porównywane są wyniki silnika z pliku gamma.h.
+ * Znaczenie parametrów i wyników funkcji jest takie samo jak dla
+ * odpowiadających im funkcji z pliku gamma.h.
+ */
+
+#ifndef GAMMA_REF_H
+#define GAMMA_REF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Struktura przechowująca stan gry silnika wzorcowego.
+ */
+typedef struct gamma_ref gamma_ref_t;
+
+/** @brief Tworzy strukturę przechowującą stan gry.
+ * Odpowiednik funkcji gamma_new.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz, liczba dodatnia.
+ * @return Wskaźnik na utworzoną strukturę lub NULL.
+ */
+gamma_ref_t* gamma_ref_new(uint32_t width, uint32_t height,
+                           uint32_t players, uint32_t areas);
+
+/** @brief Usuwa strukturę przechowującą stan gry.
+ * Odpowiednik funkcji gamma_delete.
+ * @param[in] g       – wskaźnik na usuwaną strukturę.
+ */
+void gamma_ref_delete(gamma_ref_t *g);
+
+/** @brief Wykonuje ruch.
+ * Odpowiednik funkcji gamma_move.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Wartość @p true, jeśli ruch został wykonany, a @p false w p.p.
+ */
+bool gamma_ref_move(gamma_ref_t *g, uint32_t player, uint32_t x, uint32_t y);
+
+/** @brief Wykonuje złoty ruch.
+ * Odpowiednik funkcji gamma_golden_move.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Wartość @p true, jeśli złoty ruch został wykonany, a @p false w p.p.
+ */
+bool gamma_ref_golden_move(gamma_ref_t *g, uint32_t player,
+                           uint32_t x, uint32_t y);
+
+/** @brief Podaje liczbę pól zajętych przez gracza.
+ * Odpowiednik funkcji gamma_busy_fields.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól zajętych przez gracza lub zero.
+ */
+uint64_t gamma_ref_busy_fields(gamma_ref_t *g, uint32_t player);
+
+/** @brief Podaje liczbę pól, jakie jeszcze gracz może zająć.
+ * Odpowiednik funkcji gamma_free_fields.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól, jakie jeszcze może zająć gracz lub zero.
+ */
+uint64_t gamma_ref_free_fields(gamma_ref_t *g, uint32_t player);
+
+/** @brief Sprawdza, czy gracz może wykonać złoty ruch.
+ * Odpowiednik funkcji gamma_golden_possible.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Wartość @p true, jeśli gracz może wykonać złoty ruch,
+ * a @p false w przeciwnym przypadku.
+ */
+bool gamma_ref_golden_possible(gamma_ref_t *g, uint32_t player);
+
+/** @brief Daje napis opisujący stan planszy.
+ * Odpowiednik funkcji gamma_board. Funkcja wywołująca musi zwolnić bufor.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na zaalokowany bufor lub NULL.
+ */
+char* gamma_ref_board(gamma_ref_t *g);
+
+#endif /* GAMMA_REF_H */
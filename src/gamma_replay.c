@@ -0,0 +1,139 @@
+/** @file
+ * Odtwarzanie zapisanych przebiegów gry (zob. record.h). Bez numeru ruchu
+ * program wypisuje parametry przebiegu: planszę, liczbę ruchów i punktów
+ * kontrolnych oraz odstęp między nimi. Z numerem ruchu odtwarza stan gry po
+ * tym ruchu i wypisuje jego skrót, czas odtworzenia i liczby pól graczy;
+ * opcja -b wypisuje dodatkowo planszę, a -o zapisuje stan gry jako migawkę.
+ * Przebieg zapisuje program gamma z opcją -w.
+ *
+ * Użycie: gamma_replay [-b] [-o migawka] przebieg [ruch]
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do getopt i clock_gettime.
+
+#include "gamma.h"
+#include "record.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Podaje aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Wypisuje parametry przebiegu.
+ * @param fd - Deskryptor pliku przebiegu.
+ * @param path - Ścieżka pliku do komunikatu o błędzie.
+ * @return Kod wyjścia programu.
+ */
+static int print_info(int fd, const char *path) {
+    gamma_record_info_t info;
+    if (!gamma_record_info(fd, &info)) {
+        perror(path);
+        return 1;
+    }
+    printf("board %" PRIu32 "x%" PRIu32 " players %" PRIu32
+           " areas %" PRIu32 "\n", info.width, info.height, info.players,
+           info.areas);
+    printf("moves %" PRIu64 " checkpoints %" PRIu64 " interval %" PRIu32 "\n",
+           info.moves, info.checkpoints, info.interval);
+    return 0;
+}
+
+/**
+ * Odtwarza stan gry po ruchu @p move i wypisuje jego opis.
+ * @param fd - Deskryptor pliku przebiegu.
+ * @param path - Ścieżka pliku do komunikatu o błędzie.
+ * @param move - Numer ruchu.
+ * @param board - Czy wypisać planszę.
+ * @param output - Ścieżka pliku migawki albo NULL.
+ * @return Kod wyjścia programu.
+ */
+static int print_move(int fd, const char *path, uint64_t move, bool board,
+                      const char *output) {
+    uint64_t start = now();
+    gamma_t *g = gamma_record_seek(fd, move);
+    uint64_t elapsed = now() - start;
+    if (g == NULL) {
+        perror(path);
+        return 1;
+    }
+    printf("move %" PRIu64 " hash %016" PRIx64 " seek %.3f ms\n", move,
+           gamma_hash(g), elapsed / 1e6);
+    for (uint32_t player = 1; player <= gamma_get_players(g); ++player)
+        printf("player %" PRIu32 " fields %" PRIu64 "\n", player,
+               gamma_busy_fields(g, player));
+    if (board) {
+        char *text = gamma_board(g);
+        if (text != NULL)
+            printf("%s", text);
+        free(text);
+    }
+
+    int result = 0;
+    if (output != NULL) {
+        int out = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0 || !gamma_save(g, out)) {
+            perror(output);
+            result = 1;
+        }
+        if (out >= 0)
+            close(out);
+    }
+    gamma_delete(g);
+    return result;
+}
+
+/**
+ * Główna funkcja programu.
+ * @param argc - Liczba argumentów.
+ * @param argv - Argumenty wywołania.
+ * @return 0 w przypadku sukcesu, 1 w razie błędu.
+ */
+int main(int argc, char *argv[]) {
+    bool board = false;
+    const char *output = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "bo:")) != -1) {
+        if (opt == 'b') {
+            board = true;
+        }
+        else if (opt == 'o') {
+            output = optarg;
+        }
+        else {
+            optind = argc + 1;
+            break;
+        }
+    }
+    char *end = "";
+    unsigned long long move = 0;
+    if (optind + 2 == argc)
+        move = strtoull(argv[optind + 1], &end, 10);
+    if ((optind + 1 != argc && optind + 2 != argc) || *end != '\0') {
+        fprintf(stderr, "Usage: %s [-b] [-o snapshot] record [move]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *path = argv[optind];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    int result = optind + 1 == argc ? print_info(fd, path) :
+                 print_move(fd, path, move, board, output);
+    close(fd);
+    return result;
+}
@@ -0,0 +1,609 @@
+/** @file
+ * Rozgrywki automatyczne między prostymi strategiami. Każda partia ma
+ * własne ziarno wyliczone z ziarna programu i numeru partii, więc wyniki nie
+ * zależą od liczby wątków. Kolejność tur i utrata tury są takie same jak
+ * w trybie interaktywnym (moduł turn). Partie są rozgrywane paczkami na puli
+ * wątków, a wyniki każdej paczki dopisywane do pliku w kolejności partii.
+ * Na koniec program wypisuje liczbę partii i ruchów na sekundę oraz udział
+ * każdego gracza w wygranych.
+ *
+ * Strategie, podawane po opcjach osobno dla kolejnych graczy albo jedna dla
+ * wszystkich (domyślnie gracze nieparzyści grają greedy, a parzyści random):
+ * - random - losowy zwykły ruch;
+ * - greedy - największa przewaga pól nad najsilniejszym przeciwnikiem: złoty
+ *   ruch na pole jedynego lidera, a poza tym zwykły ruch, najchętniej obok
+ *   własnego pola, żeby nie tworzyć nowego obszaru;
+ * - frontier - zwykły ruch dający najwięcej nowych pustych pól sąsiadujących
+ *   z polami gracza.
+ * Gracz bez zwykłego ruchu wykonuje losowy złoty ruch, jeśli może.
+ *
+ * Plik wyników ma po jednym wierszu na partię: numer partii, jej ziarno,
+ * liczbę ruchów, liczbę złotych ruchów, 1 dla partii przerwanej, bo nikt nie
+ * mógł zmienić planszy, oraz liczby pól kolejnych graczy.
+ *
+ * Użycie: gamma_selfplay [-g partie] [-w szerokość] [-h wysokość]
+ *                        [-p gracze] [-a obszary] [-s ziarno] [-j wątki]
+ *                        [-o plik_wyników] [strategia]...
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do getopt i clock_gettime.
+
+#include "gamma.h"
+#include "thread_pool.h"
+#include "turn.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_GAMES 10000 ///< Domyślna liczba partii.
+#define DEFAULT_SIDE 10 ///< Domyślny bok planszy.
+#define DEFAULT_PLAYERS 2 ///< Domyślna liczba graczy.
+#define DEFAULT_AREAS 4 ///< Domyślna maksymalna liczba obszarów.
+#define MAX_PLAYERS 255 ///< Największa liczba graczy.
+#define BATCH 1024 ///< Liczba partii w paczce.
+
+/**
+ * Strategia gracza.
+ */
+typedef enum policy {
+    POLICY_RANDOM, ///< Losowy ruch.
+    POLICY_GREEDY, ///< Największa przewaga pól.
+    POLICY_FRONTIER, ///< Najwięcej pustych pól na granicy.
+    POLICY_COUNT ///< Liczba strategii.
+} policy_t;
+
+/** Nazwy strategii w wierszu poleceń. */
+static const char *policy_names[] = {"random", "greedy", "frontier"};
+
+/**
+ * Wynik jednej partii.
+ */
+typedef struct result {
+    uint64_t seed; ///< Ziarno partii.
+    uint64_t moves; ///< Liczba wykonanych ruchów.
+    uint64_t golden; ///< Liczba złotych ruchów.
+    bool stalled; ///< Czy partia została przerwana.
+} result_t;
+
+/**
+ * Stan jednego wątku.
+ */
+typedef struct worker {
+    gamma_t *g; ///< Plansza rozgrywanej partii.
+    gamma_cell_t *cells; ///< Bufor na ruchy gracza.
+    uint64_t rng; ///< Stan generatora liczb pseudolosowych.
+} worker_t;
+
+/**
+ * Ustawienia i stan wszystkich rozgrywek.
+ */
+typedef struct selfplay {
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t height; ///< Wysokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    uint32_t areas; ///< Maksymalna liczba obszarów.
+    uint64_t seed; ///< Ziarno programu.
+    policy_t seats[MAX_PLAYERS]; ///< Strategie kolejnych graczy.
+    gamma_t *empty; ///< Pusta plansza, z której startuje każda partia.
+    worker_t *workers; ///< Stany wątków.
+    uint64_t first; ///< Numer pierwszej partii paczki.
+    uint64_t count; ///< Liczba partii paczki.
+    atomic_uint_fast64_t next; ///< Numer następnej nierozdanej partii paczki.
+    result_t *results; ///< Wyniki partii paczki.
+    uint64_t *scores; ///< Liczby pól graczy w partiach paczki.
+} selfplay_t;
+
+/**
+ * Generator xorshift64*.
+ * @param state - Wskaźnik na stan generatora.
+ * @return Kolejna liczba pseudolosowa.
+ */
+static uint64_t rng_next(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+/**
+ * Mieszanie splitmix64, którym wyliczamy ziarna partii.
+ * @param x - Wartość wejściowa.
+ * @return Wymieszana wartość.
+ */
+static uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Podaje aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Podaje właściciela pola albo 0 dla pola pustego lub spoza planszy. Koszt
+ * jest rzędu wysokości drzewa reprezentantów pola.
+ * @param s - Wskaźnik na ustawienia.
+ * @param w - Wskaźnik na stan wątku.
+ * @param x - Numer kolumny, być może spoza planszy.
+ * @param y - Numer wiersza, być może spoza planszy.
+ * @return Numer właściciela.
+ */
+static uint32_t owner_at(const selfplay_t *s, const worker_t *w, int64_t x,
+                         int64_t y) {
+    gamma_area_t area;
+    if (x < 0 || y < 0 || x >= s->width || y >= s->height ||
+        !gamma_area_info(w->g, (uint32_t) x, (uint32_t) y, &area))
+        return 0;
+    return area.player;
+}
+
+/**
+ * Sprawdza, czy pole sąsiaduje z polem gracza.
+ * @param s      - Wskaźnik na ustawienia.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param x      - Numer kolumny.
+ * @param y      - Numer wiersza.
+ * @return Wartość true, jeśli któryś sąsiad należy do gracza.
+ */
+static bool touches(const selfplay_t *s, const worker_t *w, uint32_t player,
+                    int64_t x, int64_t y) {
+    return owner_at(s, w, x - 1, y) == player ||
+           owner_at(s, w, x + 1, y) == player ||
+           owner_at(s, w, x, y - 1) == player ||
+           owner_at(s, w, x, y + 1) == player;
+}
+
+/**
+ * Liczy, o ile urośnie zbiór pustych pól sąsiadujących z polami gracza po
+ * jego ruchu na pole (@p x, @p y).
+ * @param s      - Wskaźnik na ustawienia.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param x      - Numer kolumny.
+ * @param y      - Numer wiersza.
+ * @return Przyrost, być może ujemny.
+ */
+static int frontier_gain(const selfplay_t *s, const worker_t *w,
+                         uint32_t player, int64_t x, int64_t y) {
+    static const int dx[] = {-1, 1, 0, 0};
+    static const int dy[] = {0, 0, -1, 1};
+    int gain = touches(s, w, player, x, y) ? -1 : 0;
+    for (int i = 0; i < 4; ++i) {
+        int64_t nx = x + dx[i], ny = y + dy[i];
+        if (nx >= 0 && ny >= 0 && nx < s->width && ny < s->height &&
+            owner_at(s, w, nx, ny) == 0 && !touches(s, w, player, nx, ny))
+            ++gain;
+    }
+    return gain;
+}
+
+/**
+ * Wykonuje losowy złoty ruch gracza, a jeśli @p victim jest różny od 0, to
+ * tylko na pole tego gracza.
+ * @param s      - Wskaźnik na ustawienia.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param victim - Numer gracza, któremu zabieramy pole, lub 0.
+ * @param r      - Wskaźnik na wynik partii.
+ * @return Wartość true, jeśli ruch został wykonany.
+ */
+static bool play_golden(const selfplay_t *s, worker_t *w, uint32_t player,
+                        uint32_t victim, result_t *r) {
+    uint64_t cap = (uint64_t) s->width * s->height;
+    uint64_t count = gamma_golden_targets(w->g, player, w->cells, cap);
+    uint64_t chosen = count, seen = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (victim != 0 && owner_at(s, w, w->cells[i].x, w->cells[i].y) !=
+                           victim)
+            continue;
+        if (rng_next(&(w->rng)) % ++seen == 0)
+            chosen = i;
+    }
+    if (chosen == count)
+        return false;
+    gamma_cell_t c = w->cells[chosen];
+    if (!gamma_golden_move(w->g, player, c.x, c.y))
+        return false;
+    ++(r->moves);
+    ++(r->golden);
+    return true;
+}
+
+/**
+ * Wykonuje zwykły ruch na pole wybrane z listy ruchów gracza.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param cell   - Wybrane pole.
+ * @param r      - Wskaźnik na wynik partii.
+ * @return Wartość true, jeśli ruch został wykonany.
+ */
+static bool play_move(worker_t *w, uint32_t player, gamma_cell_t cell,
+                      result_t *r) {
+    if (!gamma_move(w->g, player, cell.x, cell.y))
+        return false;
+    ++(r->moves);
+    return true;
+}
+
+/**
+ * Wykonuje ruch strategii greedy.
+ * @param s      - Wskaźnik na ustawienia.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param r      - Wskaźnik na wynik partii.
+ * @return Wartość true, jeśli gracz wykonał ruch.
+ */
+static bool play_greedy(const selfplay_t *s, worker_t *w, uint32_t player,
+                        result_t *r) {
+    uint64_t own = gamma_busy_fields(w->g, player);
+    uint64_t best = 0;
+    uint32_t leader = 0, leaders = 0;
+    for (uint32_t i = 1; i <= s->players; ++i) {
+        if (i == player)
+            continue;
+        uint64_t busy = gamma_busy_fields(w->g, i);
+        if (busy > best || leaders == 0) {
+            best = busy;
+            leader = i;
+            leaders = 1;
+        }
+        else if (busy == best) {
+            ++leaders;
+        }
+    }
+    if (leaders == 1 && best > 0 && best >= own &&
+        play_golden(s, w, player, leader, r))
+        return true;
+
+    uint64_t cap = (uint64_t) s->width * s->height;
+    uint64_t count = gamma_legal_moves(w->g, player, w->cells, cap);
+    if (count == 0)
+        return play_golden(s, w, player, 0, r);
+    uint64_t chosen = 0, seen = 0;
+    bool joined = false;
+    for (uint64_t i = 0; i < count; ++i) {
+        bool joins = touches(s, w, player, w->cells[i].x, w->cells[i].y);
+        if (joins && !joined) {
+            joined = true;
+            seen = 0;
+        }
+        if (joins == joined && rng_next(&(w->rng)) % ++seen == 0)
+            chosen = i;
+    }
+    return play_move(w, player, w->cells[chosen], r);
+}
+
+/**
+ * Wykonuje ruch strategii frontier.
+ * @param s      - Wskaźnik na ustawienia.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param r      - Wskaźnik na wynik partii.
+ * @return Wartość true, jeśli gracz wykonał ruch.
+ */
+static bool play_frontier(const selfplay_t *s, worker_t *w, uint32_t player,
+                          result_t *r) {
+    uint64_t cap = (uint64_t) s->width * s->height;
+    uint64_t count = gamma_legal_moves(w->g, player, w->cells, cap);
+    if (count == 0)
+        return play_golden(s, w, player, 0, r);
+    uint64_t chosen = 0, seen = 0;
+    int best = -5;
+    for (uint64_t i = 0; i < count; ++i) {
+        int gain = frontier_gain(s, w, player, w->cells[i].x, w->cells[i].y);
+        if (gain > best) {
+            best = gain;
+            seen = 0;
+        }
+        if (gain == best && rng_next(&(w->rng)) % ++seen == 0)
+            chosen = i;
+    }
+    return play_move(w, player, w->cells[chosen], r);
+}
+
+/**
+ * Wykonuje ruch gracza według jego strategii.
+ * @param s      - Wskaźnik na ustawienia.
+ * @param w      - Wskaźnik na stan wątku.
+ * @param player - Numer gracza.
+ * @param r      - Wskaźnik na wynik partii.
+ * @return Wartość true, jeśli gracz wykonał ruch.
+ */
+static bool play(const selfplay_t *s, worker_t *w, uint32_t player,
+                 result_t *r) {
+    switch (s->seats[player - 1]) {
+        case POLICY_GREEDY:
+            return play_greedy(s, w, player, r);
+        case POLICY_FRONTIER:
+            return play_frontier(s, w, player, r);
+        default:
+            if (!gamma_random_move(w->g, player, &(w->rng)))
+                return play_golden(s, w, player, 0, r);
+            ++(r->moves);
+            return true;
+    }
+}
+
+/**
+ * Rozgrywa jedną partię od pustej planszy.
+ * @param s     - Wskaźnik na ustawienia.
+ * @param w     - Wskaźnik na stan wątku.
+ * @param game  - Numer partii.
+ * @param r     - Wskaźnik, pod który zapisujemy wynik.
+ * @param busy  - Tablica, do której zapisujemy liczby pól graczy.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool play_game(const selfplay_t *s, worker_t *w, uint64_t game,
+                      result_t *r, uint64_t *busy) {
+    if (!gamma_copy(w->g, s->empty))
+        return false;
+    r->seed = mix(s->seed ^ mix(game));
+    r->moves = 0;
+    r->golden = 0;
+    r->stalled = false;
+    w->rng = r->seed | 1;
+
+    turn_t turn;
+    turn_reset(&turn);
+    uint32_t idle = 0;
+    while (!turn_game_over(&turn, w->g)) {
+        if (!turn_begin(&turn, w->g))
+            continue;
+        if (play(s, w, turn.player, r)) {
+            idle = 0;
+        }
+        else if (++idle == s->players) {
+            // Nikt nie może zmienić planszy, choć formalnie ma złoty ruch.
+            r->stalled = true;
+            break;
+        }
+        turn_end(&turn, w->g);
+    }
+    for (uint32_t i = 1; i <= s->players; ++i)
+        busy[i - 1] = gamma_busy_fields(w->g, i);
+    return true;
+}
+
+/**
+ * Zadanie puli wątków: rozgrywa kolejne nierozdane partie paczki.
+ * @param arg  - Wskaźnik na ustawienia i stan rozgrywek.
+ * @param task - Numer wątku.
+ */
+static void play_task(void *arg, uint32_t task) {
+    selfplay_t *s = arg;
+    worker_t *w = &(s->workers[task]);
+    uint64_t i;
+    while ((i = atomic_fetch_add_explicit(&(s->next), 1,
+                                          memory_order_relaxed)) < s->count) {
+        if (!play_game(s, w, s->first + i, &(s->results[i]),
+                       &(s->scores[i * s->players])))
+            s->results[i].moves = UINT64_MAX;
+    }
+}
+
+/**
+ * Dopisuje wyniki paczki do pliku i do udziałów graczy w wygranych.
+ * @param s      - Wskaźnik na ustawienia i stan rozgrywek.
+ * @param out    - Plik wyników lub NULL.
+ * @param wins   - Udziały graczy w wygranych.
+ * @param moves  - Wskaźnik na łączną liczbę ruchów.
+ * @return Wartość false, gdy którejś partii zabrakło pamięci.
+ */
+static bool collect(const selfplay_t *s, FILE *out, double *wins,
+                    uint64_t *moves) {
+    for (uint64_t i = 0; i < s->count; ++i) {
+        const result_t *r = &(s->results[i]);
+        const uint64_t *busy = &(s->scores[i * s->players]);
+        if (r->moves == UINT64_MAX)
+            return false;
+        *moves += r->moves;
+        uint64_t best = 0;
+        uint32_t winners = 0;
+        for (uint32_t p = 0; p < s->players; ++p) {
+            if (busy[p] > best) {
+                best = busy[p];
+                winners = 1;
+            }
+            else if (busy[p] == best) {
+                ++winners;
+            }
+        }
+        for (uint32_t p = 0; p < s->players; ++p)
+            if (busy[p] == best)
+                wins[p] += 1.0 / winners;
+        if (out != NULL) {
+            fprintf(out, "%lu %lu %lu %lu %d", s->first + i, r->seed,
+                    r->moves, r->golden, r->stalled);
+            for (uint32_t p = 0; p < s->players; ++p)
+                fprintf(out, " %lu", busy[p]);
+            fputc('\n', out);
+        }
+    }
+    return true;
+}
+
+/**
+ * Rozgrywa wszystkie partie i wypisuje podsumowanie.
+ * @param s       - Wskaźnik na ustawienia.
+ * @param games   - Liczba partii.
+ * @param threads - Liczba wątków.
+ * @param out     - Plik wyników lub NULL.
+ * @return 0, gdy wszystko się udało, 1 w przeciwnym wypadku.
+ */
+static int run(selfplay_t *s, uint64_t games, uint32_t threads, FILE *out) {
+    int status = 1;
+    uint64_t cells = (uint64_t) s->width * s->height;
+    thread_pool_t *pool = threads > 1 ? thread_pool_new(threads) : NULL;
+    s->empty = gamma_new(s->width, s->height, s->players, s->areas);
+    s->workers = calloc(threads, sizeof(worker_t));
+    s->results = malloc(sizeof(result_t) * BATCH);
+    s->scores = malloc(sizeof(uint64_t) * BATCH * s->players);
+    double *wins = calloc(s->players, sizeof(double));
+    bool ready = (threads == 1 || pool != NULL) && s->empty != NULL &&
+                 s->workers != NULL && s->results != NULL &&
+                 s->scores != NULL && wins != NULL;
+    for (uint32_t i = 0; ready && i < threads; ++i) {
+        s->workers[i].g = gamma_clone(s->empty);
+        s->workers[i].cells = malloc(sizeof(gamma_cell_t) * cells);
+        ready = s->workers[i].g != NULL && s->workers[i].cells != NULL;
+    }
+
+    if (!ready) {
+        fprintf(stderr, "Cannot start %u threads\n", threads);
+    }
+    else {
+        if (out != NULL) {
+            fprintf(out, "# %ux%u players %u areas %u seed %lu policies",
+                    s->width, s->height, s->players, s->areas, s->seed);
+            for (uint32_t p = 0; p < s->players; ++p)
+                fprintf(out, " %s", policy_names[s->seats[p]]);
+            fprintf(out, "\n# game seed moves golden stalled busy...\n");
+        }
+        uint64_t moves = 0;
+        uint64_t start = now();
+        status = 0;
+        for (s->first = 0; s->first < games && status == 0;
+             s->first += s->count) {
+            s->count = games - s->first < BATCH ? games - s->first : BATCH;
+            atomic_store_explicit(&(s->next), 0, memory_order_relaxed);
+            if (pool != NULL)
+                thread_pool_run(pool, threads, play_task, s);
+            else
+                play_task(s, 0);
+            if (!collect(s, out, wins, &moves)) {
+                fprintf(stderr, "Out of memory\n");
+                status = 1;
+            }
+        }
+        double seconds = (now() - start) / 1e9;
+        if (status == 0) {
+            printf("%ux%u, %u players, %u areas, %u threads: %lu games, "
+                   "%lu moves in %.3f s\n", s->width, s->height, s->players,
+                   s->areas, threads, games, moves, seconds);
+            printf("%.0f games/s, %.0f moves/s\n",
+                   seconds > 0 ? games / seconds : 0.0,
+                   seconds > 0 ? moves / seconds : 0.0);
+            printf("%-8s %-10s %s\n", "player", "policy", "wins");
+            for (uint32_t p = 0; p < s->players; ++p)
+                printf("%-8u %-10s %.4f\n", p + 1, policy_names[s->seats[p]],
+                       wins[p] / games);
+        }
+    }
+
+    for (uint32_t i = 0; s->workers != NULL && i < threads; ++i) {
+        gamma_delete(s->workers[i].g);
+        free(s->workers[i].cells);
+    }
+    free(s->workers);
+    free(s->results);
+    free(s->scores);
+    free(wins);
+    gamma_delete(s->empty);
+    thread_pool_delete(pool);
+    return status;
+}
+
+/**
+ * Podaje strategię o danej nazwie.
+ * @param name   - Nazwa strategii.
+ * @param policy - Wskaźnik, pod który zapisujemy strategię.
+ * @return Wartość false, jeśli nie ma takiej strategii.
+ */
+static bool parse_policy(const char *name, policy_t *policy) {
+    for (int i = 0; i < POLICY_COUNT; ++i) {
+        if (strcmp(name, policy_names[i]) == 0) {
+            *policy = (policy_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Główna funkcja programu.
+ * @param argc  - Liczba argumentów.
+ * @param argv  - Argumenty wywołania.
+ * @return 0, gdy wszystkie partie zostały rozegrane, 1 w przeciwnym wypadku.
+ */
+int main(int argc, char *argv[]) {
+    selfplay_t s = {0};
+    s.width = DEFAULT_SIDE;
+    s.height = DEFAULT_SIDE;
+    s.players = DEFAULT_PLAYERS;
+    s.areas = DEFAULT_AREAS;
+    s.seed = 1;
+    uint64_t games = DEFAULT_GAMES;
+    uint32_t threads = 1;
+    const char *path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:w:h:p:a:s:j:o:")) != -1) {
+        unsigned long value = opt != '?' && opt != 'o' ?
+                              strtoul(optarg, NULL, 10) : 0;
+        switch (opt) {
+            case 'g': games = value; break;
+            case 'w': s.width = value; break;
+            case 'h': s.height = value; break;
+            case 'p': s.players = value; break;
+            case 'a': s.areas = value; break;
+            case 's': s.seed = value; break;
+            case 'j': threads = value; break;
+            case 'o': path = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-g games] [-w width] [-h height] "
+                                "[-p players] [-a areas] [-s seed] "
+                                "[-j threads] [-o results] [policy]...\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (games == 0 || s.width == 0 || s.height == 0 || s.players == 0 ||
+        s.areas == 0 || threads == 0) {
+        fprintf(stderr, "Parameters must be positive\n");
+        return 1;
+    }
+    if (s.players > MAX_PLAYERS) {
+        fprintf(stderr, "At most %u players\n", MAX_PLAYERS);
+        return 1;
+    }
+
+    int policies = argc - optind;
+    if (policies != 0 && policies != 1 && (uint32_t) policies != s.players) {
+        fprintf(stderr, "Give one policy or one per player\n");
+        return 1;
+    }
+    for (uint32_t p = 0; p < s.players; ++p) {
+        if (policies == 0)
+            s.seats[p] = p % 2 == 0 ? POLICY_GREEDY : POLICY_RANDOM;
+        else if (!parse_policy(argv[optind + (policies == 1 ? 0 : p)],
+                               &(s.seats[p]))) {
+            fprintf(stderr, "Unknown policy; use random, greedy or "
+                            "frontier\n");
+            return 1;
+        }
+    }
+
+    FILE *out = NULL;
+    if (path != NULL && (out = fopen(path, "w")) == NULL) {
+        perror(path);
+        return 1;
+    }
+    int status = run(&s, games, threads, out);
+    if (out != NULL && fclose(out) != 0) {
+        perror(path);
+        status = 1;
+    }
+    return status;
+}
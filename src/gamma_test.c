@@ -11,11 +11,19 @@
 #undef NDEBUG
 #endif
 
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do fileno.
+
 #include "gamma.h"
+#include "snapshot.h"
+#include "record.h"
+#include "game_table.h"
 #include <assert.h>
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 /**
  * Tak ma wyglądać plansza po wykonaniu wszystkich testów.
@@ -32,6 +40,73 @@ static const char board[] =
         "1221......\n"
         "1.........\n";
 
+/** Liczba bloków przydzielonych przez @ref counting_alloc i niezwolnionych. */
+static int live_blocks = 0;
+
+/**
+ * Funkcja przydzielająca pamięć i zliczająca przydzielone bloki.
+ * @param size      - Rozmiar bloku.
+ * @param alignment - Wymagane wyrównanie.
+ * @param ctx       - Wskaźnik na licznik wszystkich przydziałów.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void* counting_alloc(size_t size, size_t alignment, void *ctx) {
+    ++*(int*) ctx;
+    ++live_blocks;
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment *
+                                    alignment);
+}
+
+/**
+ * Funkcja zwalniająca pamięć przydzieloną przez @ref counting_alloc.
+ * @param ptr   - Wskaźnik na blok.
+ * @param size  - Rozmiar bloku.
+ * @param ctx   - Wskaźnik na licznik wszystkich przydziałów.
+ */
+static void counting_free(void *ptr, size_t size, void *ctx) {
+    (void) size;
+    (void) ctx;
+    --live_blocks;
+    free(ptr);
+}
+
+/**
+ * Funkcja zapamiętująca największy obszar spośród przeglądanych.
+ * @param area  - Opis obszaru.
+ * @param ctx   - Wskaźnik na opis największego dotąd obszaru.
+ * @return Zawsze true.
+ */
+static bool keep_largest(const gamma_area_t *area, void *ctx) {
+    gamma_area_t *largest = ctx;
+    if (area->size > largest->size)
+        *largest = *area;
+    return true;
+}
+
+/**
+ * Wątek czytelnika planszy w trybie współbieżnym. Dopóki gracz 1 nie ma
+ * wszystkich pól, sprawdza, że opublikowane liczniki są spójne i nie
+ * cofają się, bo w grze nie ma złotych ruchów.
+ * @param arg   - Wskaźnik na planszę 8x8 dla jednego gracza.
+ * @return Zawsze NULL.
+ */
+static void* read_counters(void *arg) {
+    gamma_t *g = arg;
+    gamma_player_info_t info, last = {0};
+    do {
+        assert(gamma_player_info(g, 1, &info));
+        assert(info.version >= last.version && info.version <= 64);
+        assert(info.busy_fields == info.version);
+        assert(info.free_fields == 64 - info.busy_fields);
+        assert(gamma_busy_fields(g, 1) >= info.busy_fields);
+        last = info;
+    } while (info.busy_fields < 64);
+    char *text = gamma_board(g);
+    assert(text != NULL && strchr(text, '.') == NULL);
+    free(text);
+    return NULL;
+}
+
 /** @brief Testuje silnik gry gamma.
  * Przeprowadza przykładowe testy silnika gry gamma.
  * @return Zero, gdy wszystkie testy przebiegły poprawnie,
@@ -94,5 +169,361 @@ int main() {
     free(p);
 
     gamma_delete(g);
+
+    int allocations = 0;
+    gamma_allocator_t allocator = {counting_alloc, counting_free, &allocations};
+    g = gamma_new_ex(10, 10, 2, 3, &allocator);
+    assert(g != NULL);
+    assert(gamma_move(g, 1, 9, 9));
+    assert(gamma_busy_fields(g, 1) == 1);
+    gamma_delete(g);
+    assert(allocations == 1 && live_blocks == 0);
+
+    g = gamma_new(6, 4, 2, 3);
+    assert(g != NULL);
+    assert(gamma_move(g, 1, 1, 1));
+    assert(gamma_move(g, 1, 2, 1));
+    assert(gamma_move(g, 1, 2, 2));
+    assert(gamma_move(g, 1, 5, 3));
+    gamma_area_t area;
+    assert(!gamma_area_info(g, 0, 0, &area));
+    assert(gamma_area_info(g, 1, 1, &area));
+    assert(area.player == 1 && area.size == 3);
+    assert(area.min_x == 1 && area.min_y == 1);
+    assert(area.max_x == 2 && area.max_y == 2);
+    gamma_area_t largest = {0, 0, 0, 0, 0, 0};
+    assert(gamma_for_each_area(g, 1, keep_largest, &largest));
+    assert(largest.size == 3);
+    gamma_delete(g);
+
+    g = gamma_new(6, 4, 2, 1);
+    assert(g != NULL);
+    assert(gamma_move(g, 1, 1, 1));
+    assert(gamma_move(g, 1, 2, 1));
+    assert(gamma_move(g, 2, 1, 2));
+    gamma_cell_t cells[24];
+    assert(gamma_legal_moves(g, 1, cells, 24) == 5);
+    assert(gamma_legal_moves(g, 1, cells, 2) == 2);
+    assert(gamma_golden_targets(g, 2, cells, 24) == 1);
+    assert(cells[0].x == 1 && cells[0].y == 1);
+    assert(gamma_golden_move(g, 2, 1, 1));
+    assert(gamma_legal_moves(g, 1, cells, 24) == gamma_free_fields(g, 1));
+    assert(gamma_golden_targets(g, 2, cells, 24) == 0);
+    assert(gamma_can_move(g, 1) && gamma_can_move(g, 2));
+
+    gamma_t *over = gamma_new(1, 2, 2, 1);
+    assert(over != NULL);
+    assert(gamma_move(over, 1, 0, 0) && gamma_move(over, 2, 0, 1));
+    assert(gamma_can_move(over, 1) && !gamma_game_over(over));
+    assert(gamma_golden_move(over, 1, 0, 1));
+    assert(!gamma_can_move(over, 1) && gamma_can_move(over, 2));
+    assert(gamma_golden_move(over, 2, 0, 0));
+    assert(!gamma_can_move(over, 2) && gamma_game_over(over));
+    assert(!gamma_can_move(over, 3) && !gamma_game_over(NULL));
+    gamma_delete(over);
+
+    gamma_t *land = gamma_new(5, 3, 2, 4);
+    assert(land != NULL);
+    uint32_t labels[15];
+    uint64_t counts[3];
+    assert(gamma_territory(land, labels, counts));
+    assert(counts[0] == 15 && counts[1] == 0 && labels[7] == 0);
+    assert(gamma_move(land, 1, 0, 0) && gamma_move(land, 2, 4, 2));
+    assert(gamma_territory(land, labels, counts));
+    assert(counts[0] == 3 && counts[1] == 6 && counts[2] == 6);
+    assert(labels[0] == 1 && labels[1] == 1 && labels[3] == GAMMA_TERRITORY_TIE);
+    assert(labels[7] == GAMMA_TERRITORY_TIE && labels[13] == 2);
+    assert(gamma_move(land, 1, 2, 1) && gamma_move(land, 2, 3, 2));
+    assert(gamma_territory(land, labels, counts));
+    assert(counts[0] == 4 && counts[1] == 7 && counts[2] == 4);
+    assert(labels[8] == GAMMA_TERRITORY_TIE && labels[10] == 1);
+    assert(!gamma_territory(land, NULL, counts) && errno == EINVAL);
+    gamma_delete(land);
+
+    gamma_t *shared = gamma_new(8, 8, 1, 64);
+    assert(shared != NULL && gamma_set_concurrent(shared, true));
+    pthread_t reader;
+    assert(pthread_create(&reader, NULL, read_counters, shared) == 0);
+    uint64_t writer_seed = 1;
+    while (gamma_random_move(shared, 1, &writer_seed))
+        continue;
+    assert(pthread_join(reader, NULL) == 0);
+    assert(gamma_version(shared) == 64 && gamma_free_fields(shared, 1) == 0);
+    assert(gamma_set_concurrent(shared, false));
+    assert(gamma_version(shared) == 64 && gamma_busy_fields(shared, 1) == 64);
+    gamma_delete(shared);
+
+    gamma_t *watched = gamma_new(20, 30, 12, 5);
+    assert(gamma_snapshot_acquire(watched) == NULL && errno == EINVAL);
+    assert(watched != NULL && gamma_set_snapshots(watched, 2));
+    char *empty = gamma_board(watched);
+    gamma_snapshot_t *old = gamma_snapshot_acquire(watched);
+    assert(old != NULL);
+    assert(gamma_move(watched, 12, 19, 29));
+    assert(gamma_move(watched, 1, 0, 0));
+    assert(gamma_golden_move(watched, 2, 0, 0));
+    gamma_snapshot_t *now = gamma_snapshot_acquire(watched);
+    assert(now != NULL);
+    assert(gamma_snapshot_acquire(watched) == NULL && errno == EAGAIN);
+    assert(gamma_snapshot_version(old) == 0);
+    assert(gamma_snapshot_owner(old, 19, 29) == 0);
+    p = gamma_snapshot_board(old);
+    assert(strcmp(p, empty) == 0);
+    free(p);
+    free(empty);
+    assert(gamma_snapshot_version(now) == 3);
+    assert(gamma_snapshot_hash(now) == gamma_hash(watched));
+    assert(gamma_snapshot_owner(now, 19, 29) == 12);
+    assert(gamma_snapshot_owner(now, 0, 0) == 2);
+    assert(gamma_snapshot_busy_fields(now, 1) == 0);
+    assert(gamma_snapshot_player_areas(now, 2) == 1);
+    assert(gamma_snapshot_golden_used(now, 2));
+    assert(!gamma_snapshot_golden_used(old, 2));
+    p = gamma_snapshot_board(now);
+    char *current = gamma_board(watched);
+    assert(strcmp(p, current) == 0);
+    free(p);
+    free(current);
+    gamma_snapshot_release(old);
+    gamma_snapshot_release(now);
+    gamma_delete(watched);
+
+    gamma_t *copy = gamma_clone(g);
+    assert(copy != NULL);
+    char *before = gamma_board(g);
+    p = gamma_board(copy);
+    assert(strcmp(p, before) == 0);
+    free(p);
+    uint64_t seed = 1;
+    while (gamma_random_move(copy, 1, &seed)) {}
+    assert(gamma_free_fields(copy, 1) == 0);
+    p = gamma_board(g);
+    assert(strcmp(p, before) == 0);
+    free(p);
+    assert(gamma_copy(copy, g));
+    assert(gamma_busy_fields(copy, 1) == gamma_busy_fields(g, 1));
+    assert(gamma_move(copy, 1, 3, 1));
+    assert(gamma_area_info(copy, 3, 1, &area) && area.size == 2);
+    free(before);
+    gamma_delete(copy);
+    gamma_delete(g);
+
+    gamma_t *a = gamma_new(4, 4, 2, 2);
+    gamma_t *b = gamma_new(4, 4, 2, 2);
+    gamma_t *c = gamma_new(4, 4, 2, 2);
+    assert(a != NULL && b != NULL && c != NULL);
+    assert(gamma_hash(a) == 0);
+    assert(gamma_move(a, 1, 0, 0) && gamma_move(a, 2, 3, 3));
+    assert(gamma_move(b, 2, 3, 3) && gamma_move(b, 1, 0, 0));
+    assert(gamma_move(c, 1, 3, 0) && gamma_move(c, 2, 0, 3));
+    assert(gamma_hash(a) != 0 && gamma_hash(a) == gamma_hash(b));
+    assert(gamma_hash(a) != gamma_hash(c));
+    assert(gamma_canonical_hash(a) == gamma_canonical_hash(c));
+    uint64_t hash = gamma_hash(a);
+    assert(gamma_golden_move(a, 1, 3, 3) && gamma_golden_move(c, 1, 0, 3));
+    assert(gamma_hash(a) != hash);
+    assert(gamma_canonical_hash(a) == gamma_canonical_hash(c));
+    assert(gamma_golden_move(b, 1, 3, 3));
+    assert(gamma_hash(b) == gamma_hash(a));
+    assert(gamma_canonical_hash(b) == gamma_canonical_hash(a));
+    gamma_delete(b);
+    b = gamma_new(4, 4, 2, 2);
+    assert(gamma_move(b, 1, 0, 0) && gamma_move(b, 1, 3, 3));
+    assert(gamma_hash(b) != gamma_hash(a));
+    gamma_delete(b);
+    gamma_delete(c);
+
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    int fd = fileno(file);
+    assert(gamma_move(a, 2, 1, 2) && gamma_save(a, fd));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    b = gamma_load(fd);
+    assert(b != NULL);
+    before = gamma_board(a);
+    p = gamma_board(b);
+    assert(strcmp(p, before) == 0);
+    free(p);
+    free(before);
+    assert(gamma_hash(b) == gamma_hash(a));
+    assert(gamma_busy_fields(b, 1) == 2 && gamma_busy_fields(b, 2) == 1);
+    assert(!gamma_golden_possible(b, 1) && gamma_golden_possible(b, 2));
+    assert(gamma_free_fields(b, 1) == gamma_free_fields(a, 1));
+    assert(gamma_area_info(b, 3, 3, &area) && area.player == 1);
+
+    gamma_view_t *view = gamma_view_open(fd, true);
+    assert(view != NULL);
+    assert(gamma_view_header(view)->width == 4);
+    assert(gamma_view_owner(view, 3, 3) == 1);
+    assert(gamma_view_owner(view, 1, 2) == 2);
+    assert(gamma_view_owner(view, 2, 2) == 0);
+    assert(gamma_view_busy_fields(view, 1) == 2);
+    assert(gamma_view_player_areas(view, 1) == 2);
+    assert(gamma_view_golden_used(view, 1) && !gamma_view_golden_used(view, 2));
+    gamma_view_close(view);
+
+    uint8_t byte = 1;
+    assert(pwrite(fd, &byte, 1, 200) == 1);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(gamma_load(fd) == NULL && errno == EBADMSG);
+    assert(gamma_view_open(fd, true) == NULL && errno == EBADMSG);
+    fclose(file);
+    gamma_delete(a);
+    gamma_delete(b);
+
+    file = tmpfile();
+    assert(file != NULL);
+    fd = fileno(file);
+    a = gamma_new(4, 4, 2, 2);
+    gamma_recorder_t *rec = gamma_recorder_new(a, fd, 2);
+    assert(rec != NULL);
+    char *states[6];
+    states[0] = gamma_board(a);
+    assert(gamma_recorder_move(rec, 1, 0, 0));
+    states[1] = gamma_board(a);
+    assert(gamma_recorder_move(rec, 2, 1, 1));
+    states[2] = gamma_board(a);
+    assert(!gamma_recorder_move(rec, 2, 1, 1));
+    assert(gamma_recorder_move(rec, 1, 2, 2));
+    states[3] = gamma_board(a);
+    assert(gamma_recorder_golden_move(rec, 2, 0, 0));
+    states[4] = gamma_board(a);
+    assert(gamma_recorder_move(rec, 1, 3, 3));
+    states[5] = gamma_board(a);
+    assert(gamma_recorder_finish(rec));
+
+    gamma_record_info_t info;
+    assert(gamma_record_info(fd, &info));
+    assert(info.width == 4 && info.players == 2 && info.interval == 2);
+    assert(info.moves == 5 && info.checkpoints == 2);
+    for (uint64_t move = 0; move <= 5; ++move) {
+        b = gamma_record_seek(fd, move);
+        assert(b != NULL);
+        p = gamma_board(b);
+        assert(strcmp(p, states[move]) == 0);
+        free(p);
+        free(states[move]);
+        assert(gamma_golden_possible(b, 2) == (move >= 1 && move < 4));
+        gamma_delete(b);
+    }
+    assert(gamma_record_seek(fd, 6) == NULL && errno == ERANGE);
+    fclose(file);
+    gamma_delete(a);
+
+    game_table_t *table = game_table_new(1u << 20);
+    assert(table != NULL);
+    game_handle_t first = game_table_create(table, 30, 20, 3, 4);
+    game_handle_t second = game_table_create(table, 30, 20, 3, 4);
+    assert(first != GAME_HANDLE_NONE && second != GAME_HANDLE_NONE);
+    assert(game_table_create(table, 0, 20, 3, 4) == GAME_HANDLE_NONE);
+    a = game_table_get(table, first);
+    assert(a != NULL && a != game_table_get(table, second));
+    assert(gamma_move(a, 1, 29, 19) && gamma_golden_move(a, 2, 29, 19));
+    assert(game_table_remove(table, first));
+    assert(!game_table_remove(table, first));
+    assert(game_table_get(table, first) == NULL);
+    game_handle_t third = game_table_create(table, 30, 20, 3, 4);
+    assert(third != GAME_HANDLE_NONE && third != first);
+    assert(game_table_get(table, first) == NULL);
+    a = game_table_get(table, third);
+    assert(gamma_busy_fields(a, 2) == 0 && gamma_free_fields(a, 1) == 600);
+    game_table_stats_t table_stats;
+    game_table_stats(table, &table_stats);
+    assert(table_stats.live == 2 && table_stats.created == 3);
+    assert(table_stats.reused == 1 && table_stats.pooled_blocks == 0);
+    game_table_delete(table);
+
+    a = gamma_new(3, 1, 2, 1);
+    assert(a != NULL && gamma_set_feed(a, 64));
+    assert(!gamma_set_feed(a, 8) && errno == EINVAL);
+    uint64_t position = gamma_feed_position(a);
+    assert(position == 0);
+    assert(gamma_move(a, 1, 0, 0) && gamma_move(a, 2, 2, 0));
+    assert(gamma_move(a, 1, 1, 0) && gamma_golden_move(a, 2, 1, 0));
+    assert(gamma_golden_move(a, 1, 1, 0));
+    const gamma_event_t expected[] = {
+        {GAMMA_EVENT_OWNER, 1, 0, 0, 0, 0},
+        {GAMMA_EVENT_AREAS, 1, 0, 0, 0, 1},
+        {GAMMA_EVENT_OWNER, 2, 2, 0, 0, 0},
+        {GAMMA_EVENT_AREAS, 2, 0, 0, 0, 1},
+        {GAMMA_EVENT_OWNER, 1, 1, 0, 0, 0},
+        {GAMMA_EVENT_OWNER, 2, 1, 0, 1, 0},
+        {GAMMA_EVENT_GOLDEN, 2, 0, 0, 0, 0},
+        {GAMMA_EVENT_BLOCKED, 2, 0, 0, 0, 1},
+        {GAMMA_EVENT_OWNER, 1, 1, 0, 2, 0},
+        {GAMMA_EVENT_GOLDEN, 1, 0, 0, 0, 0},
+        {GAMMA_EVENT_BLOCKED, 1, 0, 0, 0, 1}};
+    uint8_t events[GAMMA_EVENT_MAX_SIZE];
+    size_t events_length, event_count = 0;
+    while (gamma_feed_read(a, &position, events, sizeof(events),
+                           &events_length) && events_length > 0) {
+        gamma_event_t event;
+        for (size_t i = 0; i < events_length; ++event_count) {
+            size_t length = gamma_event_decode(events + i, events_length - i,
+                                               &event);
+            assert(length > 0 && event_count < 11);
+            assert(memcmp(&event, &expected[event_count],
+                          sizeof(event)) == 0);
+            i += length;
+        }
+    }
+    assert(event_count == 11 && position == gamma_feed_position(a));
+    assert(gamma_game_over(a));
+    b = gamma_new(3, 1, 2, 1);
+    assert(b != NULL && gamma_copy(a, b));
+    assert(gamma_feed_read(a, &position, events, sizeof(events),
+                           &events_length));
+    gamma_event_t event;
+    assert(gamma_event_decode(events, events_length, &event) == 2);
+    assert(event.type == GAMMA_EVENT_RESET && event.value == 0);
+    for (int i = 0; i < 3; ++i)
+        assert(gamma_copy(a, b) && gamma_move(a, 1, 0, 0) &&
+               gamma_move(a, 2, 2, 0));
+    position = 0;
+    assert(!gamma_feed_read(a, &position, events, sizeof(events),
+                            &events_length) && errno == ERANGE);
+    assert(position == gamma_feed_position(a));
+    assert(gamma_feed_read(a, &position, events, sizeof(events),
+                           &events_length) && events_length == 0);
+    assert(gamma_move(a, 1, 1, 0));
+    assert(gamma_feed_read(a, &position, events, sizeof(events),
+                           &events_length));
+    assert(gamma_event_decode(events, events_length, &event) == 5);
+    assert(event.type == GAMMA_EVENT_OWNER && event.player == 1);
+    assert(gamma_event_decode(events, 1, NULL) == 0);
+    gamma_delete(b);
+    gamma_delete(a);
+
+    char mapped_dir[] = "/tmp/gamma_test_XXXXXX";
+    assert(mkdtemp(mapped_dir) != NULL);
+    a = gamma_new_mapped(30, 20, 3, 4, mapped_dir);
+    b = gamma_new(30, 20, 3, 4);
+    assert(a != NULL && b != NULL);
+    uint64_t mapped_seed = 5;
+    for (uint32_t i = 0; i < 300; ++i) {
+        uint64_t other_seed = mapped_seed;
+        assert(gamma_random_move(a, 1 + i % 3, &mapped_seed) ==
+               gamma_random_move(b, 1 + i % 3, &other_seed));
+    }
+    assert(gamma_golden_move(a, 1, 0, 0) == gamma_golden_move(b, 1, 0, 0));
+    gamma_t *mapped_copy = gamma_clone(a);
+    assert(mapped_copy != NULL);
+    gamma_t *second_copy = gamma_clone(a);
+    assert(second_copy != NULL);
+    gamma_delete(second_copy);
+    gamma_delete(a);
+    p = gamma_board(mapped_copy);
+    char *expected_board = gamma_board(b);
+    assert(p != NULL && expected_board != NULL);
+    assert(strcmp(p, expected_board) == 0);
+    free(p);
+    free(expected_board);
+    // Pliki gier nie mają nazw w katalogu, więc da się go usunąć, zanim
+    // gra się skończy.
+    assert(rmdir(mapped_dir) == 0);
+    gamma_delete(mapped_copy);
+    gamma_delete(b);
+    assert(gamma_new_mapped(3, 3, 2, 2, mapped_dir) == NULL &&
+           errno == ENOENT);
     return 0;
 }
\ No newline at end of file
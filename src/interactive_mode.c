@@ -14,6 +14,7 @@
 #include <sys/ioctl.h>
 #include "interactive_mode.h"
 #include "gamma.h"
+#include "turn.h"
 
 #define NORMAL 0 ///< Rprezentacja normalnego stanu gry.
 #define START 55 ///< Reprezentacja początku gry.
@@ -23,11 +24,11 @@
 #define NO_ARROW 0 ///< Zerowy poziom wczytania strzałki.
 #define FIRST_ARROW 1 ///< Pierwszy poziom wczytania strzałki.
 #define SECOND_ARROW 2 ///< Drugi poziom wczytania strzałki.
-#define STARTING_PLAYER 1 ///< Gracz rozpoczynający grę.
 #define START_ROW 0 ///< Numer pierwszego wiersza.
 #define START_COL 0 ///< Numer pierwszej kolumny.
 #define GAME_END_CHAR '\4' ///< Kod znaku ctrl + d.
 #define BAD_TERMINAL (-1) ///< Nie można pobrać atrybutów okna terminala.
+#define REPORT_SIZE 128 ///< Rozmiar opisu ostatniego ruchu komputera.
 
 /**
  * Enum zawierający obsługiwane kody sygnałów wysyłanych przez użytkownika.
@@ -37,6 +38,27 @@ enum INPUT_CODE {
     ARROW_DOWN, ARROW_LEFT, ARROW_RIGHT
 };
 
+/**
+ * Stan graczy sterowanych przez komputer.
+ */
+typedef struct computer {
+    const interactive_options_t *options; ///< Ustawienia trybu.
+    mcts_t *mcts; ///< Stan przeszukiwania lub NULL, gdy nie ma komputera.
+    char report[REPORT_SIZE]; ///< Opis ostatniego ruchu komputera.
+} computer_t;
+
+/**
+ * Stan jednej rozgrywki w trybie interaktywnym.
+ */
+typedef struct session {
+    gamma_t *g; ///< Plansza do gry.
+    int state; ///< Stan gry: START, NORMAL albo ENDING.
+    turn_t turn; ///< Kolejka graczy.
+    uint32_t x; ///< Kolumna kursora.
+    uint32_t y; ///< Wiersz kursora, liczony od góry planszy.
+    computer_t computer; ///< Stan graczy sterowanych przez komputer.
+} session_t;
+
 /**
  * Funkcja czyszcząca ekran terminala.
  */
@@ -172,34 +194,80 @@ static void move_x(gamma_t *g, uint32_t *x, int command) {
     }
 }
 
+/**
+ * Funkcja sprawdzająca, czy gracz jest sterowany przez komputer.
+ * @param computer  - wskaźnik na stan graczy komputerowych.
+ * @param player    - numer gracza.
+ * @return          - true, jeśli gracz jest sterowany przez komputer.
+ */
+static bool is_computer(const computer_t *computer, uint32_t player) {
+    for (uint32_t i = 0; i < computer->options->computer_count; ++i)
+        if (computer->options->computers[i] == player)
+            return true;
+    return false;
+}
+
+/**
+ * Funkcja wykonująca turę gracza sterowanego przez komputer. Wybiera ruch
+ * przeszukiwaniem MCTS i zapamiętuje jego opis z liczbą rozegranych
+ * partii na sekundę.
+ * @param g         - wskaźnik na planszę do gry.
+ * @param computer  - wskaźnik na stan graczy komputerowych.
+ * @param player    - numer gracza.
+ * @param x         - współrzędna aktualnej kolumny.
+ * @param y         - współrzędna aktualnego wiersza.
+ */
+static void computer_turn(gamma_t *g, computer_t *computer, uint32_t player,
+                          uint32_t x, uint32_t y) {
+    uint32_t padding;
+    clear_screen();
+    print_board(g, &padding, x, y);
+    printf("PLAYER: %u \x1B[93mCOMPUTER IS THINKING\x1B[39m\n", player);
+    fflush(stdout);
+
+    mcts_result_t result;
+    if (!mcts_search(computer->mcts, g, player, &result) || !result.found) {
+        snprintf(computer->report, REPORT_SIZE,
+                 "PLAYER %u (COMPUTER) SKIPPED", player);
+        return;
+    }
+    if (result.golden)
+        gamma_golden_move(g, player, result.x, result.y);
+    else
+        gamma_move(g, player, result.x, result.y);
+    double seconds = result.elapsed_ns / 1e9;
+    snprintf(computer->report, REPORT_SIZE,
+             "PLAYER %u (COMPUTER) %s %u %u, %lu PLAYOUTS, %.0f PLAYOUTS/S",
+             player, result.golden ? "GOLDEN" : "MOVE", result.x, result.y,
+             result.playouts,
+             seconds > 0 ? result.playouts / seconds : 0.0);
+}
+
 /**
  * Funkcja obsługująca wykonanie tury dla gracza.
- * @param g     - wskaźnik na strukturę przechowywującą planszę do gry.
- * @param state - wskaźnik na zmienną przechowywującą stan gry.
+ * @param session   - wskaźnik na stan rozgrywki.
  */
-static void make_turn(gamma_t *g, int *state) {
+static void make_turn(session_t *session) {
+    gamma_t *g = session->g;
     uint32_t width = gamma_get_width(g);
     uint32_t height = gamma_get_height(g);
-
-    static uint32_t player = STARTING_PLAYER;
-    static uint32_t x = START_COL;
-    static uint32_t y = START_ROW;
-    static uint32_t skip_count = 0;
     uint32_t padding;
-    if (player > gamma_get_players(g))
-        player = STARTING_PLAYER;
-    if (skip_count == gamma_get_players(g))
-        *state = ENDING;
-    if (*state == START) {
-        x = (width - 1) / 2;
-        y = (height - 1) / 2;
-        *state = NORMAL;
+    if (turn_game_over(&(session->turn), g))
+        session->state = ENDING;
+    if (session->state == START) {
+        session->x = (width - 1) / 2;
+        session->y = (height - 1) / 2;
+        session->state = NORMAL;
     }
 
-    if (!gamma_golden_possible(g, player) &&
-        gamma_free_fields(g, player) == 0) {
-        ++player;
-        ++skip_count;
+    if (!turn_begin(&(session->turn), g))
+        return;
+
+    uint32_t player = session->turn.player;
+    if (is_computer(&(session->computer), player)) {
+        computer_turn(g, &(session->computer), player, session->x,
+                      session->y);
+        turn_end(&(session->turn), g);
         return;
     }
 
@@ -208,29 +276,30 @@ static void make_turn(gamma_t *g, int *state) {
 
     do {
         clear_screen();
-        print_board(g, &padding, x, y);
+        print_board(g, &padding, session->x, session->y);
         print_player_stats(g, player);
+        if (session->computer.report[0] != '\0')
+            printf("%s\n", session->computer.report);
 
         command = take_input();
         if (command == ARROW_UP || command == ARROW_DOWN)
-            move_y(g, &y, command);
+            move_y(g, &(session->y), command);
         if (command == ARROW_LEFT || command == ARROW_RIGHT)
-            move_x(g, &x, command);
-        if (command == MOVE && gamma_move(g, player, x,
-                height - 1 - y))
+            move_x(g, &(session->x), command);
+        if (command == MOVE && gamma_move(g, player, session->x,
+                height - 1 - session->y))
             move_ended = true;
-        if (command == GOLDEN && gamma_golden_move(g, player, x,
-                height - 1 - y))
+        if (command == GOLDEN && gamma_golden_move(g, player, session->x,
+                height - 1 - session->y))
             move_ended = true;
         if (command == SKIP)
             move_ended = true;
 
     } while(command != END && !move_ended);
     if (command == END)
-        *state = ENDING;
+        session->state = ENDING;
 
-    ++player;
-    skip_count = 0;
+    turn_end(&(session->turn), g);
 }
 
 /**
@@ -262,7 +331,7 @@ static void end_on_error(gamma_t *g) {
     exit(1);
 }
 
-void interactive_mode(gamma_t *g) {
+void interactive_mode(gamma_t *g, const interactive_options_t *options) {
     struct termios orig;
 
     struct winsize window;
@@ -281,16 +350,24 @@ void interactive_mode(gamma_t *g) {
         end_on_error(g);
     }
 
-    int state = START;
+    session_t session = {g, START, {TURN_FIRST_PLAYER, 0}, START_COL,
+                         START_ROW, {options, NULL, ""}};
+    if (options->computer_count > 0 &&
+        (session.computer.mcts = mcts_new(g, &(options->search))) == NULL) {
+        printf("Not enough memory for the computer player.\n");
+        tcsetattr(STDIN_FILENO, TCSANOW, &orig);
+        end_on_error(g);
+    }
 
     while (true) {
-        make_turn(g, &state);
-        if (state != NORMAL)
+        make_turn(&session);
+        if (session.state != NORMAL)
             break;
     }
     clear_screen();
-    if (state == ENDING)
+    if (session.state == ENDING)
         print_summary(g);
+    mcts_delete(session.computer.mcts);
     gamma_delete(g);
     tcsetattr(STDIN_FILENO, TCSANOW, &orig);
     printf("\033[?25h");
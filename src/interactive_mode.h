@@ -3,14 +3,25 @@
  * Interfejs obsługujący tryb interaktywny.
  */
 #include "gamma.h"
+#include "mcts.h"
 
 #ifndef GAMMA_INTERACTIVE_MODE_H
 #define GAMMA_INTERACTIVE_MODE_H
 
+/**
+ * Ustawienia trybu interaktywnego.
+ */
+typedef struct interactive_options {
+    const uint32_t *computers; ///< Numery graczy sterowanych przez komputer.
+    uint32_t computer_count; ///< Liczba elementów tablicy computers.
+    mcts_config_t search; ///< Ustawienia przeszukiwania gracza komputerowego.
+} interactive_options_t;
+
 /**
  * Główna funkcja obsługująca tryb interaktywny.
- * @param g     - wskaźnik na strukturę przechowującą planszę do gry gamma.
+ * @param g         - wskaźnik na strukturę przechowującą planszę do gry gamma.
+ * @param options   - wskaźnik na ustawienia trybu.
  */
-void interactive_mode(gamma_t *g);
+void interactive_mode(gamma_t *g, const interactive_options_t *options);
 
 #endif //GAMMA_INTERACTIVE_MODE_H
@@ -0,0 +1,565 @@
+/**
+ * @file
+ * Implementacja gracza komputerowego MCTS. Węzły drzewa leżą w jednej
+ * tablicy przydzielonej przy tworzeniu, a dzieci węzła zajmują w niej
+ * spójny przedział. Każdy wątek rozgrywa losowe partie na własnej kopii
+ * planszy przez @ref gamma_random_move, więc pętla przeszukiwania nie
+ * przydziela pamięci.
+ *
+ * Statystyki węzłów i stan ich rozwinięcia są zmiennymi atomowymi, żeby
+ * wspólne drzewo mogło być aktualizowane przez wiele wątków bez zamków.
+ * Węzeł rozwija ten wątek, który pierwszy zmieni jego stan z NODE_LEAF na
+ * NODE_EXPANDING; pozostałe traktują go do czasu opublikowania dzieci jak
+ * liść. Wątek schodzący przez węzeł wspólnego drzewa dolicza mu wirtualne
+ * przegrane, które zniechęcają inne wątki do tej samej ścieżki, i odejmuje
+ * je po rozegraniu partii.
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do clock_gettime.
+
+#include "mcts.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define VIRTUAL_LOSS 3 ///< Liczba wirtualnych przegranych na zejście.
+#define REWARD_SCALE (1u << 24) ///< Wartość wygranej w stałym przecinku.
+#define MIN_PATH 64 ///< Początkowa długość ścieżki wątku.
+
+/**
+ * Rodzaj ruchu prowadzącego do węzła.
+ */
+typedef enum node_kind {
+    NODE_MOVE, ///< Zwykły ruch.
+    NODE_GOLDEN, ///< Złoty ruch.
+    NODE_PASS ///< Gracz nie ma ruchu i traci kolejkę.
+} node_kind_t;
+
+/**
+ * Stan rozwinięcia węzła.
+ */
+enum node_state {
+    NODE_LEAF, ///< Węzeł nie ma dzieci.
+    NODE_EXPANDING, ///< Któryś wątek właśnie tworzy dzieci węzła.
+    NODE_EXPANDED, ///< Dzieci węzła są gotowe.
+    NODE_FINAL ///< Węzeł nie będzie rozwijany: koniec gry lub brak węzłów.
+};
+
+/**
+ * Węzeł drzewa gry.
+ */
+typedef struct node {
+    atomic_uint state; ///< Stan rozwinięcia (@ref node_state).
+    uint32_t first_child; ///< Indeks pierwszego dziecka.
+    uint32_t children; ///< Liczba dzieci.
+    uint32_t x; ///< Numer kolumny pola ruchu.
+    uint32_t y; ///< Numer wiersza pola ruchu.
+    uint32_t player; ///< Gracz, który wykonał ruch prowadzący do węzła.
+    uint32_t passes; ///< Liczba utraconych kolejek z rzędu po ruchu.
+    node_kind_t kind; ///< Rodzaj ruchu.
+    atomic_uint visits; ///< Liczba partii, także wirtualnych, przez węzeł.
+    atomic_uint_fast64_t reward; /**< Suma wyników partii dla gracza player,
+    w jednostkach 1 / REWARD_SCALE. */
+} node_t;
+
+/**
+ * Drzewo gry.
+ */
+typedef struct tree {
+    node_t *nodes; ///< Węzły drzewa, korzeń pod indeksem 0.
+    uint32_t capacity; ///< Rozmiar tablicy nodes.
+    atomic_uint used; ///< Liczba zajętych węzłów.
+} tree_t;
+
+/**
+ * Stan jednego wątku przeszukiwania.
+ */
+typedef struct worker {
+    tree_t *tree; ///< Drzewo, które buduje wątek.
+    gamma_t *scratch; ///< Kopia planszy, na której wątek rozgrywa partie.
+    uint32_t *path; ///< Indeksy węzłów na ścieżce od korzenia.
+    uint32_t path_size; ///< Rozmiar tablicy path.
+    gamma_cell_t *cells; ///< Bufor na ruchy rozwijanego węzła.
+    uint64_t *busy; ///< Liczby pól graczy na końcu partii.
+    uint64_t rng; ///< Stan generatora liczb pseudolosowych.
+    uint64_t playouts; ///< Liczba partii w bieżącym przeszukiwaniu.
+} worker_t;
+
+/**
+ * Struktura przechowująca stan przeszukiwania.
+ */
+struct mcts {
+    mcts_config_t config; ///< Ustawienia.
+    uint64_t cells; ///< Liczba pól planszy.
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    tree_t *trees; ///< Drzewa: jedno wspólne albo po jednym na wątek.
+    uint32_t tree_count; ///< Liczba drzew.
+    worker_t *workers; ///< Stany wątków.
+    thread_pool_t *pool; ///< Pula wątków lub NULL dla jednego wątku.
+    uint64_t *merged; ///< Zsumowane odwiedziny ruchów korzenia.
+    gamma_t *root; ///< Plansza bieżącego przeszukiwania.
+    uint32_t root_player; ///< Gracz, dla którego szukamy ruchu.
+    uint64_t deadline; ///< Koniec bieżącego przeszukiwania w nanosekundach.
+};
+
+/**
+ * Funkcja pomocnicza podająca aktualny czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Generator xorshift64*.
+ * @param state - Wskaźnik na stan generatora.
+ * @return Kolejna liczba pseudolosowa.
+ */
+static uint64_t rng_next(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+void mcts_default_config(mcts_config_t *config) {
+    config->budget_ms = MCTS_DEFAULT_BUDGET_MS;
+    config->exploration = MCTS_DEFAULT_EXPLORATION;
+    config->max_nodes = MCTS_DEFAULT_MAX_NODES;
+    config->seed = 1;
+    config->threads = 1;
+    config->parallel = MCTS_TREE_PARALLEL;
+}
+
+mcts_t* mcts_new(gamma_t *g, const mcts_config_t *config) {
+    if (g == NULL)
+        return NULL;
+    mcts_t *mcts = calloc(1, sizeof(mcts_t));
+    if (mcts == NULL)
+        return NULL;
+    if (config != NULL)
+        mcts->config = *config;
+    else
+        mcts_default_config(&(mcts->config));
+    mcts_config_t *c = &(mcts->config);
+    if (c->threads < 1)
+        c->threads = 1;
+    if (c->threads > MCTS_MAX_THREADS)
+        c->threads = MCTS_MAX_THREADS;
+    if (c->seed == 0)
+        c->seed = 1;
+
+    mcts->width = gamma_get_width(g);
+    mcts->players = gamma_get_players(g);
+    mcts->cells = (uint64_t) mcts->width * gamma_get_height(g);
+    mcts->tree_count = c->parallel == MCTS_ROOT_PARALLEL ? c->threads : 1;
+    uint32_t capacity = c->max_nodes / mcts->tree_count;
+    mcts->trees = calloc(mcts->tree_count, sizeof(tree_t));
+    mcts->workers = calloc(c->threads, sizeof(worker_t));
+    mcts->merged = calloc(2 * mcts->cells, sizeof(uint64_t));
+    if (mcts->trees == NULL || mcts->workers == NULL || mcts->merged == NULL ||
+        capacity < 1 ||
+        (c->threads > 1 && (mcts->pool = thread_pool_new(c->threads)) == NULL)) {
+        mcts_delete(mcts);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < mcts->tree_count; ++i) {
+        mcts->trees[i].capacity = capacity;
+        atomic_init(&(mcts->trees[i].used), 0);
+        if ((mcts->trees[i].nodes = malloc(sizeof(node_t) * capacity)) == NULL) {
+            mcts_delete(mcts);
+            return NULL;
+        }
+    }
+    for (uint32_t i = 0; i < c->threads; ++i) {
+        worker_t *w = &(mcts->workers[i]);
+        w->tree = &(mcts->trees[i % mcts->tree_count]);
+        w->rng = c->seed + 0x9E3779B97F4A7C15ull * i;
+        w->path_size = MIN_PATH;
+        w->scratch = gamma_clone(g);
+        w->path = malloc(sizeof(uint32_t) * w->path_size);
+        w->cells = malloc(sizeof(gamma_cell_t) * 2 * mcts->cells);
+        w->busy = malloc(sizeof(uint64_t) * ((size_t) mcts->players + 1));
+        if (w->scratch == NULL || w->path == NULL || w->cells == NULL ||
+            w->busy == NULL) {
+            mcts_delete(mcts);
+            return NULL;
+        }
+    }
+    return mcts;
+}
+
+void mcts_delete(mcts_t *mcts) {
+    if (mcts == NULL)
+        return;
+    thread_pool_delete(mcts->pool);
+    for (uint32_t i = 0; mcts->workers != NULL && i < mcts->config.threads;
+         ++i) {
+        gamma_delete(mcts->workers[i].scratch);
+        free(mcts->workers[i].path);
+        free(mcts->workers[i].cells);
+        free(mcts->workers[i].busy);
+    }
+    for (uint32_t i = 0; mcts->trees != NULL && i < mcts->tree_count; ++i)
+        free(mcts->trees[i].nodes);
+    free(mcts->workers);
+    free(mcts->trees);
+    free(mcts->merged);
+    free(mcts);
+}
+
+/**
+ * Funkcja pomocnicza podająca gracza, który ma ruch po graczu @p player.
+ * @param player - Numer gracza.
+ * @param players - Liczba graczy.
+ * @return Numer następnego gracza.
+ */
+static inline uint32_t next_player(uint32_t player, uint32_t players) {
+    return player == players ? 1 : player + 1;
+}
+
+/**
+ * Funkcja pomocnicza inicjująca węzeł.
+ * @param node - Wskaźnik na węzeł.
+ * @param kind - Rodzaj ruchu.
+ * @param player - Gracz wykonujący ruch.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @param passes - Liczba utraconych kolejek z rzędu po ruchu.
+ */
+static void init_node(node_t *node, node_kind_t kind, uint32_t player,
+                      uint32_t x, uint32_t y, uint32_t passes) {
+    atomic_init(&(node->state), NODE_LEAF);
+    node->first_child = 0;
+    node->children = 0;
+    node->x = x;
+    node->y = y;
+    node->player = player;
+    node->passes = passes;
+    node->kind = kind;
+    atomic_init(&(node->visits), 0);
+    atomic_init(&(node->reward), 0);
+}
+
+/**
+ * Funkcja pomocnicza rozwijająca węzeł o wszystkie ruchy gracza @p player
+ * na planszy roboczej wątku, w losowej kolejności. Gracz bez ruchów dostaje
+ * jedno dziecko utraty kolejki. Wywołujący musi wcześniej przestawić węzeł
+ * w stan NODE_EXPANDING. Gdy w drzewie zabrakło węzłów, węzeł pozostaje
+ * liściem na zawsze.
+ * @param w - Wskaźnik na stan wątku.
+ * @param parent - Indeks rozwijanego węzła.
+ * @param player - Gracz, który ma ruch.
+ */
+static void expand(worker_t *w, uint32_t parent, uint32_t player) {
+    tree_t *tree = w->tree;
+    node_t *node = &(tree->nodes[parent]);
+    uint64_t cells = gamma_get_width(w->scratch) *
+                     (uint64_t) gamma_get_height(w->scratch);
+    uint64_t moves = gamma_legal_moves(w->scratch, player, w->cells, cells);
+    uint64_t golden = gamma_golden_targets(w->scratch, player,
+                                           w->cells + moves, cells);
+    uint64_t count = moves + golden;
+    uint32_t needed = count > 0 ? (uint32_t) count : 1;
+
+    // Wstępne sprawdzenie chroni licznik used przed przepełnieniem, gdy
+    // wiele wątków próbuje rezerwować węzły w pełnym drzewie.
+    uint32_t first = atomic_load_explicit(&(tree->used), memory_order_relaxed);
+    if (count < tree->capacity && needed <= tree->capacity - first)
+        first = atomic_fetch_add_explicit(&(tree->used), needed,
+                                          memory_order_relaxed);
+    if (first > tree->capacity || needed > tree->capacity - first) {
+        atomic_store_explicit(&(node->state), NODE_FINAL,
+                              memory_order_release);
+        return;
+    }
+
+    node_t *child = &(tree->nodes[first]);
+    if (count == 0) {
+        init_node(child, NODE_PASS, player, 0, 0, node->passes + 1);
+    }
+    else {
+        for (uint64_t i = 0; i < count; ++i)
+            init_node(&(child[i]), i < moves ? NODE_MOVE : NODE_GOLDEN,
+                      player, w->cells[i].x, w->cells[i].y, 0);
+        for (uint64_t i = count - 1; i > 0; --i) {
+            uint64_t j = rng_next(&(w->rng)) % (i + 1);
+            node_t tmp = child[i];
+            child[i] = child[j];
+            child[j] = tmp;
+        }
+    }
+    node->first_child = first;
+    node->children = needed;
+    atomic_store_explicit(&(node->state), NODE_EXPANDED, memory_order_release);
+}
+
+/**
+ * Funkcja pomocnicza wybierająca dziecko rozwiniętego węzła według UCT.
+ * Dzieci jeszcze nieodwiedzone mają pierwszeństwo.
+ * @param mcts - Wskaźnik na stan przeszukiwania.
+ * @param tree - Wskaźnik na drzewo.
+ * @param parent - Indeks węzła.
+ * @return Indeks wybranego dziecka.
+ */
+static uint32_t select_child(const mcts_t *mcts, tree_t *tree,
+                             uint32_t parent) {
+    node_t *node = &(tree->nodes[parent]);
+    double log_visits = log(atomic_load_explicit(&(node->visits),
+                                                 memory_order_relaxed) + 1.0);
+    uint32_t best = node->first_child;
+    double best_value = -1.0;
+    for (uint32_t i = 0; i < node->children; ++i) {
+        node_t *child = &(tree->nodes[node->first_child + i]);
+        uint32_t visits = atomic_load_explicit(&(child->visits),
+                                               memory_order_relaxed);
+        if (visits == 0)
+            return node->first_child + i;
+        double reward = (double) atomic_load_explicit(&(child->reward),
+                                                      memory_order_relaxed) /
+                        REWARD_SCALE;
+        double value = reward / visits + mcts->config.exploration *
+                                         sqrt(log_visits / visits);
+        if (value > best_value) {
+            best_value = value;
+            best = node->first_child + i;
+        }
+    }
+    return best;
+}
+
+/**
+ * Funkcja pomocnicza wykonująca ruch węzła na planszy roboczej.
+ * @param g - Wskaźnik na planszę roboczą.
+ * @param node - Wskaźnik na węzeł.
+ */
+static void apply(gamma_t *g, const node_t *node) {
+    if (node->kind == NODE_MOVE)
+        gamma_move(g, node->player, node->x, node->y);
+    else if (node->kind == NODE_GOLDEN)
+        gamma_golden_move(g, node->player, node->x, node->y);
+}
+
+/**
+ * Funkcja pomocnicza podająca, ile odwiedzin dolicza węzłowi zejście przez
+ * niego: przy wspólnym drzewie kilku wątków odwiedziny z wirtualnymi
+ * przegranymi, a w pozostałych przypadkach jedno.
+ * @param mcts - Wskaźnik na stan przeszukiwania.
+ * @return Liczba odwiedzin.
+ */
+static inline uint32_t visit_weight(const mcts_t *mcts) {
+    return mcts->tree_count == 1 && mcts->config.threads > 1 ? VIRTUAL_LOSS : 1;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca węzeł do ścieżki wątku i doliczająca mu
+ * odwiedziny, przy wspólnym drzewie razem z wirtualnymi przegranymi.
+ * @param mcts - Wskaźnik na stan przeszukiwania.
+ * @param w - Wskaźnik na stan wątku.
+ * @param depth - Wskaźnik na długość ścieżki.
+ * @param index - Indeks węzła.
+ * @return Wartość false, gdy zabrakło pamięci na dłuższą ścieżkę.
+ */
+static bool visit(const mcts_t *mcts, worker_t *w, uint32_t *depth,
+                  uint32_t index) {
+    if (*depth == w->path_size) {
+        uint32_t *path = realloc(w->path, sizeof(uint32_t) * 2 * w->path_size);
+        if (path == NULL)
+            return false;
+        w->path = path;
+        w->path_size *= 2;
+    }
+    w->path[(*depth)++] = index;
+    uint32_t loss = visit_weight(mcts);
+    atomic_fetch_add_explicit(&(w->tree->nodes[index].visits), loss,
+                              memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza rozgrywająca losową partię zwykłymi ruchami do końca
+ * gry, czyli do chwili, gdy wszyscy gracze po kolei nie mają ruchu.
+ * @param w - Wskaźnik na stan wątku.
+ * @param player - Gracz, który ma ruch.
+ * @param passes - Liczba utraconych już z rzędu kolejek.
+ */
+static void playout(worker_t *w, uint32_t player, uint32_t passes) {
+    gamma_t *g = w->scratch;
+    uint32_t players = gamma_get_players(g);
+    while (passes < players) {
+        if (gamma_random_move(g, player, &(w->rng)))
+            passes = 0;
+        else
+            ++passes;
+        player = next_player(player, players);
+    }
+}
+
+/**
+ * Funkcja pomocnicza przekazująca wynik partii węzłom ścieżki i zdejmująca
+ * z nich wirtualne przegrane. Gracze z największą liczbą pól dzielą między
+ * siebie wygraną.
+ * @param mcts - Wskaźnik na stan przeszukiwania.
+ * @param w - Wskaźnik na stan wątku.
+ * @param depth - Długość ścieżki.
+ */
+static void backpropagate(const mcts_t *mcts, worker_t *w, uint32_t depth) {
+    uint32_t players = mcts->players;
+    uint64_t best = 0;
+    uint32_t winners = 0;
+    for (uint32_t i = 1; i <= players; ++i) {
+        w->busy[i] = gamma_busy_fields(w->scratch, i);
+        if (w->busy[i] > best) {
+            best = w->busy[i];
+            winners = 1;
+        }
+        else if (w->busy[i] == best) {
+            ++winners;
+        }
+    }
+    uint64_t share = REWARD_SCALE / winners;
+    uint32_t loss = visit_weight(mcts);
+    for (uint32_t i = 0; i < depth; ++i) {
+        node_t *node = &(w->tree->nodes[w->path[i]]);
+        if (loss > 1)
+            atomic_fetch_sub_explicit(&(node->visits), loss - 1,
+                                      memory_order_relaxed);
+        if (node->player != 0 && w->busy[node->player] == best)
+            atomic_fetch_add_explicit(&(node->reward), share,
+                                      memory_order_relaxed);
+    }
+}
+
+/**
+ * Funkcja pomocnicza wykonująca jedną iterację przeszukiwania: zejście,
+ * rozwinięcie, partię i aktualizację statystyk.
+ * @param mcts - Wskaźnik na stan przeszukiwania.
+ * @param w - Wskaźnik na stan wątku.
+ */
+static void iterate(const mcts_t *mcts, worker_t *w) {
+    tree_t *tree = w->tree;
+    uint32_t players = mcts->players;
+    uint32_t current = 0;
+    uint32_t depth = 0;
+    uint32_t to_move = mcts->root_player;
+    uint32_t weight = visit_weight(mcts);
+    gamma_copy(w->scratch, mcts->root);
+    visit(mcts, w, &depth, current);
+
+    for (;;) {
+        node_t *node = &(tree->nodes[current]);
+        unsigned state = atomic_load_explicit(&(node->state),
+                                              memory_order_acquire);
+        // Liść rozwijamy dopiero przy drugiej wizycie, korzeń od razu.
+        if (state == NODE_LEAF && node->passes >= players) {
+            atomic_store_explicit(&(node->state), NODE_FINAL,
+                                  memory_order_relaxed);
+        }
+        else if (state == NODE_LEAF &&
+                 (current == 0 ||
+                  atomic_load_explicit(&(node->visits),
+                                       memory_order_relaxed) > weight) &&
+                 atomic_compare_exchange_strong(&(node->state), &state,
+                                                NODE_EXPANDING)) {
+            expand(w, current, to_move);
+            state = atomic_load_explicit(&(node->state), memory_order_acquire);
+        }
+        if (state != NODE_EXPANDED)
+            break;
+        uint32_t child = select_child(mcts, tree, current);
+        if (!visit(mcts, w, &depth, child))
+            break;
+        current = child;
+        apply(w->scratch, &(tree->nodes[current]));
+        to_move = next_player(tree->nodes[current].player, players);
+    }
+    playout(w, to_move, tree->nodes[current].passes);
+    backpropagate(mcts, w, depth);
+    ++(w->playouts);
+}
+
+/**
+ * Zadanie puli wątków: iteracje przeszukiwania jednego wątku aż do końca
+ * czasu.
+ * @param arg - Wskaźnik na stan przeszukiwania.
+ * @param task - Numer wątku.
+ */
+static void search_task(void *arg, uint32_t task) {
+    mcts_t *mcts = arg;
+    worker_t *w = &(mcts->workers[task]);
+    do {
+        iterate(mcts, w);
+    } while (now() < mcts->deadline);
+}
+
+bool mcts_search(mcts_t *mcts, gamma_t *g, uint32_t player,
+                 mcts_result_t *out) {
+    if (mcts == NULL || g == NULL || out == NULL || player == 0 ||
+        player > mcts->players || gamma_get_players(g) != mcts->players)
+        return false;
+    uint64_t start = now();
+    mcts->deadline = start + (uint64_t) mcts->config.budget_ms * 1000000u;
+    mcts->root = g;
+    mcts->root_player = player;
+
+    // Indeks ruchów planszy g jest kopiowany do plansz roboczych, więc
+    // budujemy go raz tutaj, a nie w każdej partii.
+    gamma_legal_moves(g, player, mcts->workers[0].cells, 0);
+    if (!gamma_copy(mcts->workers[0].scratch, g))
+        return false;
+    for (uint32_t i = 0; i < mcts->tree_count; ++i) {
+        atomic_store_explicit(&(mcts->trees[i].used), 1, memory_order_relaxed);
+        init_node(&(mcts->trees[i].nodes[0]), NODE_PASS, 0, 0, 0, 0);
+    }
+    for (uint32_t i = 0; i < mcts->config.threads; ++i)
+        mcts->workers[i].playouts = 0;
+
+    if (mcts->pool != NULL)
+        thread_pool_run(mcts->pool, mcts->config.threads, search_task, mcts);
+    else
+        search_task(mcts, 0);
+
+    out->playouts = 0;
+    out->nodes = 0;
+    for (uint32_t i = 0; i < mcts->config.threads; ++i)
+        out->playouts += mcts->workers[i].playouts;
+    for (uint64_t i = 0; i < 2 * mcts->cells; ++i)
+        mcts->merged[i] = 0;
+    for (uint32_t t = 0; t < mcts->tree_count; ++t) {
+        const tree_t *tree = &(mcts->trees[t]);
+        uint32_t used = atomic_load(&(tree->used));
+        out->nodes += used < tree->capacity ? used : tree->capacity;
+        const node_t *root = &(tree->nodes[0]);
+        if (atomic_load(&(root->state)) != NODE_EXPANDED)
+            continue;
+        for (uint32_t i = 0; i < root->children; ++i) {
+            const node_t *child = &(tree->nodes[root->first_child + i]);
+            if (child->kind != NODE_PASS)
+                mcts->merged[(child->kind == NODE_GOLDEN) * mcts->cells +
+                             (uint64_t) child->y * mcts->width + child->x] +=
+                    atomic_load(&(child->visits)) + 1;
+        }
+    }
+
+    out->found = false;
+    out->golden = false;
+    uint64_t best_visits = 0;
+    for (uint64_t i = 0; i < 2 * mcts->cells; ++i) {
+        if (mcts->merged[i] > best_visits) {
+            uint64_t cell = i % mcts->cells;
+            best_visits = mcts->merged[i];
+            out->found = true;
+            out->golden = i >= mcts->cells;
+            out->x = (uint32_t) (cell % mcts->width);
+            out->y = (uint32_t) (cell / mcts->width);
+        }
+    }
+    out->elapsed_ns = now() - start;
+    return true;
+}
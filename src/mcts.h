@@ -0,0 +1,107 @@
+/**
+ * @file
+ * Interfejs gracza komputerowego wybierającego ruchy przeszukiwaniem drzewa
+ * gry metodą Monte Carlo (MCTS) z wyborem ruchów według UCT. Przeszukiwanie
+ * może działać na kilku wątkach: każdy wątek rozgrywa partie na własnej
+ * kopii planszy i buduje własne drzewo, łączone na końcu (zrównoleglenie
+ * korzenia), albo wszystkie wątki budują jedno wspólne drzewo z wirtualnymi
+ * przegranymi i atomowo aktualizowanymi statystykami węzłów.
+ */
+
+#ifndef GAMMA_MCTS_H
+#define GAMMA_MCTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+/**
+ * Struktura przechowująca stan przeszukiwania: drzewa, pulę wątków oraz
+ * kopie planszy i bufory każdego wątku, przydzielone raz dla danej planszy.
+ */
+typedef struct mcts mcts_t;
+
+/**
+ * Sposób podziału przeszukiwania między wątki.
+ */
+typedef enum mcts_parallel {
+    MCTS_TREE_PARALLEL, ///< Jedno wspólne drzewo.
+    MCTS_ROOT_PARALLEL ///< Osobne drzewa łączone w korzeniu.
+} mcts_parallel_t;
+
+/**
+ * Ustawienia przeszukiwania.
+ */
+typedef struct mcts_config {
+    uint32_t budget_ms; ///< Czas na wybór jednego ruchu w milisekundach.
+    double exploration; ///< Stała eksploracji we wzorze UCT.
+    uint32_t max_nodes; /**< Największa liczba węzłów, przy zrównolegleniu
+    korzenia dzielona równo między drzewa wątków. */
+    uint64_t seed; ///< Ziarno generatora liczb pseudolosowych, niezerowe.
+    uint32_t threads; ///< Liczba wątków, co najmniej 1.
+    mcts_parallel_t parallel; ///< Sposób podziału między wątki.
+} mcts_config_t;
+
+/**
+ * Wynik przeszukiwania.
+ */
+typedef struct mcts_result {
+    bool found; ///< Czy gracz ma jakikolwiek ruch.
+    bool golden; ///< Czy wybrany ruch jest złotym ruchem.
+    uint32_t x; ///< Numer kolumny wybranego pola.
+    uint32_t y; ///< Numer wiersza wybranego pola.
+    uint64_t playouts; ///< Liczba rozegranych losowych partii.
+    uint64_t elapsed_ns; ///< Czas przeszukiwania w nanosekundach.
+    uint32_t nodes; ///< Liczba węzłów wszystkich drzew.
+} mcts_result_t;
+
+/** Domyślny czas na ruch w milisekundach. */
+#define MCTS_DEFAULT_BUDGET_MS 100
+/** Domyślna stała eksploracji. */
+#define MCTS_DEFAULT_EXPLORATION 0.7
+/** Domyślna największa liczba węzłów drzewa. */
+#define MCTS_DEFAULT_MAX_NODES (1u << 20)
+/** Największa liczba wątków przeszukiwania. */
+#define MCTS_MAX_THREADS 256
+
+/**
+ * Funkcja wypełniająca ustawienia wartościami domyślnymi.
+ * @param config - Wskaźnik na ustawienia.
+ */
+void mcts_default_config(mcts_config_t *config);
+
+/**
+ * Funkcja tworząca stan przeszukiwania dla plansz o parametrach planszy
+ * @p g. Liczba wątków powyżej @ref MCTS_MAX_THREADS jest obcinana.
+ * @param g - Wskaźnik na planszę.
+ * @param config - Wskaźnik na ustawienia lub NULL dla domyślnych.
+ * @return Wskaźnik na stan przeszukiwania lub NULL, gdy zabrakło pamięci
+ * lub nie udało się uruchomić wątków.
+ */
+mcts_t* mcts_new(gamma_t *g, const mcts_config_t *config);
+
+/**
+ * Funkcja zwalniająca stan przeszukiwania. Nic nie robi dla NULL.
+ * @param mcts - Wskaźnik na stan przeszukiwania.
+ */
+void mcts_delete(mcts_t *mcts);
+
+/**
+ * Funkcja wybierająca ruch gracza @p player na planszy @p g. Przez czas
+ * z ustawień powtarza: zejście drzewem według UCT, rozwinięcie liścia o
+ * wszystkie zwykłe i złote ruchy gracza, losową partię zwykłymi ruchami do
+ * końca gry na kopii planszy i aktualizację statystyk na ścieżce. Wygrana
+ * daje graczowi 1, remis k graczy po 1/k. Wybierany jest najczęściej
+ * odwiedzany ruch, przy zrównolegleniu korzenia po zsumowaniu odwiedzin
+ * ze wszystkich drzew. Plansza @p g nie jest zmieniana i nie wolno jej
+ * zmieniać w trakcie przeszukiwania.
+ * @param mcts - Wskaźnik na stan przeszukiwania utworzony dla tej planszy.
+ * @param g - Wskaźnik na planszę.
+ * @param player - Numer gracza, który ma wykonać ruch.
+ * @param out - Wskaźnik, pod który zapisujemy wynik.
+ * @return Wartość false, gdy parametry są niepoprawne lub zabrakło pamięci.
+ */
+bool mcts_search(mcts_t *mcts, gamma_t *g, uint32_t player,
+                 mcts_result_t *out);
+
+#endif //GAMMA_MCTS_H
@@ -0,0 +1,521 @@
+/**
+ * @file
+ * Implementacja indeksu ruchów. Każde pole należy do dokładnie jednej listy
+ * pól właściciela i do list brzegu albo styku co najwyżej czterech różnych
+ * graczy sąsiadujących z polem. Pozycje pola w tych listach są zapamiętane
+ * przy polu, więc wstawianie i usuwanie działa w czasie stałym.
+ *
+ * Pola graczy leżące na czyimś styku są dodatkowo rozłożone na kubełki
+ * według właściciela i ograniczenia liczby obszarów, na które rozpadną się
+ * ich sąsiedzi po opróżnieniu pola. Każde pole, którego właściciel może
+ * sobie pozwolić na taki rozpad, jest policzone u wszystkich graczy z nim
+ * sąsiadujących. Zmiana liczby obszarów właściciela przelicza tylko
+ * kubełki między starym i nowym zapasem.
+ */
+
+#include "move_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NEIGHBOURS 4 ///< Liczba sąsiadów pola.
+#define RING 8 ///< Liczba pól otaczających pole, łącznie z narożnymi.
+#define BUCKETS (NEIGHBOURS + 1) ///< Liczba kubełków pól styku gracza.
+#define NO_BUCKET UINT64_MAX ///< Pozycja pola, które nie leży w kubełku.
+#define MIN_CAPACITY 16 ///< Początkowy rozmiar tablicy listy.
+
+/**
+ * Przynależność pola do listy brzegu albo styku jednego gracza.
+ */
+typedef struct slot {
+    uint32_t player; ///< Numer gracza lub 0 dla wolnego miejsca.
+    uint64_t pos; ///< Pozycja pola w liście gracza.
+} slot_t;
+
+/**
+ * Struktura przechowująca indeks ruchów.
+ */
+struct move_index {
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t height; ///< Wysokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    uint32_t *owners; ///< Właściciele pól w porządku wierszowym.
+    uint64_t *owned_pos; ///< Pozycje pól w listach ich właścicieli.
+    slot_t *slots; ///< Po NEIGHBOURS przynależności każdego pola.
+    move_list_t *owned; ///< Listy pól graczy, pod indeksem 0 puste pola.
+    move_list_t *frontier; ///< Listy brzegów graczy.
+    move_list_t *contact; ///< Listy styków graczy.
+    uint8_t *bounds; ///< Ograniczenia rozpadu obszaru dla pól w kubełkach.
+    uint64_t *bucket_pos; ///< Pozycje pól w kubełkach lub NO_BUCKET.
+    /** Po BUCKETS kubełków pól styku każdego gracza, według ograniczenia. */
+    move_list_t *buckets;
+    int32_t *budgets; ///< Największe ograniczenie, na które stać gracza.
+    uint64_t *golden; ///< Liczby pewnych celów złotego ruchu graczy.
+};
+
+/** Przesunięcia sąsiadów w poziomie. */
+static const int delta_x[NEIGHBOURS] = {-1, 1, 0, 0};
+/** Przesunięcia sąsiadów w pionie. */
+static const int delta_y[NEIGHBOURS] = {0, 0, -1, 1};
+/** Przesunięcia pól otaczających w poziomie, zgodnie z ruchem wskazówek
+ * zegara od górnego; pola o parzystych numerach są sąsiadami. */
+static const int ring_x[RING] = {0, 1, 1, 1, 0, -1, -1, -1};
+/** Przesunięcia pól otaczających w pionie. */
+static const int ring_y[RING] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+/**
+ * Funkcja pomocnicza pakująca współrzędne pola.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Pole zapisane jako (y << 32) | x.
+ */
+static inline uint64_t pack(uint32_t x, uint32_t y) {
+    return ((uint64_t) y << 32) | x;
+}
+
+/**
+ * Funkcja pomocnicza podająca numer pola w porządku wierszowym.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Pole zapisane jako (y << 32) | x.
+ * @return Numer pola.
+ */
+static inline uint64_t dense(const move_index_t *index, uint64_t cell) {
+    return (cell >> 32) * index->width + (uint32_t) cell;
+}
+
+/**
+ * Funkcja pomocnicza podająca sąsiada pola.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Pole zapisane jako (y << 32) | x.
+ * @param direction - Numer kierunku, od 0 do NEIGHBOURS - 1.
+ * @param out - Wskaźnik na miejsce na sąsiada.
+ * @return Wartość true, gdy sąsiad leży na planszy.
+ */
+static inline bool neighbour(const move_index_t *index, uint64_t cell,
+                             int direction, uint64_t *out) {
+    int64_t x = (int64_t) (uint32_t) cell + delta_x[direction];
+    int64_t y = (int64_t) (cell >> 32) + delta_y[direction];
+    if (x < 0 || y < 0 || x >= index->width || y >= index->height)
+        return false;
+    *out = pack((uint32_t) x, (uint32_t) y);
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca pole na koniec listy.
+ * @param list - Wskaźnik na listę.
+ * @param cell - Pole.
+ * @return Pozycja pola lub UINT64_MAX, gdy zabrakło pamięci.
+ */
+static uint64_t list_push(move_list_t *list, uint64_t cell) {
+    if (list->count == list->capacity) {
+        uint64_t capacity = list->capacity < MIN_CAPACITY ?
+                            MIN_CAPACITY : 2 * list->capacity;
+        uint64_t *cells = realloc(list->cells, sizeof(uint64_t) * capacity);
+        if (cells == NULL)
+            return UINT64_MAX;
+        list->cells = cells;
+        list->capacity = capacity;
+    }
+    list->cells[list->count] = cell;
+    return list->count++;
+}
+
+/**
+ * Funkcja pomocnicza usuwająca z listy brzegu lub styku gracza @p player
+ * pole z pozycji @p pos, przenosząc na nią ostatnie pole listy.
+ * @param index - Wskaźnik na indeks.
+ * @param list - Wskaźnik na listę.
+ * @param player - Numer gracza listy.
+ * @param pos - Pozycja usuwanego pola.
+ */
+static void slot_list_remove(move_index_t *index, move_list_t *list,
+                             uint32_t player, uint64_t pos) {
+    uint64_t last = list->cells[--(list->count)];
+    if (pos == list->count)
+        return;
+    list->cells[pos] = last;
+    slot_t *slots = index->slots + dense(index, last) * NEIGHBOURS;
+    for (int i = 0; i < NEIGHBOURS; ++i) {
+        if (slots[i].player == player) {
+            slots[i].pos = pos;
+            return;
+        }
+    }
+}
+
+/**
+ * Funkcja pomocnicza usuwająca pole ze wszystkich list brzegów i styków.
+ * Rodzaj list wynika z bieżącego właściciela pola, więc trzeba ją wywołać
+ * przed jego zmianą.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Pole.
+ */
+static void detach(move_index_t *index, uint64_t cell) {
+    uint64_t id = dense(index, cell);
+    move_list_t *lists = index->owners[id] == 0 ?
+                         index->frontier : index->contact;
+    slot_t *slots = index->slots + id * NEIGHBOURS;
+    for (int i = 0; i < NEIGHBOURS; ++i) {
+        if (slots[i].player != 0) {
+            slot_list_remove(index, &(lists[slots[i].player]),
+                             slots[i].player, slots[i].pos);
+            slots[i].player = 0;
+        }
+    }
+}
+
+/**
+ * Funkcja pomocnicza dopisująca pole do list brzegów lub styków graczy,
+ * których pola sąsiadują z polem.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Pole.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool attach(move_index_t *index, uint64_t cell) {
+    uint64_t id = dense(index, cell);
+    uint32_t owner = index->owners[id];
+    move_list_t *lists = owner == 0 ? index->frontier : index->contact;
+    slot_t *slots = index->slots + id * NEIGHBOURS;
+    int used = 0;
+    for (int i = 0; i < NEIGHBOURS; ++i) {
+        uint64_t next;
+        if (!neighbour(index, cell, i, &next))
+            continue;
+        uint32_t player = index->owners[dense(index, next)];
+        bool seen = player == 0 || player == owner;
+        for (int j = 0; j < used && !seen; ++j)
+            seen = slots[j].player == player;
+        if (seen)
+            continue;
+        uint64_t pos = list_push(&(lists[player]), cell);
+        if (pos == UINT64_MAX)
+            return false;
+        slots[used].player = player;
+        slots[used].pos = pos;
+        ++used;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza licząca ograniczenie liczby obszarów, na które
+ * rozpadną się sąsiedzi zajętego pola należący do jego właściciela, jeśli
+ * pole zostanie opróżnione. Dwóch sąsiadów połączonych przez wspólne pole
+ * narożne na pewno zostanie w jednym obszarze, więc wynikiem jest liczba
+ * takich sąsiadów pomniejszona o liczbę łączących ich pól narożnych, ale
+ * nie mniejsza niż jeden, jeśli pole ma sąsiada.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Zajęte pole.
+ * @return Liczba od 0 do NEIGHBOURS.
+ */
+static uint8_t split_bound(const move_index_t *index, uint64_t cell) {
+    uint32_t owner = index->owners[dense(index, cell)];
+    bool same[RING];
+    for (int i = 0; i < RING; ++i) {
+        int64_t x = (int64_t) (uint32_t) cell + ring_x[i];
+        int64_t y = (int64_t) (cell >> 32) + ring_y[i];
+        same[i] = x >= 0 && y >= 0 && x < index->width &&
+                  y < index->height &&
+                  index->owners[(uint64_t) y * index->width + x] == owner;
+    }
+    int neighbours = 0, joined = 0;
+    for (int i = 0; i < RING; i += 2) {
+        neighbours += same[i];
+        joined += same[i] && same[i + 1] && same[(i + 2) % RING];
+    }
+    if (neighbours == 0)
+        return 0;
+    return neighbours > joined ? (uint8_t) (neighbours - joined) : 1;
+}
+
+/**
+ * Funkcja pomocnicza podająca kubełek pól styku gracza.
+ * @param index - Wskaźnik na indeks.
+ * @param owner - Numer właściciela pól.
+ * @param bound - Ograniczenie rozpadu obszaru pól kubełka.
+ * @return Wskaźnik na kubełek.
+ */
+static inline move_list_t* bucket_of(const move_index_t *index,
+                                     uint32_t owner, uint8_t bound) {
+    return &(index->buckets[(size_t) owner * BUCKETS + bound]);
+}
+
+/**
+ * Funkcja pomocnicza dodająca @p delta do liczby pewnych celów złotego
+ * ruchu graczy, na których styku leży pole.
+ * @param index - Wskaźnik na indeks.
+ * @param id - Numer zajętego pola w porządku wierszowym.
+ * @param delta - 1 lub -1.
+ */
+static void count_golden(move_index_t *index, uint64_t id, int delta) {
+    const slot_t *slots = index->slots + id * NEIGHBOURS;
+    for (int i = 0; i < NEIGHBOURS && slots[i].player != 0; ++i)
+        index->golden[slots[i].player] += (uint64_t) (int64_t) delta;
+}
+
+/**
+ * Funkcja pomocnicza wstawiająca zajęte pole leżące na czyimś styku do
+ * kubełka jego właściciela i liczącą je u sąsiadujących graczy, jeśli
+ * właściciela stać na jego utratę. Ograniczenie jest liczone tylko dla pól
+ * na styku, bo tylko one trafiają do kubełków.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Pole.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool account(move_index_t *index, uint64_t cell) {
+    uint64_t id = dense(index, cell);
+    uint32_t owner = index->owners[id];
+    if (owner == 0 || index->slots[id * NEIGHBOURS].player == 0)
+        return true;
+    uint8_t bound = split_bound(index, cell);
+    index->bounds[id] = bound;
+    uint64_t pos = list_push(bucket_of(index, owner, bound), cell);
+    if (pos == UINT64_MAX)
+        return false;
+    index->bucket_pos[id] = pos;
+    if (bound <= index->budgets[owner])
+        count_golden(index, id, 1);
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza cofająca @ref account dla pola. Trzeba ją wywołać
+ * przed zmianą właściciela pola, jego ograniczenia lub jego styków.
+ * @param index - Wskaźnik na indeks.
+ * @param cell - Pole.
+ */
+static void unaccount(move_index_t *index, uint64_t cell) {
+    uint64_t id = dense(index, cell);
+    uint64_t pos = index->bucket_pos[id];
+    if (pos == NO_BUCKET)
+        return;
+    uint32_t owner = index->owners[id];
+    uint8_t bound = index->bounds[id];
+    move_list_t *bucket = bucket_of(index, owner, bound);
+    uint64_t last = bucket->cells[--(bucket->count)];
+    bucket->cells[pos] = last;
+    index->bucket_pos[dense(index, last)] = pos;
+    index->bucket_pos[id] = NO_BUCKET;
+    if (bound <= index->budgets[owner])
+        count_golden(index, id, -1);
+}
+
+move_index_t* move_index_new(uint32_t width, uint32_t height,
+                             uint32_t players) {
+    uint64_t cells = (uint64_t) width * height;
+    if (cells == 0 || cells > SIZE_MAX / (sizeof(slot_t) * NEIGHBOURS))
+        return NULL;
+    move_index_t *index = calloc(1, sizeof(move_index_t));
+    if (index == NULL)
+        return NULL;
+    index->width = width;
+    index->height = height;
+    index->players = players;
+    index->owners = calloc(cells, sizeof(uint32_t));
+    index->owned_pos = malloc(sizeof(uint64_t) * cells);
+    index->slots = calloc(cells * NEIGHBOURS, sizeof(slot_t));
+    index->owned = calloc((size_t) players + 1, sizeof(move_list_t));
+    index->frontier = calloc((size_t) players + 1, sizeof(move_list_t));
+    index->contact = calloc((size_t) players + 1, sizeof(move_list_t));
+    index->bounds = calloc(cells, sizeof(uint8_t));
+    index->bucket_pos = malloc(sizeof(uint64_t) * cells);
+    index->buckets = calloc(((size_t) players + 1) * BUCKETS,
+                            sizeof(move_list_t));
+    index->budgets = malloc(sizeof(int32_t) * ((size_t) players + 1));
+    index->golden = calloc((size_t) players + 1, sizeof(uint64_t));
+    move_list_t *empty = index->owned;
+    if (index->owners == NULL || index->owned_pos == NULL ||
+        index->slots == NULL || empty == NULL ||
+        index->frontier == NULL || index->contact == NULL ||
+        index->bounds == NULL || index->bucket_pos == NULL ||
+        index->buckets == NULL || index->budgets == NULL ||
+        index->golden == NULL ||
+        (empty->cells = malloc(sizeof(uint64_t) * cells)) == NULL) {
+        move_index_delete(index);
+        return NULL;
+    }
+
+    empty->count = empty->capacity = cells;
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint64_t id = (uint64_t) y * width + x;
+            empty->cells[id] = pack(x, y);
+            index->owned_pos[id] = id;
+            index->bucket_pos[id] = NO_BUCKET;
+        }
+    }
+    for (uint32_t i = 0; i <= players; ++i)
+        index->budgets[i] = NEIGHBOURS;
+    return index;
+}
+
+void move_index_delete(move_index_t *index) {
+    if (index == NULL)
+        return;
+    for (uint32_t i = 0; i <= index->players; ++i) {
+        if (index->owned != NULL)
+            free(index->owned[i].cells);
+        if (index->frontier != NULL)
+            free(index->frontier[i].cells);
+        if (index->contact != NULL)
+            free(index->contact[i].cells);
+        for (int j = 0; j < BUCKETS && index->buckets != NULL; ++j)
+            free(bucket_of(index, i, (uint8_t) j)->cells);
+    }
+    free(index->owned);
+    free(index->frontier);
+    free(index->contact);
+    free(index->owners);
+    free(index->owned_pos);
+    free(index->slots);
+    free(index->bounds);
+    free(index->bucket_pos);
+    free(index->buckets);
+    free(index->budgets);
+    free(index->golden);
+    free(index);
+}
+
+/**
+ * Funkcja pomocnicza kopiująca listę pól.
+ * @param dst - Wskaźnik na listę docelową.
+ * @param src - Wskaźnik na listę źródłową.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool list_copy(move_list_t *dst, const move_list_t *src) {
+    if (dst->capacity < src->count) {
+        uint64_t *cells = realloc(dst->cells, sizeof(uint64_t) * src->capacity);
+        if (cells == NULL)
+            return false;
+        dst->cells = cells;
+        dst->capacity = src->capacity;
+    }
+    if (src->count > 0)
+        memcpy(dst->cells, src->cells, sizeof(uint64_t) * src->count);
+    dst->count = src->count;
+    return true;
+}
+
+bool move_index_copy(move_index_t *dst, const move_index_t *src) {
+    if (dst->width != src->width || dst->height != src->height ||
+        dst->players != src->players)
+        return false;
+    size_t cells = (size_t) src->width * src->height;
+    memcpy(dst->owners, src->owners, sizeof(uint32_t) * cells);
+    memcpy(dst->owned_pos, src->owned_pos, sizeof(uint64_t) * cells);
+    memcpy(dst->slots, src->slots, sizeof(slot_t) * NEIGHBOURS * cells);
+    memcpy(dst->bounds, src->bounds, sizeof(uint8_t) * cells);
+    memcpy(dst->bucket_pos, src->bucket_pos, sizeof(uint64_t) * cells);
+    memcpy(dst->budgets, src->budgets,
+           sizeof(int32_t) * ((size_t) src->players + 1));
+    memcpy(dst->golden, src->golden,
+           sizeof(uint64_t) * ((size_t) src->players + 1));
+    for (uint32_t i = 0; i <= src->players; ++i) {
+        if (!list_copy(&(dst->owned[i]), &(src->owned[i])) ||
+            !list_copy(&(dst->frontier[i]), &(src->frontier[i])) ||
+            !list_copy(&(dst->contact[i]), &(src->contact[i])))
+            return false;
+        for (int j = 0; j < BUCKETS; ++j)
+            if (!list_copy(bucket_of(dst, i, (uint8_t) j),
+                           bucket_of(src, i, (uint8_t) j)))
+                return false;
+    }
+    return true;
+}
+
+bool move_index_set(move_index_t *index, uint32_t x, uint32_t y,
+                    uint32_t owner) {
+    uint64_t cell = pack(x, y);
+    uint64_t id = dense(index, cell);
+    uint32_t old = index->owners[id];
+    if (old == owner)
+        return true;
+
+    uint64_t around[NEIGHBOURS];
+    int count = 0;
+    for (int i = 0; i < NEIGHBOURS; ++i)
+        if (neighbour(index, cell, i, &(around[count])))
+            ++count;
+    // Zmiana właściciela zmienia styki pola i jego sąsiadów, a ograniczenia
+    // pól narożnych tylko wtedy, gdy należą do starego lub nowego
+    // właściciela.
+    uint64_t block[RING + 1];
+    int blocks = 0;
+    block[blocks++] = cell;
+    for (int i = 0; i < count; ++i)
+        block[blocks++] = around[i];
+    for (int i = 1; i < RING; i += 2) {
+        int64_t bx = (int64_t) x + ring_x[i], by = (int64_t) y + ring_y[i];
+        if (bx < 0 || by < 0 || bx >= index->width || by >= index->height)
+            continue;
+        uint32_t corner = index->owners[(uint64_t) by * index->width + bx];
+        if (corner != 0 && (corner == old || corner == owner))
+            block[blocks++] = pack((uint32_t) bx, (uint32_t) by);
+    }
+    for (int i = 0; i < blocks; ++i)
+        unaccount(index, block[i]);
+
+    detach(index, cell);
+    for (int i = 0; i < count; ++i)
+        detach(index, around[i]);
+
+    move_list_t *from = &(index->owned[old]);
+    uint64_t last = from->cells[--(from->count)];
+    from->cells[index->owned_pos[id]] = last;
+    index->owned_pos[dense(index, last)] = index->owned_pos[id];
+    uint64_t pos = list_push(&(index->owned[owner]), cell);
+    if (pos == UINT64_MAX)
+        return false;
+    index->owned_pos[id] = pos;
+    index->owners[id] = owner;
+
+    if (!attach(index, cell))
+        return false;
+    for (int i = 0; i < count; ++i)
+        if (!attach(index, around[i]))
+            return false;
+    for (int i = 0; i < blocks; ++i)
+        if (!account(index, block[i]))
+            return false;
+    return true;
+}
+
+void move_index_set_budget(move_index_t *index, uint32_t owner,
+                           int64_t budget) {
+    int32_t to = budget < -1 ? -1 : budget > NEIGHBOURS ? NEIGHBOURS :
+                 (int32_t) budget;
+    int32_t from = index->budgets[owner];
+    int delta = to > from ? 1 : -1;
+    int32_t low = to > from ? from : to;
+    int32_t high = to > from ? to : from;
+    for (int32_t bound = low + 1; bound <= high; ++bound) {
+        const move_list_t *bucket = bucket_of(index, owner, (uint8_t) bound);
+        for (uint64_t i = 0; i < bucket->count; ++i)
+            count_golden(index, dense(index, bucket->cells[i]), delta);
+    }
+    index->budgets[owner] = to;
+}
+
+uint64_t move_index_golden(const move_index_t *index, uint32_t player) {
+    return index->golden[player];
+}
+
+const move_list_t* move_index_owned(const move_index_t *index,
+                                    uint32_t player) {
+    return &(index->owned[player]);
+}
+
+const move_list_t* move_index_frontier(const move_index_t *index,
+                                       uint32_t player) {
+    return &(index->frontier[player]);
+}
+
+const move_list_t* move_index_contact(const move_index_t *index,
+                                      uint32_t player) {
+    return &(index->contact[player]);
+}
+
+uint32_t move_index_split_bound(const move_index_t *index,
+                                uint32_t x, uint32_t y) {
+    return split_bound(index, pack(x, y));
+}
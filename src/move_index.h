@@ -0,0 +1,136 @@
+/**
+ * @file
+ * Interfejs indeksu ruchów: zbiorów pól każdego gracza, pustych pól
+ * sąsiadujących z graczem (brzegu gracza) i pól innych graczy sąsiadujących
+ * z graczem (styku gracza), aktualizowanych przy każdej zmianie właściciela
+ * pola, oraz liczby pewnych celów złotego ruchu każdego gracza. Pola w
+ * listach są zapisane jako (y << 32) | x.
+ */
+
+#ifndef GAMMA_MOVE_INDEX_H
+#define GAMMA_MOVE_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Struktura przechowująca indeks ruchów.
+ */
+typedef struct move_index move_index_t;
+
+/**
+ * Lista pól. Kolejność pól zależy od historii zmian.
+ */
+typedef struct move_list {
+    uint64_t *cells; ///< Pola listy.
+    uint64_t count; ///< Liczba pól listy.
+    uint64_t capacity; ///< Rozmiar tablicy cells.
+} move_list_t;
+
+/**
+ * Funkcja tworząca indeks pustej planszy.
+ * @param width - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @param players - Liczba graczy.
+ * @return Wskaźnik na indeks lub NULL, gdy zabrakło pamięci.
+ */
+move_index_t* move_index_new(uint32_t width, uint32_t height,
+                             uint32_t players);
+
+/**
+ * Funkcja zwalniająca indeks. Nic nie robi, jeśli @p index jest NULL.
+ * @param index - Wskaźnik na indeks.
+ */
+void move_index_delete(move_index_t *index);
+
+/**
+ * Funkcja kopiująca stan indeksu @p src do indeksu @p dst tej samej planszy.
+ * Pamięć jest przydzielana tylko wtedy, gdy któraś z list @p dst jest za
+ * krótka, więc kolejne kopie tego samego indeksu jej nie przydzielają.
+ * @param dst - Wskaźnik na indeks docelowy.
+ * @param src - Wskaźnik na indeks źródłowy.
+ * @return Wartość false, gdy rozmiary planszy są różne lub zabrakło pamięci;
+ * indeks @p dst jest wtedy niespójny i trzeba go usunąć.
+ */
+bool move_index_copy(move_index_t *dst, const move_index_t *src);
+
+/**
+ * Funkcja zmieniająca właściciela pola (@p x, @p y) na @p owner i
+ * aktualizująca listy pola i jego sąsiadów.
+ * @param index - Wskaźnik na indeks.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @param owner - Numer nowego właściciela lub 0 dla pustego pola.
+ * @return Wartość false, gdy zabrakło pamięci; indeks jest wtedy
+ * niespójny i trzeba go usunąć.
+ */
+bool move_index_set(move_index_t *index, uint32_t x, uint32_t y,
+                    uint32_t owner);
+
+/**
+ * Funkcja podająca listę pól gracza @p player.
+ * @param index - Wskaźnik na indeks.
+ * @param player - Numer gracza lub 0 dla listy pustych pól.
+ * @return Wskaźnik na listę.
+ */
+const move_list_t* move_index_owned(const move_index_t *index,
+                                    uint32_t player);
+
+/**
+ * Funkcja podająca listę pustych pól sąsiadujących z polami gracza.
+ * @param index - Wskaźnik na indeks.
+ * @param player - Numer gracza.
+ * @return Wskaźnik na listę.
+ */
+const move_list_t* move_index_frontier(const move_index_t *index,
+                                       uint32_t player);
+
+/**
+ * Funkcja podająca listę pól innych graczy sąsiadujących z polami gracza.
+ * @param index - Wskaźnik na indeks.
+ * @param player - Numer gracza.
+ * @return Wskaźnik na listę.
+ */
+const move_list_t* move_index_contact(const move_index_t *index,
+                                      uint32_t player);
+
+/**
+ * Funkcja podająca ograniczenie z góry liczby obszarów, na które rozpadną
+ * się sąsiedzi pola (@p x, @p y) należący do jego właściciela, jeśli pole
+ * zostanie opróżnione. Sąsiedzi połączeni przez wspólne pole narożne są
+ * liczeni raz.
+ * @param index - Wskaźnik na indeks.
+ * @param x - Numer kolumny zajętego pola.
+ * @param y - Numer wiersza zajętego pola.
+ * @return Liczba od 0 do 4.
+ */
+uint32_t move_index_split_bound(const move_index_t *index,
+                                uint32_t x, uint32_t y);
+
+/**
+ * Funkcja ustawiająca największy rozpad obszaru, na który stać gracza
+ * @p owner przy utracie pola, czyli maksymalną liczbę obszarów
+ * powiększoną o jeden i pomniejszoną o liczbę obszarów gracza. Koszt jest
+ * rzędu liczby pól styku gracza, których ograniczenie leży między starą a
+ * nową wartością.
+ * @param index - Wskaźnik na indeks.
+ * @param owner - Numer gracza.
+ * @param budget - Nowa wartość; wartości spoza przedziału od -1 do 4 są do
+ * niego przycinane.
+ */
+void move_index_set_budget(move_index_t *index, uint32_t owner,
+                           int64_t budget);
+
+/**
+ * Funkcja podająca liczbę pól innych graczy sąsiadujących z polami gracza,
+ * których właściciela stać na rozpad obszaru według
+ * @ref move_index_split_bound. Każde takie pole na pewno można zająć złotym
+ * ruchem, ale gdy liczba jest zerem, pole o ograniczeniu wyższym niż
+ * faktyczny rozpad może jeszcze istnieć.
+ * @param index - Wskaźnik na indeks.
+ * @param player - Numer gracza.
+ * @return Liczba pól.
+ */
+uint64_t move_index_golden(const move_index_t *index, uint32_t player);
+
+#endif //GAMMA_MOVE_INDEX_H
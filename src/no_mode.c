@@ -3,8 +3,12 @@
  * Implementacja modułu zawierającego wczytywanie standardowego wejścia przed
  * wybraniem trybu gry.
  */
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do open i close.
+
+#include <fcntl.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <unistd.h>
 #include "no_mode.h"
 #include "interactive_mode.h"
 #include "batch_mode.h"
@@ -87,10 +91,36 @@ static gamma_t* get_game(size_t *line, int *mode) {
     return NULL;
 }
 
+/**
+ * Funkcja pomocnicza rozgrywająca grę w trybie wsadowym, w razie potrzeby
+ * zapisując jej przebieg do pliku.
+ * @param g         - Wskaźnik na planszę do gry w Gamma.
+ * @param line      - Wskaźnik na aktualny numer wiersza.
+ * @param record    - wskaźnik na ustawienia zapisu przebiegu gry.
+ */
+static void recorded_batch_mode(gamma_t *g, size_t *line,
+                                const record_options_t *record) {
+    if (record->path == NULL) {
+        batch_mode(g, line, NULL);
+        return;
+    }
+    int fd = open(record->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    gamma_recorder_t *recorder = NULL;
+    if (fd < 0 || (recorder = gamma_recorder_new(g, fd,
+                                                 record->interval)) == NULL)
+        perror(record->path);
+    batch_mode(g, line, recorder);
+    if (fd >= 0)
+        close(fd);
+}
+
 /**
  * Funkcja rozpoczynająca grę i wywołująca odpowiedni tryb.
+ * @param options   - wskaźnik na ustawienia trybu interaktywnego.
+ * @param record    - wskaźnik na ustawienia zapisu przebiegu gry.
  */
-void begin_game() {
+void begin_game(const interactive_options_t *options,
+                const record_options_t *record) {
     size_t line = START_LINE;
     int mode = NO_MODE;
 
@@ -107,8 +137,8 @@ void begin_game() {
 
     if (mode == BATCH_MODE) {
         printf("OK %zu\n", line - 1);
-        batch_mode(g, &line);
+        recorded_batch_mode(g, &line, record);
     }
     else if(mode == INTERACTIVE_MODE)
-        interactive_mode(g);
+        interactive_mode(g, options);
 }
\ No newline at end of file
@@ -6,12 +6,27 @@
 #ifndef GAMMA_NO_MODE_H
 #define GAMMA_NO_MODE_H
 
+#include "interactive_mode.h"
+#include "record.h"
+
+/**
+ * Ustawienia zapisu przebiegu gry w trybie wsadowym.
+ */
+typedef struct record_options {
+    const char *path; ///< Ścieżka pliku przebiegu albo NULL bez zapisu.
+    uint32_t interval; ///< Odstęp między punktami kontrolnymi.
+} record_options_t;
+
 /**
  * Funkcja odpowiadająca za wczytanie polecenia z poprawnym trybem gry i
  * wywołaniem odpowiedniego trybu gry.
  * Z każdym błędnym poleceniem wypisuje stosowny błąd na stderr zgodnie
  * ze specyfikacją zadania.
+ * @param options   - wskaźnik na ustawienia trybu interaktywnego.
+ * @param record    - wskaźnik na ustawienia zapisu przebiegu gry, które
+ * dotyczą tylko trybu wsadowego.
  */
-void begin_game();
+void begin_game(const interactive_options_t *options,
+                const record_options_t *record);
 
 #endif //GAMMA_NO_MODE_H
@@ -0,0 +1,508 @@
+/**
+ * @file
+ * Implementacja zapisu przebiegu gry z punktami kontrolnymi i odtwarzania
+ * stanu gry po dowolnym ruchu.
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do pread i fstat.
+
+#include "record.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RECORD_MAGIC "GAMMAREC" ///< Znacznik początku pliku przebiegu.
+#define RECORD_END_MAGIC "GAMMAEND" ///< Znacznik końca pliku przebiegu.
+#define RECORD_VERSION 1 ///< Wersja formatu.
+#define RECORD_BYTE_ORDER 0x01020304u ///< Znacznik porządku bajtów.
+#define RECORD_GOLDEN (UINT32_C(1) << 31) ///< Bit złotego ruchu.
+#define RECORD_BUFFER 4096 ///< Liczba ruchów w buforze zapisu i odczytu.
+#define RECORD_INITIAL_INDEX 16 ///< Początkowy rozmiar indeksu.
+
+/**
+ * Nagłówek pliku przebiegu.
+ */
+typedef struct record_header {
+    char magic[8]; ///< Znacznik @ref RECORD_MAGIC bez kończącego zera.
+    uint32_t version; ///< Wersja formatu.
+    uint32_t byte_order; ///< Znacznik @ref RECORD_BYTE_ORDER.
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t height; ///< Wysokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    uint32_t areas; ///< Maksymalna liczba obszarów gracza.
+    uint32_t interval; ///< Odstęp między punktami kontrolnymi.
+    uint32_t reserved; ///< Zero.
+} record_header_t;
+
+/**
+ * Zapisany ruch. Ruch gracza 0 oznacza, że dalej leży migawka.
+ */
+typedef struct record_move {
+    uint32_t player; ///< Numer gracza, z bitem @ref RECORD_GOLDEN.
+    uint32_t x; ///< Numer kolumny.
+    uint32_t y; ///< Numer wiersza.
+} record_move_t;
+
+/**
+ * Element indeksu punktów kontrolnych.
+ */
+typedef struct record_checkpoint {
+    uint64_t move; ///< Liczba ruchów przed punktem kontrolnym.
+    uint64_t offset; ///< Położenie migawki w pliku.
+} record_checkpoint_t;
+
+/**
+ * Stopka pliku przebiegu.
+ */
+typedef struct record_footer {
+    uint64_t index_offset; ///< Położenie indeksu punktów kontrolnych.
+    uint64_t checkpoints; ///< Liczba punktów kontrolnych.
+    uint64_t moves; ///< Liczba zapisanych ruchów.
+    char magic[8]; ///< Znacznik @ref RECORD_END_MAGIC.
+} record_footer_t;
+
+_Static_assert(sizeof(record_header_t) == 40 && sizeof(record_move_t) == 12 &&
+               sizeof(record_checkpoint_t) == 16 &&
+               sizeof(record_footer_t) == 32,
+               "record structures must have no padding");
+
+/**
+ * Struktura przechowująca stan zapisu przebiegu gry.
+ */
+struct gamma_recorder {
+    gamma_t *g; ///< Plansza.
+    int fd; ///< Deskryptor pliku.
+    int error; ///< Kod pierwszego błędu zapisu albo 0.
+    uint32_t interval; ///< Odstęp między punktami kontrolnymi.
+    uint32_t used; ///< Liczba ruchów w buforze.
+    uint64_t moves; ///< Liczba zapisanych ruchów.
+    uint64_t offset; ///< Położenie w pliku za ostatnim zapisanym bajtem.
+    uint64_t checkpoints; ///< Liczba punktów kontrolnych.
+    uint64_t capacity; ///< Rozmiar indeksu.
+    record_checkpoint_t *index; ///< Indeks punktów kontrolnych.
+    record_move_t buffer[RECORD_BUFFER]; ///< Bufor ruchów.
+};
+
+/**
+ * Funkcja pomocnicza zapisująca całą tablicę bajtów.
+ * @param fd - Deskryptor pliku.
+ * @param data - Wskaźnik na dane.
+ * @param size - Liczba bajtów.
+ * @return Wartość false z ustawionym errno, gdy zapis się nie udał.
+ */
+static bool write_all(int fd, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        bytes += written;
+        size -= (size_t) written;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza czytająca dokładnie @p size bajtów od bieżącego
+ * położenia w pliku.
+ * @param fd - Deskryptor pliku.
+ * @param data - Wskaźnik na bufor.
+ * @param size - Liczba bajtów.
+ * @return Wartość false z ustawionym errno (EBADMSG, gdy plik się skończył),
+ * jeśli odczyt się nie udał.
+ */
+static bool read_all(int fd, void *data, size_t size) {
+    uint8_t *bytes = data;
+    while (size > 0) {
+        ssize_t got = read(fd, bytes, size);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            return false;
+        if (got == 0) {
+            errno = EBADMSG;
+            return false;
+        }
+        bytes += got;
+        size -= (size_t) got;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza czytająca dokładnie @p size bajtów z położenia
+ * @p offset.
+ * @param fd - Deskryptor pliku.
+ * @param data - Wskaźnik na bufor.
+ * @param size - Liczba bajtów.
+ * @param offset - Położenie w pliku.
+ * @return Wartość false z ustawionym errno, jeśli odczyt się nie udał.
+ */
+static bool pread_all(int fd, void *data, size_t size, uint64_t offset) {
+    uint8_t *bytes = data;
+    while (size > 0) {
+        ssize_t got = pread(fd, bytes, size, (off_t) offset);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            return false;
+        if (got == 0) {
+            errno = EBADMSG;
+            return false;
+        }
+        bytes += got;
+        offset += (uint64_t) got;
+        size -= (size_t) got;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza zapisująca bufor ruchów. Po pierwszym błędzie
+ * zapamiętuje jego kod i nic więcej nie zapisuje.
+ * @param rec - Wskaźnik na stan zapisu.
+ * @return Wartość true, jeśli do tej pory nie było błędu.
+ */
+static bool flush_moves(gamma_recorder_t *rec) {
+    if (rec->error == 0 && rec->used > 0) {
+        size_t size = sizeof(record_move_t) * rec->used;
+        if (write_all(rec->fd, rec->buffer, size))
+            rec->offset += size;
+        else
+            rec->error = errno;
+    }
+    rec->used = 0;
+    return rec->error == 0;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca ruch do bufora.
+ * @param rec - Wskaźnik na stan zapisu.
+ * @param player - Numer gracza z bitem złotego ruchu albo 0 dla znacznika.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ */
+static void append_move(gamma_recorder_t *rec, uint32_t player,
+                        uint32_t x, uint32_t y) {
+    if (rec->used == RECORD_BUFFER)
+        flush_moves(rec);
+    rec->buffer[rec->used++] = (record_move_t) {player, x, y};
+}
+
+/**
+ * Funkcja pomocnicza zapisująca punkt kontrolny: znacznik, a za nim
+ * migawkę bieżącego stanu gry, oraz dopisująca go do indeksu.
+ * @param rec - Wskaźnik na stan zapisu.
+ */
+static void checkpoint(gamma_recorder_t *rec) {
+    append_move(rec, 0, 0, 0);
+    if (!flush_moves(rec))
+        return;
+    if (rec->checkpoints == rec->capacity) {
+        uint64_t capacity = rec->capacity * 2;
+        record_checkpoint_t *index =
+            realloc(rec->index, sizeof(record_checkpoint_t) * capacity);
+        if (index == NULL) {
+            rec->error = ENOMEM;
+            return;
+        }
+        rec->index = index;
+        rec->capacity = capacity;
+    }
+    uint64_t offset = rec->offset;
+    if (!gamma_save(rec->g, rec->fd)) {
+        rec->error = errno;
+        return;
+    }
+    off_t end = lseek(rec->fd, 0, SEEK_CUR);
+    if (end < 0) {
+        rec->error = errno;
+        return;
+    }
+    rec->offset = (uint64_t) end;
+    rec->index[rec->checkpoints++] = (record_checkpoint_t) {rec->moves, offset};
+}
+
+gamma_recorder_t* gamma_recorder_new(gamma_t *g, int fd, uint32_t interval) {
+    if (g == NULL || fd < 0 || interval == 0 ||
+        gamma_get_players(g) >= RECORD_GOLDEN) {
+        errno = EINVAL;
+        return NULL;
+    }
+    off_t position = lseek(fd, 0, SEEK_CUR);
+    if (position != 0) {
+        if (position > 0)
+            errno = EINVAL;
+        return NULL;
+    }
+    gamma_recorder_t *rec = malloc(sizeof(gamma_recorder_t));
+    if (rec == NULL)
+        return NULL;
+    rec->index = malloc(sizeof(record_checkpoint_t) * RECORD_INITIAL_INDEX);
+    if (rec->index == NULL) {
+        free(rec);
+        return NULL;
+    }
+    rec->g = g;
+    rec->fd = fd;
+    rec->error = 0;
+    rec->interval = interval;
+    rec->used = 0;
+    rec->moves = 0;
+    rec->checkpoints = 0;
+    rec->capacity = RECORD_INITIAL_INDEX;
+
+    record_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+    header.version = RECORD_VERSION;
+    header.byte_order = RECORD_BYTE_ORDER;
+    header.width = gamma_get_width(g);
+    header.height = gamma_get_height(g);
+    header.players = gamma_get_players(g);
+    header.areas = gamma_get_areas(g);
+    header.interval = interval;
+    if (!write_all(fd, &header, sizeof(header))) {
+        int error = errno;
+        free(rec->index);
+        free(rec);
+        errno = error;
+        return NULL;
+    }
+    rec->offset = sizeof(header);
+    if (gamma_hash(g) != 0)
+        checkpoint(rec);
+    return rec;
+}
+
+/**
+ * Funkcja pomocnicza zapisująca udany ruch i w razie potrzeby punkt
+ * kontrolny.
+ * @param rec - Wskaźnik na stan zapisu.
+ * @param player - Numer gracza z bitem złotego ruchu.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ */
+static void record_move(gamma_recorder_t *rec, uint32_t player,
+                        uint32_t x, uint32_t y) {
+    append_move(rec, player, x, y);
+    if (++(rec->moves) % rec->interval == 0)
+        checkpoint(rec);
+}
+
+bool gamma_recorder_move(gamma_recorder_t *rec, uint32_t player,
+                         uint32_t x, uint32_t y) {
+    if (rec == NULL || !gamma_move(rec->g, player, x, y))
+        return false;
+    record_move(rec, player, x, y);
+    return true;
+}
+
+bool gamma_recorder_golden_move(gamma_recorder_t *rec, uint32_t player,
+                                uint32_t x, uint32_t y) {
+    if (rec == NULL || !gamma_golden_move(rec->g, player, x, y))
+        return false;
+    record_move(rec, player | RECORD_GOLDEN, x, y);
+    return true;
+}
+
+bool gamma_recorder_finish(gamma_recorder_t *rec) {
+    if (rec == NULL)
+        return true;
+    record_footer_t footer;
+    if (flush_moves(rec)) {
+        footer.index_offset = rec->offset;
+        footer.checkpoints = rec->checkpoints;
+        footer.moves = rec->moves;
+        memcpy(footer.magic, RECORD_END_MAGIC, sizeof(footer.magic));
+        if (!write_all(rec->fd, rec->index,
+                       sizeof(record_checkpoint_t) * rec->checkpoints) ||
+            !write_all(rec->fd, &footer, sizeof(footer)))
+            rec->error = errno;
+    }
+    int error = rec->error;
+    free(rec->index);
+    free(rec);
+    errno = error;
+    return error == 0;
+}
+
+/**
+ * Funkcja pomocnicza wczytująca i sprawdzająca nagłówek i stopkę pliku
+ * przebiegu.
+ * @param fd - Deskryptor pliku.
+ * @param header - Wskaźnik, pod który zapisujemy nagłówek.
+ * @param footer - Wskaźnik, pod który zapisujemy stopkę.
+ * @return Wartość false z ustawionym errno, jeśli odczyt się nie udał lub
+ * plik jest niepoprawny.
+ */
+static bool read_frame(int fd, record_header_t *header,
+                       record_footer_t *footer) {
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return false;
+    uint64_t size = (uint64_t) st.st_size;
+    if (st.st_size < (off_t) (sizeof(*header) + sizeof(*footer))) {
+        errno = EBADMSG;
+        return false;
+    }
+    if (!pread_all(fd, header, sizeof(*header), 0) ||
+        !pread_all(fd, footer, sizeof(*footer), size - sizeof(*footer)))
+        return false;
+    uint64_t index_end = size - sizeof(*footer);
+    bool valid =
+        memcmp(header->magic, RECORD_MAGIC, sizeof(header->magic)) == 0 &&
+        header->version == RECORD_VERSION &&
+        header->byte_order == RECORD_BYTE_ORDER &&
+        header->width > 0 && header->height > 0 && header->players > 0 &&
+        header->players < RECORD_GOLDEN && header->areas > 0 &&
+        header->interval > 0 && header->reserved == 0 &&
+        memcmp(footer->magic, RECORD_END_MAGIC, sizeof(footer->magic)) == 0 &&
+        footer->index_offset >= sizeof(*header) &&
+        footer->index_offset <= index_end &&
+        footer->checkpoints == (index_end - footer->index_offset) /
+                               sizeof(record_checkpoint_t) &&
+        (index_end - footer->index_offset) % sizeof(record_checkpoint_t) == 0;
+    if (!valid)
+        errno = EBADMSG;
+    return valid;
+}
+
+bool gamma_record_info(int fd, gamma_record_info_t *out) {
+    record_header_t header;
+    record_footer_t footer;
+    if (out == NULL) {
+        errno = EINVAL;
+        return false;
+    }
+    if (!read_frame(fd, &header, &footer))
+        return false;
+    out->width = header.width;
+    out->height = header.height;
+    out->players = header.players;
+    out->areas = header.areas;
+    out->interval = header.interval;
+    out->moves = footer.moves;
+    out->checkpoints = footer.checkpoints;
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza wyszukująca binarnie ostatni punkt kontrolny nie
+ * późniejszy niż ruch @p move.
+ * @param fd - Deskryptor pliku.
+ * @param footer - Wskaźnik na stopkę.
+ * @param move - Numer ruchu.
+ * @param found - Wskaźnik, pod który zapisujemy punkt kontrolny. Jeśli go
+ * nie ma, zapisujemy punkt ruchu 0 z położeniem 0.
+ * @return Wartość false z ustawionym errno, jeśli odczyt się nie udał lub
+ * indeks jest niepoprawny.
+ */
+static bool find_checkpoint(int fd, const record_footer_t *footer,
+                            uint64_t move, record_checkpoint_t *found) {
+    *found = (record_checkpoint_t) {0, 0};
+    uint64_t low = 0, high = footer->checkpoints;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        record_checkpoint_t entry;
+        if (!pread_all(fd, &entry, sizeof(entry), footer->index_offset +
+                       middle * sizeof(record_checkpoint_t)))
+            return false;
+        if (entry.move <= move) {
+            *found = entry;
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    if (found->offset != 0 && (found->offset < sizeof(record_header_t) ||
+                               found->offset >= footer->index_offset)) {
+        errno = EBADMSG;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza powtarzająca @p count kolejnych ruchów od bieżącego
+ * położenia w pliku.
+ * @param g - Wskaźnik na planszę.
+ * @param fd - Deskryptor pliku.
+ * @param count - Liczba ruchów.
+ * @return Wartość false z ustawionym errno, jeśli odczyt się nie udał albo
+ * któryś ruch jest niepoprawny.
+ */
+static bool replay(gamma_t *g, int fd, uint64_t count) {
+    record_move_t *moves = malloc(sizeof(record_move_t) * RECORD_BUFFER);
+    if (moves == NULL)
+        return false;
+    bool valid = true;
+    while (valid && count > 0) {
+        uint32_t part = count < RECORD_BUFFER ? (uint32_t) count : RECORD_BUFFER;
+        if (!read_all(fd, moves, sizeof(record_move_t) * part)) {
+            valid = false;
+            break;
+        }
+        for (uint32_t i = 0; valid && i < part; ++i) {
+            uint32_t player = moves[i].player & ~RECORD_GOLDEN;
+            if (moves[i].player & RECORD_GOLDEN)
+                valid = gamma_golden_move(g, player, moves[i].x, moves[i].y);
+            else
+                valid = gamma_move(g, player, moves[i].x, moves[i].y);
+            if (!valid)
+                errno = EBADMSG;
+        }
+        count -= part;
+    }
+    free(moves);
+    return valid;
+}
+
+gamma_t* gamma_record_seek(int fd, uint64_t move) {
+    record_header_t header;
+    record_footer_t footer;
+    record_checkpoint_t start;
+    if (!read_frame(fd, &header, &footer))
+        return NULL;
+    if (move > footer.moves) {
+        errno = ERANGE;
+        return NULL;
+    }
+    if (!find_checkpoint(fd, &footer, move, &start))
+        return NULL;
+
+    gamma_t *g = NULL;
+    if (start.offset == 0) {
+        if (lseek(fd, sizeof(header), SEEK_SET) < 0)
+            return NULL;
+        g = gamma_new(header.width, header.height, header.players,
+                      header.areas);
+        if (g == NULL)
+            errno = ENOMEM;
+    }
+    else if (lseek(fd, (off_t) start.offset, SEEK_SET) >= 0) {
+        g = gamma_load(fd);
+        if (g != NULL && (gamma_get_width(g) != header.width ||
+                          gamma_get_height(g) != header.height ||
+                          gamma_get_players(g) != header.players ||
+                          gamma_get_areas(g) != header.areas)) {
+            gamma_delete(g);
+            g = NULL;
+            errno = EBADMSG;
+        }
+    }
+    if (g == NULL)
+        return NULL;
+    if (!replay(g, fd, move - start.move)) {
+        int error = errno;
+        gamma_delete(g);
+        errno = error;
+        return NULL;
+    }
+    return g;
+}
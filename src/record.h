@@ -0,0 +1,113 @@
+/**
+ * @file
+ * Interfejs zapisu przebiegu gry z punktami kontrolnymi i szybkiego
+ * odtwarzania stanu gry po dowolnym ruchu.
+ *
+ * Plik przebiegu zaczyna się nagłówkiem z parametrami planszy i odstępem K
+ * między punktami kontrolnymi. Dalej leżą kolejne udane ruchy, po 12 bajtów:
+ * numer gracza z najstarszym bitem ustawionym dla złotego ruchu oraz numery
+ * kolumny i wiersza. Po każdym K-tym ruchu zapisywany jest punkt kontrolny:
+ * znacznik w postaci ruchu gracza 0, a po nim migawka stanu gry w formacie
+ * @ref gamma_save. Plik kończy indeks punktów kontrolnych (numer ruchu i
+ * położenie migawki) i stopka z położeniem indeksu, liczbą punktów
+ * kontrolnych i liczbą ruchów. Odtworzenie stanu po ruchu N wczytuje
+ * ostatni punkt kontrolny nie późniejszy niż N i powtarza najwyżej K - 1
+ * ruchów.
+ */
+
+#ifndef GAMMA_RECORD_H
+#define GAMMA_RECORD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+/** Domyślny odstęp między punktami kontrolnymi w ruchach. */
+#define RECORD_DEFAULT_INTERVAL 65536
+
+/**
+ * Struktura przechowująca stan zapisu przebiegu gry.
+ */
+typedef struct gamma_recorder gamma_recorder_t;
+
+/**
+ * Parametry zapisanego przebiegu gry.
+ */
+typedef struct gamma_record_info {
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t height; ///< Wysokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    uint32_t areas; ///< Maksymalna liczba obszarów gracza.
+    uint32_t interval; ///< Odstęp między punktami kontrolnymi w ruchach.
+    uint64_t moves; ///< Liczba zapisanych ruchów.
+    uint64_t checkpoints; ///< Liczba punktów kontrolnych.
+} gamma_record_info_t;
+
+/**
+ * Funkcja rozpoczynająca zapis przebiegu gry na planszy @p g do pliku
+ * @p fd, który musi być zwykłym plikiem otwartym do zapisu. Jeśli plansza
+ * nie jest pusta, jej stan zostaje zapisany jako punkt kontrolny ruchu 0.
+ * Ruchy trzeba potem wykonywać przez @ref gamma_recorder_move i
+ * @ref gamma_recorder_golden_move.
+ * @param g - Wskaźnik na planszę, która musi istnieć do końca zapisu.
+ * @param fd - Deskryptor pliku.
+ * @param interval - Odstęp między punktami kontrolnymi, dodatni.
+ * @return Wskaźnik na stan zapisu lub NULL z ustawionym errno.
+ */
+gamma_recorder_t* gamma_recorder_new(gamma_t *g, int fd, uint32_t interval);
+
+/**
+ * Funkcja wykonująca ruch jak @ref gamma_move i zapisująca go, jeśli się
+ * udał.
+ * @param rec - Wskaźnik na stan zapisu.
+ * @param player - Numer gracza.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Wynik @ref gamma_move. Błąd zapisu nie zmienia wyniku, tylko jest
+ * zgłaszany przez @ref gamma_recorder_finish.
+ */
+bool gamma_recorder_move(gamma_recorder_t *rec, uint32_t player,
+                         uint32_t x, uint32_t y);
+
+/**
+ * Funkcja wykonująca złoty ruch jak @ref gamma_golden_move i zapisująca go,
+ * jeśli się udał.
+ * @param rec - Wskaźnik na stan zapisu.
+ * @param player - Numer gracza.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Wynik @ref gamma_golden_move.
+ */
+bool gamma_recorder_golden_move(gamma_recorder_t *rec, uint32_t player,
+                                uint32_t x, uint32_t y);
+
+/**
+ * Funkcja kończąca zapis: dopisuje indeks punktów kontrolnych i stopkę oraz
+ * zwalnia stan zapisu. Nie zamyka pliku. Nic nie robi dla NULL.
+ * @param rec - Wskaźnik na stan zapisu.
+ * @return Wartość false z ustawionym errno, jeśli któryś zapis się nie
+ * udał.
+ */
+bool gamma_recorder_finish(gamma_recorder_t *rec);
+
+/**
+ * Funkcja odczytująca parametry zapisanego przebiegu gry.
+ * @param fd - Deskryptor pliku przebiegu otwartego do odczytu.
+ * @param out - Wskaźnik, pod który zapisujemy parametry.
+ * @return Wartość false z ustawionym errno (EBADMSG dla niepoprawnego
+ * pliku), jeśli odczyt się nie udał.
+ */
+bool gamma_record_info(int fd, gamma_record_info_t *out);
+
+/**
+ * Funkcja odtwarzająca stan gry po ruchu numer @p move: wczytuje ostatni
+ * punkt kontrolny nie późniejszy niż @p move i powtarza kolejne ruchy.
+ * @param fd - Deskryptor pliku przebiegu otwartego do odczytu.
+ * @param move - Numer ruchu, od 0 (pusta plansza) do liczby ruchów.
+ * @return Wskaźnik na nową planszę lub NULL z ustawionym errno: ERANGE, gdy
+ * przebieg ma mniej ruchów, EBADMSG dla niepoprawnego pliku, a w
+ * pozostałych przypadkach kod błędu odczytu lub ENOMEM.
+ */
+gamma_t* gamma_record_seek(int fd, uint64_t move);
+
+#endif //GAMMA_RECORD_H
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Zamek sekwencyjny: jeden pisarz publikuje niewielki zestaw liczników, a
+ * dowolnie wielu czytelników odczytuje ich spójny stan bez zamków i bez
+ * zapisów do pamięci współdzielonej.
+ *
+ * Pisarz zwiększa numer sekwencji przed zapisem i po nim, więc numer jest
+ * nieparzysty dokładnie wtedy, gdy zapis trwa. Czytelnik zapamiętuje numer,
+ * czyta dane i powtarza odczyt, jeśli numer się zmienił. Chronione dane
+ * muszą być zmiennymi atomowymi czytanymi i zapisywanymi z porządkiem
+ * memory_order_relaxed, a zapisy różnych pisarzy trzeba szeregować
+ * zewnętrznie.
+ */
+
+#ifndef GAMMA_SEQLOCK_H
+#define GAMMA_SEQLOCK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Struktura zamka sekwencyjnego.
+ */
+typedef struct seqlock {
+    atomic_uint_fast64_t sequence; ///< Numer sekwencji, nieparzysty w zapisie.
+} seqlock_t;
+
+/**
+ * Funkcja inicjująca zamek.
+ * @param lock - Wskaźnik na zamek.
+ */
+static inline void seqlock_init(seqlock_t *lock) {
+    atomic_init(&(lock->sequence), 0);
+}
+
+/**
+ * Funkcja rozpoczynająca zapis danych chronionych zamkiem.
+ * @param lock - Wskaźnik na zamek.
+ */
+static inline void seqlock_write_begin(seqlock_t *lock) {
+    uint_fast64_t sequence = atomic_load_explicit(&(lock->sequence),
+                                                  memory_order_relaxed);
+    atomic_store_explicit(&(lock->sequence), sequence + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * Funkcja kończąca zapis danych chronionych zamkiem.
+ * @param lock - Wskaźnik na zamek.
+ */
+static inline void seqlock_write_end(seqlock_t *lock) {
+    uint_fast64_t sequence = atomic_load_explicit(&(lock->sequence),
+                                                  memory_order_relaxed);
+    atomic_store_explicit(&(lock->sequence), sequence + 1,
+                          memory_order_release);
+}
+
+/**
+ * Funkcja rozpoczynająca odczyt. Czeka, aż skończy się trwający zapis.
+ * @param lock - Wskaźnik na zamek.
+ * @return Numer sekwencji do przekazania @ref seqlock_read_retry.
+ */
+static inline uint_fast64_t seqlock_read_begin(seqlock_t *lock) {
+    uint_fast64_t sequence;
+    while ((sequence = atomic_load_explicit(&(lock->sequence),
+                                            memory_order_acquire)) & 1)
+        continue;
+    return sequence;
+}
+
+/**
+ * Funkcja kończąca odczyt.
+ * @param lock - Wskaźnik na zamek.
+ * @param sequence - Wynik @ref seqlock_read_begin.
+ * @return Wartość true, gdy w trakcie odczytu nastąpił zapis i odczyt trzeba
+ * powtórzyć.
+ */
+static inline bool seqlock_read_retry(seqlock_t *lock,
+                                      uint_fast64_t sequence) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&(lock->sequence), memory_order_relaxed) !=
+           sequence;
+}
+
+#endif //GAMMA_SEQLOCK_H
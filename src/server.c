@@ -0,0 +1,774 @@
+/**
+ * @file
+ * Implementacja serwera gier na gnieździe domeny uniksowej.
+ *
+ * Pętla zdarzeń czyta z gotowego połączenia co najwyżej jeden fragment
+ * naraz, żeby żadne połączenie nie zagłodziło pozostałych. Pełne wiersze
+ * są wykonywane wprost z fragmentu, a w buforze połączenia zostaje tylko
+ * niedokończony ostatni wiersz. Odpowiedzi trafiają do bufora wyjścia i są
+ * wysyłane od razu; resztę wysyła się, gdy gniazdo znów przyjmuje dane.
+ * Gdy bufor wyjścia się zapełni, wykonywanie wierszy staje, a reszta
+ * fragmentu czeka w buforze wejścia, aż gniazdo przyjmie odpowiedzi.
+ * Dopóki bufor wyjścia jest pełny albo czekają wstrzymane wiersze, z
+ * połączenia nic się nie czyta.
+ * Gry połączeń żyją we wspólnej tablicy gier, więc plansza zamkniętego
+ * połączenia czeka w puli na następną grę podobnego rozmiaru.
+ */
+
+#define _GNU_SOURCE ///< Potrzebne do accept4.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "server.h"
+#include "batch_mode.h"
+#include "gamma.h"
+#include "game_table.h"
+
+#define BASE 10 ///< Podstawa systemu liczbowego wczytywanych liczb.
+#define START_LINE 1 ///< Numer pierwszego wiersza połączenia.
+#define MAX_EVENTS 256 ///< Liczba zdarzeń odbieranych naraz.
+#define READ_CHUNK 65536 ///< Rozmiar fragmentu czytanego z połączenia.
+#define LINE_LIMIT 65536 /**< Najdłuższy przechowywany niedokończony wiersz;
+dłuższy wiersz jest błędnym poleceniem. */
+#define OUTPUT_LIMIT (1u << 20) /**< Rozmiar bufora wyjścia, powyżej którego
+połączenie przestaje być czytane. */
+#define KEPT_CAPACITY 4096 /**< Największy pusty bufor, którego nie zwalniamy
+po wysłaniu danych. */
+#define FORMAT_SIZE 64 ///< Początkowe miejsce na jedną sformatowaną odpowiedź.
+#define MOVE_ARGS 3 ///< Liczba argumentów ruchu i złotego ruchu.
+#define HEADER_ARGS 4 ///< Liczba liczb w nagłówku gry.
+#define POOL_LIMIT (64u << 20) /**< Największy łączny rozmiar wolnych bloków
+plansz, które serwer trzyma dla następnych gier. */
+
+/**
+ * Bufor bajtów połączenia.
+ */
+typedef struct buffer {
+    char *data; ///< Dane bufora.
+    size_t start; ///< Położenie pierwszego niewysłanego bajtu.
+    size_t length; ///< Koniec danych bufora.
+    size_t capacity; ///< Rozmiar tablicy data.
+} buffer_t;
+
+/**
+ * Stan jednego połączenia.
+ */
+typedef struct connection connection_t;
+
+/**
+ * Stan jednego połączenia.
+ */
+struct connection {
+    int fd; ///< Gniazdo połączenia.
+    game_table_t *table; ///< Tablica gier serwera.
+    game_handle_t game; ///< Uchwyt gry połączenia w tablicy.
+    gamma_t *g; ///< Gra połączenia lub NULL przed nagłówkiem.
+    size_t line; ///< Numer bieżącego wiersza.
+    buffer_t in; /**< Niedokończony ostatni wiersz, a gdy pending, także
+    wstrzymane pełne wiersze przed nim. */
+    buffer_t out; ///< Odpowiedzi czekające na wysłanie.
+    bool pending; /**< Czy w buforze wejścia czekają pełne wiersze,
+    wstrzymane przez pełny bufor wyjścia. */
+    uint32_t *labels; /**< Etykiety pól dla polecenia t, przydzielane przy
+    pierwszym poleceniu lub NULL. */
+    uint64_t *counts; ///< Liczby pól graczy dla polecenia t lub NULL.
+    bool skipping; /**< Czy pomijamy resztę zbyt długiego wiersza, który
+    został już zgłoszony jako błąd. */
+    bool eof; ///< Czy klient zakończył wysyłanie.
+    bool failed; ///< Czy zabrakło pamięci lub gniazdo zgłosiło błąd.
+    uint32_t events; ///< Zdarzenia, na które połączenie czeka w epoll.
+    connection_t *prev; ///< Poprzednie połączenie na liście.
+    connection_t *next; ///< Następne połączenie na liście.
+};
+
+/**
+ * Fragment wiersza, który jest właśnie rozbierany.
+ */
+typedef struct cursor {
+    const char *position; ///< Pierwszy nieprzeczytany znak.
+    const char *end; ///< Koniec wiersza, bez znaku nowej linii.
+} cursor_t;
+
+/** Ustawiana przez obsługę sygnału, kończy pętlę zdarzeń. */
+static volatile sig_atomic_t stop_requested = 0;
+
+/**
+ * Obsługa sygnałów SIGINT i SIGTERM.
+ * @param signal_number - Numer sygnału.
+ */
+static void request_stop(int signal_number) {
+    (void) signal_number;
+    stop_requested = 1;
+}
+
+/**
+ * Funkcja pomocnicza zapewniająca w buforze miejsce na @p extra bajtów za
+ * jego danymi. Przesuwa dane na początek tablicy, zanim ją powiększy.
+ * @param buffer - Wskaźnik na bufor.
+ * @param extra - Potrzebna liczba bajtów.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool buffer_reserve(buffer_t *buffer, size_t extra) {
+    if (buffer->capacity - buffer->length >= extra)
+        return true;
+    if (buffer->start > 0) {
+        memmove(buffer->data, buffer->data + buffer->start,
+                buffer->length - buffer->start);
+        buffer->length -= buffer->start;
+        buffer->start = 0;
+        if (buffer->capacity - buffer->length >= extra)
+            return true;
+    }
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : FORMAT_SIZE;
+    while (capacity - buffer->length < extra)
+        capacity *= 2;
+    char *data = realloc(buffer->data, capacity);
+    if (data == NULL)
+        return false;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza opróżniająca bufor. Duże tablice są zwalniane, żeby
+ * bezczynne połączenia zajmowały mało pamięci.
+ * @param buffer - Wskaźnik na bufor.
+ */
+static void buffer_clear(buffer_t *buffer) {
+    buffer->start = 0;
+    buffer->length = 0;
+    if (buffer->capacity > KEPT_CAPACITY) {
+        free(buffer->data);
+        buffer->data = NULL;
+        buffer->capacity = 0;
+    }
+}
+
+/**
+ * Funkcja pomocnicza dopisująca bajty do bufora.
+ * @param buffer - Wskaźnik na bufor.
+ * @param data - Dopisywane bajty.
+ * @param size - Liczba bajtów.
+ * @return Wartość false, gdy zabrakło pamięci.
+ */
+static bool buffer_append(buffer_t *buffer, const char *data, size_t size) {
+    if (!buffer_reserve(buffer, size))
+        return false;
+    memcpy(buffer->data + buffer->length, data, size);
+    buffer->length += size;
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca sformatowaną odpowiedź do bufora wyjścia
+ * połączenia, jak printf.
+ * @param c - Wskaźnik na połączenie.
+ * @param format - Format odpowiedzi.
+ */
+static void reply(connection_t *c, const char *format, ...) {
+    va_list args;
+    size_t size = FORMAT_SIZE;
+    for (;;) {
+        if (!buffer_reserve(&(c->out), size)) {
+            c->failed = true;
+            return;
+        }
+        va_start(args, format);
+        int written = vsnprintf(c->out.data + c->out.length, size, format,
+                                args);
+        va_end(args);
+        if (written < 0) {
+            c->failed = true;
+            return;
+        }
+        if ((size_t) written < size) {
+            c->out.length += (size_t) written;
+            return;
+        }
+        size = (size_t) written + 1;
+    }
+}
+
+/**
+ * Funkcja pomocnicza zgłaszająca błąd w bieżącym wierszu połączenia, w tym
+ * samym formacie co @ref print_error.
+ * @param c - Wskaźnik na połączenie.
+ */
+static void reply_error(connection_t *c) {
+    reply(c, "ERROR %zu\n", c->line);
+}
+
+/**
+ * Funkcja pomocnicza pomijająca białe znaki.
+ * @param cursor - Wskaźnik na rozbierany wiersz.
+ */
+static void skip_white(cursor_t *cursor) {
+    while (cursor->position < cursor->end && is_white(*(cursor->position)))
+        ++(cursor->position);
+}
+
+/**
+ * Funkcja pomocnicza czytająca liczbę typu uint32_t tak jak
+ * @ref read_uint32: liczbą jest najdłuższy ciąg znaków innych niż białe,
+ * który musi składać się z cyfr i mieścić w typie uint32_t.
+ * @param cursor - Wskaźnik na rozbierany wiersz.
+ * @param error - Wskaźnik na zmienną ustawianą na true w razie błędu.
+ * @return Wczytana liczba albo 0 w razie błędu.
+ */
+static uint32_t read_number(cursor_t *cursor, bool *error) {
+    const char *begin = cursor->position;
+    uint64_t number = 0;
+    while (cursor->position < cursor->end && !is_white(*(cursor->position))) {
+        char c = *(cursor->position++);
+        if (c < '0' || c > '9' || number > UINT32_MAX)
+            *error = true;
+        else
+            number = number * BASE + (uint64_t) (c - '0');
+    }
+    if (cursor->position == begin || number > UINT32_MAX)
+        *error = true;
+    return *error ? 0 : (uint32_t) number;
+}
+
+/**
+ * Funkcja pomocnicza czytająca argumenty polecenia: po literze polecenia
+ * musi być biały znak, a po ostatnim argumencie już tylko białe znaki.
+ * @param cursor - Wskaźnik na rozbierany wiersz, za literą polecenia.
+ * @param args - Tablica na argumenty.
+ * @param count - Liczba argumentów.
+ * @return Wartość true, jeśli polecenie jest poprawne.
+ */
+static bool read_arguments(cursor_t *cursor, uint32_t *args, int count) {
+    bool error = cursor->position == cursor->end ||
+                 !is_white(*(cursor->position));
+    for (int i = 0; i < count; ++i) {
+        skip_white(cursor);
+        args[i] = read_number(cursor, &error);
+    }
+    skip_white(cursor);
+    return !error && cursor->position == cursor->end;
+}
+
+/**
+ * Funkcja pomocnicza sprawdzająca, czy do końca wiersza są tylko białe
+ * znaki.
+ * @param cursor - Wskaźnik na rozbierany wiersz.
+ * @return Wartość true, jeśli wiersz nie ma już innych znaków.
+ */
+static bool read_end(cursor_t *cursor) {
+    skip_white(cursor);
+    return cursor->position == cursor->end;
+}
+
+/**
+ * Funkcja pomocnicza wykonująca polecenie wypisania potencjalnego
+ * terytorium graczy, jak polecenie t trybu wsadowego. Tablice wyniku są
+ * przydzielane przy pierwszym poleceniu i zostają w połączeniu.
+ * @param c - Wskaźnik na połączenie.
+ */
+static void territory_reply(connection_t *c) {
+    uint32_t players = gamma_get_players(c->g);
+    if (c->labels == NULL)
+        c->labels = malloc(sizeof(uint32_t) * gamma_get_width(c->g) *
+                           gamma_get_height(c->g));
+    if (c->counts == NULL)
+        c->counts = malloc(sizeof(uint64_t) * ((size_t) players + 1));
+    if (c->labels == NULL || c->counts == NULL ||
+        !gamma_territory(c->g, c->labels, c->counts)) {
+        reply_error(c);
+        return;
+    }
+    for (uint32_t player = 1; player <= players; ++player)
+        reply(c, "%lu ", c->counts[player]);
+    reply(c, "%lu\n", c->counts[0]);
+}
+
+/**
+ * Funkcja pomocnicza wykonująca polecenie wypisania statystyk silnika, jak
+ * polecenie s trybu wsadowego.
+ * @param c - Wskaźnik na połączenie.
+ */
+static void stats_reply(connection_t *c) {
+    static const char *names[GAMMA_OP_COUNT] = {
+        "move", "golden_move", "busy_fields", "free_fields",
+        "golden_possible", "board", "print_board", "territory"
+    };
+    gamma_stats_t stats;
+    if (!gamma_stats(c->g, &stats)) {
+        reply_error(c);
+        return;
+    }
+    for (int op = 0; op < GAMMA_OP_COUNT; ++op) {
+        reply(c, "%s %lu", names[op], stats.calls[op]);
+        for (int i = 0; i < GAMMA_STATS_BUCKETS; ++i)
+            if (stats.latency[op][i] > 0)
+                reply(c, " %d:%lu", i, stats.latency[op][i]);
+        reply(c, "\n");
+    }
+    reply(c, "cells_scanned %lu\n", stats.cells_scanned);
+    reply(c, "find_root_hops %lu\n", stats.find_root_hops);
+    reply(c, "golden_rebuilds %lu\n", stats.golden_rebuilds);
+    reply(c, "golden_rebuilt_cells %lu\n", stats.golden_rebuilt_cells);
+}
+
+/**
+ * Funkcja pomocnicza wykonująca polecenie trybu wsadowego. Niedokończony
+ * ostatni wiersz połączenia jest błędnym poleceniem, jak w trybie wsadowym.
+ * @param c - Wskaźnik na połączenie z grą.
+ * @param cursor - Wskaźnik na wiersz polecenia.
+ * @param terminated - Czy wiersz kończy się znakiem nowej linii.
+ */
+static void command_line(connection_t *c, cursor_t *cursor, bool terminated) {
+    uint32_t args[MOVE_ARGS];
+    char command = *(cursor->position++);
+    bool valid;
+    if (command == 'm' || command == 'g')
+        valid = read_arguments(cursor, args, MOVE_ARGS);
+    else if (command == 'b' || command == 'f' || command == 'q')
+        valid = read_arguments(cursor, args, 1);
+    else
+        valid = (command == 'p' || command == 's' || command == 't') &&
+                read_end(cursor);
+    if (!valid || !terminated) {
+        reply_error(c);
+        return;
+    }
+
+    char *board;
+    switch (command) {
+        case 'm':
+            reply(c, "%d\n", gamma_move(c->g, args[0], args[1], args[2]));
+            break;
+        case 'g':
+            reply(c, "%d\n",
+                  gamma_golden_move(c->g, args[0], args[1], args[2]));
+            break;
+        case 'b':
+            reply(c, "%lu\n", gamma_busy_fields(c->g, args[0]));
+            break;
+        case 'f':
+            reply(c, "%lu\n", gamma_free_fields(c->g, args[0]));
+            break;
+        case 'q':
+            reply(c, "%d\n", gamma_golden_possible(c->g, args[0]));
+            break;
+        case 'p':
+            board = gamma_board(c->g);
+            if (board == NULL)
+                reply_error(c);
+            else if (!buffer_append(&(c->out), board, strlen(board)))
+                c->failed = true;
+            free(board);
+            break;
+        case 's':
+            stats_reply(c);
+            break;
+        default:
+            territory_reply(c);
+            break;
+    }
+}
+
+/**
+ * Funkcja pomocnicza wykonująca wiersz przed nagłówkiem gry, jak wybór
+ * trybu przed grą. Tryb interaktywny nie jest dostępny przez gniazdo, więc
+ * jego nagłówek jest błędem, podobnie jak nagłówek gry, której nie udało się
+ * utworzyć.
+ * @param c - Wskaźnik na połączenie bez gry.
+ * @param cursor - Wskaźnik na niepusty wiersz, który nie jest komentarzem.
+ * @param terminated - Czy wiersz kończy się znakiem nowej linii.
+ */
+static void header_line(connection_t *c, cursor_t *cursor, bool terminated) {
+    bool error = *(cursor->position++) != 'B';
+    uint32_t args[HEADER_ARGS];
+    for (int i = 0; i < HEADER_ARGS; ++i) {
+        skip_white(cursor);
+        args[i] = read_number(cursor, &error);
+    }
+    if (!error && read_end(cursor) && terminated) {
+        c->game = game_table_create(c->table, args[0], args[1], args[2],
+                                    args[3]);
+        c->g = game_table_get(c->table, c->game);
+    }
+    if (c->g == NULL)
+        reply_error(c);
+    else
+        reply(c, "OK %zu\n", c->line);
+}
+
+/**
+ * Funkcja pomocnicza wykonująca jeden wiersz połączenia.
+ * @param c - Wskaźnik na połączenie.
+ * @param text - Wiersz bez znaku nowej linii.
+ * @param length - Długość wiersza.
+ * @param terminated - Czy wiersz kończy się znakiem nowej linii.
+ */
+static void execute_line(connection_t *c, const char *text, size_t length,
+                         bool terminated) {
+    cursor_t cursor = {text, text + length};
+    if (length > 0 && text[0] != '#') {
+        if (c->g == NULL)
+            header_line(c, &cursor, terminated);
+        else
+            command_line(c, &cursor, terminated);
+    }
+    ++(c->line);
+}
+
+/**
+ * Funkcja pomocnicza odkładająca do bufora wejścia połączenia resztę
+ * fragmentu bez pełnych wierszy. Zbyt długi niedokończony wiersz jest
+ * błędnym poleceniem, a jego reszta jest pomijana.
+ * @param c - Wskaźnik na połączenie.
+ * @param data - Początek reszty.
+ * @param end - Koniec reszty.
+ */
+static void keep_tail(connection_t *c, const char *data, const char *end) {
+    if (end - data > LINE_LIMIT) {
+        reply_error(c);
+        ++(c->line);
+        c->skipping = true;
+    }
+    else if (data < end && !buffer_append(&(c->in), data,
+                                          (size_t) (end - data))) {
+        c->failed = true;
+    }
+}
+
+/**
+ * Funkcja pomocnicza wykonująca pełne wiersze od @p data, dopóki bufor
+ * wyjścia połączenia nie jest pełny.
+ * @param c - Wskaźnik na połączenie.
+ * @param data - Początek wierszy.
+ * @param end - Koniec wierszy.
+ * @return Początek pierwszego niewykonanego wiersza.
+ */
+static const char* execute_lines(connection_t *c, const char *data,
+                                 const char *end) {
+    const char *newline;
+    while (c->out.length < OUTPUT_LIMIT &&
+           (newline = memchr(data, '\n', (size_t) (end - data))) != NULL) {
+        execute_line(c, data, (size_t) (newline - data), true);
+        data = newline + 1;
+    }
+    return data;
+}
+
+/**
+ * Funkcja pomocnicza wykonująca wiersze wstrzymane w buforze wejścia
+ * połączenia, dopóki bufor wyjścia nie jest pełny. Gdy zostaje już tylko
+ * niedokończony ostatni wiersz, połączenie przestaje mieć wstrzymane
+ * wiersze.
+ * @param c - Wskaźnik na połączenie z wstrzymanymi wierszami.
+ */
+static void resume(connection_t *c) {
+    const char *data = c->in.data + c->in.start;
+    const char *end = c->in.data + c->in.length;
+    data = execute_lines(c, data, end);
+    c->in.start = (size_t) (data - c->in.data);
+    if (memchr(data, '\n', (size_t) (end - data)) != NULL)
+        return;
+    c->pending = false;
+    if (end - data > LINE_LIMIT) {
+        reply_error(c);
+        ++(c->line);
+        c->skipping = true;
+        buffer_clear(&(c->in));
+        return;
+    }
+    // Reszta trafia na początek bufora, bo dalsze fragmenty są do niej
+    // dopisywane od razu.
+    c->in.length = (size_t) (end - data);
+    c->in.start = 0;
+    memmove(c->in.data, data, c->in.length);
+    if (c->in.length == 0)
+        buffer_clear(&(c->in));
+}
+
+/**
+ * Funkcja pomocnicza wykonująca pełne wiersze przeczytanego fragmentu, a
+ * niedokończony ostatni wiersz odkładająca do bufora wejścia połączenia.
+ * Gdy bufor wyjścia się zapełni, niewykonane wiersze też trafiają do bufora
+ * wejścia jako wstrzymane.
+ * @param c - Wskaźnik na połączenie bez wstrzymanych wierszy.
+ * @param data - Przeczytany fragment.
+ * @param size - Długość fragmentu.
+ */
+static void feed(connection_t *c, const char *data, size_t size) {
+    const char *end = data + size;
+    if (c->in.length > 0 || c->skipping) {
+        const char *newline = memchr(data, '\n', size);
+        const char *stop = newline != NULL ? newline : end;
+        if (c->skipping) {
+            c->skipping = newline == NULL;
+        }
+        else if (c->in.length + (size_t) (stop - data) > LINE_LIMIT) {
+            reply_error(c);
+            ++(c->line);
+            buffer_clear(&(c->in));
+            c->skipping = newline == NULL;
+        }
+        else if (!buffer_append(&(c->in), data, (size_t) (stop - data))) {
+            c->failed = true;
+            return;
+        }
+        else if (newline != NULL) {
+            execute_line(c, c->in.data, c->in.length, true);
+            buffer_clear(&(c->in));
+        }
+        if (newline == NULL)
+            return;
+        data = newline + 1;
+    }
+
+    data = execute_lines(c, data, end);
+    if (memchr(data, '\n', (size_t) (end - data)) == NULL)
+        keep_tail(c, data, end);
+    else if (!buffer_append(&(c->in), data, (size_t) (end - data)))
+        c->failed = true;
+    else
+        c->pending = true;
+}
+
+/**
+ * Funkcja pomocnicza wysyłająca tyle odpowiedzi, ile przyjmie gniazdo.
+ * @param c - Wskaźnik na połączenie.
+ */
+static void flush(connection_t *c) {
+    while (c->out.start < c->out.length) {
+        ssize_t sent = send(c->fd, c->out.data + c->out.start,
+                            c->out.length - c->out.start, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                c->failed = true;
+            if (errno != EINTR)
+                return;
+            continue;
+        }
+        c->out.start += (size_t) sent;
+    }
+    buffer_clear(&(c->out));
+}
+
+/**
+ * Funkcja pomocnicza zamykająca połączenie i zwalniająca jego grę.
+ * @param list - Wskaźnik na pierwsze połączenie listy.
+ * @param c - Wskaźnik na połączenie.
+ */
+static void close_connection(connection_t **list, connection_t *c) {
+    if (c->prev != NULL)
+        c->prev->next = c->next;
+    else
+        *list = c->next;
+    if (c->next != NULL)
+        c->next->prev = c->prev;
+    close(c->fd);
+    game_table_remove(c->table, c->game);
+    free(c->in.data);
+    free(c->out.data);
+    free(c->labels);
+    free(c->counts);
+    free(c);
+}
+
+/**
+ * Funkcja pomocnicza obsługująca zdarzenie połączenia: czyta jeden
+ * fragment, wykonuje jego wiersze, wysyła odpowiedzi, a gdy gniazdo przyjęło
+ * je wszystkie, wykonuje wstrzymane wiersze. Na koniec ustawia zdarzenia,
+ * na które połączenie czeka. Zamyka połączenie po błędzie albo gdy klient
+ * skończył wysyłanie i dostał wszystkie odpowiedzi.
+ * @param epoll - Deskryptor epoll.
+ * @param list - Wskaźnik na pierwsze połączenie listy.
+ * @param c - Wskaźnik na połączenie.
+ * @param events - Zgłoszone zdarzenia.
+ * @param chunk - Bufor na przeczytany fragment, READ_CHUNK bajtów.
+ */
+static void serve(int epoll, connection_t **list, connection_t *c,
+                  uint32_t events, char *chunk) {
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !c->eof &&
+        !c->pending && c->out.length < OUTPUT_LIMIT) {
+        ssize_t size = recv(c->fd, chunk, READ_CHUNK, 0);
+        if (size > 0) {
+            feed(c, chunk, (size_t) size);
+        }
+        else if (size == 0) {
+            c->eof = true;
+            if (c->in.length > 0 && !c->skipping)
+                execute_line(c, c->in.data, c->in.length, false);
+            buffer_clear(&(c->in));
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            c->failed = true;
+        }
+    }
+    if (!c->failed)
+        flush(c);
+    while (c->pending && !c->failed && c->out.length < OUTPUT_LIMIT) {
+        resume(c);
+        if (!c->failed)
+            flush(c);
+    }
+
+    uint32_t wanted = 0;
+    if (!c->eof && !c->pending && c->out.length < OUTPUT_LIMIT)
+        wanted |= EPOLLIN;
+    if (c->out.start < c->out.length)
+        wanted |= EPOLLOUT;
+    if (c->failed || wanted == 0) {
+        close_connection(list, c);
+        return;
+    }
+    if (wanted != c->events) {
+        struct epoll_event event = {.events = wanted, .data.ptr = c};
+        if (epoll_ctl(epoll, EPOLL_CTL_MOD, c->fd, &event) < 0) {
+            close_connection(list, c);
+            return;
+        }
+        c->events = wanted;
+    }
+}
+
+/**
+ * Funkcja pomocnicza przyjmująca wszystkie czekające połączenia.
+ * @param epoll - Deskryptor epoll.
+ * @param listener - Gniazdo nasłuchujące.
+ * @param table - Wskaźnik na tablicę gier serwera.
+ * @param list - Wskaźnik na pierwsze połączenie listy.
+ */
+static void accept_all(int epoll, int listener, game_table_t *table,
+                       connection_t **list) {
+    for (;;) {
+        int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE || errno == ENOMEM ||
+                errno == ENOBUFS)
+                perror("accept");
+            return;
+        }
+        connection_t *c = calloc(1, sizeof(connection_t));
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = c};
+        if (c == NULL || epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+            free(c);
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->table = table;
+        c->line = START_LINE;
+        c->events = EPOLLIN;
+        c->next = *list;
+        if (*list != NULL)
+            (*list)->prev = c;
+        *list = c;
+    }
+}
+
+/**
+ * Funkcja pomocnicza podnosząca miękki limit otwartych plików do limitu
+ * twardego, żeby serwer mógł obsłużyć tysiące połączeń.
+ */
+static void raise_file_limit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+        limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/**
+ * Funkcja pomocnicza tworząca gniazdo nasłuchujące.
+ * @param path - Ścieżka gniazda.
+ * @return Deskryptor gniazda lub -1 w razie błędu, wypisanego na stderr.
+ */
+static int open_listener(const char *path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 ||
+        bind(fd, (struct sockaddr*) &address, sizeof(address)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool server_run(const char *path) {
+    raise_file_limit();
+    int listener = open_listener(path);
+    if (listener < 0)
+        return false;
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    char *chunk = malloc(READ_CHUNK);
+    struct epoll_event *events = malloc(sizeof(struct epoll_event) *
+                                        MAX_EVENTS);
+    game_table_t *table = game_table_new(POOL_LIMIT);
+    if (epoll < 0 || chunk == NULL || events == NULL || table == NULL ||
+        epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) < 0) {
+        perror("epoll");
+        game_table_delete(table);
+        free(chunk);
+        free(events);
+        if (epoll >= 0)
+            close(epoll);
+        close(listener);
+        unlink(path);
+        return false;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    connection_t *list = NULL;
+    bool ok = true;
+    while (!stop_requested) {
+        int count = epoll_wait(epoll, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.ptr == NULL)
+                accept_all(epoll, listener, table, &list);
+            else
+                serve(epoll, &list, events[i].data.ptr, events[i].events,
+                      chunk);
+        }
+    }
+
+    while (list != NULL)
+        close_connection(&list, list);
+    game_table_delete(table);
+    free(chunk);
+    free(events);
+    close(epoll);
+    close(listener);
+    unlink(path);
+    return ok;
+}
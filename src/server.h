@@ -0,0 +1,26 @@
+/**
+ * @file
+ * Interfejs serwera gier na gnieździe domeny uniksowej. Każde połączenie to
+ * osobna gra w trybie wsadowym: klient wysyła wiersz nagłówka
+ * B szerokość wysokość gracze obszary, a potem polecenia trybu wsadowego.
+ * Odpowiedzi i komunikaty o błędach trafiają w kolejności do tego samego
+ * połączenia. Wszystkie połączenia obsługuje jedna pętla zdarzeń epoll z
+ * nieblokującymi gniazdami i buforami wejścia i wyjścia każdego połączenia.
+ */
+#ifndef GAMMA_SERVER_H
+#define GAMMA_SERVER_H
+
+#include <stdbool.h>
+
+/**
+ * Funkcja uruchamiająca serwer. Usuwa istniejący plik gniazda @p path,
+ * tworzy nowe gniazdo i obsługuje połączenia do sygnału SIGINT lub SIGTERM.
+ * Na koniec zamyka wszystkie połączenia, zwalnia ich gry i usuwa plik
+ * gniazda.
+ * @param path  - Ścieżka gniazda.
+ * @return Wartość false, gdy nie udało się uruchomić serwera; przyczyna jest
+ * wtedy wypisana na stderr.
+ */
+bool server_run(const char *path);
+
+#endif //GAMMA_SERVER_H
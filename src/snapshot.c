@@ -0,0 +1,254 @@
+/**
+ * @file
+ * Implementacja formatu migawek stanu gry i widoku migawki odwzorowanej w
+ * pamięci.
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do mmap i fstat.
+
+#include "snapshot.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SUM_K1 0x87C37B91114253D5ull ///< Pierwsza stała mieszająca sumy.
+#define SUM_K2 0x4CF5AD432745937Full ///< Druga stała mieszająca sumy.
+
+_Static_assert(sizeof(snapshot_header_t) == 96,
+               "snapshot header must have no padding");
+
+/**
+ * Struktura przechowująca widok migawki.
+ */
+struct gamma_view {
+    void *map; ///< Początek odwzorowania.
+    size_t size; ///< Rozmiar odwzorowania.
+    const snapshot_header_t *header; ///< Nagłówek.
+    const uint32_t *player_areas; ///< Liczby obszarów graczy.
+    const uint64_t *player_fields; ///< Liczby pól graczy.
+    const uint8_t *golden_used; ///< Znaczniki złotych ruchów.
+    const uint8_t *owners; ///< Właściciele pól.
+};
+
+/**
+ * Funkcja pomocnicza zaokrąglająca w górę do wielokrotności
+ * @ref SNAPSHOT_ALIGN.
+ * @param offset - Położenie w pliku.
+ * @param out - Wskaźnik, pod który zapisujemy wynik.
+ * @return Wartość false, gdy wynik nie mieści się w uint64_t.
+ */
+static bool align_up(uint64_t offset, uint64_t *out) {
+    if (offset > UINT64_MAX - (SNAPSHOT_ALIGN - 1))
+        return false;
+    *out = (offset + SNAPSHOT_ALIGN - 1) & ~(uint64_t) (SNAPSHOT_ALIGN - 1);
+    return true;
+}
+
+/**
+ * Funkcja pomocnicza wyliczająca położenie sekcji za sekcją zaczynającą się
+ * w @p offset i złożoną z @p count elementów po @p size bajtów.
+ * @param offset - Początek sekcji.
+ * @param count - Liczba elementów.
+ * @param size - Rozmiar elementu.
+ * @param out - Wskaźnik, pod który zapisujemy wynik.
+ * @return Wartość false, gdy wynik nie mieści się w uint64_t.
+ */
+static bool next_section(uint64_t offset, uint64_t count, uint64_t size,
+                         uint64_t *out) {
+    if (count > (UINT64_MAX - offset) / size)
+        return false;
+    return align_up(offset + count * size, out);
+}
+
+bool snapshot_init(snapshot_header_t *header, uint32_t width, uint32_t height,
+                   uint32_t players, uint32_t areas, uint32_t owner_bytes) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = SNAPSHOT_VERSION;
+    header->byte_order = SNAPSHOT_BYTE_ORDER;
+    header->width = width;
+    header->height = height;
+    header->players = players;
+    header->areas = areas;
+    header->owner_bytes = owner_bytes;
+    uint64_t entries = (uint64_t) players + 1;
+    return align_up(sizeof(*header), &(header->areas_offset)) &&
+           next_section(header->areas_offset, entries, sizeof(uint32_t),
+                        &(header->fields_offset)) &&
+           next_section(header->fields_offset, entries, sizeof(uint64_t),
+                        &(header->golden_offset)) &&
+           next_section(header->golden_offset, entries, sizeof(uint8_t),
+                        &(header->owners_offset)) &&
+           next_section(header->owners_offset, (uint64_t) width * height,
+                        owner_bytes, &(header->file_size));
+}
+
+bool snapshot_header_valid(const snapshot_header_t *header) {
+    snapshot_header_t expected;
+    if (header->owner_bytes != sizeof(uint8_t) &&
+        header->owner_bytes != sizeof(uint16_t) &&
+        header->owner_bytes != sizeof(uint32_t))
+        return false;
+    if (!snapshot_init(&expected, header->width, header->height,
+                       header->players, header->areas, header->owner_bytes))
+        return false;
+    return memcmp(header->magic, expected.magic, sizeof(header->magic)) == 0 &&
+           header->version == expected.version &&
+           header->byte_order == expected.byte_order &&
+           header->width > 0 && header->height > 0 && header->players > 0 &&
+           header->areas > 0 && header->reserved == 0 &&
+           header->areas_offset == expected.areas_offset &&
+           header->fields_offset == expected.fields_offset &&
+           header->golden_offset == expected.golden_offset &&
+           header->owners_offset == expected.owners_offset &&
+           header->file_size == expected.file_size;
+}
+
+/**
+ * Funkcja pomocnicza dopisująca jedno słowo do sumy kontrolnej.
+ * @param state - Dotychczasowa suma.
+ * @param word - Słowo.
+ * @return Nowa suma.
+ */
+static inline uint64_t sum_word(uint64_t state, uint64_t word) {
+    word *= SUM_K1;
+    word = (word << 31) | (word >> 33);
+    state ^= word * SUM_K2;
+    return ((state << 27) | (state >> 37)) * 5 + 0x52DCE729;
+}
+
+void snapshot_sum_init(snapshot_sum_t *sum) {
+    sum->state = 0;
+    sum->length = 0;
+    sum->carry = 0;
+    sum->carry_bytes = 0;
+}
+
+void snapshot_sum_update(snapshot_sum_t *sum, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    sum->length += size;
+    while (size > 0 && sum->carry_bytes > 0) {
+        sum->carry |= (uint64_t) *bytes++ << (8 * sum->carry_bytes);
+        --size;
+        if (++(sum->carry_bytes) == sizeof(uint64_t)) {
+            sum->state = sum_word(sum->state, sum->carry);
+            sum->carry = 0;
+            sum->carry_bytes = 0;
+        }
+    }
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        sum->state = sum_word(sum->state, word);
+        bytes += sizeof(word);
+    }
+    while (size-- > 0)
+        sum->carry |= (uint64_t) *bytes++ << (8 * sum->carry_bytes++);
+}
+
+uint64_t snapshot_sum_final(const snapshot_sum_t *sum) {
+    uint64_t state = sum_word(sum->state, sum->carry) ^ sum->length;
+    state ^= state >> 33;
+    state *= 0xFF51AFD7ED558CCDull;
+    state ^= state >> 33;
+    return state;
+}
+
+/**
+ * Funkcja pomocnicza licząca sumę kontrolną odwzorowanego pliku.
+ * @param map - Początek pliku.
+ * @param header - Nagłówek pliku.
+ * @return Suma kontrolna.
+ */
+static uint64_t map_checksum(const uint8_t *map,
+                             const snapshot_header_t *header) {
+    snapshot_header_t copy = *header;
+    copy.checksum = 0;
+    snapshot_sum_t sum;
+    snapshot_sum_init(&sum);
+    snapshot_sum_update(&sum, &copy, sizeof(copy));
+    snapshot_sum_update(&sum, map + sizeof(copy),
+                        header->file_size - sizeof(copy));
+    return snapshot_sum_final(&sum);
+}
+
+gamma_view_t* gamma_view_open(int fd, bool verify) {
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return NULL;
+    if (st.st_size < (off_t) sizeof(snapshot_header_t) ||
+        (uint64_t) st.st_size > SIZE_MAX) {
+        errno = EBADMSG;
+        return NULL;
+    }
+    gamma_view_t *view = malloc(sizeof(gamma_view_t));
+    if (view == NULL)
+        return NULL;
+    view->size = (size_t) st.st_size;
+    view->map = mmap(NULL, view->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (view->map == MAP_FAILED) {
+        free(view);
+        return NULL;
+    }
+
+    const uint8_t *map = view->map;
+    const snapshot_header_t *header = view->map;
+    if (!snapshot_header_valid(header) || header->file_size != view->size ||
+        (verify && map_checksum(map, header) != header->checksum)) {
+        gamma_view_close(view);
+        errno = EBADMSG;
+        return NULL;
+    }
+    view->header = header;
+    view->player_areas = (const uint32_t*) (map + header->areas_offset);
+    view->player_fields = (const uint64_t*) (map + header->fields_offset);
+    view->golden_used = map + header->golden_offset;
+    view->owners = map + header->owners_offset;
+    return view;
+}
+
+void gamma_view_close(gamma_view_t *view) {
+    if (view == NULL)
+        return;
+    munmap(view->map, view->size);
+    free(view);
+}
+
+const snapshot_header_t* gamma_view_header(const gamma_view_t *view) {
+    return view->header;
+}
+
+uint32_t gamma_view_owner(const gamma_view_t *view, uint32_t x, uint32_t y) {
+    const snapshot_header_t *header = view->header;
+    if (x >= header->width || y >= header->height)
+        return 0;
+    size_t cell = (size_t) y * header->width + x;
+    switch (header->owner_bytes) {
+        case sizeof(uint8_t):
+            return view->owners[cell];
+        case sizeof(uint16_t):
+            return ((const uint16_t*) view->owners)[cell];
+        default:
+            return ((const uint32_t*) view->owners)[cell];
+    }
+}
+
+uint64_t gamma_view_busy_fields(const gamma_view_t *view, uint32_t player) {
+    if (player == 0 || player > view->header->players)
+        return 0;
+    return view->player_fields[player];
+}
+
+uint32_t gamma_view_player_areas(const gamma_view_t *view, uint32_t player) {
+    if (player == 0 || player > view->header->players)
+        return 0;
+    return view->player_areas[player];
+}
+
+bool gamma_view_golden_used(const gamma_view_t *view, uint32_t player) {
+    if (player == 0 || player > view->header->players)
+        return false;
+    return view->golden_used[player] != 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file
+ * Interfejs binarnego formatu migawek stanu gry zapisywanych przez
+ * @ref gamma_save i wczytywanych przez @ref gamma_load oraz widoku migawki
+ * tylko do odczytu, który odwzorowuje plik w pamięci bez kopiowania.
+ *
+ * Plik zaczyna się nagłówkiem @ref snapshot_header_t, po którym leżą kolejno
+ * sekcje: liczby obszarów graczy (uint32_t), liczby pól graczy (uint64_t),
+ * znaczniki wykorzystania złotego ruchu (po jednym bajcie) i właściciele pól
+ * wiersz po wierszu, bez ramki, na owner_bytes bajtach. Każda tablica graczy
+ * ma players + 1 elementów, z nieużywanym elementem 0. Każda sekcja zaczyna
+ * się na granicy @ref SNAPSHOT_ALIGN bajtów i jest dopełniona zerami, więc
+ * po odwzorowaniu pliku w pamięci tablice są poprawnie wyrównane. Liczby są
+ * zapisane w porządku bajtów komputera, który zapisał plik; znacznik
+ * byte_order pozwala wykryć plik z komputera o innym porządku. Suma
+ * kontrolna obejmuje cały plik z polem checksum wyzerowanym.
+ */
+
+#ifndef GAMMA_SNAPSHOT_H
+#define GAMMA_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Znacznik początku pliku migawki. */
+#define SNAPSHOT_MAGIC "GAMMASNP"
+/** Wersja formatu. */
+#define SNAPSHOT_VERSION 1
+/** Znacznik porządku bajtów. */
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+/** Wyrównanie sekcji pliku w bajtach. */
+#define SNAPSHOT_ALIGN 64
+
+/**
+ * Nagłówek migawki.
+ */
+typedef struct snapshot_header {
+    char magic[8]; ///< Znacznik @ref SNAPSHOT_MAGIC bez kończącego zera.
+    uint32_t version; ///< Wersja formatu.
+    uint32_t byte_order; ///< Znacznik @ref SNAPSHOT_BYTE_ORDER.
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t height; ///< Wysokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    uint32_t areas; ///< Maksymalna liczba obszarów gracza.
+    uint32_t owner_bytes; ///< Rozmiar numeru właściciela pola: 1, 2 lub 4.
+    uint32_t reserved; ///< Zero.
+    uint64_t hash; ///< Skrót stanu gry z @ref gamma_hash.
+    uint64_t areas_offset; ///< Położenie liczb obszarów graczy.
+    uint64_t fields_offset; ///< Położenie liczb pól graczy.
+    uint64_t golden_offset; ///< Położenie znaczników złotych ruchów.
+    uint64_t owners_offset; ///< Położenie właścicieli pól.
+    uint64_t file_size; ///< Rozmiar pliku.
+    uint64_t checksum; ///< Suma kontrolna pliku.
+} snapshot_header_t;
+
+/**
+ * Stan liczenia sumy kontrolnej.
+ */
+typedef struct snapshot_sum {
+    uint64_t state; ///< Dotychczasowa suma.
+    uint64_t length; ///< Liczba przetworzonych bajtów.
+    uint64_t carry; ///< Bajty niepełnego słowa.
+    uint32_t carry_bytes; ///< Liczba bajtów niepełnego słowa.
+} snapshot_sum_t;
+
+/**
+ * Funkcja wypełniająca nagłówek dla planszy o podanych parametrach:
+ * znaczniki, wersję i położenia sekcji. Pola hash i checksum są zerowane.
+ * @param header - Wskaźnik na nagłówek.
+ * @param width - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @param players - Liczba graczy.
+ * @param areas - Maksymalna liczba obszarów gracza.
+ * @param owner_bytes - Rozmiar numeru właściciela pola.
+ * @return Wartość false, gdy rozmiar pliku nie mieści się w uint64_t.
+ */
+bool snapshot_init(snapshot_header_t *header, uint32_t width, uint32_t height,
+                   uint32_t players, uint32_t areas, uint32_t owner_bytes);
+
+/**
+ * Funkcja sprawdzająca, czy nagłówek wczytany z pliku jest poprawny:
+ * znaczniki, wersja, niezerowe parametry i położenia sekcji zgodne z
+ * @ref snapshot_init.
+ * @param header - Wskaźnik na nagłówek.
+ * @return Wartość true, jeśli nagłówek jest poprawny.
+ */
+bool snapshot_header_valid(const snapshot_header_t *header);
+
+/**
+ * Funkcja rozpoczynająca liczenie sumy kontrolnej.
+ * @param sum - Wskaźnik na stan sumy.
+ */
+void snapshot_sum_init(snapshot_sum_t *sum);
+
+/**
+ * Funkcja dopisująca bajty do sumy kontrolnej. Dane można podawać
+ * fragmentami dowolnej długości; wynik zależy tylko od ich złączenia.
+ * @param sum - Wskaźnik na stan sumy.
+ * @param data - Wskaźnik na dane.
+ * @param size - Liczba bajtów.
+ */
+void snapshot_sum_update(snapshot_sum_t *sum, const void *data, size_t size);
+
+/**
+ * Funkcja kończąca liczenie sumy kontrolnej.
+ * @param sum - Wskaźnik na stan sumy.
+ * @return Suma kontrolna.
+ */
+uint64_t snapshot_sum_final(const snapshot_sum_t *sum);
+
+/**
+ * Struktura przechowująca widok migawki odwzorowanej w pamięci.
+ */
+typedef struct gamma_view gamma_view_t;
+
+/**
+ * Funkcja odwzorowująca migawkę z pliku @p fd w pamięci tylko do odczytu.
+ * Dane nie są kopiowane: system wczytuje strony pliku dopiero przy odczycie,
+ * więc otwarcie dużej planszy bez sprawdzania sumy kontrolnej trwa krótko.
+ * Deskryptor można zamknąć zaraz po wywołaniu.
+ * @param fd - Deskryptor pliku otwartego do odczytu.
+ * @param verify - Czy sprawdzić sumę kontrolną, co wymaga przeczytania
+ * całego pliku.
+ * @return Wskaźnik na widok lub NULL z ustawionym errno: EBADMSG dla
+ * niepoprawnego pliku, ENOMEM, gdy zabrakło pamięci, a w pozostałych
+ * przypadkach kod błędu funkcji fstat lub mmap.
+ */
+gamma_view_t* gamma_view_open(int fd, bool verify);
+
+/**
+ * Funkcja zamykająca widok. Nic nie robi dla NULL.
+ * @param view - Wskaźnik na widok.
+ */
+void gamma_view_close(gamma_view_t *view);
+
+/**
+ * Funkcja podająca nagłówek migawki.
+ * @param view - Wskaźnik na widok.
+ * @return Wskaźnik na nagłówek w odwzorowanym pliku.
+ */
+const snapshot_header_t* gamma_view_header(const gamma_view_t *view);
+
+/**
+ * Funkcja podająca właściciela pola.
+ * @param view - Wskaźnik na widok.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @return Numer gracza albo 0 dla pola pustego lub spoza planszy.
+ */
+uint32_t gamma_view_owner(const gamma_view_t *view, uint32_t x, uint32_t y);
+
+/**
+ * Funkcja podająca liczbę pól gracza.
+ * @param view - Wskaźnik na widok.
+ * @param player - Numer gracza.
+ * @return Liczba pól lub 0 dla niepoprawnego numeru gracza.
+ */
+uint64_t gamma_view_busy_fields(const gamma_view_t *view, uint32_t player);
+
+/**
+ * Funkcja podająca liczbę obszarów gracza.
+ * @param view - Wskaźnik na widok.
+ * @param player - Numer gracza.
+ * @return Liczba obszarów lub 0 dla niepoprawnego numeru gracza.
+ */
+uint32_t gamma_view_player_areas(const gamma_view_t *view, uint32_t player);
+
+/**
+ * Funkcja sprawdzająca, czy gracz wykorzystał złoty ruch.
+ * @param view - Wskaźnik na widok.
+ * @param player - Numer gracza.
+ * @return Wartość true, jeśli gracz wykorzystał złoty ruch.
+ */
+bool gamma_view_golden_used(const gamma_view_t *view, uint32_t player);
+
+#endif //GAMMA_SNAPSHOT_H
@@ -0,0 +1,566 @@
+/**
+ * @file
+ * Implementacja niezmiennych migawek stanu gry dla obserwatorów.
+ */
+
+#include "spectate.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PAGE_SIZE 256 ///< Rozmiar strony danych w bajtach.
+#define FANOUT_SHIFT 5 ///< Logarytm liczby dzieci węzła wewnętrznego.
+#define FANOUT (1u << FANOUT_SHIFT) ///< Liczba dzieci węzła wewnętrznego.
+#define RECLAIM_INTERVAL 64 ///< Liczba publikacji między przeglądami slotów.
+#define SLOT_ALIGN 64 ///< Wyrównanie slotów do linii pamięci podręcznej.
+#define LOG_BASE 10 ///< Baza logarytmu używana przy wypisywaniu planszy.
+
+/**
+ * Węzeł drzewa stron: strona danych albo węzeł wewnętrzny.
+ */
+typedef struct spectate_node spectate_node_t;
+
+/**
+ * Węzeł drzewa stron.
+ */
+struct spectate_node {
+    spectate_node_t *next; ///< Następny węzeł listy wycofanych lub wolnych.
+    uint64_t generation; /**< Numer wersji, w której węzeł powstał; 0 dla
+    wspólnych węzłów pustej planszy, których nigdy się nie zwalnia. */
+    uint64_t retired; ///< Epoka wycofania węzła.
+    union {
+        uint8_t bytes[PAGE_SIZE]; ///< Dane strony.
+        spectate_node_t *children[FANOUT]; ///< Dzieci węzła wewnętrznego.
+    };
+};
+
+_Static_assert(sizeof(spectate_node_t*) * FANOUT <= PAGE_SIZE,
+               "inner node must fit in a page");
+
+/**
+ * Opublikowana wersja stanu gry.
+ */
+typedef struct spectate_version spectate_version_t;
+
+/**
+ * Opublikowana wersja stanu gry.
+ */
+struct spectate_version {
+    spectate_version_t *next; ///< Następna wersja listy wycofanych lub wolnych.
+    uint64_t retired; ///< Epoka wycofania wersji.
+    uint64_t version; ///< Wersja stanu gry.
+    uint64_t hash; ///< Skrót stanu gry.
+    const spectate_node_t *root; ///< Korzeń drzewa stron wersji.
+};
+
+/**
+ * Liczniki gracza zapisane w stronach.
+ */
+typedef struct spectate_player {
+    uint64_t fields; ///< Liczba pól gracza.
+    uint32_t areas; ///< Liczba obszarów gracza.
+    uint32_t golden_used; ///< Czy gracz wykorzystał złoty ruch.
+} spectate_player_t;
+
+_Static_assert(PAGE_SIZE % sizeof(spectate_player_t) == 0,
+               "player counters must not cross pages");
+
+/**
+ * Slot czytelnika, a zarazem migawka zwracana przez
+ * @ref spectate_acquire. Każdy slot zajmuje własną linię pamięci
+ * podręcznej, więc czytelnicy nie przeszkadzają sobie nawzajem.
+ */
+struct gamma_snapshot {
+    /** Epoka, w której czytelnik wziął migawkę, lub 0 dla wolnego slotu. */
+    _Alignas(SLOT_ALIGN) atomic_uint_fast64_t epoch;
+    const spectate_version_t *version; ///< Trzymana wersja.
+    const spectate_t *spectate; ///< Stan migawek, do którego należy slot.
+};
+
+/**
+ * Struktura przechowująca stan migawek planszy.
+ */
+struct spectate {
+    uint32_t width; ///< Szerokość planszy.
+    uint32_t height; ///< Wysokość planszy.
+    uint32_t players; ///< Liczba graczy.
+    uint32_t owner_bytes; ///< Rozmiar numeru właściciela pola.
+    uint64_t players_offset; ///< Położenie liczników graczy w danych.
+    uint32_t depth; ///< Liczba poziomów węzłów wewnętrznych nad stronami.
+    spectate_node_t **zero; /**< Wspólne węzły pustej planszy dla każdego
+    poziomu, od strony do korzenia. */
+    spectate_node_t *root; ///< Korzeń przygotowywanej wersji.
+    uint64_t generation; ///< Numer przygotowywanej wersji.
+    spectate_node_t *replaced; /**< Węzły zastąpione w przygotowywanej
+    wersji, wciąż należące do opublikowanej. */
+    atomic_bool failed; ///< Czy zabrakło pamięci na kopię strony.
+
+    _Atomic(spectate_version_t*) published; ///< Ostatnia opublikowana wersja.
+    atomic_uint_fast64_t epoch; ///< Bieżąca epoka, od 1.
+    gamma_snapshot_t *slots; ///< Sloty czytelników.
+    uint32_t readers; ///< Liczba slotów.
+    atomic_uint next_slot; ///< Slot, od którego zaczyna szukać czytelnik.
+
+    spectate_node_t *retired_first; ///< Najstarszy wycofany węzeł.
+    spectate_node_t *retired_last; ///< Najmłodszy wycofany węzeł.
+    spectate_version_t *versions_first; ///< Najstarsza wycofana wersja.
+    spectate_version_t *versions_last; ///< Najmłodsza wycofana wersja.
+    spectate_node_t *free_nodes; ///< Pula wolnych węzłów.
+    spectate_version_t *free_versions; ///< Pula wolnych wersji.
+    uint32_t publishes; ///< Publikacje od ostatniego przeglądu slotów.
+};
+
+/**
+ * Funkcja pomocnicza pobierająca węzeł z puli lub przydzielająca nowy.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @return Wskaźnik na węzeł lub NULL, gdy zabrakło pamięci.
+ */
+static spectate_node_t* node_alloc(spectate_t *spectate) {
+    spectate_node_t *node = spectate->free_nodes;
+    if (node != NULL)
+        spectate->free_nodes = node->next;
+    else
+        node = malloc(sizeof(spectate_node_t));
+    return node;
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca węzły listy.
+ * @param node - Pierwszy węzeł listy.
+ */
+static void free_nodes(spectate_node_t *node) {
+    while (node != NULL) {
+        spectate_node_t *next = node->next;
+        free(node);
+        node = next;
+    }
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca wersje listy.
+ * @param version - Pierwsza wersja listy.
+ */
+static void free_versions(spectate_version_t *version) {
+    while (version != NULL) {
+        spectate_version_t *next = version->next;
+        free(version);
+        version = next;
+    }
+}
+
+/**
+ * Funkcja pomocnicza zwalniająca węzły poddrzewa, które nie są wspólnymi
+ * węzłami pustej planszy.
+ * @param node - Korzeń poddrzewa.
+ * @param level - Poziom korzenia, 0 dla strony.
+ */
+static void free_tree(spectate_node_t *node, uint32_t level) {
+    if (node->generation == 0)
+        return;
+    if (level > 0)
+        for (uint32_t i = 0; i < FANOUT; ++i)
+            free_tree(node->children[i], level - 1);
+    free(node);
+}
+
+spectate_t* spectate_new(uint32_t width, uint32_t height, uint32_t players,
+                         uint32_t owner_bytes, uint32_t readers) {
+    uint64_t cells = (uint64_t) width * height;
+    uint64_t counters = ((uint64_t) players + 1) * sizeof(spectate_player_t);
+    if (cells > (UINT64_MAX - counters - PAGE_SIZE) / owner_bytes) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    uint64_t players_offset = (cells * owner_bytes +
+                               sizeof(spectate_player_t) - 1) /
+                              sizeof(spectate_player_t) *
+                              sizeof(spectate_player_t);
+    uint64_t pages = (players_offset + counters + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint32_t depth = 0;
+    for (uint64_t span = 1; span < pages; span <<= FANOUT_SHIFT)
+        ++depth;
+
+    spectate_t *spectate = calloc(1, sizeof(spectate_t));
+    size_t slots_size = (sizeof(gamma_snapshot_t) * readers + SLOT_ALIGN - 1) /
+                        SLOT_ALIGN * SLOT_ALIGN;
+    if (spectate == NULL ||
+        (spectate->zero = calloc(depth + 1, sizeof(spectate_node_t*))) ==
+        NULL ||
+        (spectate->slots = aligned_alloc(SLOT_ALIGN, slots_size)) == NULL) {
+        spectate_delete(spectate);
+        errno = ENOMEM;
+        return NULL;
+    }
+    spectate->width = width;
+    spectate->height = height;
+    spectate->players = players;
+    spectate->owner_bytes = owner_bytes;
+    spectate->players_offset = players_offset;
+    spectate->depth = depth;
+    spectate->readers = readers;
+    for (uint32_t i = 0; i < readers; ++i) {
+        atomic_init(&(spectate->slots[i].epoch), 0);
+        spectate->slots[i].version = NULL;
+        spectate->slots[i].spectate = spectate;
+    }
+    for (uint32_t level = 0; level <= depth; ++level) {
+        spectate_node_t *node = calloc(1, sizeof(spectate_node_t));
+        if (node == NULL) {
+            spectate_delete(spectate);
+            errno = ENOMEM;
+            return NULL;
+        }
+        if (level > 0)
+            for (uint32_t i = 0; i < FANOUT; ++i)
+                node->children[i] = spectate->zero[level - 1];
+        spectate->zero[level] = node;
+    }
+    spectate->root = spectate->zero[depth];
+    spectate->generation = 1;
+    atomic_init(&(spectate->failed), false);
+    atomic_init(&(spectate->published), NULL);
+    atomic_init(&(spectate->epoch), 1);
+    atomic_init(&(spectate->next_slot), 0);
+    return spectate;
+}
+
+void spectate_delete(spectate_t *spectate) {
+    if (spectate == NULL)
+        return;
+    if (spectate->zero != NULL && spectate->root != NULL)
+        free_tree(spectate->root, spectate->depth);
+    free_nodes(spectate->replaced);
+    free_nodes(spectate->retired_first);
+    free_nodes(spectate->free_nodes);
+    free(atomic_load(&(spectate->published)));
+    free_versions(spectate->versions_first);
+    free_versions(spectate->free_versions);
+    if (spectate->zero != NULL)
+        for (uint32_t level = 0; level <= spectate->depth; ++level)
+            free(spectate->zero[level]);
+    free(spectate->zero);
+    free(spectate->slots);
+    free(spectate);
+}
+
+/**
+ * Funkcja pomocnicza podająca do zapisu stronę przygotowywanej wersji.
+ * Kopiuje stronę i węzły na ścieżce od korzenia, które nie powstały w
+ * przygotowywanej wersji, a zastąpione odkłada do wycofania.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @param page - Numer strony.
+ * @return Wskaźnik na dane strony lub NULL, gdy zabrakło pamięci.
+ */
+static uint8_t* writable_page(spectate_t *spectate, uint64_t page) {
+    spectate_node_t **slot = &(spectate->root);
+    for (uint32_t level = spectate->depth;; --level) {
+        spectate_node_t *node = *slot;
+        if (node->generation != spectate->generation) {
+            spectate_node_t *copy = node_alloc(spectate);
+            if (copy == NULL)
+                return NULL;
+            memcpy(copy->bytes, node->bytes, PAGE_SIZE);
+            copy->generation = spectate->generation;
+            if (node->generation != 0) {
+                node->next = spectate->replaced;
+                spectate->replaced = node;
+            }
+            *slot = node = copy;
+        }
+        if (level == 0)
+            return node->bytes;
+        slot = &(node->children[(page >> (FANOUT_SHIFT * (level - 1))) &
+                                (FANOUT - 1)]);
+    }
+}
+
+/**
+ * Funkcja pomocnicza podająca stronę drzewa o korzeniu @p root.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @param root - Korzeń drzewa stron.
+ * @param page - Numer strony.
+ * @return Wskaźnik na dane strony.
+ */
+static const uint8_t* read_page(const spectate_t *spectate,
+                                const spectate_node_t *root, uint64_t page) {
+    for (uint32_t level = spectate->depth; level > 0; --level)
+        root = root->children[(page >> (FANOUT_SHIFT * (level - 1))) &
+                              (FANOUT - 1)];
+    return root->bytes;
+}
+
+/**
+ * Funkcja pomocnicza zapisująca dane w przygotowywanej wersji. Dane nie
+ * mogą przekraczać granicy strony. Niezmienione dane nie są kopiowane.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @param offset - Położenie danych.
+ * @param data - Dane.
+ * @param size - Rozmiar danych.
+ */
+static void write_data(spectate_t *spectate, uint64_t offset,
+                       const void *data, size_t size) {
+    uint64_t page = offset / PAGE_SIZE;
+    size_t in_page = offset % PAGE_SIZE;
+    if (atomic_load_explicit(&(spectate->failed), memory_order_relaxed) ||
+        memcmp(read_page(spectate, spectate->root, page) + in_page, data,
+               size) == 0)
+        return;
+    uint8_t *bytes = writable_page(spectate, page);
+    if (bytes == NULL)
+        atomic_store(&(spectate->failed), true);
+    else
+        memcpy(bytes + in_page, data, size);
+}
+
+void spectate_set_owner(spectate_t *spectate, uint32_t x, uint32_t y,
+                        uint32_t owner) {
+    uint64_t offset = ((uint64_t) y * spectate->width + x) *
+                      spectate->owner_bytes;
+    uint8_t owner8 = (uint8_t) owner;
+    uint16_t owner16 = (uint16_t) owner;
+    const void *data = spectate->owner_bytes == sizeof(uint8_t) ?
+                       (const void*) &owner8 :
+                       spectate->owner_bytes == sizeof(uint16_t) ?
+                       (const void*) &owner16 : (const void*) &owner;
+    write_data(spectate, offset, data, spectate->owner_bytes);
+}
+
+void spectate_set_player(spectate_t *spectate, uint32_t player,
+                         uint64_t fields, uint32_t areas, bool golden_used) {
+    spectate_player_t counters = {fields, areas, golden_used};
+    write_data(spectate, spectate->players_offset +
+                         (uint64_t) player * sizeof(spectate_player_t),
+               &counters, sizeof(counters));
+}
+
+/**
+ * Funkcja pomocnicza rozpoczynająca nową epokę i zwracająca do puli
+ * wycofane węzły i wersje, których nie może już trzymać żaden czytelnik:
+ * wycofane w epoce wcześniejszej niż najstarsza epoka zajętych slotów.
+ * @param spectate - Wskaźnik na stan migawek.
+ */
+static void reclaim(spectate_t *spectate) {
+    // Czytelnik, który zapisze w slocie nową epokę, przeczyta wersję
+    // opublikowaną po wycofaniu wszystkiego, co ma starszą epokę.
+    atomic_fetch_add(&(spectate->epoch), 1);
+    uint64_t oldest = UINT64_MAX;
+    for (uint32_t i = 0; i < spectate->readers; ++i) {
+        uint64_t epoch = atomic_load(&(spectate->slots[i].epoch));
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+    while (spectate->retired_first != NULL &&
+           spectate->retired_first->retired < oldest) {
+        spectate_node_t *node = spectate->retired_first;
+        spectate->retired_first = node->next;
+        node->next = spectate->free_nodes;
+        spectate->free_nodes = node;
+    }
+    if (spectate->retired_first == NULL)
+        spectate->retired_last = NULL;
+    while (spectate->versions_first != NULL &&
+           spectate->versions_first->retired < oldest) {
+        spectate_version_t *version = spectate->versions_first;
+        spectate->versions_first = version->next;
+        version->next = spectate->free_versions;
+        spectate->free_versions = version;
+    }
+    if (spectate->versions_first == NULL)
+        spectate->versions_last = NULL;
+}
+
+bool spectate_publish(spectate_t *spectate, uint64_t version, uint64_t hash) {
+    if (atomic_load_explicit(&(spectate->failed), memory_order_relaxed))
+        return false;
+    spectate_version_t *next = spectate->free_versions;
+    if (next != NULL)
+        spectate->free_versions = next->next;
+    else if ((next = malloc(sizeof(spectate_version_t))) == NULL) {
+        atomic_store(&(spectate->failed), true);
+        return false;
+    }
+    next->next = NULL;
+    next->version = version;
+    next->hash = hash;
+    next->root = spectate->root;
+
+    // Czytelnik wpisuje epokę do slotu przed odczytem wersji, więc to, co
+    // zastąpiła nowa wersja, może trzymać tylko czytelnik ze slotem o epoce
+    // nie późniejszej niż bieżąca.
+    spectate_version_t *old = atomic_exchange(&(spectate->published), next);
+    uint64_t epoch = atomic_load(&(spectate->epoch));
+    if (old != NULL) {
+        old->retired = epoch;
+        if (spectate->versions_last != NULL)
+            spectate->versions_last->next = old;
+        else
+            spectate->versions_first = old;
+        spectate->versions_last = old;
+    }
+    for (spectate_node_t *node = spectate->replaced; node != NULL;) {
+        spectate_node_t *following = node->next;
+        node->retired = epoch;
+        node->next = NULL;
+        if (spectate->retired_last != NULL)
+            spectate->retired_last->next = node;
+        else
+            spectate->retired_first = node;
+        spectate->retired_last = node;
+        node = following;
+    }
+    spectate->replaced = NULL;
+    ++(spectate->generation);
+
+    if (++(spectate->publishes) >= RECLAIM_INTERVAL) {
+        spectate->publishes = 0;
+        reclaim(spectate);
+    }
+    return true;
+}
+
+gamma_snapshot_t* spectate_acquire(spectate_t *spectate) {
+    if (atomic_load(&(spectate->failed))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    uint32_t start = atomic_fetch_add_explicit(&(spectate->next_slot), 1,
+                                               memory_order_relaxed);
+    for (uint32_t i = 0; i < spectate->readers; ++i) {
+        gamma_snapshot_t *slot = &(spectate->slots[(start + i) %
+                                                   spectate->readers]);
+        uint_fast64_t free_slot = 0;
+        uint_fast64_t epoch = atomic_load(&(spectate->epoch));
+        if (atomic_load_explicit(&(slot->epoch), memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_strong(&(slot->epoch), &free_slot, epoch)) {
+            slot->version = atomic_load(&(spectate->published));
+            if (slot->version != NULL)
+                return slot;
+            gamma_snapshot_release(slot);
+            break;
+        }
+    }
+    errno = EAGAIN;
+    return NULL;
+}
+
+void gamma_snapshot_release(gamma_snapshot_t *s) {
+    if (s != NULL)
+        atomic_store_explicit(&(s->epoch), 0, memory_order_release);
+}
+
+uint64_t gamma_snapshot_version(const gamma_snapshot_t *s) {
+    return s->version->version;
+}
+
+uint64_t gamma_snapshot_hash(const gamma_snapshot_t *s) {
+    return s->version->hash;
+}
+
+/**
+ * Funkcja pomocnicza odczytująca numer właściciela z danych strony.
+ * @param bytes - Wskaźnik na numer w stronie.
+ * @param owner_bytes - Rozmiar numeru.
+ * @return Numer właściciela.
+ */
+static uint32_t decode_owner(const uint8_t *bytes, uint32_t owner_bytes) {
+    if (owner_bytes == sizeof(uint8_t))
+        return *bytes;
+    if (owner_bytes == sizeof(uint16_t)) {
+        uint16_t owner;
+        memcpy(&owner, bytes, sizeof(owner));
+        return owner;
+    }
+    uint32_t owner;
+    memcpy(&owner, bytes, sizeof(owner));
+    return owner;
+}
+
+uint32_t gamma_snapshot_owner(const gamma_snapshot_t *s, uint32_t x,
+                              uint32_t y) {
+    const spectate_t *spectate = s->spectate;
+    if (x >= spectate->width || y >= spectate->height)
+        return 0;
+    uint64_t offset = ((uint64_t) y * spectate->width + x) *
+                      spectate->owner_bytes;
+    return decode_owner(read_page(spectate, s->version->root,
+                                  offset / PAGE_SIZE) + offset % PAGE_SIZE,
+                        spectate->owner_bytes);
+}
+
+/**
+ * Funkcja pomocnicza odczytująca liczniki gracza z migawki.
+ * @param s - Wskaźnik na migawkę.
+ * @param player - Numer gracza.
+ * @param out - Wskaźnik, pod który zapisujemy liczniki.
+ * @return Wartość false dla niepoprawnego numeru gracza.
+ */
+static bool read_player(const gamma_snapshot_t *s, uint32_t player,
+                        spectate_player_t *out) {
+    const spectate_t *spectate = s->spectate;
+    if (player == 0 || player > spectate->players)
+        return false;
+    uint64_t offset = spectate->players_offset +
+                      (uint64_t) player * sizeof(spectate_player_t);
+    memcpy(out, read_page(spectate, s->version->root, offset / PAGE_SIZE) +
+                offset % PAGE_SIZE, sizeof(*out));
+    return true;
+}
+
+uint64_t gamma_snapshot_busy_fields(const gamma_snapshot_t *s,
+                                    uint32_t player) {
+    spectate_player_t counters;
+    return read_player(s, player, &counters) ? counters.fields : 0;
+}
+
+uint32_t gamma_snapshot_player_areas(const gamma_snapshot_t *s,
+                                     uint32_t player) {
+    spectate_player_t counters;
+    return read_player(s, player, &counters) ? counters.areas : 0;
+}
+
+bool gamma_snapshot_golden_used(const gamma_snapshot_t *s, uint32_t player) {
+    spectate_player_t counters;
+    return read_player(s, player, &counters) && counters.golden_used;
+}
+
+char* gamma_snapshot_board(const gamma_snapshot_t *s) {
+    const spectate_t *spectate = s->spectate;
+    uint32_t size = 0;
+    for (uint32_t n = spectate->players; n > 0; n /= LOG_BASE)
+        ++size;
+    uint64_t cell = size > 1 ? size + 1 : 1;
+    uint64_t row = (uint64_t) spectate->width * cell + 1;
+    if (row > (SIZE_MAX - 1) / spectate->height)
+        return NULL;
+    char *board = malloc(row * spectate->height + 1);
+    if (board == NULL)
+        return NULL;
+
+    char *position = board;
+    for (uint32_t i = spectate->height; i-- > 0;) {
+        uint64_t offset = (uint64_t) i * spectate->width *
+                          spectate->owner_bytes;
+        uint64_t page = offset / PAGE_SIZE;
+        const uint8_t *bytes = read_page(spectate, s->version->root, page);
+        for (uint32_t j = 0; j < spectate->width; ++j) {
+            if (offset / PAGE_SIZE != page) {
+                page = offset / PAGE_SIZE;
+                bytes = read_page(spectate, s->version->root, page);
+            }
+            uint32_t owner = decode_owner(bytes + offset % PAGE_SIZE,
+                                          spectate->owner_bytes);
+            offset += spectate->owner_bytes;
+            if (size <= 1)
+                *(position++) = owner != 0 ? (char) (owner + '0') : '.';
+            else if (owner != 0)
+                position += sprintf(position, "%*u", (int) cell, owner);
+            else
+                position += sprintf(position, "%*c", (int) cell, '.');
+        }
+        *(position++) = '\n';
+    }
+    *position = '\0';
+    return board;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * Interfejs niezmiennych migawek stanu gry dla obserwatorów.
+ *
+ * Właściciele pól (wiersz po wierszu, bez ramki) i liczniki graczy leżą w
+ * stronach po 256 bajtów, do których prowadzi drzewo o 32 dzieciach w
+ * węźle. Wątek wykonujący ruchy zmienia strony metodą kopiowania przy
+ * zapisie: strona i węzły na ścieżce od korzenia, które należą do
+ * opublikowanej wersji, są kopiowane przy pierwszym zapisie po publikacji,
+ * a nowa wersja jest publikowana jednym zapisem wskaźnika. Czytelnik bierze
+ * wolny slot, zapisuje w nim bieżącą epokę i czyta wskaźnik wersji, więc
+ * nigdy nie czeka na ruch, a ruch nigdy nie czeka na czytelnika. Zastąpione
+ * strony i wersje trafiają na listę z numerem epoki i wracają do puli,
+ * gdy żaden slot nie ma epoki nie późniejszej niż ich numer. Funkcje
+ * czytelnika są zadeklarowane w gamma.h.
+ */
+
+#ifndef GAMMA_SPECTATE_H
+#define GAMMA_SPECTATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+/**
+ * Struktura przechowująca stan migawek planszy po stronie wątku
+ * wykonującego ruchy.
+ */
+typedef struct spectate spectate_t;
+
+/**
+ * Funkcja tworząca migawki pustej planszy. Pierwsza wersja powstaje przy
+ * pierwszym wywołaniu @ref spectate_publish.
+ * @param width - Szerokość planszy.
+ * @param height - Wysokość planszy.
+ * @param players - Liczba graczy.
+ * @param owner_bytes - Rozmiar numeru właściciela pola: 1, 2 lub 4 bajty.
+ * @param readers - Liczba slotów, czyli migawek trzymanych naraz, dodatnia.
+ * @return Wskaźnik na stan migawek lub NULL z ustawionym errno: EOVERFLOW
+ * dla zbyt dużej planszy i ENOMEM, gdy zabrakło pamięci.
+ */
+spectate_t* spectate_new(uint32_t width, uint32_t height, uint32_t players,
+                         uint32_t owner_bytes, uint32_t readers);
+
+/**
+ * Funkcja zwalniająca stan migawek. Żaden czytelnik nie może wtedy trzymać
+ * migawki. Nic nie robi dla NULL.
+ * @param spectate - Wskaźnik na stan migawek.
+ */
+void spectate_delete(spectate_t *spectate);
+
+/**
+ * Funkcja zapisująca właściciela pola w przygotowywanej wersji.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @param x - Numer kolumny.
+ * @param y - Numer wiersza.
+ * @param owner - Numer gracza lub 0 dla pustego pola.
+ */
+void spectate_set_owner(spectate_t *spectate, uint32_t x, uint32_t y,
+                        uint32_t owner);
+
+/**
+ * Funkcja zapisująca liczniki gracza w przygotowywanej wersji.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @param player - Numer gracza.
+ * @param fields - Liczba pól gracza.
+ * @param areas - Liczba obszarów gracza.
+ * @param golden_used - Czy gracz wykorzystał złoty ruch.
+ */
+void spectate_set_player(spectate_t *spectate, uint32_t player,
+                         uint64_t fields, uint32_t areas, bool golden_used);
+
+/**
+ * Funkcja publikująca przygotowaną wersję i zwracająca do puli strony,
+ * których nie trzyma już żaden czytelnik. Gdy wcześniej zabrakło pamięci
+ * na kopię strony, nic nie robi, a @ref spectate_acquire zgłasza błąd.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @param version - Wersja stanu gry.
+ * @param hash - Skrót stanu gry.
+ * @return Wartość false, jeśli któraś kopia strony się nie udała.
+ */
+bool spectate_publish(spectate_t *spectate, uint64_t version, uint64_t hash);
+
+/**
+ * Funkcja biorąca migawkę ostatniej opublikowanej wersji. Może być
+ * wywoływana z dowolnego wątku.
+ * @param spectate - Wskaźnik na stan migawek.
+ * @return Wskaźnik na migawkę lub NULL z ustawionym errno: EAGAIN, gdy
+ * wszystkie sloty są zajęte, a ENOMEM, gdy zabrakło pamięci na kopię
+ * strony i migawki przestały nadążać za grą.
+ */
+gamma_snapshot_t* spectate_acquire(spectate_t *spectate);
+
+#endif //GAMMA_SPECTATE_H
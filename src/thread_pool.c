@@ -0,0 +1,163 @@
+/**
+ * @file
+ * Implementacja puli wątków wykonującej ponumerowane zadania.
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< Potrzebne do wątków POSIX.
+
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/**
+ * Struktura przechowująca stan puli wątków.
+ */
+struct thread_pool {
+    uint32_t threads; ///< Liczba wątków razem z wątkiem wywołującym.
+    pthread_t *workers; ///< Wątki robocze, threads - 1 elementów.
+    pthread_mutex_t lock; ///< Zamek chroniący pola poniżej.
+    pthread_cond_t work; ///< Sygnał nowego wywołania lub zakończenia puli.
+    pthread_cond_t done; ///< Sygnał zakończenia pracy ostatniego wątku.
+    uint64_t generation; ///< Numer bieżącego wywołania thread_pool_run.
+    uint32_t active; ///< Liczba wątków roboczych, które jeszcze pracują.
+    bool stop; ///< Czy wątki robocze mają się zakończyć.
+    bool busy; ///< Czy trwa któreś wywołanie thread_pool_run.
+    thread_task_t task; ///< Zadanie bieżącego wywołania.
+    void *arg; ///< Argument bieżącego wywołania.
+    uint32_t tasks; ///< Liczba zadań bieżącego wywołania.
+    atomic_uint next; ///< Numer następnego zadania do pobrania.
+};
+
+/**
+ * Funkcja pomocnicza pobierająca i wykonująca zadania, dopóki jakieś
+ * zostały.
+ * @param pool - Wskaźnik na pulę.
+ */
+static void run_tasks(thread_pool_t *pool) {
+    uint32_t task;
+    while ((task = atomic_fetch_add_explicit(&(pool->next), 1,
+                                             memory_order_relaxed)) <
+           pool->tasks)
+        pool->task(pool->arg, task);
+}
+
+/**
+ * Główna funkcja wątku roboczego.
+ * @param arg - Wskaźnik na pulę.
+ * @return Zawsze NULL.
+ */
+static void* worker_main(void *arg) {
+    thread_pool_t *pool = arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&(pool->lock));
+    for (;;) {
+        while (!pool->stop && pool->generation == seen)
+            pthread_cond_wait(&(pool->work), &(pool->lock));
+        if (pool->stop)
+            break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&(pool->lock));
+
+        run_tasks(pool);
+
+        pthread_mutex_lock(&(pool->lock));
+        if (--(pool->active) == 0)
+            pthread_cond_signal(&(pool->done));
+    }
+    pthread_mutex_unlock(&(pool->lock));
+    return NULL;
+}
+
+/**
+ * Funkcja pomocnicza kończąca pierwsze @p started wątków roboczych puli.
+ * @param pool - Wskaźnik na pulę.
+ * @param started - Liczba uruchomionych wątków roboczych.
+ */
+static void stop_workers(thread_pool_t *pool, uint32_t started) {
+    pthread_mutex_lock(&(pool->lock));
+    pool->stop = true;
+    pthread_cond_broadcast(&(pool->work));
+    pthread_mutex_unlock(&(pool->lock));
+    for (uint32_t i = 0; i < started; ++i)
+        pthread_join(pool->workers[i], NULL);
+}
+
+thread_pool_t* thread_pool_new(uint32_t threads) {
+    if (threads < 2)
+        return NULL;
+    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    if (pool == NULL)
+        return NULL;
+    pool->workers = malloc(sizeof(pthread_t) * (threads - 1));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->threads = threads;
+    pool->generation = 0;
+    pool->active = 0;
+    pool->stop = false;
+    pool->busy = false;
+    pool->tasks = 0;
+    atomic_init(&(pool->next), 0);
+    pthread_mutex_init(&(pool->lock), NULL);
+    pthread_cond_init(&(pool->work), NULL);
+    pthread_cond_init(&(pool->done), NULL);
+
+    for (uint32_t i = 0; i < threads - 1; ++i) {
+        if (pthread_create(&(pool->workers[i]), NULL, worker_main, pool) != 0) {
+            stop_workers(pool, i);
+            pool->threads = 1;
+            thread_pool_delete(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void thread_pool_delete(thread_pool_t *pool) {
+    if (pool == NULL)
+        return;
+    if (pool->threads > 1)
+        stop_workers(pool, pool->threads - 1);
+    pthread_mutex_destroy(&(pool->lock));
+    pthread_cond_destroy(&(pool->work));
+    pthread_cond_destroy(&(pool->done));
+    free(pool->workers);
+    free(pool);
+}
+
+uint32_t thread_pool_threads(const thread_pool_t *pool) {
+    return pool->threads;
+}
+
+void thread_pool_run(thread_pool_t *pool, uint32_t tasks, thread_task_t task,
+                     void *arg) {
+    pthread_mutex_lock(&(pool->lock));
+    if (pool->busy) {
+        pthread_mutex_unlock(&(pool->lock));
+        for (uint32_t i = 0; i < tasks; ++i)
+            task(arg, i);
+        return;
+    }
+    pool->busy = true;
+    pool->task = task;
+    pool->arg = arg;
+    pool->tasks = tasks;
+    atomic_store_explicit(&(pool->next), 0, memory_order_relaxed);
+    pool->active = pool->threads - 1;
+    ++(pool->generation);
+    pthread_cond_broadcast(&(pool->work));
+    pthread_mutex_unlock(&(pool->lock));
+
+    run_tasks(pool);
+
+    pthread_mutex_lock(&(pool->lock));
+    while (pool->active > 0)
+        pthread_cond_wait(&(pool->done), &(pool->lock));
+    pool->busy = false;
+    pthread_mutex_unlock(&(pool->lock));
+}
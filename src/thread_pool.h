@@ -0,0 +1,62 @@
+/**
+ * @file
+ * Interfejs prostej puli wątków wykonującej ponumerowane zadania.
+ * Wątek wywołujący @ref thread_pool_run również wykonuje zadania, więc pula
+ * dla n wątków uruchamia n - 1 wątków roboczych.
+ */
+
+#ifndef GAMMA_THREAD_POOL_H
+#define GAMMA_THREAD_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Struktura przechowująca stan puli wątków.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * Zadanie wykonywane przez pulę.
+ * @param arg - Argument przekazany do @ref thread_pool_run.
+ * @param task - Numer zadania, od 0 do liczby zadań - 1.
+ */
+typedef void (*thread_task_t)(void *arg, uint32_t task);
+
+/**
+ * Funkcja tworząca pulę @p threads wątków.
+ * @param threads - Liczba wątków razem z wątkiem wywołującym, co najmniej 2.
+ * @return Wskaźnik na pulę lub NULL, gdy nie udało się zaalokować pamięci
+ * lub uruchomić wątków.
+ */
+thread_pool_t* thread_pool_new(uint32_t threads);
+
+/**
+ * Funkcja kończąca wątki puli i zwalniająca jej pamięć. Nic nie robi, jeśli
+ * @p pool jest NULL.
+ * @param pool - Wskaźnik na pulę.
+ */
+void thread_pool_delete(thread_pool_t *pool);
+
+/**
+ * Funkcja podająca liczbę wątków puli razem z wątkiem wywołującym.
+ * @param pool - Wskaźnik na pulę.
+ * @return Liczba wątków.
+ */
+uint32_t thread_pool_threads(const thread_pool_t *pool);
+
+/**
+ * Funkcja wykonująca zadania od 0 do @p tasks - 1 na wątkach puli i wątku
+ * wywołującym. Zadania są rozdzielane dynamicznie; funkcja wraca dopiero po
+ * zakończeniu wszystkich, a ich zapisy są wtedy widoczne dla wywołującego.
+ * Jeśli pula wykonuje już wywołanie z innego wątku, wszystkie zadania
+ * wykonuje wątek wywołujący.
+ * @param pool - Wskaźnik na pulę.
+ * @param tasks - Liczba zadań.
+ * @param task - Funkcja wykonująca jedno zadanie.
+ * @param arg - Argument przekazywany do każdego zadania.
+ */
+void thread_pool_run(thread_pool_t *pool, uint32_t tasks, thread_task_t task,
+                     void *arg);
+
+#endif //GAMMA_THREAD_POOL_H
@@ -0,0 +1,37 @@
+/**
+ * @file
+ * Implementacja modułu pilnującego kolejności tur.
+ */
+#include "turn.h"
+
+void turn_reset(turn_t *turn) {
+    turn->player = TURN_FIRST_PLAYER;
+    turn->skip_count = 0;
+}
+
+bool turn_game_over(const turn_t *turn, gamma_t *g) {
+    return turn->skip_count >= gamma_get_players(g) || gamma_game_over(g);
+}
+
+/**
+ * Funkcja pomocnicza przekazująca turę następnemu graczowi.
+ * @param turn - Wskaźnik na stan kolejki.
+ * @param g - Wskaźnik na planszę.
+ */
+static void next_player(turn_t *turn, gamma_t *g) {
+    turn->player = turn->player % gamma_get_players(g) + 1;
+}
+
+bool turn_begin(turn_t *turn, gamma_t *g) {
+    if (!gamma_can_move(g, turn->player)) {
+        next_player(turn, g);
+        ++(turn->skip_count);
+        return false;
+    }
+    return true;
+}
+
+void turn_end(turn_t *turn, gamma_t *g) {
+    next_player(turn, g);
+    turn->skip_count = 0;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * Interfejs modułu pilnującego kolejności tur. Gracze ruszają się po kolei
+ * od gracza 1. Gracz, który nie może wykonać ani zwykłego, ani złotego
+ * ruchu, traci turę. Gra kończy się, gdy żaden gracz nie może wykonać ruchu,
+ * bez czekania, aż każdy z nich straci turę. Moduł jest wspólny dla trybu
+ * interaktywnego i rozgrywek automatycznych.
+ */
+#ifndef GAMMA_TURN_H
+#define GAMMA_TURN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+/** Gracz rozpoczynający grę. */
+#define TURN_FIRST_PLAYER 1
+
+/**
+ * Stan kolejki graczy.
+ */
+typedef struct turn {
+    uint32_t player; ///< Gracz, który ma turę.
+    uint32_t skip_count; ///< Liczba utraconych z rzędu tur.
+} turn_t;
+
+/**
+ * Funkcja ustawiająca kolejkę na początek gry.
+ * @param turn - Wskaźnik na stan kolejki.
+ */
+void turn_reset(turn_t *turn);
+
+/**
+ * Funkcja sprawdzająca, czy gra się skończyła.
+ * @param turn - Wskaźnik na stan kolejki.
+ * @param g - Wskaźnik na planszę.
+ * @return Wartość true, jeśli żaden gracz nie może wykonać ruchu lub turę
+ * straciło z rzędu tylu graczy, ilu gra.
+ */
+bool turn_game_over(const turn_t *turn, gamma_t *g);
+
+/**
+ * Funkcja rozpoczynająca turę gracza @p turn->player. Gracz bez żadnego
+ * ruchu traci turę: kolejka przechodzi do następnego gracza.
+ * @param turn - Wskaźnik na stan kolejki.
+ * @param g - Wskaźnik na planszę.
+ * @return Wartość true, jeśli gracz może wykonać ruch, a false, jeśli stracił
+ * turę.
+ */
+bool turn_begin(turn_t *turn, gamma_t *g);
+
+/**
+ * Funkcja kończąca turę gracza, który mógł wykonać ruch, także jeśli z ruchu
+ * zrezygnował.
+ * @param turn - Wskaźnik na stan kolejki.
+ * @param g - Wskaźnik na planszę.
+ */
+void turn_end(turn_t *turn, gamma_t *g);
+
+#endif //GAMMA_TURN_H